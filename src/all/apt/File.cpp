@@ -1,25 +1,40 @@
 #include <apt/File.h>
 
+#include <algorithm> // max
 #include <cstdlib> // malloc, free
 #include <cstring> // memcpy
 #include <utility> // swap
 
 using namespace apt;
 
+void apt::swap(File& _a, File& _b)
+{
+	using std::swap;
+	swap(_a.m_path,     _b.m_path);
+	swap(_a.m_data,     _b.m_data);
+	swap(_a.m_dataSize, _b.m_dataSize);
+	swap(_a.m_dataCapacity, _b.m_dataCapacity);
+	swap(_a.m_impl,     _b.m_impl);
+	swap(_a.m_isMapped, _b.m_isMapped);
+}
+
 // PUBLIC
 
 void File::setData(const char* _data, uint64 _size)
 {
+	unmap();
 	if (m_data) {
-		if (_size > m_dataSize || _size == 0) {
+		if (_size > m_dataCapacity || _size == 0) {
 			free(m_data);
 			m_data = 0;
+			m_dataCapacity = 0;
 		}
 	}
 
 	if (!m_data && _size > 0) {
 		m_data = (char*)malloc(_size);
 		APT_ASSERT(m_data);
+		m_dataCapacity = _size;
 	}
 	if (_data) {
 		memcpy(m_data, _data, _size);
@@ -29,7 +44,13 @@ void File::setData(const char* _data, uint64 _size)
 
 void File::appendData(const char* _data, uint64 _size)
 {
-	m_data = (char*)realloc(m_data, m_dataSize + _size);
+	APT_ASSERT_MSG(!m_isMapped, "File::appendData: '%s' is mapped (read only)", getPath());
+	uint64 size = m_dataSize + _size;
+	if (size > m_dataCapacity) {
+		m_dataCapacity = std::max(size, m_dataCapacity * 2);
+		m_data = (char*)realloc(m_data, m_dataCapacity);
+		APT_ASSERT(m_data);
+	}
 	if (_data) {
 		memcpy(m_data + m_dataSize, _data, _size);
 	}
@@ -43,11 +64,14 @@ void File::ctorCommon()
 {
 	m_data = nullptr;
 	m_dataSize = 0;
+	m_dataCapacity = 0;
 	m_impl = nullptr;
+	m_isMapped = false;
 }
 
 void File::dtorCommon()
 {
+	unmap();
 	if (m_data) {
 		free(m_data);
 		m_data = nullptr;
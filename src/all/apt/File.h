@@ -34,6 +34,12 @@ public:
 	//   interpreted directly as a C string.
 	static bool Read(File& file_, const char* _path = 0);
 
+	// Map the file at _path, or file_.getPath() if _path is 0, into memory. getData() points directly to the mapped 
+	// view, which is read only and remains valid until file_ is destroyed or its data is replaced. Return false if an
+	// error occurred, in which case file_ remains unchanged.
+	// \note Unlike Read() there is no implicit null appended to the data.
+	static bool Map(File& file_, const char* _path = 0);
+
 	// Write file to _path, or _file.getPath() if _path is 0. Return false if an error occurred, 
 	// in which case any existing file at _path may or may not have been overwritten.
 	static bool Write(const File& _file, const char* _path = 0);
@@ -42,7 +48,8 @@ public:
 	// is 0 the buffer is allocated.
 	void        setData(const char* _data, uint64 _size);
 
-	// Append _size bytes from _data to the internal buffer. If _data is 0 the internal buffer is reallocated.
+	// Append _size bytes from _data to the internal buffer. If _data is 0 the internal buffer is reallocated. The
+	// buffer grows geometrically, hence many small appends are amortized O(1).
 	void        appendData(const char* _data, uint64 _size);
 
 	const char* getPath() const                                 { return (const char*)m_path; }
@@ -51,16 +58,22 @@ public:
 	char*       getData()                                       { return m_data; }
 	uint64      getDataSize() const                             { return m_dataSize; }
 	void        setDataSize(uint64 _size)                       { setData(0, _size); }
+	bool        isMapped() const                                { return m_isMapped; }
+
+	friend void swap(File& _a, File& _b);
 
 
 private:
 	PathStr m_path;
 	char*   m_data;
 	uint64  m_dataSize;
+	uint64  m_dataCapacity; // allocated size of m_data (0 if mapped)
 	void*   m_impl;
+	bool    m_isMapped;
 
 	void ctorCommon();
 	void dtorCommon();
+	void unmap(); // release the view/mapping handle if m_isMapped, platform specific
 
 };
 
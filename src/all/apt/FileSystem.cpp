@@ -125,49 +125,30 @@ PathStr FileSystem::MakePath(const char* _path, RootType _root)
 	return PathStr(_path);
 }
 
-PathStr FileSystem::StripPath(const char* _path)
+StringView FileSystem::StripPath(const StringView& _path)
 {
-	const char* beg = _path;
-	while (*_path) {
-		if (*_path == '/' || *_path == '\\') {
-			beg = _path + 1;
-		}
-		++_path;
-	}
-	return PathStr(beg);
+	const char* beg = _path.findLast("/\\");
+	return beg ? StringView(beg + 1, _path.end()) : _path;
 }
 
-PathStr FileSystem::GetPath(const char* _path)
+StringView FileSystem::GetPath(const StringView& _path)
 {
-	const char* beg = _path;
-	const char* end = _path;
-	while (*_path) {
-		if (*_path == '/' || *_path == '\\') {
-			end = _path + 1;
-		}
-		++_path;
-	}
-	PathStr ret;
-	ret.set(beg, end - beg);
-	return ret;
+	const char* end = _path.findLast("/\\");
+	return StringView(_path.begin(), end ? end + 1 : _path.begin());
 }
 
-PathStr FileSystem::GetFileName(const char* _path)
+StringView FileSystem::GetFileName(const StringView& _path)
 {
-	const char* beg = _path;
-	while (*_path) {
-		if (*_path == '/' || *_path == '\\') {
-			beg = _path + 1;
-		}
-		++_path;
-	}
-	const char* end = beg;
-	while (*end && *end != '.') {
-		++end;
-	}
-	PathStr ret;
-	ret.set(beg, end - beg);
-	return ret;
+	StringView ret = StripPath(_path);
+	const char* end = ret.findFirst('.');
+	return end ? StringView(ret.begin(), end) : ret;
+}
+
+StringView FileSystem::GetExtension(const StringView& _path)
+{
+	StringView ret = StripPath(_path);
+	const char* beg = ret.findLast('.');
+	return beg ? StringView(beg + 1, ret.end()) : StringView(ret.end(), ret.end());
 }
 
 const char* FileSystem::FindExtension(const char* _path)
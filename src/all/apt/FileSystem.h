@@ -54,6 +54,10 @@ public:
 	// Delete a file.
 	static bool        Delete(const char* _path);
 
+	// Rename the file at _from to _to, replacing _to if it exists. The replacement is atomic where the platform permits,
+	// i.e. a reader of _to sees either the old or the new file. Return false if an error occurred.
+	static bool        Rename(const char* _from, const char* _to);
+
 	// Get the creation/last modified time for a file. The path is constructed as per Read(). 
 	static DateTime    GetTimeCreated(const char* _path, RootType _rootHint = RootType_Default);
 	static DateTime    GetTimeModified(const char* _path, RootType _rootHint = RootType_Default);
@@ -79,15 +83,23 @@ public:
 
 	// Strip any root from _path, or the whole path if _path is absolute.
 	static PathStr     StripRoot(const char* _path);
-	// Strip path from _path.
-	static PathStr     StripPath(const char* _path);
 
+	// The following functions return a view into _path (no copy is made), hence the result is only valid during the 
+	// lifetime of _path. Construct a PathStr from the result if a copy is required. Passing a temporary string (e.g.
+	// GetExtension(MakePath(...))) would return a dangling view and doesn't compile.
+
+	// Strip path from _path.
+	static StringView  StripPath(const StringView& _path);
+	static StringView  StripPath(StringBase&& _path) = delete;
 	// Extract path from _path (remove file name + extension).
-	static PathStr     GetPath(const char* _path);
+	static StringView  GetPath(const StringView& _path);
+	static StringView  GetPath(StringBase&& _path) = delete;
 	// Extract file name from _path (remove path + extension).
-	static PathStr     GetFileName(const char* _path);
+	static StringView  GetFileName(const StringView& _path);
+	static StringView  GetFileName(StringBase&& _path) = delete;
 	// Extract extension from _path (remove path + file name).
-	static PathStr     GetExtension(const char* _path) { return PathStr(FindExtension(_path)); }
+	static StringView  GetExtension(const StringView& _path);
+	static StringView  GetExtension(StringBase&& _path) = delete;
 
 	// Return ptr to the character following the last occurrence of '.' in _path.
 	static const char* FindExtension(const char* _path);
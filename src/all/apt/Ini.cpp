@@ -2,7 +2,10 @@
 
 #include <apt/log.h>
 #include <apt/memory.h>
+#include <apt/numeric.h>
+#include <apt/simd_string.h>
 #include <apt/File.h>
+#include <apt/FileSystem.h>
 #include <apt/String.h>
 #include <apt/TextParser.h>
 #include <apt/Time.h>
@@ -13,10 +16,72 @@ static const char* kLineEnd = "\n";
 
 #define INI_ERROR(line, msg) APT_LOG_ERR("Ini syntax error, line %d: '%s'", line, msg)
 
+// Index entries combine the name hash with the section index, or one of the following.
+enum { kIndexAnySection = -1, kIndexSection = -2 };
+static uint64 IndexHash(StringHash _name, int _section)
+{
+	return _name.getHash() ^ ((uint64)(_section + 3) * 0x9E3779B97F4A7C15ull);
+}
+
+// Binary image layout. Offsets are in bytes from the start of the image, which contains (in order) the header, section
+// table, key table, values, hash index and a blob of null-terminated names/string values. Names and string values are
+// stored as offsets (string values in Value::m_int).
+static const uint32 kBinaryMagic   = 0x494E4900; // "\0INI", a text Ini can't begin with a null
+static const uint32 kBinaryVersion = 1;
+
+struct Ini::BinaryHeader
+{
+	uint32 m_magic;
+	uint32 m_version;
+	uint32 m_size;
+	uint32 m_sectionCount;
+	uint32 m_keyCount;
+	uint32 m_valueCount;
+	uint32 m_indexSize;
+	uint32 m_sections;
+	uint32 m_keys;
+	uint32 m_values;
+	uint32 m_index;
+	uint32 m_strings;
+};
+struct BinarySection
+{
+	uint32 m_name;
+	sint32 m_propertyCount;
+	sint32 m_keyOffset;
+};
+struct BinaryKey
+{
+	uint32 m_name;
+	sint32 m_type;
+	sint32 m_valueCount;
+	sint32 m_valueOffset;
+};
+
+static bool IsBinary(const char* _data, uint64 _size)
+{
+	uint32 magic;
+	if (_size < sizeof(magic)) {
+		return false;
+	}
+	memcpy(&magic, _data, sizeof(magic));
+	return magic == kBinaryMagic;
+}
+
+static uint32 AlignOffset(uint32 _offset, uint32 _align)
+{
+	return (_offset + _align - 1) & ~(_align - 1);
+}
+
 // PUBLIC
 
 bool Ini::Read(Ini& iniFile_, const File& _file)
 {
+	if (IsBinary(_file.getData(), _file.getDataSize())) {
+		iniFile_.m_image.setData(_file.getData(), _file.getDataSize());
+		return iniFile_.loadImage();
+	}
+	APT_ASSERT(!_file.isMapped()); // mapped text isn't null terminated, use File::Read()
 	return iniFile_.parse(_file.getData());
 }
 
@@ -24,33 +89,83 @@ bool Ini::Read(Ini& iniFile_, const char* _path)
 {
 	APT_AUTOTIMER("Ini::Read(%s)", _path);
 	File f;
+	if (!File::Map(f, _path)) {
+		return false;
+	}
+	if (IsBinary(f.getData(), f.getDataSize())) {
+		swap(iniFile_.m_image, f); // keep the mapping, the Ini operates directly on the image
+		return iniFile_.loadImage();
+	}
+ // text needs a null terminator which the mapped view doesn't have, read the file instead (releases the mapping)
 	if (!File::Read(f, _path)) {
 		return false;
 	}
-	return Read(iniFile_, f);
+	return iniFile_.parse(f.getData());
+}
+
+bool Ini::ReadCached(Ini& iniFile_, const char* _path, const char* _cachePath)
+{
+	File::PathStr cachePath;
+	if (_cachePath) {
+		cachePath.set(_cachePath);
+	} else {
+		cachePath.setf("%s.bin", _path);
+	}
+	if (File::Exists((const char*)cachePath) && FileSystem::GetTimeModified((const char*)cachePath, FileSystem::RootType_Root) >= FileSystem::GetTimeModified(_path, FileSystem::RootType_Root)) {
+	 // only accept a binary image, a corrupt cache must not be parsed as text
+		File f;
+		if (File::Map(f, (const char*)cachePath) && IsBinary(f.getData(), f.getDataSize())) {
+			swap(iniFile_.m_image, f);
+			if (iniFile_.loadImage()) {
+				return true;
+			}
+		}
+		APT_LOG_ERR("Ini::ReadCached: failed to read cache '%s', reparsing '%s'", (const char*)cachePath, _path);
+	}
+	if (!Read(iniFile_, _path)) {
+		return false;
+	}
+
+ // write to a temporary file and rename it over the cache, a reader never sees a partially written cache
+	File::PathStr tmpPath;
+	tmpPath.setf("%s.tmp", (const char*)cachePath);
+	if (!Write(iniFile_, (const char*)tmpPath, Format_Binary) || !FileSystem::Rename((const char*)tmpPath, (const char*)cachePath)) {
+		APT_LOG_ERR("Ini::ReadCached: failed to write cache '%s'", (const char*)cachePath); // not fatal, iniFile_ is valid
+		FileSystem::Delete((const char*)tmpPath);
+	}
+	return true;
 }
 
-bool Ini::Write(const Ini& _iniFile, File& file_)
+bool Ini::Write(const Ini& _iniFile, File& file_, Format _format)
 {
-	String<0> buf;
+	if (_format == Format_Binary) {
+		return _iniFile.writeImage(file_);
+	}
+	if (_iniFile.m_header) {
+		APT_LOG_ERR("Ini::Write: binary images can only be written as Format_Binary");
+		return false;
+	}
+
+	StringBuilder buf;
+	char num[kMaxDoubleStringLength];
 
 	for (auto& section : _iniFile.m_sections) {
 		if (section.m_propertyCount == 0) { // skip empty sections
 			continue;
 		}
-		if (!section.m_name.isEmpty()) { // default empty section
-			buf.appendf("[%s]\n", (const char*)section.m_name);
+		if (*section.m_name != '\0') { // default empty section
+			buf.appendf("[%s]\n", section.m_name);
 		}
 
 		for (int i = section.m_keyOffset, n = i + section.m_propertyCount; i < n; ++i) {
 			const Key& key = _iniFile.m_keys[i];
-			buf.appendf("%s = ", (const char*)key.m_name);
+			buf.appendf("%s = ", key.m_name);
 			for (int j = key.m_valueOffset, m = j + key.m_valueCount; j < m; ++j) {
 				const Value& val = _iniFile.m_values[j];
 				switch (key.m_type) {
 				case ValueType_Bool:     buf.append(val.m_bool ? "true" : "false"); break;
-				case ValueType_Int:      buf.appendf("%d", val.m_int); break;
-				case ValueType_Double:   buf.appendf("%1.10f", val.m_double); break; // \todo better float representation for printing; want to print the smallest number of significant digits
+				case ValueType_Int:      IntToString(num, val.m_int); buf.append(num); break;
+				case ValueType_Double:   DoubleToString(num, val.m_double); buf.append(num); break;
 				case ValueType_String:   buf.appendf("\"%s\"", val.m_string); break;
 				default:                 APT_ASSERT(false);
 				};
@@ -67,61 +182,79 @@ bool Ini::Write(const Ini& _iniFile, File& file_)
 	return true;
 }
 
-bool Ini::Write(const Ini& _iniFile, const char* _path)
+bool Ini::Write(const Ini& _iniFile, const char* _path, Format _format)
 {
 	APT_AUTOTIMER("Ini::Write(%s)", _path);
 	File f;
-	if (Write(_iniFile, f)) {
+	if (Write(_iniFile, f, _format)) {
 		return File::Write(f, _path);
 	}
 	return false;
 }
 
 Ini::Ini()
+	: m_indexCount(0)
+	, m_header(0)
 {
  // push default section
 	Section s = { "", 0, (int)m_keys.size() };
-	m_sections.push_back(s);
+	addSection(s);
 }
 
 Ini::~Ini()
 {
-	for (auto& key : m_keys) {
-		if (key.m_type != ValueType_String) {
-			continue;
-		}
-		for (int i = key.m_valueOffset; i < key.m_valueOffset + key.m_valueCount; ++i) {
-			APT_FREE(m_values[i].m_string);
-		}
-	}
+ // names and string values are freed with m_arena
 }
 
 Ini::Property Ini::getProperty(const char* _name, const char* _section) const
+{
+	return getProperty(StringView(_name), _section ? StringView(_section) : StringView());
+}
+
+Ini::Property Ini::getProperty(const StringView& _name, const StringView& _section) const
+{
+	return getProperty(StringHash(_name), _section.isNull() ? StringHash() : StringHash(_section));
+}
+
+Ini::Property Ini::getProperty(StringHash _name, StringHash _section) const
 {
 	Property ret(ValueType_Bool, 0, 0);
 
-	const Section* section = _section ? findSection(_section) : 0;
-	const Key* key = findKey(_name, section);
-	if (key) {
-		ret.m_type  = key->m_type;
-		ret.m_count = key->m_valueCount;
-		ret.m_first = &const_cast<Value&>(m_values[key->m_valueOffset]);
+	int section = _section == StringHash::kInvalidHash ? -1 : findSection(_section);
+	int key = findKey(_name, section);
+	if (key != -1 && m_header) {
+		if ((uint32)key >= m_header->m_keyCount) { // index entries are only validated against the larger of the section/key counts
+			return ret;
+		}
+		const char* image = (const char*)m_header;
+		const BinaryKey& k = ((const BinaryKey*)(image + m_header->m_keys))[key];
+		ret.m_type  = (ValueType)k.m_type;
+		ret.m_count = k.m_valueCount;
+		ret.m_first = (Value*)(image + m_header->m_values) + k.m_valueOffset;
+		ret.m_image = image;
+	} else if (key != -1) {
+		const Key& k = m_keys[key];
+		ret.m_type  = k.m_type;
+		ret.m_count = k.m_valueCount;
+		ret.m_first = &const_cast<Value&>(m_values[k.m_valueOffset]);
 	}
 	return ret;
 }
 
 void Ini::pushSection(const char* _name)
 {
-	APT_ASSERT_MSG(findSection(_name) == 0, "Ini::pushSection: '%s' already exists", _name);
-	Section s = { NameStr(_name), 0, (int)m_keys.size() };
-	m_sections.push_back(s);
+	APT_ASSERT_MSG(!m_header, "Ini::pushSection: binary images are read only");
+	APT_ASSERT_MSG(findSection(_name) == -1, "Ini::pushSection: '%s' already exists", _name);
+	Section s = { m_arena.allocString(_name, (uint)strlen(_name)), 0, (int)m_keys.size() };
+	addSection(s);
 }
 
 #define APT_Ini_pushValueArray(_type, _typeEnum, _valueMember) \
 	template <> void Ini::pushValueArray<_type>(const char* _name, const _type _value[], int _count) { \
-		APT_ASSERT_MSG(findKey(_name, &m_sections.back()) == 0, "Ini::pushValue: '%s' already exists in section '%s'", _name, m_sections.back().m_name.isEmpty() ? "default" : (const char*)m_sections.back().m_name); \
-		Key key = { NameStr(_name), ValueType:: ## _typeEnum, _count, (int)m_values.size() }; \
-		m_keys.push_back(key); \
+		APT_ASSERT_MSG(!m_header, "Ini::pushValue: binary images are read only"); \
+		APT_ASSERT_MSG(findKey(_name, (int)m_sections.size() - 1) == -1, "Ini::pushValue: '%s' already exists in section '%s'", _name, *m_sections.back().m_name == '\0' ? "default" : m_sections.back().m_name); \
+		Key key = { m_arena.allocString(_name, (uint)strlen(_name)), ValueType:: ## _typeEnum, _count, (int)m_values.size() }; \
+		addKey(key); \
 		for (int i = 0; i < _count; ++i) { \
 			m_values.push_back(Value()); \
 			m_values.back(). ## _valueMember = _value[i]; \
@@ -136,13 +269,13 @@ APT_Ini_pushValueArray(float,  ValueType_Double, m_double)
 
 void Ini::pushValueArray(const char* _name, const char* _value[], int _count)
 {
-	APT_ASSERT_MSG(findKey(_name, &m_sections.back()) == 0, "Ini::pushValue: '%s' already exists in section '%s'", _name, m_sections.back().m_name.isEmpty() ? "default" : (const char*)m_sections.back().m_name);
-	Key key = { NameStr(_name), ValueType_String, _count, (int)m_values.size() };
-	m_keys.push_back(key);
+	APT_ASSERT_MSG(!m_header, "Ini::pushValue: binary images are read only");
+	APT_ASSERT_MSG(findKey(_name, (int)m_sections.size() - 1) == -1, "Ini::pushValue: '%s' already exists in section '%s'", _name, *m_sections.back().m_name == '\0' ? "default" : m_sections.back().m_name);
+	Key key = { m_arena.allocString(_name, (uint)strlen(_name)), ValueType_String, _count, (int)m_values.size() };
+	addKey(key);
 	for (int i = 0; i < _count; ++i) {
 		m_values.push_back(Value());
-		m_values.back().m_string = (char*)APT_MALLOC(sizeof(char*) * (strlen(_value[i]) + 1));
-		strcpy(m_values.back().m_string, _value[i]);
+		m_values.back().m_string = m_arena.allocString(_value[i], (uint)strlen(_value[i]));
 	}
 	++m_sections.back().m_propertyCount;
 }
@@ -152,12 +285,25 @@ void Ini::pushValueArray(const char* _name, const char* _value[], int _count)
 bool Ini::parse(const char* _str)
 {
 	APT_ASSERT(_str);
+	if (m_header) {
+		APT_LOG_ERR("Ini::Read: can't append text to a binary image");
+		return false;
+	}
 	
 	if (m_sections.empty()) {
 		Section s = { "", 0, (int)m_keys.size() };
-		m_sections.push_back(s);
+		addSection(s);
 	}
 
+ // reserve storage up front, the counts include any '=', ',' and '[' in comments/strings hence may be an overestimate
+	const char* end = internal::FindChar(_str, '\0');
+	uint keyCount = internal::CountChar(_str, end, '=');
+	uint sectionCount = internal::CountChar(_str, end, '[');
+	m_sections.reserve(m_sections.size() + sectionCount);
+	m_keys.reserve(m_keys.size() + keyCount);
+	m_values.reserve(m_values.size() + keyCount + internal::CountChar(_str, end, ','));
+	reserveIndex(m_indexCount + keyCount * 2 + sectionCount);
+
 	TextParser tp(_str);
 	while (!tp.isNull()) {
 		tp.skipWhitespace();
@@ -172,9 +318,8 @@ bool Ini::parse(const char* _str)
 				INI_ERROR(tp.getLineCount(beg), "Unterminated section");
 				return false;
 			}
-			Section s = { NameStr(), 0, (int)m_keys.size() };
-			s.m_name.set(beg, tp - beg);
-			m_sections.push_back(s);
+			Section s = { m_arena.allocString(beg, (uint)(tp - beg)), 0, (int)m_keys.size() };
+			addSection(s);
 			tp.advance(); // skip ']'
 		} else if (*tp == '=' || *tp == ',') {
 			if (m_keys.empty()) {
@@ -204,9 +349,7 @@ bool Ini::parse(const char* _str)
 				Value v;
 				sint n = tp - beg;
 				tp.advance(); // skip '"'
-				v.m_string = (char*)APT_MALLOC(sizeof(char) * (n + 1));;
-				strncpy(v.m_string, beg, n);
-				v.m_string[n] = '\0';
+				v.m_string = m_arena.allocString(beg, (uint)n);
 				m_values.push_back(v);
 
 			} else if (*tp == 't' || *tp == 'f') {
@@ -221,26 +364,17 @@ bool Ini::parse(const char* _str)
 			 // value is a number
 				const char* beg = tp;
 				tp.advanceToNextWhitespaceOr(',');
-				long int l = strtol(beg, 0, 0);
-				double d = strtod(beg, 0);
+				const char* num = beg + (*beg == '-' || *beg == '+' ? 1 : 0);
 				Value v;
-				if (d == 0.0 && l != 0) {
-				 // value was an int
+				if ((num[0] == '0' && (num[1] == 'x' || num[1] == 'X')) || !tp.containsAny(beg, ".eEnN")) { // n/N to catch INF/NAN
+				 // value is an int (hex values may contain 'e')
 					k.m_type = ValueType_Int;
-					v.m_int = (sint64)l;
-				} else if (l == 0 && d != 0.0) {
-				 // value was a double
-					k.m_type = ValueType_Double;
-					v.m_double = d;
+					v.m_int = 0;
+					ParseInt(v.m_int, beg);
 				} else {
-				 // both were nonzero, guess if an int or a double was intended
-					if (tp.containsAny(beg, ".eEnN")) { // n/N to catch INF/NAN
-						k.m_type = ValueType_Double;
-						v.m_double = d;
-					} else {
-						k.m_type = ValueType_Int;
-						v.m_int = (sint64)l;
-					}
+					k.m_type = ValueType_Double;
+					v.m_double = 0.0;
+					ParseDouble(v.m_double, beg);
 				}
 				m_values.push_back(v);
 
@@ -268,10 +402,10 @@ bool Ini::parse(const char* _str)
 			}
 
 			Key k;
-			k.m_name.set(beg, tp - beg);
+			k.m_name = m_arena.allocString(beg, (uint)(tp - beg));
 			k.m_valueOffset = (int)m_values.size();
 			k.m_valueCount = 0;
-			m_keys.push_back(k);
+			addKey(k);
 
 			++m_sections.back().m_propertyCount;
 		}
@@ -279,28 +413,245 @@ bool Ini::parse(const char* _str)
 	return true;
 }
 
-const Ini::Section* Ini::findSection(const char* _name) const
+void Ini::addSection(const Section& _section)
 {
-	for (auto& section : m_sections) {
-		if (section.m_name == _name) {
-			return &section;
+	int i = (int)m_sections.size();
+	m_sections.push_back(_section);
+	StringHash name(_section.m_name);
+	if (findSection(name) == -1) { // first occurrence only
+		insertIndexEntry(IndexHash(name, kIndexSection), i);
+	}
+}
+
+void Ini::addKey(const Key& _key)
+{
+	int i = (int)m_keys.size();
+	m_keys.push_back(_key);
+	StringHash name(_key.m_name);
+	int section = (int)m_sections.size() - 1; // keys are always pushed to the last section
+	if (findKey(name, section) == -1) {
+		insertIndexEntry(IndexHash(name, section), i);
+	}
+	if (findKey(name, -1) == -1) {
+		insertIndexEntry(IndexHash(name, kIndexAnySection), i);
+	}
+}
+
+int Ini::findSection(StringHash _name) const
+{
+	const IndexEntry* entry = findIndexEntry(IndexHash(_name, kIndexSection));
+	return entry ? entry->m_index : -1;
+}
+
+int Ini::findKey(StringHash _name, int _section) const
+{
+	const IndexEntry* entry = findIndexEntry(IndexHash(_name, _section < 0 ? kIndexAnySection : _section));
+	return entry ? entry->m_index : -1;
+}
+
+const Ini::IndexEntry* Ini::findIndexEntry(uint64 _hash) const
+{
+	const IndexEntry* index = m_index.data();
+	uint size = (uint)m_index.size();
+	if (m_header) {
+		index = (const IndexEntry*)((const char*)m_header + m_header->m_index);
+		size = m_header->m_indexSize;
+	}
+	if (size == 0) {
+		return 0;
+	}
+	const uint mask = size - 1;
+	uint i = (uint)(_hash ^ (_hash >> 32)) & mask;
+	while (index[i].m_index != -1 && index[i].m_hash != _hash) {
+		i = (i + 1) & mask;
+	}
+	return &index[i];
+}
+
+void Ini::insertIndexEntry(uint64 _hash, int _index)
+{
+	reserveIndex(m_indexCount + 1);
+	IndexEntry& entry = m_index[findIndexEntry(_hash) - m_index.data()];
+	APT_ASSERT(entry.m_index == -1);
+	entry.m_hash  = _hash;
+	entry.m_index = _index;
+	++m_indexCount;
+}
+
+void Ini::reserveIndex(int _count)
+{
+ // keep the load factor <= 1/2
+	uint size = m_index.empty() ? 64 : (uint)m_index.size();
+	while ((uint)_count * 2 > size) {
+		size *= 2;
+	}
+	if (size == (uint)m_index.size()) {
+		return;
+	}
+	eastl::vector<IndexEntry> old;
+	old.swap(m_index);
+	IndexEntry empty = { 0, -1 };
+	m_index.resize(size, empty);
+	for (auto& entry : old) {
+		if (entry.m_index != -1) {
+			m_index[findIndexEntry(entry.m_hash) - m_index.data()] = entry;
 		}
 	}
-	return 0;
 }
-const Ini::Key* Ini::findKey(const char* _name, const Section* _section) const
+
+bool Ini::loadImage()
 {
-	int koff = 0;
-	int kcount = (int)m_keys.size();
-	if (_section) {
-		koff = _section->m_keyOffset;
-		kcount = _section->m_propertyCount;
-	}
-	for (int i = koff, n = koff + kcount; i < n; ++i) {
-		if (m_keys[i].m_name == _name) {
-			return &m_keys[i];
+ // the image may be corrupt or truncated, validate every offset/count before m_header can be dereferenced
+	const char* image = m_image.getData();
+	const uint64 imageSize = m_image.getDataSize();
+	const BinaryHeader* header = (const BinaryHeader*)image;
+	bool valid = imageSize >= sizeof(BinaryHeader) && header->m_magic == kBinaryMagic && header->m_version == kBinaryVersion && header->m_size == imageSize;
+	auto InRange = [imageSize](uint32 _offset, uint32 _count, uint64 _elementSize) -> bool {
+		return (uint64)_offset + (uint64)_count * _elementSize <= imageSize;
+	};
+	auto IsString = [header](uint64 _offset) -> bool {
+	 // the last byte of the image is checked to be null below, hence any offset into the string blob is terminated
+		return _offset >= header->m_strings && _offset < header->m_size;
+	};
+	valid = valid 
+		&& header->m_sections >= sizeof(BinaryHeader)
+		&& InRange(header->m_sections, header->m_sectionCount, sizeof(BinarySection))
+		&& InRange(header->m_keys, header->m_keyCount, sizeof(BinaryKey))
+		&& header->m_values % alignof(Value) == 0 && InRange(header->m_values, header->m_valueCount, sizeof(Value))
+		&& header->m_index % alignof(IndexEntry) == 0 && InRange(header->m_index, header->m_indexSize, sizeof(IndexEntry))
+		&& header->m_strings <= header->m_size
+		&& (header->m_strings == header->m_size || image[header->m_size - 1] == '\0')
+		;
+	if (valid) {
+		const BinarySection* sections = (const BinarySection*)(image + header->m_sections);
+		for (uint32 i = 0; valid && i < header->m_sectionCount; ++i) {
+			const BinarySection& section = sections[i];
+			valid = IsString(section.m_name)
+				&& section.m_keyOffset >= 0 && section.m_propertyCount >= 0
+				&& (uint64)section.m_keyOffset + (uint64)section.m_propertyCount <= header->m_keyCount
+				;
 		}
+		const BinaryKey* keys = (const BinaryKey*)(image + header->m_keys);
+		const Value* values = (const Value*)(image + header->m_values);
+		for (uint32 i = 0; valid && i < header->m_keyCount; ++i) {
+			const BinaryKey& key = keys[i];
+			valid = IsString(key.m_name)
+				&& key.m_type >= 0 && key.m_type < ValueType_Count
+				&& key.m_valueOffset >= 0 && key.m_valueCount >= 0
+				&& (uint64)key.m_valueOffset + (uint64)key.m_valueCount <= header->m_valueCount
+				;
+			if (valid && key.m_type == ValueType_String) {
+				for (sint32 j = key.m_valueOffset, n = j + key.m_valueCount; valid && j < n; ++j) {
+					valid = values[j].m_int >= 0 && IsString((uint64)values[j].m_int);
+				}
+			}
+		}
+	 // findIndexEntry() requires a power of 2 size and at least 1 empty slot to terminate
+		const uint32 indexSize = header->m_indexSize;
+		valid = valid && (indexSize & (indexSize - 1)) == 0;
+		const IndexEntry* index = (const IndexEntry*)(image + header->m_index);
+		const uint32 maxIndex = header->m_sectionCount > header->m_keyCount ? header->m_sectionCount : header->m_keyCount;
+		uint32 emptyCount = 0;
+		for (uint32 i = 0; valid && i < indexSize; ++i) {
+			if (index[i].m_index == -1) {
+				++emptyCount;
+			} else {
+				valid = index[i].m_index >= 0 && (uint32)index[i].m_index < maxIndex;
+			}
+		}
+		valid = valid && (indexSize == 0 || emptyCount > 0);
+	}
+	if (!valid) {
+		APT_LOG_ERR("Ini::Read: invalid binary image '%s'", m_image.getPath());
+		m_image.setData(0, 0);
+		m_header = 0;
+		return false;
 	}
-	return 0;
+	m_sections.clear();
+	m_keys.clear();
+	m_values.clear();
+	m_index.clear();
+	m_indexCount = 0;
+	m_arena.reset();
+	m_header = header;
+	return true;
 }
 
+bool Ini::writeImage(File& file_) const
+{
+	if (m_header) {
+		file_.setData((const char*)m_header, m_header->m_size);
+		return true;
+	}
+
+	uint32 stringsSize = 0;
+	for (auto& section : m_sections) {
+		stringsSize += (uint32)strlen(section.m_name) + 1;
+	}
+	for (auto& key : m_keys) {
+		stringsSize += (uint32)strlen(key.m_name) + 1;
+		if (key.m_type == ValueType_String) {
+			for (int i = key.m_valueOffset, n = i + key.m_valueCount; i < n; ++i) {
+				stringsSize += (uint32)strlen(m_values[i].m_string) + 1;
+			}
+		}
+	}
+
+	BinaryHeader header;
+	header.m_magic        = kBinaryMagic;
+	header.m_version      = kBinaryVersion;
+	header.m_sectionCount = (uint32)m_sections.size();
+	header.m_keyCount     = (uint32)m_keys.size();
+	header.m_valueCount   = (uint32)m_values.size();
+	header.m_indexSize    = (uint32)m_index.size();
+	header.m_sections     = (uint32)sizeof(BinaryHeader);
+	header.m_keys         = header.m_sections + header.m_sectionCount * (uint32)sizeof(BinarySection);
+	header.m_values       = AlignOffset(header.m_keys + header.m_keyCount * (uint32)sizeof(BinaryKey), alignof(Value));
+	header.m_index        = AlignOffset(header.m_values + header.m_valueCount * (uint32)sizeof(Value), alignof(IndexEntry));
+	header.m_strings      = header.m_index + header.m_indexSize * (uint32)sizeof(IndexEntry);
+	header.m_size         = header.m_strings + stringsSize;
+
+	file_.setDataSize(header.m_size);
+	char* image = file_.getData();
+	memset(image, 0, header.m_size);
+	memcpy(image, &header, sizeof(header));
+
+	uint32 stringOffset = header.m_strings;
+	auto WriteString = [image, &stringOffset](const char* _str) -> uint32 {
+		uint32 ret = stringOffset;
+		uint32 len = (uint32)strlen(_str) + 1;
+		memcpy(image + stringOffset, _str, len);
+		stringOffset += len;
+		return ret;
+	};
+
+	BinarySection* sections = (BinarySection*)(image + header.m_sections);
+	for (uint32 i = 0; i < header.m_sectionCount; ++i) {
+		sections[i].m_name          = WriteString(m_sections[i].m_name);
+		sections[i].m_propertyCount = m_sections[i].m_propertyCount;
+		sections[i].m_keyOffset     = m_sections[i].m_keyOffset;
+	}
+	BinaryKey* keys = (BinaryKey*)(image + header.m_keys);
+	Value* values = (Value*)(image + header.m_values);
+	memcpy(values, m_values.data(), m_values.size() * sizeof(Value));
+	for (uint32 i = 0; i < header.m_keyCount; ++i) {
+		const Key& key = m_keys[i];
+		keys[i].m_name        = WriteString(key.m_name);
+		keys[i].m_type        = key.m_type;
+		keys[i].m_valueCount  = key.m_valueCount;
+		keys[i].m_valueOffset = key.m_valueOffset;
+		if (key.m_type == ValueType_String) {
+			for (int j = key.m_valueOffset, n = j + key.m_valueCount; j < n; ++j) {
+				values[j].m_int = WriteString(m_values[j].m_string);
+			}
+		}
+	}
+	IndexEntry* index = (IndexEntry*)(image + header.m_index);
+	for (uint32 i = 0; i < header.m_indexSize; ++i) {
+	 // copy members, padding stays zeroed
+		index[i].m_hash  = m_index[i].m_hash;
+		index[i].m_index = m_index[i].m_index;
+	}
+	APT_ASSERT(stringOffset == header.m_size);
+	return true;
+}
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <apt/apt.h>
+#include <apt/File.h>
+#include <apt/MemoryArena.h>
 #include <apt/String.h>
+#include <apt/StringHash.h>
 
 #include <EASTL/vector.h>
 
@@ -23,6 +26,15 @@ namespace apt {
 //       "fourteen"
 // \endcode
 //
+// Sections and keys are indexed by the StringHash of their names, lookups are
+// O(1). Hot code can precompute the hashes and call getProperty(StringHash).
+// Names and string values are stored in a MemoryArena.
+//
+// Ini files can also be written as a binary image (Format_Binary) which loads
+// without parsing; getProperty() operates directly on the (memory mapped) 
+// image. An Ini loaded from a binary image is read only. ReadCached() 
+// maintains a binary cache of a text Ini file.
+//
 // \todo String escape characters
 // \todo Line breaks within strings
 ////////////////////////////////////////////////////////////////////////////////
@@ -30,6 +42,14 @@ class Ini
 {
 public:
 
+	enum Format
+	{
+		Format_Text,
+		Format_Binary,
+
+		Format_Count
+	};
+
 	enum ValueType
 	{
 		ValueType_Bool, 
@@ -52,14 +72,16 @@ public:
 	{
 		friend class Ini;
 
-		ValueType m_type;
-		int       m_count;
-		Value*    m_first;
+		ValueType   m_type;
+		int         m_count;
+		Value*      m_first;
+		const char* m_image; // if the Ini is a binary image, string values are offsets from m_image
 
 		Property(ValueType _type, int _count, Value* _first)
 			: m_type(_type)
 			, m_count(_count)
 			, m_first(_first)
+			, m_image(0)
 		{
 		}
 
@@ -68,6 +90,7 @@ public:
 			: m_type(ValueType_Count)
 			, m_count(0)
 			, m_first(0)
+			, m_image(0)
 		{
 		}
 		
@@ -77,17 +100,25 @@ public:
 		bool        asBool(int _i = 0) const      { APT_ASSERT(m_type == ValueType_Bool);   APT_ASSERT(_i < m_count); return m_first[_i].m_bool;   }
 		sint64      asInt(int _i = 0) const       { APT_ASSERT(m_type == ValueType_Int);    APT_ASSERT(_i < m_count); return m_first[_i].m_int;    }
 		double      asDouble(int _i = 0) const    { APT_ASSERT(m_type == ValueType_Double); APT_ASSERT(_i < m_count); return m_first[_i].m_double; }
-		const char* asString(int _i = 0) const    { APT_ASSERT(m_type == ValueType_String); APT_ASSERT(_i < m_count); return m_first[_i].m_string; }	
+		const char* asString(int _i = 0) const    { APT_ASSERT(m_type == ValueType_String); APT_ASSERT(_i < m_count); return m_image ? m_image + m_first[_i].m_int : m_first[_i].m_string; }
 	};
 	
 	// Read from a file and parse. Invalidates any existing Property instances returned by getProperty();
-	// Return false if an error occurred.
+	// Return false if an error occurred. The format is detected automatically, binary images read from _path are
+	// memory mapped. Reading a binary image replaces the contents of iniFile_, text is appended.
+	// \note Text passed via _file must be null terminated, i.e. loaded with File::Read() rather than File::Map().
 	static bool Read(Ini& iniFile_, const File& _file);
 	static bool Read(Ini& iniFile_, const char* _path);
 
-	// Write to a file.
-	static bool Write(const Ini& _iniFile, File& file_);
-	static bool Write(const Ini& _iniFile, const char* _path);
+	// Read _path via a binary cache at _cachePath (_path + ".bin" if 0). The cache is used if it exists and isn't 
+	// older than _path according to FileSystem::GetTimeModified(), else _path is parsed and the cache is rewritten. If
+	// the cache can't be read (e.g. it is corrupt) _path is parsed instead. The cache is written to a temporary file which
+	// is then renamed, hence a partially written cache is never read.
+	static bool ReadCached(Ini& iniFile_, const char* _path, const char* _cachePath = 0);
+
+	// Write to a file. An Ini loaded from a binary image can only be written as Format_Binary.
+	static bool Write(const Ini& _iniFile, File& file_, Format _format = Format_Text);
+	static bool Write(const Ini& _iniFile, const char* _path, Format _format = Format_Text);
 
 	Ini();
 	~Ini();
@@ -98,6 +129,11 @@ public:
 	// previously returned Property instances.
 	// Return property instance. If no matching property was found, isNull() will return true.
 	Property getProperty(const char* _name, const char* _section = 0) const;
+	// As getProperty(), _section may be a null StringView to search all sections.
+	Property getProperty(const StringView& _name, const StringView& _section = StringView()) const;
+	// As getProperty(), _name and _section are hashes of the name strings. _section may be an invalid (default
+	// constructed) StringHash to search all sections.
+	Property getProperty(StringHash _name, StringHash _section = StringHash()) const;
 
 	void pushSection(const char* _name);
 	template <typename tType>
@@ -108,30 +144,55 @@ public:
 	void pushValue(const char* _name, const char* _value)  { pushValueArray(_name, &_value, 1); }
 
 private:
-	typedef String<32> NameStr;
+	struct BinaryHeader;
 
 	struct Key
 	{
-		NameStr    m_name;
+		const char* m_name;
 		ValueType  m_type;
 		int        m_valueCount;
 		int        m_valueOffset;
 	};
 	struct Section
 	{
-		NameStr    m_name;
+		const char* m_name;
 		int        m_propertyCount;
 		int        m_keyOffset;      
 	};
+	
+	// Open addressing hash table (linear probing) of indices into m_sections/m_keys. Each key is inserted twice: for
+	// lookups within its section, and for lookups in all sections (first occurrence of the name only).
+	struct IndexEntry
+	{
+		uint64     m_hash;  // see IndexHash()
+		int        m_index; // -1 if empty
+	};
 
-	eastl::vector<Section> m_sections;
-	eastl::vector<Key>     m_keys;
-	eastl::vector<Value>   m_values;
+	eastl::vector<Section>    m_sections;
+	eastl::vector<Key>        m_keys;
+	eastl::vector<Value>      m_values;
+	eastl::vector<IndexEntry> m_index;     // size is a power of 2
+	int                       m_indexCount;
+	MemoryArena               m_arena;     // names, string values
+	File                      m_image;     // binary image (if loaded via Read())
+	const BinaryHeader*       m_header;    // 0 unless m_image is loaded
 
 	bool parse(const char* _str);
+	bool loadImage(); // validate m_image, init m_header
+	bool writeImage(File& file_) const;
+
+	// Push a section/key and add it to the index.
+	void addSection(const Section& _section);
+	void addKey(const Key& _key);
+
+	// Return the index of the matching section/key, or -1 if not found. _section may be -1 to search all sections.
+	int findSection(StringHash _name) const;
+	int findKey(StringHash _name, int _section) const;
 
-	const Section* findSection(const char* _name) const;
-	const Key* findKey(const char* _name, const Section* _section) const;
+	// Return the slot containing _hash or the empty slot where it should be inserted (searches the image if loaded). Return 0 if the index is empty.
+	const IndexEntry* findIndexEntry(uint64 _hash) const;
+	void insertIndexEntry(uint64 _hash, int _index);
+	void reserveIndex(int _count); // grow the index to fit _count entries
 	
 };
 
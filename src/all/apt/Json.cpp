@@ -1,24 +1,144 @@
 #include <apt/Json.h>
 
+#include <apt/base64.h>
 #include <apt/log.h>
 #include <apt/math.h>
 #include <apt/memory.h>
+#include <apt/MemoryArena.h>
+#include <apt/File.h>
 #include <apt/FileSystem.h>
 #include <apt/String.h>
 #include <apt/Time.h>
 
 #include <EASTL/vector.h>
+#include <EASTL/map.h>
 
+#include <atomic>
 #include <cstring>
+#include <utility> // move
 
 #define RAPIDJSON_ASSERT(x) APT_ASSERT(x)
 #define RAPIDJSON_PARSE_DEFAULT_FLAGS (kParseFullPrecisionFlag | kParseCommentsFlag | kParseTrailingCommasFlag)
 #include <rapidjson/error/en.h>
 #include <rapidjson/document.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/prettywriter.h>
 
 using namespace apt;
 
+// rapidjson Allocator for DOM values, allocates from a MemoryArena (Free() is a noop, as per MemoryPoolAllocator).
+class JsonAllocator: private non_copyable<JsonAllocator>
+{
+public:
+	static const bool kNeedFree = false;
+
+	void* Malloc(size_t _size)
+	{
+		return _size ? m_arena.alloc((uint)_size) : nullptr;
+	}
+	void* Realloc(void* _ptr, size_t _oldSize, size_t _newSize)
+	{
+		return _newSize ? m_arena.realloc(_ptr, (uint)_oldSize, (uint)_newSize) : nullptr;
+	}
+	static void Free(void*) {}
+
+	// Invalidate all allocations, retain the largest block for reuse.
+	void reset()
+	{
+		m_arena.reset();
+	}
+
+private:
+	MemoryArena m_arena;
+};
+
+// rapidjson Allocator for the parse stacks (document and reader). Stacks are freed at the end of each parse, hence
+// the most recently freed stacks are retained per thread for reuse. Allocations are prefixed with a header containing
+// the capacity since Free() is static.
+class JsonStackAllocator
+{
+public:
+	static const bool kNeedFree = true;
+
+	void* Malloc(size_t _size)
+	{
+		return Realloc(nullptr, 0, _size);
+	}
+	void* Realloc(void* _ptr, size_t _oldSize, size_t _newSize)
+	{
+		if (_newSize == 0) {
+			Free(_ptr);
+			return nullptr;
+		}
+		Header* h = _ptr ? (Header*)_ptr - 1 : nullptr;
+		if (!h) {
+			for (auto& cached : s_cache) {
+				if (cached && cached->m_capacity >= _newSize) {
+					h = cached;
+					cached = nullptr;
+					return h + 1;
+				}
+			}
+		}
+		if (h && h->m_capacity >= _newSize) {
+			return _ptr;
+		}
+		h = (Header*)APT_REALLOC(h, sizeof(Header) + _newSize);
+		h->m_capacity = _newSize;
+		return h + 1;
+	}
+	static void Free(void* _ptr)
+	{
+		if (!_ptr) {
+			return;
+		}
+		Header* h = (Header*)_ptr - 1;
+		if (h->m_capacity <= kMaxCacheCapacity) {
+		 // replace an empty or the smallest cached stack
+			Header** slot = s_cache.begin();
+			for (auto& cached : s_cache) {
+				if (!cached || (*slot && cached->m_capacity < (*slot)->m_capacity)) {
+					slot = &cached;
+				}
+			}
+			if (!*slot || (*slot)->m_capacity < h->m_capacity) {
+				eastl::swap(*slot, h);
+			}
+		}
+		if (h) {
+			APT_FREE(h);
+		}
+	}
+
+private:
+	struct Header
+	{
+		size_t m_capacity;
+		size_t m_pad; // maintain 16 byte alignment
+	};
+	static const size_t kMaxCacheCapacity = 1024 * 1024;
+	struct Cache
+	{
+		Header* m_stacks[2] = {};
+
+		~Cache() // free the cached stacks on thread exit
+		{
+			for (auto& cached : m_stacks) {
+				APT_FREE(cached);
+				cached = nullptr;
+			}
+		}
+		Header** begin() { return m_stacks; }
+		Header** end()   { return m_stacks + APT_ARRAY_COUNT(m_stacks); }
+	};
+	static APT_THREAD_LOCAL Cache s_cache;
+};
+APT_THREAD_LOCAL JsonStackAllocator::Cache JsonStackAllocator::s_cache;
+
+typedef rapidjson::GenericDocument<rapidjson::UTF8<>, JsonAllocator, JsonStackAllocator> JsonDocument;
+typedef JsonDocument::ValueType                                                          JsonValue;
+typedef rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>, JsonStackAllocator> JsonReaderType;
+
 static Json::ValueType GetValueType(rapidjson::Type _type)
 {
 	switch (_type) {
@@ -35,6 +155,94 @@ static Json::ValueType GetValueType(rapidjson::Type _type)
 	return Json::ValueType_Count;
 }
 
+// rapidjson output stream, writes directly to a File's internal buffer. The buffer grows geometrically via
+// File::appendData(), finish() truncates the file to the size written.
+class JsonFileStream: private non_copyable<JsonFileStream>
+{
+	File& m_file;
+	char* m_pos;
+	char* m_end;
+
+	void grow(uint64 _count)
+	{
+		uint64 size = (uint64)(m_pos - m_file.getData());
+		m_file.appendData(0, APT_MAX(size, _count));
+		m_pos = m_file.getData() + size;
+		m_end = m_file.getData() + m_file.getDataSize();
+	}
+
+public:
+	typedef char Ch;
+	static const uint kInitialSize = 4 * 1024;
+
+	JsonFileStream(File& file_)
+		: m_file(file_)
+	{
+		m_file.setDataSize(kInitialSize); // reuses file_'s buffer if large enough
+		m_pos = m_file.getData();
+		m_end = m_pos + kInitialSize;
+	}
+
+	void Put(char _c)
+	{
+		if (m_pos == m_end) {
+			grow(1);
+		}
+		*m_pos++ = _c;
+	}
+
+	void reserve(uint64 _count)
+	{
+		if ((uint64)(m_end - m_pos) < _count) {
+			grow(_count);
+		}
+	}
+
+	void putUnsafe(char _c)
+	{
+		*m_pos++ = _c;
+	}
+
+	void putN(char _c, uint64 _count)
+	{
+		reserve(_count);
+		memset(m_pos, _c, (size_t)_count);
+		m_pos += _count;
+	}
+
+	void Flush() {}
+
+	void finish()
+	{
+		m_file.setDataSize((uint64)(m_pos - m_file.getData()));
+	}
+};
+
+// Specializations of rapidjson's generic stream functions (found via ADL), as per StringBuffer.
+inline void PutReserve(JsonFileStream& stream_, size_t _count)      { stream_.reserve(_count); }
+inline void PutUnsafe(JsonFileStream& stream_, char _c)            { stream_.putUnsafe(_c); }
+inline void PutN(JsonFileStream& stream_, char _c, size_t _count)  { stream_.putN(_c, _count); }
+
+template <typename tStream>
+static void WriteDocument(const JsonDocument& _dom, tStream& stream_, const Json::WriteOptions& _options)
+{
+	if (_options.m_pretty) {
+		rapidjson::PrettyWriter<tStream> wr(stream_);
+		wr.SetIndent('\t', 1);
+		wr.SetFormatOptions(rapidjson::kFormatSingleLineArray);
+		if (_options.m_precision >= 0) {
+			wr.SetMaxDecimalPlaces(_options.m_precision);
+		}
+		_dom.Accept(wr);
+	} else {
+		rapidjson::Writer<tStream> wr(stream_);
+		if (_options.m_precision >= 0) {
+			wr.SetMaxDecimalPlaces(_options.m_precision);
+		}
+		_dom.Accept(wr);
+	}
+}
+
 /*******************************************************************************
 
                                    Json
@@ -43,15 +251,45 @@ static Json::ValueType GetValueType(rapidjson::Type _type)
 
 struct Json::Impl
 {
-	rapidjson::Document m_dom;
+	JsonAllocator       m_allocator; // DOM values, see reset()
+	JsonDocument        m_dom;
+	File                m_buffer;    // source buffer if parsed in situ
+
+ // hash index for objects with > kMinIndexedMembers members, keyed by the object's member array (which doesn't move when
+ // the object is moved, and changes if the array is reallocated). Members are only ever appended (via addMember(), which
+ // re-keys the index if the array is reallocated), hence an index is updated incrementally from m_memberCount. The map
+ // is node based so that a MemberIndex doesn't move when other objects are indexed.
+	static const uint kMinIndexedMembers = 16;
+	struct IndexEntry
+	{
+		uint64 m_hash;
+		int    m_member; // -1 if empty
+	};
+	struct MemberIndex
+	{
+		uint                      m_memberCount = 0; // number of members indexed
+		eastl::vector<IndexEntry> m_entries;         // open addressing (linear probing), size is a power of 2
+	};
+	eastl::map<const void*, MemberIndex>        m_memberIndex;
+
+	Impl()
+		: m_dom(&m_allocator)
+		, m_id(++s_idCounter)
+	{
+	}
+
+ // document identity for JsonPath caches, m_generation is incremented whenever the document is modified
+	static std::atomic<uint64> s_idCounter;
+	uint64 m_id;
+	uint64 m_generation = 0;
 
  // current value set after find()
-	rapidjson::Value* m_value = nullptr;
+	JsonValue* m_value = nullptr;
 
  // value stack for objects/arrays
-	eastl::vector<eastl::pair<rapidjson::Value*, int> > m_stack;
+	eastl::vector<eastl::pair<JsonValue*, int> > m_stack;
 
-	void push(rapidjson::Value* _val = nullptr)
+	void push(JsonValue* _val = nullptr)
 	{
 		APT_ASSERT(m_stack.empty() || top() != _val); // probably a mistake, called push() twice?
 		m_stack.push_back(eastl::make_pair(_val ? _val : m_value, 0));
@@ -61,7 +299,7 @@ struct Json::Impl
 		APT_ASSERT(!m_stack.empty());
 		m_stack.pop_back();
 	}
-	rapidjson::Value* top() 
+	JsonValue* top() 
 	{
 		APT_ASSERT(!m_stack.empty());
 		return m_stack.back().first;
@@ -72,10 +310,125 @@ struct Json::Impl
 		return m_stack.back().second;
 	}
 
+	// Return the first member of _object called _name, or matching _nameHash if _name is null, else MemberEnd(). If
+	// both are specified _nameHash must be the hash of _name.
+	JsonValue::MemberIterator findMember(JsonValue& _object, const char* _name, StringHash _nameHash)
+	{
+		if (_object.MemberCount() <= kMinIndexedMembers) {
+			if (_name) {
+				return _object.FindMember(_name);
+			}
+			for (auto it = _object.MemberBegin(); it != _object.MemberEnd(); ++it) {
+				if (StringHash(it->name.GetString(), it->name.GetStringLength()) == _nameHash) {
+					return it;
+				}
+			}
+			return _object.MemberEnd();
+		}
+
+		const MemberIndex& index = getMemberIndex(_object);
+		const IndexEntry& entry = findIndexEntry(index, _nameHash != StringHash::kInvalidHash ? _nameHash : StringHash(_name));
+		if (entry.m_member == -1) {
+			return _object.MemberEnd();
+		}
+		auto ret = _object.MemberBegin() + entry.m_member;
+		if (_name && strcmp(ret->name.GetString(), _name) != 0) {
+			return _object.FindMember(_name); // hash collision
+		}
+		return ret;
+	}
+
+	// Append a member to _object. Use instead of AddMember() so that the index follows the member array if it is
+	// reallocated.
+	void addMember(JsonValue& _object, JsonValue& _name, JsonValue& _value, JsonAllocator& _allocator)
+	{
+		const void* members = _object.MemberCount() > 0 ? &*_object.MemberBegin() : nullptr;
+		_object.AddMember(_name, _value, _allocator);
+		if (members && members != &*_object.MemberBegin()) {
+			auto it = m_memberIndex.find(members);
+			if (it != m_memberIndex.end()) {
+				MemberIndex index;
+				eastl::swap(index, it->second);
+				m_memberIndex.erase(it);
+				eastl::swap(m_memberIndex[&*_object.MemberBegin()], index);
+			}
+		}
+	}
+	void addMember(JsonValue& _object, const char* _name, JsonValue& _value, JsonAllocator& _allocator)
+	{
+		JsonValue name(rapidjson::StringRef(_name));
+		addMember(_object, name, _value, _allocator);
+	}
+
+	// Get the index for _object, build/update as required.
+	const MemberIndex& getMemberIndex(JsonValue& _object)
+	{
+		MemberIndex& index = m_memberIndex[&*_object.MemberBegin()];
+		uint memberCount = _object.MemberCount();
+		if (index.m_memberCount == memberCount) {
+			return index;
+		}
+		uint beg = index.m_memberCount;
+		if (index.m_memberCount > memberCount || memberCount * 2 > (uint)index.m_entries.size()) {
+		 // rebuild, load factor <= 1/2
+			uint size = 1;
+			while (size < memberCount * 4) {
+				size *= 2;
+			}
+			IndexEntry empty = { 0, -1 };
+			index.m_entries.assign(size, empty);
+			beg = 0;
+		}
+		for (uint i = beg; i < memberCount; ++i) {
+			const JsonValue& name = (_object.MemberBegin() + i)->name;
+			IndexEntry& entry = findIndexEntry(index, StringHash(name.GetString(), name.GetStringLength()));
+			if (entry.m_member == -1) { // first occurrence only, as per FindMember()
+				entry.m_hash = StringHash(name.GetString(), name.GetStringLength());
+				entry.m_member = (int)i;
+			}
+		}
+		index.m_memberCount = memberCount;
+		return index;
+	}
+
+	// Return the entry containing _hash or the empty entry where it should be inserted.
+	static IndexEntry& findIndexEntry(const MemberIndex& _index, uint64 _hash)
+	{
+		const uint mask = (uint)_index.m_entries.size() - 1;
+		uint i = (uint)(_hash ^ (_hash >> 32)) & mask;
+		while (_index.m_entries[i].m_member != -1 && _index.m_entries[i].m_hash != _hash) {
+			i = (i + 1) & mask;
+		}
+		return const_cast<IndexEntry&>(_index.m_entries[i]);
+	}
+
+	// Return the value at _path, or nullptr if not found.
+	JsonValue* resolve(const JsonPath& _path)
+	{
+		if (!_path.isValid()) {
+			return nullptr;
+		}
+		JsonValue* ret = &m_dom;
+		for (auto& segment : _path.m_segments) {
+			if (ret->IsObject()) {
+				auto it = findMember(*ret, _path.getName(segment), segment.m_hash);
+				if (it == ret->MemberEnd()) {
+					return nullptr;
+				}
+				ret = &it->value;
+			} else if (ret->IsArray() && segment.m_index >= 0 && segment.m_index < (int)ret->Size()) {
+				ret = &(*ret)[segment.m_index];
+			} else {
+				return nullptr;
+			}
+		}
+		return ret;
+	}
+
 	// Get the current value, optionally access the element _i if an array.
-	rapidjson::Value* get(int _i = -1) 
+	JsonValue* get(int _i = -1) 
 	{
-		rapidjson::Value* ret = m_value;
+		JsonValue* ret = m_value;
 		APT_ASSERT(ret);
 		if (_i >= 0 && GetValueType(ret->GetType()) == ValueType_Array) {
 			int n = (int)ret->GetArray().Size();
@@ -86,6 +439,8 @@ struct Json::Impl
 	}
 };
 
+std::atomic<uint64> Json::Impl::s_idCounter(0);
+
 
 // PUBLIC
 
@@ -96,6 +451,9 @@ bool Json::Read(Json& json_, const File& _file)
 		APT_LOG_ERR("Json error: %s\n\t'%s'", _file.getPath(), rapidjson::GetParseError_En(json_.m_impl->m_dom.GetParseError()));
 		return false;
 	}
+	json_.m_impl->m_buffer.setData(0, 0); // previous in situ buffer no longer referenced
+	json_.m_impl->m_memberIndex.clear();
+	++json_.m_impl->m_generation;
 	return true;
 }
 
@@ -109,22 +467,37 @@ bool Json::Read(Json& json_, const char* _path, FileSystem::RootType _rootHint)
 	return Read(json_, f);
 }
 
-bool Json::Write(const Json& _json, File& file_)
+bool Json::ReadInsitu(Json& json_, File& file_)
 {
-	rapidjson::StringBuffer buf;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> wr(buf);
-	wr.SetIndent('\t', 1);
-	wr.SetFormatOptions(rapidjson::kFormatSingleLineArray);
-	_json.m_impl->m_dom.Accept(wr);
-	file_.setData(buf.GetString(), buf.GetSize());
+	APT_ASSERT_MSG(!file_.isMapped(), "Json::ReadInsitu: '%s' is mapped (read only)", file_.getPath());
+	json_.m_impl->m_dom.ParseInsitu(file_.getData());
+	if (json_.m_impl->m_dom.HasParseError()) {
+	 // m_dom is unchanged on error, file_ keeps its buffer but may be partially modified
+		APT_LOG_ERR("Json error: %s\n\t'%s'", file_.getPath(), rapidjson::GetParseError_En(json_.m_impl->m_dom.GetParseError()));
+		return false;
+	}
+ // take ownership only on success
+	File buf;
+	swap(buf, file_);
+	swap(json_.m_impl->m_buffer, buf); // previous buffer is released with buf
+	json_.m_impl->m_memberIndex.clear();
+	++json_.m_impl->m_generation;
 	return true;
 }
 
-bool Json::Write(const Json& _json, const char* _path, FileSystem::RootType _rootHint)
+bool Json::Write(const Json& _json, File& file_, const WriteOptions& _options)
+{
+	JsonFileStream stream(file_);
+	WriteDocument(_json.m_impl->m_dom, stream, _options);
+	stream.finish();
+	return true;
+}
+
+bool Json::Write(const Json& _json, const char* _path, FileSystem::RootType _rootHint, const WriteOptions& _options)
 {
 	APT_AUTOTIMER("Json::Write(%s)", _path);
 	File f;
-	if (Write(_json, f)) {
+	if (Write(_json, f, _options)) {
 		return FileSystem::Write(f, _path, _rootHint);
 	}
 	return false;
@@ -149,14 +522,41 @@ Json::~Json()
 	}
 }
 
+void Json::reset()
+{
+	m_impl->m_dom.SetObject();
+	m_impl->m_allocator.reset();
+	m_impl->m_buffer.setData(0, 0);
+	m_impl->m_memberIndex.clear();
+	++m_impl->m_generation;
+	m_impl->m_stack.clear();
+	m_impl->push(&m_impl->m_dom);
+	m_impl->m_value = nullptr;
+}
+
 bool Json::find(const char* _name)
 {
-	rapidjson::Value* top = m_impl->top();
+	JsonValue* top = m_impl->top();
+
+	if (!top->IsObject()) {
+		return false;
+	}
+	auto it = m_impl->findMember(*top, _name, StringHash());
+	if (it != top->MemberEnd()) {
+		m_impl->m_value = &it->value;
+		return true;
+	}
+	return false;
+}
+
+bool Json::find(StringHash _name)
+{
+	JsonValue* top = m_impl->top();
 
 	if (!top->IsObject()) {
 		return false;
 	}
-	auto it = top->FindMember(_name);
+	auto it = m_impl->findMember(*top, nullptr, _name);
 	if (it != top->MemberEnd()) {
 		m_impl->m_value = &it->value;
 		return true;
@@ -166,7 +566,7 @@ bool Json::find(const char* _name)
 
 bool Json::next()
 {
-	rapidjson::Value* top = m_impl->top();
+	JsonValue* top = m_impl->top();
 
 	if (GetValueType(top->GetType()) == ValueType_Array) {
 		auto it = top->Begin() + (m_impl->topIter()++);
@@ -181,6 +581,20 @@ bool Json::next()
 	return false;
 }
 
+bool Json::find(const JsonPath& _path)
+{
+	if (_path.m_cacheId != m_impl->m_id || _path.m_cacheGeneration != m_impl->m_generation) {
+		_path.m_cacheValue      = m_impl->resolve(_path);
+		_path.m_cacheId         = m_impl->m_id;
+		_path.m_cacheGeneration = m_impl->m_generation;
+	}
+	if (_path.m_cacheValue) {
+		m_impl->m_value = (JsonValue*)_path.m_cacheValue;
+		return true;
+	}
+	return false;
+}
+
 Json::ValueType Json::getType() const
 {
 	return GetValueType(m_impl->m_value->GetType()); 
@@ -188,80 +602,80 @@ Json::ValueType Json::getType() const
 
 template <> bool Json::getValue<bool>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Bool, "Json::getValue: not a bool");
 	return jsonValue->GetBool();
 }
 
 template <> sint64 Json::getValue<sint64>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetInt64();
 }
 template <> sint32 Json::getValue<sint32>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetInt();
 }
 template <> sint16 Json::getValue<sint16>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetInt();
 }
 template <> sint8 Json::getValue<sint8>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetInt();
 }
 template <> uint64 Json::getValue<uint64>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetUint64();
 }
 template <> uint32 Json::getValue<uint32>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetUint();
 }
 template <> uint16 Json::getValue<uint16>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetUint();
 }
 template <> uint8 Json::getValue<uint8>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetUint();
 }
 template <> float32 Json::getValue<float32>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetFloat();
 }
 template <> float64 Json::getValue<float64>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Number, "Json::getValue: not a number");
 	return jsonValue->GetDouble();
 }
 template <> const char* Json::getValue<const char*>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_String, "Json::getValue: not a string");
 	return jsonValue->GetString();
 }
 template <> vec2 Json::getValue<vec2>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Array, "Json::getValue: not an array");
 	APT_ASSERT_MSG(jsonValue->Size() == 2, "Json::getValue: invalid vec2, size = %d", jsonValue->Size());
 	auto& arr = jsonValue->GetArray();
@@ -269,7 +683,7 @@ template <> vec2 Json::getValue<vec2>(int _i) const
 }
 template <> vec3 Json::getValue<vec3>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Array, "Json::getValue: not an array");
 	APT_ASSERT_MSG(jsonValue->Size() == 3, "Json::getValue: invalid vec3, size = %d", jsonValue->Size());
 	auto& arr = jsonValue->GetArray();
@@ -277,7 +691,7 @@ template <> vec3 Json::getValue<vec3>(int _i) const
 }
 template <> vec4 Json::getValue<vec4>(int _i) const
 {
-	const rapidjson::Value* jsonValue = m_impl->get(_i);
+	const JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Array, "Json::getValue: not an array");
 	APT_ASSERT_MSG(jsonValue->Size() == 4, "Json::getValue: invalid vec4, size = %d", jsonValue->Size());
 	auto& arr = jsonValue->GetArray();
@@ -285,7 +699,7 @@ template <> vec4 Json::getValue<vec4>(int _i) const
 }
 template <> mat2 Json::getValue<mat2>(int _i) const
 {
-	rapidjson::Value* jsonValue = m_impl->get(_i);
+	JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Array, "Json::getValue: not an array");
 	APT_ASSERT_MSG(jsonValue->Size() == 2, "Json::getValue: invalid mat2, size = %d (should be 2* vec2)", jsonValue->Size());
 	mat2 ret;
@@ -300,7 +714,7 @@ template <> mat2 Json::getValue<mat2>(int _i) const
 }
 template <> mat3 Json::getValue<mat3>(int _i) const
 {
-	rapidjson::Value* jsonValue = m_impl->get(_i);
+	JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Array, "Json::getValue: not an array");
 	APT_ASSERT_MSG(jsonValue->Size() == 3, "Json::getValue: invalid mat3, size = %d (should be 3* vec3)", jsonValue->Size());
 	mat3 ret;
@@ -315,7 +729,7 @@ template <> mat3 Json::getValue<mat3>(int _i) const
 }
 template <> mat4 Json::getValue<mat4>(int _i) const
 {
-	rapidjson::Value* jsonValue = m_impl->get(_i);
+	JsonValue* jsonValue = m_impl->get(_i);
 	APT_ASSERT_MSG(GetValueType(jsonValue->GetType()) == ValueType_Array, "Json::getValue: not an array");
 	APT_ASSERT_MSG(jsonValue->Size() == 4, "Json::getValue: invalid mat4, size = %d (should be 4* vec4)", jsonValue->Size());
 	mat4 ret;
@@ -377,20 +791,22 @@ void Json::beginObject(const char* _name)
 	  // object already existed, check the type
 		APT_ASSERT(GetValueType(m_impl->m_value->GetType()) == ValueType_Object);
 	} else {
+		++m_impl->m_generation;
 		if (GetValueType(m_impl->top()->GetType()) == ValueType_Array) {
 			if (_name) {
 				APT_LOG("Json warning: calling beginObject() in an array, name '%s' will be ignored", _name);
 			}
 			m_impl->top()->PushBack(
-				rapidjson::Value(rapidjson::kObjectType).Move(), 
+				JsonValue(rapidjson::kObjectType).Move(), 
 				m_impl->m_dom.GetAllocator()
 				);
 			m_impl->m_value = m_impl->top()->End() - 1;
 
 		} else {
-			m_impl->top()->AddMember(
-				rapidjson::StringRef(_name),
-				rapidjson::Value(rapidjson::kObjectType).Move(), 
+			m_impl->addMember(
+				*m_impl->top(),
+				_name,
+				JsonValue(rapidjson::kObjectType).Move(), 
 				m_impl->m_dom.GetAllocator()
 				);
 			m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -405,20 +821,22 @@ void Json::beginArray(const char* _name)
 	  // object already existed, check the type
 		APT_ASSERT(GetValueType(m_impl->m_value->GetType()) == ValueType_Array);
 	} else {
+		++m_impl->m_generation;
 		if (GetValueType(m_impl->top()->GetType()) == ValueType_Array) {
 			if (_name) {
 				APT_LOG("Json warning: calling beginArray() in an array, name '%s' will be ignored", _name);
 			}
 			m_impl->top()->PushBack(
-				rapidjson::Value(rapidjson::kArrayType).Move(), 
+				JsonValue(rapidjson::kArrayType).Move(), 
 				m_impl->m_dom.GetAllocator()
 				);
 			m_impl->m_value = m_impl->top()->End() - 1;
 
 		} else {
-			m_impl->top()->AddMember(
-				rapidjson::StringRef(_name),
-				rapidjson::Value(rapidjson::kArrayType).Move(), 
+			m_impl->addMember(
+				*m_impl->top(),
+				_name,
+				JsonValue(rapidjson::kArrayType).Move(), 
 				m_impl->m_dom.GetAllocator()
 				);
 			m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -430,12 +848,14 @@ void Json::beginArray(const char* _name)
 
 template <> void Json::setValue<bool>(const char* _name, bool _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetBool(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -443,7 +863,8 @@ template <> void Json::setValue<bool>(const char* _name, bool _val)
 }
 template <> void Json::setValue<bool>(int _i, bool _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetBool(_val);
 	} else {
@@ -452,12 +873,14 @@ template <> void Json::setValue<bool>(int _i, bool _val)
 }
 template <> void Json::setValue<sint32>(const char* _name, sint32 _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetInt(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -465,7 +888,8 @@ template <> void Json::setValue<sint32>(const char* _name, sint32 _val)
 }
 template <> void Json::setValue<sint32>(int _i, sint32 _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetInt(_val);
 	} else {
@@ -474,12 +898,14 @@ template <> void Json::setValue<sint32>(int _i, sint32 _val)
 }
 template <> void Json::setValue<sint64>(const char* _name, sint64 _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetInt64(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -487,7 +913,8 @@ template <> void Json::setValue<sint64>(const char* _name, sint64 _val)
 }
 template <> void Json::setValue<sint64>(int _i, sint64 _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetInt64(_val);
 	} else {
@@ -512,12 +939,14 @@ template <> void Json::setValue<sint8>(int _i, sint8 _val)
 }
 template <> void Json::setValue<uint64>(const char* _name, uint64 _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetUint64(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -525,7 +954,8 @@ template <> void Json::setValue<uint64>(const char* _name, uint64 _val)
 }
 template <> void Json::setValue<uint64>(int _i, uint64 _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetUint64(_val);
 	} else {
@@ -534,12 +964,14 @@ template <> void Json::setValue<uint64>(int _i, uint64 _val)
 }
 template <> void Json::setValue<uint32>(const char* _name, uint32 _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetUint(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -547,7 +979,8 @@ template <> void Json::setValue<uint32>(const char* _name, uint32 _val)
 }
 template <> void Json::setValue<uint32>(int _i, uint32 _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetUint(_val);
 	} else {
@@ -572,12 +1005,14 @@ template <> void Json::setValue<uint8>(int _i, uint8 _val)
 }
 template <> void Json::setValue<float32>(const char* _name, float32 _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetFloat(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -585,7 +1020,8 @@ template <> void Json::setValue<float32>(const char* _name, float32 _val)
 }
 template <> void Json::setValue<float32>(int _i, float32 _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetFloat(_val);
 	} else {
@@ -594,12 +1030,14 @@ template <> void Json::setValue<float32>(int _i, float32 _val)
 }
 template <> void Json::setValue<float64>(const char* _name, float64 _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetDouble(_val);
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value(_val).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue(_val).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -607,7 +1045,8 @@ template <> void Json::setValue<float64>(const char* _name, float64 _val)
 }
 template <> void Json::setValue<float64>(int _i, float64 _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetDouble(_val);
 	} else {
@@ -616,12 +1055,14 @@ template <> void Json::setValue<float64>(int _i, float64 _val)
 }
 template <> void Json::setValue<const char*>(const char* _name, const char* _val)
 {
+	++m_impl->m_generation;
 	if (find(_name)) {
 		m_impl->m_value->SetString(_val, m_impl->m_dom.GetAllocator());
 	} else {
-		m_impl->top()->AddMember(
-			rapidjson::StringRef(_name),
-			rapidjson::Value().SetString(_val, m_impl->m_dom.GetAllocator()).Move(), 
+		m_impl->addMember(
+			*m_impl->top(),
+			_name,
+			JsonValue().SetString(_val, m_impl->m_dom.GetAllocator()).Move(), 
 			m_impl->m_dom.GetAllocator()
 			);
 		m_impl->m_value = &(m_impl->top()->MemberEnd() - 1)->value;
@@ -629,7 +1070,8 @@ template <> void Json::setValue<const char*>(const char* _name, const char* _val
 }
 template <> void Json::setValue<const char*>(int _i, const char* _val)
 {
-	rapidjson::Value* top = m_impl->top();
+	++m_impl->m_generation;
+	JsonValue* top = m_impl->top();
 	if (_i >= 0 && GetValueType(top->GetType()) == ValueType_Array) {
 		m_impl->m_value->GetArray()[_i].SetString(_val, m_impl->m_dom.GetAllocator());
 	} else {
@@ -639,8 +1081,9 @@ template <> void Json::setValue<const char*>(int _i, const char* _val)
 
 template <> void Json::pushValue<bool>(bool _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
@@ -648,16 +1091,18 @@ template <> void Json::pushValue<bool>(bool _val)
 
 template <> void Json::pushValue<sint64>(sint64 _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
 }
 template <> void Json::pushValue<sint32>(sint32 _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
@@ -672,16 +1117,18 @@ template <> void Json::pushValue<sint8>(sint8 _val)
 }
 template <> void Json::pushValue<uint64>(uint64 _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
 }
 template <> void Json::pushValue<uint32>(uint32 _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
@@ -696,24 +1143,27 @@ template <> void Json::pushValue<uint8>(uint8 _val)
 }
 template <> void Json::pushValue<float32>(float32 _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
 }
 template <> void Json::pushValue<float64>(float64 _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value(_val).Move(), 
+		JsonValue(_val).Move(), 
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
 }
 template <> void Json::pushValue<const char*>(const char* _val)
 {
+	++m_impl->m_generation;
 	m_impl->top()->PushBack(
-		rapidjson::Value().SetString(_val, m_impl->m_dom.GetAllocator()).Move(),
+		JsonValue().SetString(_val, m_impl->m_dom.GetAllocator()).Move(),
 		m_impl->m_dom.GetAllocator()
 		);
 	m_impl->m_value = m_impl->top()->End() - 1;
@@ -818,6 +1268,370 @@ template <> void Json::pushValue<mat4>(mat4 _val)
 	leaveArray();
 }
 
+/*******************************************************************************
+
+                                  JsonPath
+
+*******************************************************************************/
+
+// PUBLIC
+
+JsonPath::JsonPath(const char* _path)
+	: m_isValid(true)
+	, m_cacheId(0) // Json ids start at 1
+	, m_cacheGeneration(0)
+	, m_cacheValue(nullptr)
+{
+	APT_ASSERT(_path);
+	if (!*_path) {
+		return; // root
+	}
+	if (*_path != '/') {
+		APT_LOG_ERR("JsonPath: invalid path '%s' (must be empty or begin with '/')", _path);
+		m_isValid = false;
+		return;
+	}
+	const char* beg = _path + 1;
+	for (;;) {
+		const char* end = beg;
+		while (*end && *end != '/') {
+			++end;
+		}
+
+		Segment segment;
+		segment.m_name = (uint)m_names.size();
+		for (const char* c = beg; c < end; ++c) {
+			if (*c == '~' && (c[1] == '0' || c[1] == '1')) {
+				++c;
+				m_names.push_back(*c == '0' ? '~' : '/');
+			} else {
+				m_names.push_back(*c);
+			}
+		}
+		m_names.push_back('\0');
+		const char* name = &m_names[segment.m_name];
+		uint nameLen = (uint)m_names.size() - segment.m_name - 1;
+		segment.m_hash = StringHash(name, nameLen);
+
+	 // array index: digits only, no leading zeros
+		segment.m_index = -1;
+		if (nameLen > 0 && nameLen < 10 && (name[0] != '0' || nameLen == 1)) {
+			int index = 0;
+			uint i = 0;
+			for (; i < nameLen && name[i] >= '0' && name[i] <= '9'; ++i) {
+				index = index * 10 + (name[i] - '0');
+			}
+			segment.m_index = i == nameLen ? index : -1;
+		}
+		m_segments.push_back(segment);
+
+		if (!*end) {
+			break;
+		}
+		beg = end + 1;
+	}
+}
+
+/*******************************************************************************
+
+                                 JsonReader
+
+*******************************************************************************/
+
+// rapidjson input stream, refills a fixed size buffer via a JsonReader::ReadCallback.
+class ChunkedReadStream: private non_copyable<ChunkedReadStream>
+{
+public:
+	typedef char Ch;
+
+	ChunkedReadStream(JsonReader::ReadCallback* _callback, void* _userData, uint _bufferSize)
+		: m_callback(_callback)
+		, m_userData(_userData)
+		, m_bufferSize(_bufferSize)
+		, m_count(0)
+		, m_eof(false)
+	{
+		APT_ASSERT(_bufferSize > 0);
+		m_buffer = (char*)APT_MALLOC(_bufferSize + 1); // + null terminator
+		m_pos = m_end = m_buffer;
+		refill();
+	}
+
+	~ChunkedReadStream()
+	{
+		APT_FREE(m_buffer);
+	}
+
+	Ch     Peek() const  { return *m_pos; } // null at the end of the source
+	Ch     Take()        { Ch c = *m_pos; if (m_pos != m_end && ++m_pos == m_end) { refill(); } return c; }
+	size_t Tell() const  { return (size_t)(m_count + (m_pos - m_buffer)); }
+
+ // write interface is required to compile but never called
+	Ch*    PutBegin()    { APT_ASSERT(false); return nullptr; }
+	void   Put(Ch)       { APT_ASSERT(false); }
+	void   Flush()       { APT_ASSERT(false); }
+	size_t PutEnd(Ch*)   { APT_ASSERT(false); return 0; }
+
+private:
+	JsonReader::ReadCallback* m_callback;
+	void*  m_userData;
+	uint   m_bufferSize;
+	char*  m_buffer;
+	char*  m_pos;
+	char*  m_end;
+	uint64 m_count;  // bytes consumed before m_buffer
+	bool   m_eof;
+
+	void refill()
+	{
+		if (m_eof) {
+			return;
+		}
+		m_count += (uint64)(m_end - m_buffer);
+		uint n = m_callback(m_buffer, m_bufferSize, m_userData);
+		APT_ASSERT(n <= m_bufferSize);
+		m_pos = m_buffer;
+		m_end = m_buffer + n;
+		*m_end = '\0';
+		m_eof = n == 0;
+	}
+};
+
+struct JsonReader::Impl
+{
+	const File*  m_file       = nullptr;
+	ReadCallback* m_callback  = nullptr;
+	void*        m_userData   = nullptr;
+	uint         m_bufferSize = 0;
+	bool         m_stopped    = false; // handler returned false, parse errors aren't reported
+
+	template <typename tHandler>
+	bool parse(tHandler& handler_)
+	{
+		JsonReaderType reader;
+		rapidjson::ParseResult result;
+		const char* path = "";
+		if (m_file) {
+			rapidjson::MemoryStream is(m_file->getData(), (size_t)m_file->getDataSize());
+			result = reader.Parse<rapidjson::kParseDefaultFlags>(is, handler_);
+			path = m_file->getPath();
+		} else {
+			ChunkedReadStream is(m_callback, m_userData, m_bufferSize);
+			result = reader.Parse<rapidjson::kParseDefaultFlags>(is, handler_);
+		}
+		if (result.IsError() && !m_stopped) {
+			APT_LOG_ERR("Json error: %s (offset %llu)\n\t'%s'", path, (uint64)result.Offset(), rapidjson::GetParseError_En(result.Code()));
+		}
+		return !result.IsError();
+	}
+};
+
+// Forward rapidjson events to a HandlerBase.
+struct JsonReader::Sax
+{
+	HandlerBase& m_handler;
+	bool&        m_stopped;
+
+	bool check(bool _continue)                                   { m_stopped = !_continue; return _continue; }
+
+	bool Null()                                                  { return check(m_handler.nullValue()); }
+	bool Bool(bool _b)                                           { return check(m_handler.boolValue(_b)); }
+	bool Int(int _i)                                             { return check(m_handler.intValue(_i)); }
+	bool Uint(unsigned _u)                                       { return check(m_handler.intValue(_u)); }
+	bool Int64(int64_t _i)                                       { return check(m_handler.intValue(_i)); }
+	bool Uint64(uint64_t _u)                                     { return check((_u >> 63) != 0 ? m_handler.uintValue(_u) : m_handler.intValue((sint64)_u)); }
+	bool Double(double _d)                                       { return check(m_handler.doubleValue(_d)); }
+	bool RawNumber(const char*, rapidjson::SizeType, bool)       { APT_ASSERT(false); return false; } // requires kParseNumbersAsStringsFlag
+	bool String(const char* _str, rapidjson::SizeType _len, bool) { return check(m_handler.stringValue(_str, _len)); }
+	bool StartObject()                                           { return check(m_handler.beginObject()); }
+	bool Key(const char* _str, rapidjson::SizeType _len, bool)   { return check(m_handler.key(_str, _len)); }
+	bool EndObject(rapidjson::SizeType _memberCount)             { return check(m_handler.endObject(_memberCount)); }
+	bool StartArray()                                            { return check(m_handler.beginArray()); }
+	bool EndArray(rapidjson::SizeType _length)                   { return check(m_handler.endArray(_length)); }
+};
+
+// Build each element of a top-level array as the root value of a Json. Values are allocated from the Json's
+// allocator, which is cleared before each element, hence memory use is bounded by the size of the largest element.
+struct JsonReader::ArrayBuilder
+{
+	Json&                           m_json;
+	CallbackBase&                   m_callback;
+	bool&                           m_stopped;
+	eastl::vector<JsonValue> m_stack; // values/keys of unfinished objects/arrays
+	int                             m_depth;
+	bool                            m_isArray;
+
+	ArrayBuilder(Json& _json_, CallbackBase& _callback_, bool& _stopped_)
+		: m_json(_json_)
+		, m_callback(_callback_)
+		, m_stopped(_stopped_)
+		, m_depth(0)
+		, m_isArray(true)
+	{
+	}
+
+	JsonAllocator& allocator() { return m_json.m_impl->m_dom.GetAllocator(); }
+
+	// Called for the first event of each element.
+	void beginElement()
+	{
+		m_json.m_impl->m_dom.SetNull();
+		m_json.m_impl->m_memberIndex.clear();
+		++m_json.m_impl->m_generation;
+		allocator().reset();
+	}
+
+	bool value(JsonValue& _value)
+	{
+		if (m_depth == 0) {
+			APT_LOG_ERR("JsonReader::readArray: source is not an array");
+			m_isArray = false;
+			m_stopped = true; // error already reported
+			return false;
+		}
+		if (m_depth == 1) {
+		 // element is complete
+			Json::Impl* impl = m_json.m_impl;
+			static_cast<JsonValue&>(impl->m_dom).Swap(_value);
+			++impl->m_generation;
+			impl->m_stack.clear();
+			impl->push(&impl->m_dom);
+			impl->m_value = nullptr;
+			m_stopped = !m_callback(m_json);
+			return !m_stopped;
+		}
+		m_stack.push_back(std::move(_value));
+		return true;
+	}
+
+	template <typename tType>
+	bool scalar(tType _value)
+	{
+		if (m_depth == 1) {
+			beginElement();
+		}
+		JsonValue v(_value);
+		return value(v);
+	}
+
+	bool Null()                                                   { return scalar(rapidjson::kNullType); }
+	bool Bool(bool _b)                                            { return scalar(_b); }
+	bool Int(int _i)                                              { return scalar(_i); }
+	bool Uint(unsigned _u)                                        { return scalar(_u); }
+	bool Int64(int64_t _i)                                        { return scalar(_i); }
+	bool Uint64(uint64_t _u)                                      { return scalar(_u); }
+	bool Double(double _d)                                        { return scalar(_d); }
+	bool RawNumber(const char*, rapidjson::SizeType, bool)        { APT_ASSERT(false); return false; }
+
+	bool String(const char* _str, rapidjson::SizeType _len, bool)
+	{
+		if (m_depth == 1) {
+			beginElement();
+		}
+		JsonValue v(_str, _len, allocator());
+		return value(v);
+	}
+
+	bool Key(const char* _str, rapidjson::SizeType _len, bool _copy)
+	{
+		return String(_str, _len, _copy);
+	}
+
+	bool StartObject()
+	{
+		if (m_depth == 0) {
+			JsonValue v;
+			return value(v); // error
+		}
+		if (m_depth == 1) {
+			beginElement();
+		}
+		++m_depth;
+		return true;
+	}
+
+	bool EndObject(rapidjson::SizeType _memberCount)
+	{
+		--m_depth;
+		JsonValue obj(rapidjson::kObjectType);
+		auto members = m_stack.end() - _memberCount * 2;
+		for (auto it = members; it != m_stack.end(); it += 2) {
+			obj.AddMember(it[0], it[1], allocator());
+		}
+		m_stack.erase(members, m_stack.end());
+		return value(obj);
+	}
+
+	bool StartArray()
+	{
+		if (m_depth == 1) {
+			beginElement();
+		}
+		++m_depth;
+		return true;
+	}
+
+	bool EndArray(rapidjson::SizeType _length)
+	{
+		if (--m_depth == 0) {
+			return true; // end of the top-level array
+		}
+		JsonValue arr(rapidjson::kArrayType);
+		arr.Reserve(_length, allocator());
+		auto elements = m_stack.end() - _length;
+		for (auto it = elements; it != m_stack.end(); ++it) {
+			arr.PushBack(*it, allocator());
+		}
+		m_stack.erase(elements, m_stack.end());
+		return value(arr);
+	}
+};
+
+// PUBLIC
+
+JsonReader::JsonReader(const File& _file)
+	: m_impl(nullptr)
+{
+	m_impl = APT_NEW(Impl);
+	m_impl->m_file = &_file;
+}
+
+JsonReader::JsonReader(ReadCallback* _callback, void* _userData, uint _bufferSize)
+	: m_impl(nullptr)
+{
+	APT_ASSERT(_callback);
+	m_impl = APT_NEW(Impl);
+	m_impl->m_callback   = _callback;
+	m_impl->m_userData   = _userData;
+	m_impl->m_bufferSize = _bufferSize;
+}
+
+JsonReader::~JsonReader()
+{
+	if (m_impl) {
+		APT_DELETE(m_impl);
+	}
+}
+
+// PRIVATE
+
+bool JsonReader::readImpl(HandlerBase& handler_)
+{
+	m_impl->m_stopped = false;
+	Sax sax = { handler_, m_impl->m_stopped };
+	return m_impl->parse(sax);
+}
+
+bool JsonReader::readArrayImpl(Json& json_, CallbackBase& callback_)
+{
+	m_impl->m_stopped = false;
+	ArrayBuilder builder(json_, callback_, m_impl->m_stopped);
+	if (m_impl->parse(builder)) {
+		return builder.m_isArray;
+	}
+	return m_impl->m_stopped && builder.m_isArray; // stopping isn't an error
+}
+
 /*******************************************************************************
 
                               SerializerJson
@@ -984,116 +1798,6 @@ bool SerializerJson::value(StringBase& _value_, const char* _name)
 }
 
 
-// Base64 encode/decode of binary data, adapted from https://github.com/adamvr/arduino-base64
-static const char kBase64Alphabet[] = 
-		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-		"abcdefghijklmnopqrstuvwxyz"
-		"0123456789+/"
-		;
-static inline void Base64A3ToA4(const unsigned char* _a3, unsigned char* a4_) 
-{
-	a4_[0] = (_a3[0] & 0xfc) >> 2;
-	a4_[1] = ((_a3[0] & 0x03) << 4) + ((_a3[1] & 0xf0) >> 4);
-	a4_[2] = ((_a3[1] & 0x0f) << 2) + ((_a3[2] & 0xc0) >> 6);
-	a4_[3] = (_a3[2] & 0x3f);
-}
-static inline void Base64A4ToA3(const unsigned char* _a4, unsigned char* a3_) {
-	a3_[0] = (_a4[0] << 2) + ((_a4[1] & 0x30) >> 4);
-	a3_[1] = ((_a4[1] & 0xf) << 4) + ((_a4[2] & 0x3c) >> 2);
-	a3_[2] = ((_a4[2] & 0x3) << 6) + _a4[3];
-}
-static inline unsigned char Base64Index(char _c)
-{
-	if (_c >= 'A' && _c <= 'Z') return _c - 'A';
-	if (_c >= 'a' && _c <= 'z') return _c - 71;
-	if (_c >= '0' && _c <= '9') return _c + 4;
-	if (_c == '+') return 62;
-	if (_c == '/') return 63;
-	return -1;
-}
-static void Base64Encode(const char* _in, uint _inSizeBytes, char* out_, uint outSizeBytes_)
-{
-	uint i = 0;
-	uint j = 0;
-	uint k = 0;
-	unsigned char a3[3];
-	unsigned char a4[4];
-	while (_inSizeBytes--) {
-		a3[i++] = *(_in++);
-		if (i == 3) {
-			Base64A3ToA4(a3, a4);
-			for (i = 0; i < 4; i++) {
-				out_[k++] = kBase64Alphabet[a4[i]];
-			}
-			i = 0;
-		}
-	}
-	if (i) {
-		for (j = i; j < 3; j++) {
-			a3[j] = '\0';
-		}
-		Base64A3ToA4(a3, a4);
-		for (j = 0; j < i + 1; j++) {
-			out_[k++] = kBase64Alphabet[a4[j]];
-		}
-		while ((i++ < 3)) {
-			out_[k++] = '=';
-		}
-	}
-	out_[k] = '\0';
-	APT_ASSERT(outSizeBytes_ == k); // overflow
-}
-static void Base64Decode(const char* _in, uint _inSizeBytes, char* out_, uint outSizeBytes_) {
-	uint i = 0;
-	uint j = 0;
-	uint k = 0;
-	unsigned char a3[3];
-	unsigned char a4[4];
-	while (_inSizeBytes--) {
-		if (*_in == '=') {
-			break;
-		}
-		a4[i++] = *(_in++);
-		if (i == 4) {
-			for (i = 0; i < 4; i++) {
-				a4[i] = Base64Index(a4[i]);
-			}
-			Base64A4ToA3(a4, a3);
-			for (i = 0; i < 3; i++) {
-				out_[k++] = a3[i];
-			}
-			i = 0;
-		}
-	}
-
-	if (i) {
-		for (j = i; j < 4; j++) {
-			a4[j] = '\0';
-		}
-		for (j = 0; j < 4; j++) {
-			a4[j] = Base64Index(a4[j]);
-		}
-		Base64A4ToA3(a4, a3);
-		for (j = 0; j < i - 1; j++) {
-			out_[k++] = a3[j];
-		}
-	}
-	APT_ASSERT(outSizeBytes_ == k); // overflow
-}
-static uint Base64EncSizeBytes(uint _sizeBytes) 
-{
-	uint n = _sizeBytes;
-	return (n + 2 - ((n + 2) % 3)) / 3 * 4;
-}
-static uint Base64DecSizeBytes(char* _buf, uint _sizeBytes) 
-{
-	uint padCount = 0;
-	for (uint i = _sizeBytes - 1; _buf[i] == '='; i--) {
-		padCount++;
-	}
-	return ((6 * _sizeBytes) / 8) - padCount;
-}
-
 bool SerializerJson::binary(void*& _data_, uint& _sizeBytes_, const char* _name, CompressionFlags _compressionFlags)
 {
 	if (getMode() == Mode_Write) {
@@ -1105,9 +1809,10 @@ bool SerializerJson::binary(void*& _data_, uint& _sizeBytes_, const char* _name,
 			Compress(_data_, _sizeBytes_, (void*&)data, sizeBytes, _compressionFlags);
 		}
 		String<0> str;
-		str.setLength(Base64EncSizeBytes(sizeBytes) + 1);
+		str.setLength(Base64EncodedSize(sizeBytes) + 1);
 		str[0] = _compressionFlags == CompressionFlags_None ? '0' : '1'; // prepend 0, or 1 if compression
-		Base64Encode(data, sizeBytes, (char*)str + 1, str.getLength() - 1);
+		Base64Encode(data, sizeBytes, (char*)str + 1);
+		str[str.getLength()] = '\0';
 		if (_compressionFlags != CompressionFlags_None) {
 			free(data);
 		}
@@ -1115,34 +1820,182 @@ bool SerializerJson::binary(void*& _data_, uint& _sizeBytes_, const char* _name,
 
 	} else {
 		String<0> str;
-		value((StringBase&)str, _name);
+		if (!value((StringBase&)str, _name)) {
+			setError("Error serializing %s, not found or not a string", _name ? _name : "--");
+			return false;
+		}
+		if (str.getLength() < 1) {
+			setError("Error serializing %s, empty string (expected a compression prefix)", _name ? _name : "--");
+			return false;
+		}
 		bool compressed = str[0] == '1' ? true : false;
-		uint binSizeBytes = Base64DecSizeBytes((char*)str + 1, str.getLength() - 1);
-		char* bin = (char*)APT_MALLOC(binSizeBytes);
-		Base64Decode((char*)str + 1, str.getLength() - 1, bin, binSizeBytes);
+		const char* enc = (const char*)str + 1;
+		uint encSizeBytes = str.getLength() - 1;
+		uint binSizeBytes = Base64DecodedSize(enc, encSizeBytes);
+
+		if (!compressed) {
+		 // decode directly to the destination
+			if (_data_) {
+				if (binSizeBytes != _sizeBytes_) {
+					setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "--", (uint64)_sizeBytes_, (uint64)binSizeBytes);
+					return false;
+				}
+			} else {
+				_data_ = APT_MALLOC(binSizeBytes);
+				_sizeBytes_ = binSizeBytes;
+			}
+			if (!Base64Decode(enc, encSizeBytes, _data_)) {
+				setError("Error serializing %s, invalid base64 data", _name ? _name : "--");
+				return false;
+			}
+			return true;
+		}
 
-		char* ret = bin;
-		uint retSizeBytes = binSizeBytes;
-		if (compressed) {
-			ret = nullptr; // Decompress to allocates the final buffer
-			Decompress(bin, binSizeBytes, (void*&)ret, retSizeBytes);
+		char* bin = (char*)APT_MALLOC(binSizeBytes);
+		if (!Base64Decode(enc, encSizeBytes, bin)) {
+			APT_FREE(bin);
+			setError("Error serializing %s, invalid base64 data", _name ? _name : "--");
+			return false;
 		}
 		if (_data_) {
+		 // decompress directly to _data_
+			uint retSizeBytes = DecompressTo(bin, binSizeBytes, _data_, _sizeBytes_);
 			if (retSizeBytes != _sizeBytes_) {
-				setError("Error serializing %s, buffer size was %llu (expected %llu)", _sizeBytes_, retSizeBytes);
-				if (compressed) {
-					APT_FREE(ret);
-				}
+				retSizeBytes = retSizeBytes ? retSizeBytes : GetDecompressedSize(bin, binSizeBytes);
+				APT_FREE(bin);
+				setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "--", (uint64)_sizeBytes_, (uint64)retSizeBytes);
 				return false;
 			}
-			memcpy(_data_, ret, retSizeBytes);
-			if (compressed) {
-				APT_FREE(ret);
-			}
+			APT_FREE(bin);
 		} else {
+			char* ret = nullptr; // Decompress allocates the final buffer
+			uint retSizeBytes = 0;
+			Decompress(bin, binSizeBytes, (void*&)ret, retSizeBytes);
+			APT_FREE(bin);
+			if (!ret) {
+				setError("Error serializing %s, decompression failed", _name ? _name : "--");
+				return false;
+			}
 			_data_ = ret;
 			_sizeBytes_ = retSizeBytes;
 		}
 	}
 	return true;
 }
+
+template <typename tJson, typename tType>
+static void PushArray(JsonValue& array_, const tType* _data, uint _count, JsonAllocator& _allocator_)
+{
+	for (uint i = 0; i < _count; ++i) {
+		array_.PushBack(JsonValue((tJson)_data[i]).Move(), _allocator_);
+	}
+}
+
+template <typename tType>
+static bool GetArray(const JsonValue& _array, tType* data_, uint _count)
+{
+	for (uint i = 0; i < _count; ++i) {
+		const JsonValue& v = _array[i];
+		if (v.IsDouble()) {
+			data_[i] = (tType)v.GetDouble();
+		} else if (v.IsUint64()) {
+			data_[i] = (tType)v.GetUint64();
+		} else if (v.IsInt64()) {
+			data_[i] = (tType)v.GetInt64();
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+template <>
+bool GetArray<bool>(const JsonValue& _array, bool* data_, uint _count)
+{
+	for (uint i = 0; i < _count; ++i) {
+		const JsonValue& v = _array[i];
+		if (!v.IsBool()) {
+			return false;
+		}
+		data_[i] = v.GetBool();
+	}
+	return true;
+}
+
+bool SerializerJson::valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name)
+{
+	const bool inArray = m_json->getArrayLength() >= 0;
+	if (!_name && !inArray) {
+		setError("Error serializing %s array; name must be specified if not in an array", ScalarTypeToStr(_type));
+		return false;
+	}
+	Json::Impl* impl = m_json->m_impl;
+
+	if (getMode() == Mode_Read) {
+		if (inArray) {
+			if (!m_json->next()) {
+				return false;
+			}
+		} else if (!m_json->find(_name)) {
+			setError("Error serializing %s array; '%s' not found", ScalarTypeToStr(_type), _name);
+			return false;
+		}
+		const JsonValue& arr = *impl->m_value;
+		if (!arr.IsArray()) {
+			setError("Error serializing %s array; '%s' not an array", ScalarTypeToStr(_type), _name ? _name : "");
+			return false;
+		}
+		if (arr.Size() != _count) {
+			setError("Error serializing %s array '%s': array length was %u, expected %u", ScalarTypeToStr(_type), _name ? _name : "", (uint)arr.Size(), _count);
+			return false;
+		}
+		bool ret = false;
+		switch (_type) {
+			case ScalarType_Bool:    ret = GetArray(arr, (bool*)   _data_, _count); break;
+			case ScalarType_Sint8:   ret = GetArray(arr, (sint8*)  _data_, _count); break;
+			case ScalarType_Uint8:   ret = GetArray(arr, (uint8*)  _data_, _count); break;
+			case ScalarType_Sint16:  ret = GetArray(arr, (sint16*) _data_, _count); break;
+			case ScalarType_Uint16:  ret = GetArray(arr, (uint16*) _data_, _count); break;
+			case ScalarType_Sint32:  ret = GetArray(arr, (sint32*) _data_, _count); break;
+			case ScalarType_Uint32:  ret = GetArray(arr, (uint32*) _data_, _count); break;
+			case ScalarType_Sint64:  ret = GetArray(arr, (sint64*) _data_, _count); break;
+			case ScalarType_Uint64:  ret = GetArray(arr, (uint64*) _data_, _count); break;
+			case ScalarType_Float32: ret = GetArray(arr, (float32*)_data_, _count); break;
+			case ScalarType_Float64: ret = GetArray(arr, (float64*)_data_, _count); break;
+			default: APT_ASSERT(false); break;
+		};
+		if (!ret) {
+			setError("Error serializing %s array '%s'; element type mismatch", ScalarTypeToStr(_type), _name ? _name : "");
+		}
+		return ret;
+	}
+
+ // build the array directly rather than via pushValue(), which is much faster for large arrays
+	JsonAllocator& allocator = impl->m_dom.GetAllocator();
+	JsonValue arr(rapidjson::kArrayType);
+	arr.Reserve(_count, allocator);
+	switch (_type) {
+		case ScalarType_Bool:    PushArray<bool>   (arr, (bool*)   _data_, _count, allocator); break;
+		case ScalarType_Sint8:   PushArray<sint32> (arr, (sint8*)  _data_, _count, allocator); break;
+		case ScalarType_Uint8:   PushArray<uint32> (arr, (uint8*)  _data_, _count, allocator); break;
+		case ScalarType_Sint16:  PushArray<sint32> (arr, (sint16*) _data_, _count, allocator); break;
+		case ScalarType_Uint16:  PushArray<uint32> (arr, (uint16*) _data_, _count, allocator); break;
+		case ScalarType_Sint32:  PushArray<sint32> (arr, (sint32*) _data_, _count, allocator); break;
+		case ScalarType_Uint32:  PushArray<uint32> (arr, (uint32*) _data_, _count, allocator); break;
+		case ScalarType_Sint64:  PushArray<sint64> (arr, (sint64*) _data_, _count, allocator); break;
+		case ScalarType_Uint64:  PushArray<uint64> (arr, (uint64*) _data_, _count, allocator); break;
+		case ScalarType_Float32: PushArray<float32>(arr, (float32*)_data_, _count, allocator); break;
+		case ScalarType_Float64: PushArray<float64>(arr, (float64*)_data_, _count, allocator); break;
+		default: APT_ASSERT(false); break;
+	};
+	++impl->m_generation;
+	if (inArray) {
+		impl->top()->PushBack(arr, allocator);
+		impl->m_value = impl->top()->End() - 1;
+	} else if (m_json->find(_name)) {
+		*impl->m_value = arr;
+	} else {
+		impl->addMember(*impl->top(), _name, arr, allocator);
+		impl->m_value = &(impl->top()->MemberEnd() - 1)->value;
+	}
+	return true;
+}
@@ -3,9 +3,14 @@
 #include <apt/apt.h>
 #include <apt/FileSystem.h>
 #include <apt/Serializer.h>
+#include <apt/StringHash.h>
+
+#include <EASTL/vector.h>
 
 namespace apt {
 
+class JsonPath;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Json
 // Traversal of a loaded document is a state machine:
@@ -79,6 +84,7 @@ namespace apt {
 class Json
 {
 	friend class SerializerJson; 
+	friend class JsonReader;
 public:
 	enum ValueType
 	{
@@ -92,17 +98,49 @@ public:
 		ValueType_Count
 	};
 
+	struct WriteOptions
+	{
+		bool m_pretty;    // indent with tabs and break lines, else write without whitespace
+		int  m_precision; // max decimal places for floating point values, -1 for full (round trip) precision
+
+		WriteOptions(bool _pretty = true, int _precision = -1)
+			: m_pretty(_pretty)
+			, m_precision(_precision)
+		{
+		}
+	};
+
 	static bool Read(Json& json_, const File& _file);
 	static bool Read(Json& json_, const char* _path, FileSystem::RootType _rootHint = FileSystem::RootType_Default);
-	static bool Write(const Json& _json, File& file_);
-	static bool Write(const Json& _json, const char* _path, FileSystem::RootType _rootHint = FileSystem::RootType_Default);
+	// Parse file_'s buffer in place; file_ is moved into json_ (and left empty) and string values point directly into
+	// the buffer, which is released with json_ or by the next call to Read(). Faster than Read() and avoids the
+	// peak of holding the file and a copy of its strings, but the whole buffer is retained for the lifetime of json_. 
+	// file_ must be null terminated and mutable, i.e. loaded via File::Read() not File::Map(). On error file_ keeps its
+	// buffer, although the contents may have been modified by the parser.
+	static bool ReadInsitu(Json& json_, File& file_);
+	// Write directly to file_'s buffer (without an intermediate copy). Writing to _path serializes to a buffer which is
+	// then written via FileSystem::Write().
+	static bool Write(const Json& _json, File& file_, const WriteOptions& _options = WriteOptions());
+	static bool Write(const Json& _json, const char* _path, FileSystem::RootType _rootHint = FileSystem::RootType_Default, const WriteOptions& _options = WriteOptions());
 		
 	// Reads from _path if specified.
 	Json(const char* _path = nullptr, FileSystem::RootType _rootHint = FileSystem::RootType_Default);
 	~Json();
 
+	// Clear the document (to an empty object). Memory used by the previous document is retained for reuse, hence
+	// reset() followed by Read() is cheaper than constructing a new Json.
+	void reset();
+
 	// Find a named value in the current object. Return true if the value is found, in which case getValue() may be called.
+	// Objects with many members are indexed by the StringHash of the member names the first time they are searched,
+	// hence lookups are O(1). The index is updated automatically if members are added.
 	bool find(const char* _name);
+	// As find(), _name is the StringHash of the member name.
+	bool find(StringHash _name);
+	// Find the value at _path, which is relative to the document root (not the current object). Only the current value
+	// is set; the current object is unchanged. The resolved value is cached in _path, and reused until the document is
+	// modified.
+	bool find(const JsonPath& _path);
 	
 	// Get the next value in the current object/array. Return true if not the end of the object/array, in which case getValue() may be called.
 	bool next();
@@ -119,6 +157,8 @@ public:
 	// Get a named value. Equivalent to find(_name) followed by getValue(_i).
 	template <typename tType>
 	tType getValue(const char* _name, int _i = -1) { APT_VERIFY(find(_name)); return getValue<tType>(_i); }
+	template <typename tType>
+	tType getValue(const JsonPath& _path, int _i = -1) { APT_VERIFY(find(_path)); return getValue<tType>(_i); }
 		
 	// Create and set a named value. If the object already exists this modifies the type and value of the existing object.
 	template <typename tType>
@@ -163,6 +203,184 @@ private:
 
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// JsonPath
+// JSON pointer (RFC 6901) compiled to a list of hashed segments, e.g.
+// "/render/shadows/cascades/2". Segments are object member names or array
+// indices; '~1' and '~0' escape '/' and '~'. The empty path refers to the
+// document root.
+//
+// Compile hot paths once and pass them to Json::find()/getValue():
+//
+//  static const JsonPath kCascadeCount("/render/shadows/cascadeCount");
+//  int n = json.getValue<int>(kCascadeCount);
+//
+// The resolved value is cached in the JsonPath along with the document's
+// generation, which changes whenever the document is modified; repeated
+// lookups against an unmodified document are O(1). The cache isn't thread
+// safe, use one JsonPath per thread.
+////////////////////////////////////////////////////////////////////////////////
+class JsonPath
+{
+	friend class Json;
+public:
+	explicit JsonPath(const char* _path);
+
+	// Return false if the path string was invalid (non-empty without a leading '/').
+	bool isValid() const                  { return m_isValid; }
+	int  getSegmentCount() const          { return (int)m_segments.size(); }
+
+private:
+	struct Segment
+	{
+		StringHash m_hash;
+		uint       m_name;  // offset into m_names (unescaped, null-terminated)
+		int        m_index; // array index, or -1 if the segment isn't a number
+	};
+	eastl::vector<Segment> m_segments;
+	eastl::vector<char>    m_names;
+	bool                   m_isValid;
+
+ // resolve cache, see Json::find()
+	mutable uint64         m_cacheId;
+	mutable uint64         m_cacheGeneration;
+	mutable void*          m_cacheValue;
+
+	const char* getName(const Segment& _segment) const { return &m_names[_segment.m_name]; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// JsonReader
+// Streaming (SAX style) reader, emits events to a handler without building a
+// DOM. Memory use is constant with respect to the size of the source:
+//
+//  struct CountNumbers: public JsonReader::Handler
+//  {
+//     int m_count = 0;
+//     bool intValue(sint64)    { ++m_count; return true; }
+//     bool doubleValue(double) { ++m_count; return true; } // return false to stop
+//  };
+//
+//  File f;
+//  File::Map(f, "data.json");
+//  JsonReader reader(f);
+//  CountNumbers handler;
+//  reader.read(handler);
+//
+// Large arrays of records can be processed one element at a time, each element
+// is materialized as the root of a Json:
+//
+//  Json element;
+//  reader.readArray(element, [](Json& _element) {
+//     int id = _element.getValue<int>("id");
+//     return true; // return false to stop
+//  });
+//
+// The source is consumed, read()/readArray() should be called once only.
+////////////////////////////////////////////////////////////////////////////////
+class JsonReader: private non_copyable<JsonReader>
+{
+public:
+	// Fill buf_ with up to _bufSize bytes, return the number of bytes written or 0 at the end of the source.
+	typedef uint (ReadCallback)(char* buf_, uint _bufSize, void* _userData);
+
+	// Default handler, derive and override (hide) the members as required. Return false to stop reading. Strings
+	// are null terminated and valid only during the call.
+	struct Handler
+	{
+		bool beginObject()                                        { return true; }
+		bool endObject(uint /*_memberCount*/)                     { return true; }
+		bool beginArray()                                         { return true; }
+		bool endArray(uint /*_length*/)                           { return true; }
+		bool key(const char* /*_name*/, uint /*_length*/)         { return true; }
+		bool nullValue()                                          { return true; }
+		bool boolValue(bool /*_value*/)                           { return true; }
+		bool intValue(sint64 /*_value*/)                          { return true; }
+		bool uintValue(uint64 /*_value*/)                         { return true; } // only for values which don't fit in a sint64
+		bool doubleValue(double /*_value*/)                       { return true; }
+		bool stringValue(const char* /*_value*/, uint /*_length*/) { return true; }
+	};
+
+	// Read from _file (e.g. via File::Map()), which must remain valid during read()/readArray().
+	JsonReader(const File& _file);
+	// Read from a chunked source, _callback is called to fill a buffer of _bufferSize bytes as required.
+	JsonReader(ReadCallback* _callback, void* _userData, uint _bufferSize = 64 * 1024);
+	~JsonReader();
+
+	// Parse the source, calling the members of handler_ for each event. Return false if a parse error occurred or if
+	// handler_ stopped reading.
+	template <typename tHandler>
+	bool read(tHandler& handler_)
+	{
+		HandlerAdapter<tHandler> adapter(handler_);
+		return readImpl(adapter);
+	}
+
+	// Parse a top-level array, materializing each element as the root of json_ (which is reused) and calling
+	// _callback(json_), which should return false to stop. Return false if a parse error occurred or the source is 
+	// not an array.
+	template <typename tCallback>
+	bool readArray(Json& json_, tCallback _callback)
+	{
+		CallbackAdapter<tCallback> adapter(_callback);
+		return readArrayImpl(json_, adapter);
+	}
+
+private:
+	struct Impl;
+	struct Sax;
+	struct ArrayBuilder;
+	Impl* m_impl;
+
+	struct HandlerBase
+	{
+		virtual bool beginObject() = 0;
+		virtual bool endObject(uint _memberCount) = 0;
+		virtual bool beginArray() = 0;
+		virtual bool endArray(uint _length) = 0;
+		virtual bool key(const char* _name, uint _length) = 0;
+		virtual bool nullValue() = 0;
+		virtual bool boolValue(bool _value) = 0;
+		virtual bool intValue(sint64 _value) = 0;
+		virtual bool uintValue(uint64 _value) = 0;
+		virtual bool doubleValue(double _value) = 0;
+		virtual bool stringValue(const char* _value, uint _length) = 0;
+	};
+	template <typename tHandler>
+	struct HandlerAdapter: public HandlerBase
+	{
+		tHandler& m_handler;
+		HandlerAdapter(tHandler& _handler): m_handler(_handler)     {}
+		bool beginObject() override                                 { return m_handler.beginObject(); }
+		bool endObject(uint _memberCount) override                  { return m_handler.endObject(_memberCount); }
+		bool beginArray() override                                  { return m_handler.beginArray(); }
+		bool endArray(uint _length) override                        { return m_handler.endArray(_length); }
+		bool key(const char* _name, uint _length) override          { return m_handler.key(_name, _length); }
+		bool nullValue() override                                   { return m_handler.nullValue(); }
+		bool boolValue(bool _value) override                        { return m_handler.boolValue(_value); }
+		bool intValue(sint64 _value) override                       { return m_handler.intValue(_value); }
+		bool uintValue(uint64 _value) override                      { return m_handler.uintValue(_value); }
+		bool doubleValue(double _value) override                    { return m_handler.doubleValue(_value); }
+		bool stringValue(const char* _value, uint _length) override { return m_handler.stringValue(_value, _length); }
+	};
+
+	struct CallbackBase
+	{
+		virtual bool operator()(Json& _json_) = 0;
+	};
+	template <typename tCallback>
+	struct CallbackAdapter: public CallbackBase
+	{
+		tCallback m_callback;
+		CallbackAdapter(tCallback _callback): m_callback(_callback) {}
+		bool operator()(Json& _json_) override                      { return m_callback(_json_); }
+	};
+
+	bool readImpl(HandlerBase& handler_);
+	bool readArrayImpl(Json& json_, CallbackBase& callback_);
+
+}; // class JsonReader
+
 ////////////////////////////////////////////////////////////////////////////////
 // SerializerJson
 ////////////////////////////////////////////////////////////////////////////////
@@ -199,6 +417,8 @@ private:
 
 	int string(const char* _value_, const char* _name);
 
+	bool valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name) override;
+
 }; // class SerializerJson
 
 
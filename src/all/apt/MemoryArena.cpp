@@ -0,0 +1,125 @@
+#include <apt/MemoryArena.h>
+
+#include <apt/memory.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace apt;
+
+struct MemoryArena::Block
+{
+	Block* m_prev;
+	uint   m_size;   // including the header
+};
+
+static const uint kMaxBlockSize = 16 * 1024 * 1024; // block size stops growing geometrically
+
+void apt::swap(MemoryArena& _a, MemoryArena& _b)
+{
+	using std::swap;
+	swap(_a.m_block,      _b.m_block);
+	swap(_a.m_pos,        _b.m_pos);
+	swap(_a.m_end,        _b.m_end);
+	swap(_a.m_blockSize,  _b.m_blockSize);
+	swap(_a.m_blockCount, _b.m_blockCount);
+}
+
+// PUBLIC
+
+MemoryArena::MemoryArena(uint _blockSize)
+	: m_block(nullptr)
+	, m_pos(nullptr)
+	, m_end(nullptr)
+	, m_blockSize(_blockSize)
+	, m_blockCount(0)
+{
+	APT_ASSERT(_blockSize > sizeof(Block));
+}
+
+MemoryArena::~MemoryArena()
+{
+	while (m_block) {
+		Block* prev = m_block->m_prev;
+		APT_FREE(m_block);
+		m_block = prev;
+	}
+}
+
+void* MemoryArena::alloc(uint _size, uint _align)
+{
+	APT_ASSERT((_align & (_align - 1)) == 0);
+	char* ret = (char*)(((uintptr_t)m_pos + (_align - 1)) & ~(uintptr_t)(_align - 1));
+	if (!m_block || ret + _size > m_end) {
+		allocBlock(_size + _align);
+		ret = (char*)(((uintptr_t)m_pos + (_align - 1)) & ~(uintptr_t)(_align - 1));
+	}
+	m_pos = ret + _size;
+	return ret;
+}
+
+void* MemoryArena::realloc(void* _ptr, uint _oldSize, uint _newSize, uint _align)
+{
+	if (!_ptr) {
+		return alloc(_newSize, _align);
+	}
+	char* ptr = (char*)_ptr;
+	if (ptr + _oldSize == m_pos && ptr + _newSize <= m_end) {
+		m_pos = ptr + _newSize;
+		return ptr;
+	}
+	if (_newSize <= _oldSize) {
+		return ptr;
+	}
+	void* ret = alloc(_newSize, _align);
+	memcpy(ret, ptr, _oldSize);
+	return ret;
+}
+
+char* MemoryArena::allocString(const char* _str, uint _len)
+{
+	char* ret = (char*)alloc(_len + 1, 1);
+	memcpy(ret, _str, _len);
+	ret[_len] = '\0';
+	return ret;
+}
+
+void MemoryArena::reset()
+{
+	if (!m_block) {
+		return;
+	}
+ // blocks grow, hence the current block is the largest (unless a large allocation made a block > m_blockSize)
+	Block* keep = m_block;
+	for (Block* block = m_block->m_prev; block; block = block->m_prev) {
+		keep = block->m_size > keep->m_size ? block : keep;
+	}
+	while (m_block) {
+		Block* prev = m_block->m_prev;
+		if (m_block != keep) {
+			APT_FREE(m_block);
+		}
+		m_block = prev;
+	}
+	m_block = keep;
+	m_block->m_prev = nullptr;
+	m_pos = (char*)(m_block + 1);
+	m_end = (char*)m_block + m_block->m_size;
+	m_blockCount = 1;
+}
+
+// PRIVATE
+
+void MemoryArena::allocBlock(uint _minSize)
+{
+	uint size = std::max(m_blockSize, _minSize + (uint)sizeof(Block));
+	Block* block = (Block*)APT_MALLOC(size);
+	block->m_prev = m_block;
+	block->m_size = size;
+	m_block = block;
+	m_pos = (char*)(block + 1);
+	m_end = (char*)block + size;
+	m_blockSize = std::min(m_blockSize * 2, std::max(m_blockSize, kMaxBlockSize));
+	++m_blockCount;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <apt/apt.h>
+
+namespace apt {
+
+////////////////////////////////////////////////////////////////////////////////
+// MemoryArena
+// Linear allocator; allocations are serviced by incrementing a ptr within the
+// current block, individual allocations cannot be freed. When a block is full
+// a new block is allocated, block sizes grow geometrically hence the number
+// of heap allocations is O(log n) in the total size.
+// Usage:
+//
+//    MemoryArena arena;
+//    char* str = (char*)arena.alloc(len + 1, 1);
+//    Foo* foo = new(arena.alloc(sizeof(Foo), alignof(Foo))) Foo; // placement new, dtor is never called
+//    arena.reset(); // invalidate all allocations
+//
+////////////////////////////////////////////////////////////////////////////////
+class MemoryArena: private non_copyable<MemoryArena>
+{
+public:
+	// _blockSize is the size of the first block allocated when alloc() is first called.
+	MemoryArena(uint _blockSize = 4 * 1024);
+
+	// Free all allocated memory.
+	~MemoryArena();
+
+	// Allocate _size bytes with _align alignment (must be a power of 2).
+	void* alloc(uint _size, uint _align = alignof(double));
+
+	// Resize an allocation. If _ptr was the most recent allocation and there is space in the current block it is resized
+	// in place, else a new allocation is made and min(_oldSize, _newSize) bytes are copied.
+	void* realloc(void* _ptr, uint _oldSize, uint _newSize, uint _align = alignof(double));
+
+	// Copy _len chars from _str into the arena and null terminate.
+	char* allocString(const char* _str, uint _len);
+
+	// Invalidate all allocations. The largest block is retained for reuse, all others are freed.
+	void  reset();
+
+	// Number of heap allocations currently owned by the arena.
+	uint  getBlockCount() const { return m_blockCount; }
+
+	friend void swap(MemoryArena& _a, MemoryArena& _b);
+
+private:
+	struct Block;
+
+	Block* m_block;       // current block, linked to previous blocks
+	char*  m_pos;         // next free byte in m_block
+	char*  m_end;         // end of m_block
+	uint   m_blockSize;   // size of the next block
+	uint   m_blockCount;
+
+	void allocBlock(uint _minSize);
+
+};
+
+} // namespace apt
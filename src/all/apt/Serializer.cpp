@@ -20,32 +20,26 @@ void Serializer::setError(const char* _msg, ...)
 	}
 }
 
-template <typename tType, uint kLen>
-static bool ValueVecMatImpl(Serializer& _serializer_, tType& _value_, const char* _name)
+bool Serializer::value(vec2& _value_, const char* _name) { return valueArray(&_value_, 1, _name); }
+bool Serializer::value(vec3& _value_, const char* _name) { return valueArray(&_value_, 1, _name); }
+bool Serializer::value(vec4& _value_, const char* _name) { return valueArray(&_value_, 1, _name); }
+bool Serializer::value(mat2& _value_, const char* _name) { return valueArray(&_value_, 1, _name); }
+bool Serializer::value(mat3& _value_, const char* _name) { return valueArray(&_value_, 1, _name); }
+bool Serializer::value(mat4& _value_, const char* _name) { return valueArray(&_value_, 1, _name); }
+
+const char* Serializer::ScalarTypeToStr(ScalarType _type)
 {
-	uint len = kLen; \
-	if (_serializer_.beginArray(len, _name)) { \
-		bool ret = true;
-		if (len != kLen) {
-			_serializer_.setError("Error serializing %s '%s': array length was %d, expected %d", Serializer::ValueTypeToStr<tType>(), _name ? _name : "", (int)len, (int)kLen);
-			ret = false;
-		} else {
-			float* v = (float*)&_value_; // access vec/mat as a flat array
-			for (int i = 0; i < (int)kLen; ++i) { 
-				ret &= _serializer_.value(v[i]);
-			}
-		}
-		_serializer_.endArray();
-		return ret;
-	}
-	return false;
+	static const char* kScalarTypeStr[] = { "bool", "sint8", "uint8", "sint16", "uint16", "sint32", "uint32", "sint64", "uint64", "float32", "float64" };
+	APT_STATIC_ASSERT(APT_ARRAY_COUNT(kScalarTypeStr) == ScalarType_Count);
+	return kScalarTypeStr[_type];
+}
+
+uint Serializer::ScalarTypeSize(ScalarType _type)
+{
+	static const uint kScalarTypeSize[] = { sizeof(bool), 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+	APT_STATIC_ASSERT(APT_ARRAY_COUNT(kScalarTypeSize) == ScalarType_Count);
+	return kScalarTypeSize[_type];
 }
-bool Serializer::value(vec2& _value_, const char* _name) { return ValueVecMatImpl<vec2,   2>(*this, _value_, _name); }
-bool Serializer::value(vec3& _value_, const char* _name) { return ValueVecMatImpl<vec3,   3>(*this, _value_, _name); }
-bool Serializer::value(vec4& _value_, const char* _name) { return ValueVecMatImpl<vec4,   4>(*this, _value_, _name); }
-bool Serializer::value(mat2& _value_, const char* _name) { return ValueVecMatImpl<mat2, 2*2>(*this, _value_, _name); }
-bool Serializer::value(mat3& _value_, const char* _name) { return ValueVecMatImpl<mat3, 3*3>(*this, _value_, _name); }
-bool Serializer::value(mat4& _value_, const char* _name) { return ValueVecMatImpl<mat4, 4*4>(*this, _value_, _name); }
 
 // PROTECTED
 
@@ -73,6 +67,82 @@ const char* Serializer::ValueTypeToStr()
 	template <> const char* Serializer::ValueTypeToStr<mat3>()        { return "mat3";       }
 	template <> const char* Serializer::ValueTypeToStr<mat4>()        { return "mat4";       }
 
+bool Serializer::valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name)
+{
+	uint len = _count;
+	if (!beginArray(len, _name)) {
+		return false;
+	}
+	bool ret = true;
+	if (len != _count) {
+		setError("Error serializing %s array '%s': array length was %u, expected %u", ScalarTypeToStr(_type), _name ? _name : "", len, _count);
+		ret = false;
+	} else {
+		ret = valueArrayElements(_data_, _count, _type);
+	}
+	endArray();
+	return ret;
+}
+
+template <typename tType>
+static bool ValueArrayElementsImpl(Serializer& _serializer_, tType* _data_, uint _count)
+{
+	bool ret = true;
+	for (uint i = 0; i < _count; ++i) {
+		ret &= _serializer_.value(_data_[i]);
+	}
+	return ret;
+}
+bool Serializer::valueArrayElements(void* _data_, uint _count, ScalarType _type)
+{
+	switch (_type) {
+		case ScalarType_Bool:    return ValueArrayElementsImpl(*this, (bool*)   _data_, _count);
+		case ScalarType_Sint8:   return ValueArrayElementsImpl(*this, (sint8*)  _data_, _count);
+		case ScalarType_Uint8:   return ValueArrayElementsImpl(*this, (uint8*)  _data_, _count);
+		case ScalarType_Sint16:  return ValueArrayElementsImpl(*this, (sint16*) _data_, _count);
+		case ScalarType_Uint16:  return ValueArrayElementsImpl(*this, (uint16*) _data_, _count);
+		case ScalarType_Sint32:  return ValueArrayElementsImpl(*this, (sint32*) _data_, _count);
+		case ScalarType_Uint32:  return ValueArrayElementsImpl(*this, (uint32*) _data_, _count);
+		case ScalarType_Sint64:  return ValueArrayElementsImpl(*this, (sint64*) _data_, _count);
+		case ScalarType_Uint64:  return ValueArrayElementsImpl(*this, (uint64*) _data_, _count);
+		case ScalarType_Float32: return ValueArrayElementsImpl(*this, (float32*)_data_, _count);
+		case ScalarType_Float64: return ValueArrayElementsImpl(*this, (float64*)_data_, _count);
+		default: APT_ASSERT(false); return false;
+	};
+}
+
+bool Serializer::valueFields(void* _object_, const ReflectTable& _table)
+{
+	bool ret = true;
+	for (uint i = 0; i < _table.m_fieldCount; ++i) {
+		const ReflectField& field = _table.m_fields[i];
+		void* data = (char*)_object_ + field.m_offset;
+		bool ok;
+		if (field.m_type == ScalarType_Count) {
+			ok = field.m_serialize(*this, data, field.m_name);
+		} else if (field.m_count > 0) {
+			ok = valueArrayImpl(data, field.m_count, field.m_type, field.m_name);
+		} else {
+			switch (field.m_type) {
+				case ScalarType_Bool:    ok = value(*(bool*)   data, field.m_name); break;
+				case ScalarType_Sint8:   ok = value(*(sint8*)  data, field.m_name); break;
+				case ScalarType_Uint8:   ok = value(*(uint8*)  data, field.m_name); break;
+				case ScalarType_Sint16:  ok = value(*(sint16*) data, field.m_name); break;
+				case ScalarType_Uint16:  ok = value(*(uint16*) data, field.m_name); break;
+				case ScalarType_Sint32:  ok = value(*(sint32*) data, field.m_name); break;
+				case ScalarType_Uint32:  ok = value(*(uint32*) data, field.m_name); break;
+				case ScalarType_Sint64:  ok = value(*(sint64*) data, field.m_name); break;
+				case ScalarType_Uint64:  ok = value(*(uint64*) data, field.m_name); break;
+				case ScalarType_Float32: ok = value(*(float32*)data, field.m_name); break;
+				case ScalarType_Float64: ok = value(*(float64*)data, field.m_name); break;
+				default: APT_ASSERT(false); ok = false; break;
+			};
+		}
+		ret &= ok;
+	}
+	return ret;
+}
+
 
 //---
 
@@ -102,4 +172,18 @@ bool apt::Serialize(Serializer& _serializer_, vec3&       _value_, const char* _
 bool apt::Serialize(Serializer& _serializer_, vec4&       _value_, const char* _name) { return SerializeImpl(_serializer_, _value_, _name); }
 bool apt::Serialize(Serializer& _serializer_, mat2&       _value_, const char* _name) { return SerializeImpl(_serializer_, _value_, _name); }
 bool apt::Serialize(Serializer& _serializer_, mat3&       _value_, const char* _name) { return SerializeImpl(_serializer_, _value_, _name); }
-bool apt::Serialize(Serializer& _serializer_, mat4&       _value_, const char* _name) { return SerializeImpl(_serializer_, _value_, _name); }
\ No newline at end of file
+bool apt::Serialize(Serializer& _serializer_, mat4&       _value_, const char* _name) { return SerializeImpl(_serializer_, _value_, _name); }
+
+bool apt::SerializeReflected(Serializer& _serializer_, void* _object_, const ReflectTable& _table, const char* _name)
+{
+	if (!_serializer_.beginObject(_name)) {
+		APT_LOG_ERR(_serializer_.getError());
+		return false;
+	}
+	bool ret = _serializer_.valueFields(_object_, _table);
+	_serializer_.endObject();
+	if (!ret) {
+		APT_LOG_ERR(_serializer_.getError());
+	}
+	return ret;
+}
\ No newline at end of file
@@ -5,9 +5,14 @@
 #include <apt/math.h>
 #include <apt/types.h>
 #include <apt/String.h>
+#include <apt/StringHash.h>
+
+#include <cstddef> // offsetof
 
 namespace apt {
 
+struct ReflectTable;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Serializer
 // Base class for serialization handlers. 
@@ -21,6 +26,23 @@ public:
 		Mode_Write
 	};
 
+	enum ScalarType
+	{
+		ScalarType_Bool,
+		ScalarType_Sint8,
+		ScalarType_Uint8,
+		ScalarType_Sint16,
+		ScalarType_Uint16,
+		ScalarType_Sint32,
+		ScalarType_Uint32,
+		ScalarType_Sint64,
+		ScalarType_Uint64,
+		ScalarType_Float32,
+		ScalarType_Float64,
+
+		ScalarType_Count
+	};
+
 	Mode         getMode() const                       { return m_mode;  }
 	void         setMode(Mode _mode)                   { m_mode = _mode; }
 	const char*  getError() const                      { return m_errStr.isEmpty() ? nullptr : (const char*)m_errStr; }
@@ -53,7 +75,7 @@ public:
 	virtual bool value(float64&    _value_, const char* _name = nullptr) = 0;
 	virtual bool value(StringBase& _value_, const char* _name = nullptr) = 0;
 	
-	// vec* and mat* variants are implemented in terms of beginArray/endArray and value(float&).
+	// vec* and mat* variants are implemented in terms of valueArray().
 	bool         value(vec2& _value_, const char* _name = nullptr);
 	bool         value(vec3& _value_, const char* _name = nullptr);
 	bool         value(vec4& _value_, const char* _name = nullptr);
@@ -61,6 +83,27 @@ public:
 	bool         value(mat3& _value_, const char* _name = nullptr);
 	bool         value(mat4& _value_, const char* _name = nullptr);
 
+	// Serialize _count contiguous values at _data_ as a single flat array, i.e. vec* and mat* are serialized as
+	// _count * N floats. Backends serialize the whole array at once, which is much faster than calling value() per 
+	// element. When reading, the array length must match.
+	bool         valueArray(bool*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Bool,    _name); }
+	bool         valueArray(sint8*   _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Sint8,   _name); }
+	bool         valueArray(uint8*   _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Uint8,   _name); }
+	bool         valueArray(sint16*  _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Sint16,  _name); }
+	bool         valueArray(uint16*  _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Uint16,  _name); }
+	bool         valueArray(sint32*  _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Sint32,  _name); }
+	bool         valueArray(uint32*  _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Uint32,  _name); }
+	bool         valueArray(sint64*  _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Sint64,  _name); }
+	bool         valueArray(uint64*  _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Uint64,  _name); }
+	bool         valueArray(float32* _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Float32, _name); }
+	bool         valueArray(float64* _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count,       ScalarType_Float64, _name); }
+	bool         valueArray(vec2*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count * 2,   ScalarType_Float32, _name); }
+	bool         valueArray(vec3*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count * 3,   ScalarType_Float32, _name); }
+	bool         valueArray(vec4*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count * 4,   ScalarType_Float32, _name); }
+	bool         valueArray(mat2*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count * 2*2, ScalarType_Float32, _name); }
+	bool         valueArray(mat3*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count * 3*3, ScalarType_Float32, _name); }
+	bool         valueArray(mat4*    _data_, uint _count, const char* _name = nullptr) { return valueArrayImpl(_data_, _count * 4*4, ScalarType_Float32, _name); }
+
 	// Helper to avoid explicit cast to StringBase&.
 	template <uint kCapacity>
 	bool         value(String<kCapacity>& _value_, const char* _name = nullptr)
@@ -77,9 +120,16 @@ public:
 		CompressionFlags _compressionFlags = CompressionFlags_None
 		) = 0;
 
+	// Serialize the fields of the reflected struct at _object_ (see APT_REFLECT_BEGIN) as values of the current object.
+	// Return false if any field failed. The default implementation calls value()/valueArray() per field; backends may
+	// override to use the precomputed name hashes and batch contiguous fields.
+	virtual bool valueFields(void* _object_, const ReflectTable& _table);
+
 	// Return tType as a string.
 	template <typename tType>
 	static const char* ValueTypeToStr();
+	static const char* ScalarTypeToStr(ScalarType _type);
+	static uint        ScalarTypeSize(ScalarType _type);
 
 protected:
 	Mode m_mode;
@@ -92,6 +142,14 @@ protected:
 	{
 	}
 
+	// Serialize _count scalars of _type at _data_ as an array. The default implementation calls beginArray(), 
+	// valueArrayElements() then endArray().
+	virtual bool valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name);
+
+	// Call value() for _count scalars of _type at _data_ (i.e. the elements of the current array). Return false if any
+	// call to value() failed or the end of the current array was reached.
+	bool         valueArrayElements(void* _data_, uint _count, ScalarType _type);
+
 private:
 	String<64> m_errStr;
 
@@ -148,4 +206,137 @@ bool SerializeEnum(Serializer& _serializer_, tType& _value_, const char* (&_strL
 	return ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// ReflectField, ReflectTable
+// Table of a struct's fields, generated by APT_REFLECT_BEGIN/APT_REFLECT_END.
+////////////////////////////////////////////////////////////////////////////////
+struct ReflectField
+{
+	typedef bool (SerializeFunc)(Serializer& _serializer_, void* _data_, const char* _name);
+
+	const char*            m_name;
+	StringHash             m_nameHash;  // precomputed hash of m_name
+	uint32                 m_offset;    // offset of the field within the struct
+	uint32                 m_size;      // sizeof the field
+	Serializer::ScalarType m_type;      // ScalarType_Count if the field isn't a scalar, vec*, mat* or an array thereof
+	uint32                 m_count;     // scalar count if serialized via valueArray() (vec*, mat*, arrays), 0 for a single scalar
+	SerializeFunc*         m_serialize; // calls Serialize() if m_type is ScalarType_Count, else null
+
+	template <typename tField>
+	static ReflectField Make(const char* _name, uint _offset);
+};
+
+struct ReflectTable
+{
+	const ReflectField* m_fields;
+	uint                m_fieldCount;
+};
+
+// Serialize the reflected struct at _object_ as an object (call Serializer::valueFields() directly to serialize the
+// fields as values of the current object).
+bool SerializeReflected(Serializer& _serializer_, void* _object_, const ReflectTable& _table, const char* _name = nullptr);
+
+// Serialize* variant for any type reflected via APT_REFLECT_BEGIN.
+template <typename tType>
+auto Serialize(Serializer& _serializer_, tType& _value_, const char* _name = nullptr) -> decltype(GetReflectTable((const tType*)nullptr), bool())
+{
+	return SerializeReflected(_serializer_, &_value_, GetReflectTable((const tType*)nullptr), _name);
+}
+
+namespace internal {
+
+template <typename tType>
+struct ReflectFieldTraits
+{
+	static const Serializer::ScalarType kType  = Serializer::ScalarType_Count;
+	static const uint                   kCount = 0;
+};
+#define APT_REFLECT_FIELD_TRAITS(_type, _scalarType, _count) \
+	template <> struct ReflectFieldTraits<_type> { \
+		static const Serializer::ScalarType kType  = Serializer::_scalarType; \
+		static const uint                   kCount = _count; \
+	};
+APT_REFLECT_FIELD_TRAITS(bool,    ScalarType_Bool,    0)
+APT_REFLECT_FIELD_TRAITS(sint8,   ScalarType_Sint8,   0)
+APT_REFLECT_FIELD_TRAITS(uint8,   ScalarType_Uint8,   0)
+APT_REFLECT_FIELD_TRAITS(sint16,  ScalarType_Sint16,  0)
+APT_REFLECT_FIELD_TRAITS(uint16,  ScalarType_Uint16,  0)
+APT_REFLECT_FIELD_TRAITS(sint32,  ScalarType_Sint32,  0)
+APT_REFLECT_FIELD_TRAITS(uint32,  ScalarType_Uint32,  0)
+APT_REFLECT_FIELD_TRAITS(sint64,  ScalarType_Sint64,  0)
+APT_REFLECT_FIELD_TRAITS(uint64,  ScalarType_Uint64,  0)
+APT_REFLECT_FIELD_TRAITS(float32, ScalarType_Float32, 0)
+APT_REFLECT_FIELD_TRAITS(float64, ScalarType_Float64, 0)
+APT_REFLECT_FIELD_TRAITS(vec2,    ScalarType_Float32, 2)
+APT_REFLECT_FIELD_TRAITS(vec3,    ScalarType_Float32, 3)
+APT_REFLECT_FIELD_TRAITS(vec4,    ScalarType_Float32, 4)
+APT_REFLECT_FIELD_TRAITS(mat2,    ScalarType_Float32, 2*2)
+APT_REFLECT_FIELD_TRAITS(mat3,    ScalarType_Float32, 3*3)
+APT_REFLECT_FIELD_TRAITS(mat4,    ScalarType_Float32, 4*4)
+#undef APT_REFLECT_FIELD_TRAITS
+
+// Fixed-size arrays of scalars, vec* or mat* are serialized as a single flat array.
+template <typename tType, uint kLength>
+struct ReflectFieldTraits<tType[kLength]>
+{
+	static const Serializer::ScalarType kType  = ReflectFieldTraits<tType>::kType;
+	static const uint                   kCount = kLength * (ReflectFieldTraits<tType>::kCount > 0 ? ReflectFieldTraits<tType>::kCount : 1);
+};
+
+template <typename tField, bool kIsScalar>
+struct ReflectSerializeFunc
+{
+	static ReflectField::SerializeFunc* Get()  { return &Func; }
+	static bool Func(Serializer& _serializer_, void* _data_, const char* _name)
+	{
+		return Serialize(_serializer_, *(tField*)_data_, _name);
+	}
+};
+template <typename tField>
+struct ReflectSerializeFunc<tField, true>
+{
+	static ReflectField::SerializeFunc* Get()  { return nullptr; }
+};
+
+} // namespace internal
+
+template <typename tField>
+inline ReflectField ReflectField::Make(const char* _name, uint _offset)
+{
+	typedef internal::ReflectFieldTraits<tField> Traits;
+	ReflectField ret;
+	ret.m_name      = _name;
+	ret.m_nameHash  = StringHash(_name);
+	ret.m_offset    = (uint32)_offset;
+	ret.m_size      = (uint32)sizeof(tField);
+	ret.m_type      = Traits::kType;
+	ret.m_count     = (uint32)Traits::kCount;
+	ret.m_serialize = internal::ReflectSerializeFunc<tField, Traits::kType != Serializer::ScalarType_Count>::Get();
+	return ret;
+}
+
 } // namespace apt
+
+// Reflect the fields of _type for Serialize(), e.g.
+//
+//    APT_REFLECT_BEGIN(Entity)
+//       APT_REFLECT_FIELD(m_name,     "Name")
+//       APT_REFLECT_FIELD(m_position, "Position")
+//    APT_REFLECT_END()
+//
+// Serialize(_serializer_, entity, "Entity") is then equivalent to beginObject("Entity"), calling Serialize() for each
+// field in order, then endObject(). Fields may be scalars, vec*, mat*, fixed-size arrays thereof (serialized via 
+// valueArray()) or any type with a Serialize() overload (strings, other reflected structs). Use at namespace scope in 
+// the namespace containing _type; the fields must be accessible (i.e. public). The table is built on first use.
+#define APT_REFLECT_BEGIN(_type) \
+	inline const apt::ReflectTable& GetReflectTable(const _type*) \
+	{ \
+		typedef _type ReflectType_; \
+		static const apt::ReflectField kFields[] = {
+#define APT_REFLECT_FIELD(_member, _name) \
+			apt::ReflectField::Make<decltype(ReflectType_::_member)>(_name, offsetof(ReflectType_, _member)),
+#define APT_REFLECT_END() \
+		}; \
+		static const apt::ReflectTable kTable = { kFields, APT_ARRAY_COUNT(kFields) }; \
+		return kTable; \
+	}
@@ -0,0 +1,847 @@
+#include <apt/SerializerBinary.h>
+
+#include <apt/log.h>
+#include <apt/memory.h>
+#include <apt/File.h>
+#include <apt/StringHash.h>
+
+#include <cstring>
+
+using namespace apt;
+
+/*	Stream layout:
+	- Header: 'APTB', version (uint8), flags (uint8), 2 bytes padding.
+	- Root: a sequence of values, as the content of an object.
+	- Value (tagged): type (uint8), tag (uint32, only within an object), payload.
+	- Value (untagged): payload.
+	- Payload:
+		- Numeric types: the value.
+		- String: length (uint32), chars (no terminator).
+		- Binary: compressed (uint8), size (uint32), padding (aligned only), bytes.
+		- Object: size (uint32, tagged only), values.
+		- Array: length (uint32), size (uint32, tagged only), values.
+		- Packed array: scalar type (uint8, tagged only), length (uint32), padding (aligned only), values. Untagged
+		  packed arrays are therefore identical to untagged arrays, unless aligned.
+	Padding aligns the data to kAlignment relative to the start of the stream. The absolute address is only aligned if
+	the File buffer is: mapped views are page aligned, but malloc() only guarantees 8 byte alignment on Win32, hence
+	arrayView() checks the absolute address.
+	Apt only targets little-endian platforms, hence values are copied directly.
+*/
+static const char  kMagic[4]    = { 'A', 'P', 'T', 'B' };
+static const uint8 kVersion     = 1;
+static const uint  kHeaderSize  = 8;
+static const uint  kTagSize     = sizeof(uint8) + sizeof(uint32);
+
+static uint64 AlignUp(uint64 _offset)
+{
+	return (_offset + SerializerBinary::kAlignment - 1) & ~(uint64)(SerializerBinary::kAlignment - 1);
+}
+
+static uint32 Tag(StringHash::HashType _hash)
+{
+	return (uint32)(_hash ^ (_hash >> 32));
+}
+static uint32 Tag(const char* _name)
+{
+	return Tag(StringHash(_name).getHash());
+}
+
+// PUBLIC
+
+SerializerBinary::SerializerBinary(File& _file_, Mode _mode, Flags _flags)
+	: Serializer(_mode)
+	, m_file(&_file_)
+	, m_tagged((_flags & Flags_Tagged) != 0)
+	, m_aligned((_flags & Flags_Aligned) != 0)
+	, m_pos(0)
+	, m_type(0)
+	, m_valueEnd(0)
+{
+	APT_STATIC_ASSERT((int)Type_Float64 == (int)ScalarType_Float64 && (int)Type_String == (int)ScalarType_Count); // scalar types are interchangeable
+
+	Scope root = {};
+	if (_mode == Mode_Write) {
+		char header[kHeaderSize] = {};
+		memcpy(header, kMagic, sizeof(kMagic));
+		header[4] = (char)kVersion;
+		header[5] = (char)_flags;
+		m_file->setData(header, kHeaderSize);
+
+	} else {
+		const char* header = m_file->getData();
+		if (m_file->getDataSize() < kHeaderSize || memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+			setError("SerializerBinary; '%s' invalid header", m_file->getPath());
+		} else if ((uint8)header[4] != kVersion) {
+			setError("SerializerBinary; '%s' unsupported version %u (expected %u)", m_file->getPath(), (uint)(uint8)header[4], (uint)kVersion);
+		} else {
+			m_tagged = ((uint8)header[5] & Flags_Tagged) != 0;
+			m_aligned = ((uint8)header[5] & Flags_Aligned) != 0;
+			m_pos = kHeaderSize;
+			root.m_begin = kHeaderSize;
+			root.m_end = m_file->getDataSize();
+		}
+	}
+	m_scopes.push_back(root);
+}
+
+bool SerializerBinary::beginObject(const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, "object")) {
+			return false;
+		}
+		Scope scope = {};
+		if (m_tagged) {
+			if (m_type != Type_Object) {
+				setError("Error serializing object; '%s' not an object", _name ? _name : "");
+				m_pos = m_valueEnd;
+				return false;
+			}
+			uint32 size;
+			read(size);
+			scope.m_end = m_pos + size;
+		}
+		scope.m_begin = m_pos;
+		m_scopes.push_back(scope);
+
+	} else {
+		if (!begin(Type_Object, _name, "object")) {
+			return false;
+		}
+		Scope scope = {};
+		scope.m_begin = m_file->getDataSize();
+		m_scopes.push_back(scope);
+		if (m_tagged) {
+			write((uint32)0); // size, see endObject()
+		}
+	}
+	return true;
+}
+
+void SerializerBinary::endObject()
+{
+	APT_ASSERT(m_scopes.size() > 1 && !inArray());
+	const Scope& scope = m_scopes.back();
+	if (m_tagged) {
+		if (getMode() == Mode_Read) {
+			m_pos = scope.m_end;
+		} else {
+			uint32 size = (uint32)(m_file->getDataSize() - scope.m_begin - sizeof(uint32));
+			memcpy(m_file->getData() + scope.m_begin, &size, sizeof(uint32));
+		}
+	}
+	m_scopes.pop_back();
+}
+
+bool SerializerBinary::beginArray(uint& _length_, const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, "array")) {
+			return false;
+		}
+		return enterArray(_length_, _name);
+
+	} else {
+		if (!begin(Type_Array, _name, "array")) {
+			return false;
+		}
+		Scope scope = {};
+		scope.m_begin = m_file->getDataSize();
+		scope.m_isArray = true;
+		m_scopes.push_back(scope);
+		write((uint32)0); // length, see endArray()
+		if (m_tagged) {
+			write((uint32)0); // size
+		}
+	}
+	return true;
+}
+
+void SerializerBinary::endArray()
+{
+	APT_ASSERT(m_scopes.size() > 1 && inArray());
+	const Scope& scope = m_scopes.back();
+	if (getMode() == Mode_Read) {
+		if (m_tagged) {
+			m_pos = scope.m_end;
+		}
+	} else {
+		char* dst = m_file->getData() + scope.m_begin;
+		uint32 length = scope.m_index;
+		memcpy(dst, &length, sizeof(uint32));
+		if (m_tagged) {
+			uint32 size = (uint32)(m_file->getDataSize() - scope.m_begin - sizeof(uint32) * 2);
+			memcpy(dst + sizeof(uint32), &size, sizeof(uint32));
+		}
+	}
+	m_scopes.pop_back();
+}
+
+template <typename tType>
+bool SerializerBinary::valueImpl(tType& _value_, const char* _name, Type _type)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, ValueTypeToStr<tType>())) {
+			return false;
+		}
+		return readValue(_value_, _type, _name);
+
+	} else {
+		if (!begin(_type, _name, ValueTypeToStr<tType>())) {
+			return false;
+		}
+		write(_value_);
+		return true;
+	}
+}
+
+template <typename tType>
+bool SerializerBinary::readValue(tType& value_, Type _type, const char* _name)
+{
+	if (!m_tagged || m_type == _type) {
+		return read(value_);
+	}
+ // convert from the stored type
+	#define CASE_TYPE(_enum, _ctype) \
+		case _enum: { _ctype v; if (!read(v)) return false; value_ = (tType)v; return true; }
+	switch (m_type) {
+		CASE_TYPE(Type_Bool,    bool)
+		CASE_TYPE(Type_Sint8,   sint8)
+		CASE_TYPE(Type_Uint8,   uint8)
+		CASE_TYPE(Type_Sint16,  sint16)
+		CASE_TYPE(Type_Uint16,  uint16)
+		CASE_TYPE(Type_Sint32,  sint32)
+		CASE_TYPE(Type_Uint32,  uint32)
+		CASE_TYPE(Type_Sint64,  sint64)
+		CASE_TYPE(Type_Uint64,  uint64)
+		CASE_TYPE(Type_Float32, float32)
+		CASE_TYPE(Type_Float64, float64)
+		default:
+			break;
+	};
+	#undef CASE_TYPE
+	setError("Error serializing %s; '%s' not a number", ValueTypeToStr<tType>(), _name ? _name : "");
+	m_pos = m_valueEnd;
+	return false;
+}
+
+bool SerializerBinary::value(bool&    _value_, const char* _name) { return valueImpl(_value_, _name, Type_Bool);    }
+bool SerializerBinary::value(sint8&   _value_, const char* _name) { return valueImpl(_value_, _name, Type_Sint8);   }
+bool SerializerBinary::value(uint8&   _value_, const char* _name) { return valueImpl(_value_, _name, Type_Uint8);   }
+bool SerializerBinary::value(sint16&  _value_, const char* _name) { return valueImpl(_value_, _name, Type_Sint16);  }
+bool SerializerBinary::value(uint16&  _value_, const char* _name) { return valueImpl(_value_, _name, Type_Uint16);  }
+bool SerializerBinary::value(sint32&  _value_, const char* _name) { return valueImpl(_value_, _name, Type_Sint32);  }
+bool SerializerBinary::value(uint32&  _value_, const char* _name) { return valueImpl(_value_, _name, Type_Uint32);  }
+bool SerializerBinary::value(sint64&  _value_, const char* _name) { return valueImpl(_value_, _name, Type_Sint64);  }
+bool SerializerBinary::value(uint64&  _value_, const char* _name) { return valueImpl(_value_, _name, Type_Uint64);  }
+bool SerializerBinary::value(float32& _value_, const char* _name) { return valueImpl(_value_, _name, Type_Float32); }
+bool SerializerBinary::value(float64& _value_, const char* _name) { return valueImpl(_value_, _name, Type_Float64); }
+
+bool SerializerBinary::value(StringBase& _value_, const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, "StringBase")) {
+			return false;
+		}
+		if (m_tagged && m_type != Type_String) {
+			setError("Error serializing StringBase; '%s' not a string", _name ? _name : "");
+			m_pos = m_valueEnd;
+			return false;
+		}
+		uint32 length;
+		if (!read(length)) {
+			return false;
+		}
+		if (m_pos + length > m_file->getDataSize()) {
+			setError("Error serializing StringBase '%s'; unexpected end of data", _name ? _name : "");
+			return false;
+		}
+		if (length == 0) {
+			_value_.clear();
+		} else {
+			_value_.set(m_file->getData() + m_pos, length);
+		}
+		m_pos += length;
+
+	} else {
+		if (!begin(Type_String, _name, "StringBase")) {
+			return false;
+		}
+		uint32 length = (uint32)_value_.getLength();
+		write(length);
+		write((const char*)_value_, length);
+	}
+	return true;
+}
+
+bool SerializerBinary::binary(void*& _data_, uint& _sizeBytes_, const char* _name, CompressionFlags _compressionFlags)
+{
+	if (getMode() == Mode_Write) {
+		APT_ASSERT(_data_);
+		if (!begin(Type_Binary, _name, "binary")) {
+			return false;
+		}
+		void* data = _data_;
+		uint sizeBytes = _sizeBytes_;
+		if (_compressionFlags != CompressionFlags_None) {
+			data = nullptr;
+			Compress(_data_, _sizeBytes_, data, sizeBytes, _compressionFlags);
+		}
+		write((uint8)(_compressionFlags == CompressionFlags_None ? 0 : 1));
+		write((uint32)sizeBytes);
+		writeAlign();
+		write(data, sizeBytes);
+		if (_compressionFlags != CompressionFlags_None) {
+			free(data);
+		}
+
+	} else {
+		if (!find(_name, "binary")) {
+			return false;
+		}
+		if (m_tagged && m_type != Type_Binary) {
+			setError("Error serializing binary; '%s' not binary", _name ? _name : "");
+			m_pos = m_valueEnd;
+			return false;
+		}
+		uint8 compressed;
+		uint32 sizeBytes;
+		if (!read(compressed) || !read(sizeBytes)) {
+			return false;
+		}
+		readAlign();
+		if (m_pos + sizeBytes > m_file->getDataSize()) {
+			setError("Error serializing binary '%s'; unexpected end of data", _name ? _name : "");
+			return false;
+		}
+		const char* src = m_file->getData() + m_pos;
+		m_pos += sizeBytes;
+
+		if (compressed && _data_) {
+		 // decompress directly to _data_
+			uint retSizeBytes = DecompressTo(src, sizeBytes, _data_, _sizeBytes_);
+			if (retSizeBytes != _sizeBytes_) {
+				setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "binary", (uint64)_sizeBytes_, (uint64)(retSizeBytes ? retSizeBytes : GetDecompressedSize(src, sizeBytes)));
+				return false;
+			}
+			return true;
+		}
+
+		char* ret = nullptr;
+		uint retSizeBytes = sizeBytes;
+		if (compressed) {
+			Decompress(src, sizeBytes, (void*&)ret, retSizeBytes); // Decompress allocates the final buffer
+			if (!ret) {
+				setError("Error serializing %s, decompression failed", _name ? _name : "binary");
+				return false;
+			}
+			src = ret;
+		}
+		if (_data_) {
+			if (retSizeBytes != _sizeBytes_) {
+				setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "binary", (uint64)_sizeBytes_, (uint64)retSizeBytes);
+				free(ret);
+				return false;
+			}
+			memcpy(_data_, src, retSizeBytes);
+			free(ret);
+		} else if (ret) {
+			_data_ = ret;
+			_sizeBytes_ = retSizeBytes;
+		} else {
+			_data_ = APT_MALLOC(retSizeBytes);
+			_sizeBytes_ = retSizeBytes;
+			memcpy(_data_, src, retSizeBytes);
+		}
+	}
+	return true;
+}
+
+bool SerializerBinary::binaryView(const void*& data_, uint& sizeBytes_, const char* _name)
+{
+	APT_ASSERT(getMode() == Mode_Read);
+	if (!find(_name, "binary")) {
+		return false;
+	}
+	if (m_tagged && m_type != Type_Binary) {
+		setError("Error serializing binary; '%s' not binary", _name ? _name : "");
+		m_pos = m_valueEnd;
+		return false;
+	}
+	uint8 compressed;
+	uint32 sizeBytes;
+	if (!read(compressed) || !read(sizeBytes)) {
+		return false;
+	}
+	readAlign();
+	if (m_pos + sizeBytes > m_file->getDataSize()) {
+		setError("Error serializing binary '%s'; unexpected end of data", _name ? _name : "");
+		return false;
+	}
+	const char* data = m_file->getData() + m_pos;
+	m_pos += sizeBytes;
+	if (compressed) {
+		setError("Error serializing binary '%s'; data is compressed, use binary()", _name ? _name : "");
+		return false;
+	}
+	data_ = data;
+	sizeBytes_ = sizeBytes;
+	return true;
+}
+
+bool SerializerBinary::valueFields(void* _object_, const ReflectTable& _table)
+{
+	APT_ASSERT(!inArray());
+	const bool writing = getMode() == Mode_Write;
+	bool ret = true;
+	for (uint i = 0; i < _table.m_fieldCount; ++i) {
+		const ReflectField& field = _table.m_fields[i];
+		char* data = (char*)_object_ + field.m_offset;
+		if (field.m_type == ScalarType_Count) {
+			ret &= field.m_serialize(*this, data, field.m_name);
+			continue;
+		}
+
+		if (!m_tagged) {
+			if (field.m_count > 0) {
+				if (writing) {
+					writeArray(data, field.m_count, field.m_type);
+				} else {
+					ret &= readArray(data, field.m_count, field.m_type, field.m_name);
+				}
+				continue;
+			}
+		 // scalars are stored without padding, copy runs of fields which are also contiguous in memory at once
+			uint64 sizeBytes = field.m_size;
+			for (; i + 1 < _table.m_fieldCount; ++i) {
+				const ReflectField& next = _table.m_fields[i + 1];
+				if (next.m_type == ScalarType_Count || next.m_count > 0 || next.m_offset != field.m_offset + sizeBytes) {
+					break;
+				}
+				sizeBytes += next.m_size;
+			}
+			if (writing) {
+				write(data, sizeBytes);
+			} else {
+				ret &= read(data, sizeBytes);
+			}
+			continue;
+		}
+
+	 // tagged, use the precomputed name hash
+		const uint32 tag = Tag(field.m_nameHash.getHash());
+		if (writing) {
+			++m_scopes.back().m_index;
+			if (field.m_count > 0) {
+				write((uint8)Type_PackedArray);
+				write(tag);
+				writeArray(data, field.m_count, field.m_type);
+			} else {
+				write((uint8)field.m_type);
+				write(tag);
+				write(data, field.m_size);
+			}
+		} else {
+			if (!findTag(tag, field.m_name, field.m_count > 0 ? "array" : ScalarTypeToStr(field.m_type))) {
+				ret = false;
+				continue;
+			}
+			ret &= field.m_count > 0 ? readArray(data, field.m_count, field.m_type, field.m_name) : readScalar(data, field.m_type, field.m_name);
+		}
+	}
+	return ret;
+}
+
+// PRIVATE
+
+bool SerializerBinary::readScalar(void* value_, ScalarType _type, const char* _name)
+{
+	switch (_type) {
+		case ScalarType_Bool:    return readValue(*(bool*)   value_, Type_Bool,    _name);
+		case ScalarType_Sint8:   return readValue(*(sint8*)  value_, Type_Sint8,   _name);
+		case ScalarType_Uint8:   return readValue(*(uint8*)  value_, Type_Uint8,   _name);
+		case ScalarType_Sint16:  return readValue(*(sint16*) value_, Type_Sint16,  _name);
+		case ScalarType_Uint16:  return readValue(*(uint16*) value_, Type_Uint16,  _name);
+		case ScalarType_Sint32:  return readValue(*(sint32*) value_, Type_Sint32,  _name);
+		case ScalarType_Uint32:  return readValue(*(uint32*) value_, Type_Uint32,  _name);
+		case ScalarType_Sint64:  return readValue(*(sint64*) value_, Type_Sint64,  _name);
+		case ScalarType_Uint64:  return readValue(*(uint64*) value_, Type_Uint64,  _name);
+		case ScalarType_Float32: return readValue(*(float32*)value_, Type_Float32, _name);
+		case ScalarType_Float64: return readValue(*(float64*)value_, Type_Float64, _name);
+		default: APT_ASSERT(false); return false;
+	};
+}
+
+bool SerializerBinary::begin(Type _type, const char* _name, const char* _typeStr)
+{
+	Scope& scope = m_scopes.back();
+	if (!_name && !scope.m_isArray) {
+		setError("Error serializing %s; name must be specified if not in an array", _typeStr);
+		return false;
+	}
+	++scope.m_index;
+	if (m_tagged) {
+		write((uint8)_type);
+		if (!scope.m_isArray) {
+			write(Tag(_name));
+		}
+	}
+	return true;
+}
+
+void SerializerBinary::write(const void* _data, uint64 _sizeBytes)
+{
+	m_file->appendData((const char*)_data, _sizeBytes);
+}
+
+void SerializerBinary::writeAlign()
+{
+	if (m_aligned) {
+		static const char kPadding[kAlignment] = {};
+		uint64 size = m_file->getDataSize();
+		write(kPadding, AlignUp(size) - size);
+	}
+}
+
+bool SerializerBinary::find(const char* _name, const char* _typeStr)
+{
+	Scope& scope = m_scopes.back();
+	if (scope.m_isArray) {
+		if (scope.m_index >= scope.m_length) {
+			return false;
+		}
+		++scope.m_index;
+		if (scope.m_isPacked) {
+			m_type = scope.m_packedType;
+			m_valueEnd = m_pos + ScalarTypeSize((ScalarType)m_type);
+		} else if (m_tagged) {
+			uint64 size;
+			if (!read(m_type) || !payloadSize(m_type, m_pos, size)) {
+				return false;
+			}
+			m_valueEnd = m_pos + size;
+		}
+		return true;
+	}
+
+	if (!_name) {
+		setError("Error serializing %s; name must be specified if not in an array", _typeStr);
+		return false;
+	}
+	if (!m_tagged) {
+		return true;
+	}
+	return findTag(Tag(_name), _name, _typeStr);
+}
+
+bool SerializerBinary::findTag(uint32 _tag, const char* _name, const char* _typeStr)
+{
+	const Scope& scope = m_scopes.back();
+	const char* data = m_file->getData();
+
+ // search from the current position (values are usually read in the order they were written), wrap around to the
+ // start of the object
+	uint64 pos = m_pos;
+	bool wrapped = false;
+	for (;;) {
+		if (pos >= scope.m_end) {
+			if (wrapped) {
+				break;
+			}
+			pos = scope.m_begin;
+			wrapped = true;
+		}
+		if (wrapped && pos >= m_pos) {
+			break;
+		}
+		if (pos + kTagSize > scope.m_end) {
+			setError("Error serializing %s '%s'; unexpected end of data", _typeStr, _name);
+			return false;
+		}
+		uint8 type = (uint8)data[pos];
+		uint32 valueTag;
+		memcpy(&valueTag, data + pos + 1, sizeof(uint32));
+		uint64 size;
+		if (!payloadSize(type, pos + kTagSize, size)) {
+			return false;
+		}
+		if (valueTag == _tag) {
+			m_type = type;
+			m_pos = pos + kTagSize;
+			m_valueEnd = m_pos + size;
+			return true;
+		}
+		pos += kTagSize + size;
+	}
+	setError("Error serializing %s; '%s' not found", _typeStr, _name);
+	return false;
+}
+
+bool SerializerBinary::enterArray(uint& _length_, const char* _name)
+{
+	Scope scope = {};
+	scope.m_isArray = true;
+	if (m_tagged) {
+		if (m_type == Type_PackedArray) {
+			scope.m_isPacked = true;
+			read(scope.m_packedType);
+		} else if (m_type != Type_Array) {
+			setError("Error serializing array; '%s' not an array", _name ? _name : "");
+			m_pos = m_valueEnd;
+			return false;
+		}
+	}
+	uint32 length;
+	if (!read(length)) {
+		return false;
+	}
+	if (scope.m_isPacked) {
+		readAlign();
+	}
+	if (m_tagged) {
+		if (!scope.m_isPacked) {
+			uint32 size;
+			read(size);
+		}
+		scope.m_end = m_valueEnd;
+	}
+	scope.m_begin = m_pos;
+	scope.m_length = length;
+	m_scopes.push_back(scope);
+	_length_ = length;
+	return true;
+}
+
+bool SerializerBinary::payloadSize(uint8 _type, uint64 _offset, uint64& size_)
+{
+	const uint64 dataSize = m_file->getDataSize();
+	uint64 prefixSize = 0;   // size of the prefix containing the variable size
+	uint64 sizeOffset = 0;   // offset of the variable size within the prefix
+	bool   padded     = false;
+	switch (_type) {
+		case Type_String:
+		case Type_Object: prefixSize = sizeof(uint32);     sizeOffset = 0;              break;
+		case Type_Binary: prefixSize = 1 + sizeof(uint32); sizeOffset = 1; padded = true; break;
+		case Type_Array:  prefixSize = sizeof(uint32) * 2; sizeOffset = sizeof(uint32); break;
+		case Type_PackedArray: {
+			const uint64 packedPrefixSize = 1 + sizeof(uint32);
+			uint8 scalarType = ScalarType_Count;
+			uint32 length = 0;
+			if (_offset + packedPrefixSize <= dataSize) {
+				scalarType = (uint8)m_file->getData()[_offset];
+				memcpy(&length, m_file->getData() + _offset + 1, sizeof(uint32));
+			}
+			if (scalarType >= ScalarType_Count) {
+				setError("Error serializing; invalid packed array at offset %llu", _offset);
+				return false;
+			}
+			size_ = packedPrefixSize + (uint64)length * ScalarTypeSize((ScalarType)scalarType);
+			if (m_aligned) {
+				size_ += AlignUp(_offset + packedPrefixSize) - (_offset + packedPrefixSize);
+			}
+			break;
+		}
+		default:
+			if (_type >= ScalarType_Count) {
+				setError("Error serializing; invalid type %u at offset %llu", (uint)_type, _offset);
+				return false;
+			}
+			size_ = ScalarTypeSize((ScalarType)_type);
+			break;
+	};
+	if (prefixSize > 0) {
+		uint32 n = 0;
+		if (_offset + prefixSize <= dataSize) {
+			memcpy(&n, m_file->getData() + _offset + sizeOffset, sizeof(uint32));
+		}
+		size_ = prefixSize + n;
+		if (padded && m_aligned) {
+			size_ += AlignUp(_offset + prefixSize) - (_offset + prefixSize);
+		}
+	}
+	if (_offset + size_ > dataSize) {
+		setError("Error serializing; unexpected end of data at offset %llu", _offset);
+		return false;
+	}
+	return true;
+}
+
+bool SerializerBinary::read(void* data_, uint64 _sizeBytes)
+{
+	if (m_pos + _sizeBytes > m_file->getDataSize()) {
+		setError("Error serializing; unexpected end of data at offset %llu", m_pos);
+		return false;
+	}
+	memcpy(data_, m_file->getData() + m_pos, _sizeBytes);
+	m_pos += _sizeBytes;
+	return true;
+}
+
+void SerializerBinary::readAlign()
+{
+	if (m_aligned) {
+		m_pos = AlignUp(m_pos);
+	}
+}
+
+template <typename tDst, typename tSrc>
+static void ConvertArray(tDst* dst_, const char* _src, uint _count)
+{
+	for (uint i = 0; i < _count; ++i) {
+		tSrc v;
+		memcpy(&v, _src + i * sizeof(tSrc), sizeof(tSrc));
+		dst_[i] = (tDst)v;
+	}
+}
+template <typename tDst>
+static void ConvertArray(tDst* dst_, const char* _src, uint8 _srcType, uint _count)
+{
+	switch (_srcType) {
+		case Serializer::ScalarType_Bool:    ConvertArray<tDst, bool>   (dst_, _src, _count); break;
+		case Serializer::ScalarType_Sint8:   ConvertArray<tDst, sint8>  (dst_, _src, _count); break;
+		case Serializer::ScalarType_Uint8:   ConvertArray<tDst, uint8>  (dst_, _src, _count); break;
+		case Serializer::ScalarType_Sint16:  ConvertArray<tDst, sint16> (dst_, _src, _count); break;
+		case Serializer::ScalarType_Uint16:  ConvertArray<tDst, uint16> (dst_, _src, _count); break;
+		case Serializer::ScalarType_Sint32:  ConvertArray<tDst, sint32> (dst_, _src, _count); break;
+		case Serializer::ScalarType_Uint32:  ConvertArray<tDst, uint32> (dst_, _src, _count); break;
+		case Serializer::ScalarType_Sint64:  ConvertArray<tDst, sint64> (dst_, _src, _count); break;
+		case Serializer::ScalarType_Uint64:  ConvertArray<tDst, uint64> (dst_, _src, _count); break;
+		case Serializer::ScalarType_Float32: ConvertArray<tDst, float32>(dst_, _src, _count); break;
+		case Serializer::ScalarType_Float64: ConvertArray<tDst, float64>(dst_, _src, _count); break;
+		default: APT_ASSERT(false); break;
+	};
+}
+
+bool SerializerBinary::valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name)
+{
+	if (getMode() == Mode_Write) {
+	 // untagged packed arrays are identical to untagged arrays (unless aligned)
+		if (!begin(m_tagged ? Type_PackedArray : Type_Array, _name, "array")) {
+			return false;
+		}
+		writeArray(_data_, _count, _type);
+		return true;
+	}
+
+	if (!find(_name, "array")) {
+		return false;
+	}
+	return readArray(_data_, _count, _type, _name);
+}
+
+void SerializerBinary::writeArray(const void* _data, uint _count, ScalarType _type)
+{
+	if (m_tagged) {
+		write((uint8)_type);
+	}
+	write((uint32)_count);
+	writeAlign();
+	write(_data, (uint64)_count * ScalarTypeSize(_type));
+}
+
+bool SerializerBinary::readArray(void* data_, uint _count, ScalarType _type, const char* _name)
+{
+	if (m_tagged && m_type != Type_PackedArray) {
+	 // not packed (written element-wise) or not an array (enterArray() sets the error)
+		uint length = 0;
+		if (!enterArray(length, _name)) {
+			return false;
+		}
+		bool ret = length == _count;
+		if (ret) {
+			ret = valueArrayElements(data_, _count, _type);
+		} else {
+			setError("Error serializing %s array '%s': array length was %u, expected %u", ScalarTypeToStr(_type), _name ? _name : "", length, _count);
+		}
+		endArray();
+		return ret;
+	}
+
+	uint8 srcType = (uint8)_type;
+	uint32 length;
+	if ((m_tagged && !read(srcType)) || !read(length)) {
+		return false;
+	}
+	readAlign();
+	if (length != _count) {
+		setError("Error serializing %s array '%s': array length was %u, expected %u", ScalarTypeToStr(_type), _name ? _name : "", (uint)length, _count);
+		if (m_tagged) {
+			m_pos = m_valueEnd;
+		}
+		return false;
+	}
+	const uint64 sizeBytes = (uint64)_count * ScalarTypeSize(_type);
+	const char* src = m_file->getData() + m_pos;
+	if (srcType == (uint8)_type) {
+		if (m_pos + sizeBytes > m_file->getDataSize()) {
+			setError("Error serializing %s array '%s'; unexpected end of data", ScalarTypeToStr(_type), _name ? _name : "");
+			return false;
+		}
+		memcpy(data_, src, sizeBytes);
+		m_pos += sizeBytes;
+		return true;
+	}
+
+ // convert from the stored type (tagged only, the payload size was validated by find())
+	switch (_type) {
+		case ScalarType_Bool:    ConvertArray((bool*)   data_, src, srcType, _count); break;
+		case ScalarType_Sint8:   ConvertArray((sint8*)  data_, src, srcType, _count); break;
+		case ScalarType_Uint8:   ConvertArray((uint8*)  data_, src, srcType, _count); break;
+		case ScalarType_Sint16:  ConvertArray((sint16*) data_, src, srcType, _count); break;
+		case ScalarType_Uint16:  ConvertArray((uint16*) data_, src, srcType, _count); break;
+		case ScalarType_Sint32:  ConvertArray((sint32*) data_, src, srcType, _count); break;
+		case ScalarType_Uint32:  ConvertArray((uint32*) data_, src, srcType, _count); break;
+		case ScalarType_Sint64:  ConvertArray((sint64*) data_, src, srcType, _count); break;
+		case ScalarType_Uint64:  ConvertArray((uint64*) data_, src, srcType, _count); break;
+		case ScalarType_Float32: ConvertArray((float32*)data_, src, srcType, _count); break;
+		case ScalarType_Float64: ConvertArray((float64*)data_, src, srcType, _count); break;
+		default: APT_ASSERT(false); break;
+	};
+	m_pos = m_valueEnd;
+	return true;
+}
+
+bool SerializerBinary::arrayView(const void*& data_, uint& count_, ScalarType _type, uint _componentCount, const char* _name)
+{
+	APT_ASSERT(getMode() == Mode_Read);
+	if (!find(_name, "array")) {
+		return false;
+	}
+	if (m_tagged && m_type != Type_PackedArray) {
+		setError("Error serializing %s array; '%s' not a packed array", ScalarTypeToStr(_type), _name ? _name : "");
+		m_pos = m_valueEnd;
+		return false;
+	}
+	uint8 srcType = (uint8)_type;
+	uint32 length;
+	if ((m_tagged && !read(srcType)) || !read(length)) {
+		return false;
+	}
+	readAlign();
+	const uint64 sizeBytes = (uint64)length * ScalarTypeSize((ScalarType)srcType); // srcType was validated by find()
+	if (m_pos + sizeBytes > m_file->getDataSize()) {
+		setError("Error serializing %s array '%s'; unexpected end of data", ScalarTypeToStr(_type), _name ? _name : "");
+		return false;
+	}
+	const char* data = m_file->getData() + m_pos;
+	m_pos += sizeBytes;
+	if (srcType != (uint8)_type) {
+		setError("Error serializing %s array '%s'; stored as %s", ScalarTypeToStr(_type), _name ? _name : "", ScalarTypeToStr((ScalarType)srcType));
+		return false;
+	}
+	if (length % _componentCount != 0) {
+		setError("Error serializing %s array '%s'; length %u isn't a multiple of %u", ScalarTypeToStr(_type), _name ? _name : "", (uint)length, _componentCount);
+		return false;
+	}
+	if ((uintptr_t)data % ScalarTypeSize(_type) != 0) {
+		setError("Error serializing %s array '%s'; data isn't aligned (write with Flags_Aligned)", ScalarTypeToStr(_type), _name ? _name : "");
+		return false;
+	}
+	if (m_aligned && (uintptr_t)data % kAlignment != 0) {
+		setError("Error serializing %s array '%s'; data isn't aligned to %u bytes (the File buffer isn't aligned, use File::Map())", ScalarTypeToStr(_type), _name ? _name : "", kAlignment);
+		return false;
+	}
+	data_ = data;
+	count_ = length / _componentCount;
+	return true;
+}
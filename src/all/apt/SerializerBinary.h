@@ -0,0 +1,189 @@
+#pragma once
+
+#include <apt/apt.h>
+#include <apt/Serializer.h>
+
+#include <EASTL/vector.h>
+
+namespace apt {
+
+class File;
+
+////////////////////////////////////////////////////////////////////////////////
+// SerializerBinary
+// Compact little-endian binary stream written to/read from a File's buffer.
+//
+// Tagged streams (the default) prefix each value with its type and, within an
+// object, a hash of its name. Reads look up values by name hence tolerate
+// reordering and missing fields (as SerializerJson). Objects and arrays store
+// their size, hence unknown values are skipped cheaply. Numeric values are
+// converted if the stored type differs from the requested type.
+//
+// Untagged streams store only the values (plus array lengths and string/binary
+// sizes). They are smaller and faster, but reads must exactly match the
+// sequence of writes; names are ignored.
+//
+// Aligned streams pad binary data and packed arrays (see valueArray()) to 
+// kAlignment bytes, hence binaryView() and valueArrayView() can return pointers
+// directly into the data (e.g. a File::Map() view) without copying. Untagged
+// aligned streams must read arrays written via valueArray() with valueArray()
+// or valueArrayView().
+//
+// Alignment is relative to the start of the data. valueArrayView() fails if the
+// absolute address isn't aligned, e.g. a buffer from malloc() (which on Win32 is
+// only 8 byte aligned); mapped files are always aligned.
+////////////////////////////////////////////////////////////////////////////////
+class SerializerBinary: public Serializer
+{
+public:
+	enum Flags_
+	{
+		Flags_Tagged  = 1 << 0, // prefix values with a type and name hash
+		Flags_Aligned = 1 << 1, // align binary data and packed arrays to kAlignment
+
+		Flags_Default = Flags_Tagged
+	};
+	typedef uint32 Flags;
+
+	// Alignment of binary data and packed arrays relative to the start of the stream if Flags_Aligned.
+	static const uint kAlignment = 16;
+
+	// _file_ must remain valid for the lifetime of the serializer. In Mode_Write any existing data in _file_ is
+	// discarded. In Mode_Read _flags is ignored (the stream header determines the format). Changing the mode via
+	// setMode() isn't supported, construct a new SerializerBinary to read back the data.
+	SerializerBinary(File& _file_, Mode _mode, Flags _flags = Flags_Default);
+
+	bool isTagged() const  { return m_tagged; }
+	bool isAligned() const { return m_aligned; }
+
+	bool beginObject(const char* _name = nullptr) override;
+	void endObject() override;
+
+	bool beginArray(uint& _length_, const char* _name = nullptr) override;
+	void endArray() override;
+
+	bool value(bool&       _value_, const char* _name = nullptr) override;
+	bool value(sint8&      _value_, const char* _name = nullptr) override;
+	bool value(uint8&      _value_, const char* _name = nullptr) override;
+	bool value(sint16&     _value_, const char* _name = nullptr) override;
+	bool value(uint16&     _value_, const char* _name = nullptr) override;
+	bool value(sint32&     _value_, const char* _name = nullptr) override;
+	bool value(uint32&     _value_, const char* _name = nullptr) override;
+	bool value(sint64&     _value_, const char* _name = nullptr) override;
+	bool value(uint64&     _value_, const char* _name = nullptr) override;
+	bool value(float32&    _value_, const char* _name = nullptr) override;
+	bool value(float64&    _value_, const char* _name = nullptr) override;
+	bool value(StringBase& _value_, const char* _name = nullptr) override;
+
+	bool binary(void*& _data_, uint& _sizeBytes_, const char* _name = nullptr, CompressionFlags _compressionFlags = CompressionFlags_None) override;
+
+	// Use the precomputed name hashes. Untagged streams copy runs of scalar fields which are contiguous in memory at
+	// once; the data is identical to serializing each field individually.
+	bool valueFields(void* _object_, const ReflectTable& _table) override;
+
+	// Zero-copy variants of binary() and valueArray() (Mode_Read only). data_ points directly into the File's buffer
+	// and remains valid until the File is destroyed or its data is replaced; use with File::Map() to avoid reading the
+	// whole file into memory. Return false if the data is compressed, the stored type differs from the requested type
+	// or the data isn't aligned (the stream wasn't written with Flags_Aligned).
+	bool binaryView(const void*& data_, uint& sizeBytes_, const char* _name = nullptr);
+	bool valueArrayView(const bool*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Bool,    1,   _name); }
+	bool valueArrayView(const sint8*&   data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Sint8,   1,   _name); }
+	bool valueArrayView(const uint8*&   data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Uint8,   1,   _name); }
+	bool valueArrayView(const sint16*&  data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Sint16,  1,   _name); }
+	bool valueArrayView(const uint16*&  data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Uint16,  1,   _name); }
+	bool valueArrayView(const sint32*&  data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Sint32,  1,   _name); }
+	bool valueArrayView(const uint32*&  data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Uint32,  1,   _name); }
+	bool valueArrayView(const sint64*&  data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Sint64,  1,   _name); }
+	bool valueArrayView(const uint64*&  data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Uint64,  1,   _name); }
+	bool valueArrayView(const float32*& data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 1,   _name); }
+	bool valueArrayView(const float64*& data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float64, 1,   _name); }
+	bool valueArrayView(const vec2*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 2,   _name); }
+	bool valueArrayView(const vec3*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 3,   _name); }
+	bool valueArrayView(const vec4*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 4,   _name); }
+	bool valueArrayView(const mat2*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 2*2, _name); }
+	bool valueArrayView(const mat3*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 3*3, _name); }
+	bool valueArrayView(const mat4*&    data_, uint& count_, const char* _name = nullptr) { return arrayView((const void*&)data_, count_, ScalarType_Float32, 4*4, _name); }
+
+	enum Type
+	{
+		Type_Bool,
+		Type_Sint8,
+		Type_Uint8,
+		Type_Sint16,
+		Type_Uint16,
+		Type_Sint32,
+		Type_Uint32,
+		Type_Sint64,
+		Type_Uint64,
+		Type_Float32,
+		Type_Float64,
+		Type_String,
+		Type_Binary,
+		Type_Object,
+		Type_Array,
+		Type_PackedArray, // contiguous scalars of a single type, see valueArray()
+
+		Type_Count
+	};
+
+private:
+	struct Scope
+	{
+		uint64 m_begin;      // write: offset of the length/size fields, read: offset of the first value
+		uint64 m_end;        // read: offset of the end of the object/array (tagged streams only)
+		uint   m_length;     // array length, read only
+		uint   m_index;      // values written/read so far
+		bool   m_isArray;
+		bool   m_isPacked;   // read only
+		uint8  m_packedType; // scalar type if m_isPacked
+	};
+
+	File*                m_file;
+	bool                 m_tagged;
+	bool                 m_aligned;
+	uint64               m_pos;       // read offset
+	uint8                m_type;      // type of the last value found by find() (tagged streams only)
+	uint64               m_valueEnd;  // end of the last value found by find() (tagged streams only)
+	eastl::vector<Scope> m_scopes;
+
+	bool inArray() const { return m_scopes.back().m_isArray; }
+
+	// Write the type and name tag for a value (if tagged), increment the array index.
+	bool begin(Type _type, const char* _name, const char* _typeStr);
+	void write(const void* _data, uint64 _sizeBytes);
+	// Pad to kAlignment if m_aligned.
+	void writeAlign();
+	template <typename tType>
+	void write(tType _value) { write(&_value, sizeof(tType)); }
+
+	// Locate the next value in the current array or the named value in the current object, set m_pos to the start of
+	// its payload. Return false if not found or the end of the current array is reached.
+	bool find(const char* _name, const char* _typeStr);
+	// As find() for a tagged object, _tag is the folded hash of _name.
+	bool findTag(uint32 _tag, const char* _name, const char* _typeStr);
+	// Enter the array found by find(), which may be packed.
+	bool enterArray(uint& _length_, const char* _name);
+	// Return the size of the payload at _offset (excluding the type and tag).
+	bool payloadSize(uint8 _type, uint64 _offset, uint64& size_);
+	bool read(void* data_, uint64 _sizeBytes);
+	// Skip padding to kAlignment if m_aligned.
+	void readAlign();
+	template <typename tType>
+	bool read(tType& value_) { return read(&value_, sizeof(tType)); }
+
+	bool valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name) override;
+	// Write/read the payload of a packed array (after begin()/find()).
+	void writeArray(const void* _data, uint _count, ScalarType _type);
+	bool readArray(void* data_, uint _count, ScalarType _type, const char* _name);
+	bool arrayView(const void*& data_, uint& count_, ScalarType _type, uint _componentCount, const char* _name);
+
+	template <typename tType>
+	bool valueImpl(tType& _value_, const char* _name, Type _type);
+	// Read the scalar found by find(), convert if the stored type differs from _type.
+	template <typename tType>
+	bool readValue(tType& value_, Type _type, const char* _name);
+	bool readScalar(void* value_, ScalarType _type, const char* _name);
+
+}; // class SerializerBinary
+
+} // namespace apt
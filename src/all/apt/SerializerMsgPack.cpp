@@ -0,0 +1,803 @@
+#include <apt/SerializerMsgPack.h>
+
+#include <apt/log.h>
+#include <apt/memory.h>
+#include <apt/File.h>
+
+#include <cstring>
+#include <type_traits>
+
+using namespace apt;
+
+/*	MessagePack format (big-endian), see https://github.com/msgpack/msgpack/blob/master/spec.md:
+	- 0x00-0x7f positive fixint, 0xe0-0xff negative fixint.
+	- 0x80-0x8f fixmap, 0x90-0x9f fixarray, 0xa0-0xbf fixstr (count/length in the low bits).
+	- Other types are identified by the tags below, followed by a big-endian length/count (if any) then the payload.
+	Maps/arrays written by the serializer use map32/array32 so that the count can be patched in place.
+*/
+static const uint8 kNil       = 0xc0;
+static const uint8 kFalse     = 0xc2;
+static const uint8 kTrue      = 0xc3;
+static const uint8 kBin8      = 0xc4;
+static const uint8 kBin16     = 0xc5;
+static const uint8 kBin32     = 0xc6;
+static const uint8 kExt8      = 0xc7;
+static const uint8 kExt16     = 0xc8;
+static const uint8 kExt32     = 0xc9;
+static const uint8 kFloat32   = 0xca;
+static const uint8 kFloat64   = 0xcb;
+static const uint8 kUint8     = 0xcc;
+static const uint8 kUint16    = 0xcd;
+static const uint8 kUint32    = 0xce;
+static const uint8 kUint64    = 0xcf;
+static const uint8 kInt8      = 0xd0;
+static const uint8 kInt16     = 0xd1;
+static const uint8 kInt32     = 0xd2;
+static const uint8 kInt64     = 0xd3;
+static const uint8 kFixExt1   = 0xd4;
+static const uint8 kFixExt16  = 0xd8;
+static const uint8 kStr8      = 0xd9;
+static const uint8 kStr16     = 0xda;
+static const uint8 kStr32     = 0xdb;
+static const uint8 kArray16   = 0xdc;
+static const uint8 kArray32   = 0xdd;
+static const uint8 kMap16     = 0xde;
+static const uint8 kMap32     = 0xdf;
+static const uint8 kFixMap    = 0x80;
+static const uint8 kFixArray  = 0x90;
+static const uint8 kFixStr    = 0xa0;
+
+static void StoreBE(char* dst_, uint64 _value, uint _sizeBytes)
+{
+	for (uint i = 0; i < _sizeBytes; ++i) {
+		dst_[i] = (char)(_value >> ((_sizeBytes - 1 - i) * 8));
+	}
+}
+
+static uint64 LoadBE(const char* _src, uint _sizeBytes)
+{
+	uint64 ret = 0;
+	for (uint i = 0; i < _sizeBytes; ++i) {
+		ret = (ret << 8) | (uint8)_src[i];
+	}
+	return ret;
+}
+
+template <typename tType, typename tNumber>
+static tType NumberTo(const tNumber& _number)
+{
+	switch (_number.m_kind) {
+		case tNumber::Kind_Bool: return (tType)_number.m_bool;
+		case tNumber::Kind_Sint: return (tType)_number.m_sint;
+		case tNumber::Kind_Uint: return (tType)_number.m_uint;
+		default:                 return (tType)_number.m_float;
+	};
+}
+
+// PUBLIC
+
+SerializerMsgPack::SerializerMsgPack(File& _file_, Mode _mode)
+	: Serializer(_mode)
+	, m_file(&_file_)
+	, m_pos(0)
+	, m_valueBegin(0)
+{
+	if (_mode == Mode_Write) {
+		m_file->setData(nullptr, 0);
+		beginScope(kMap32, false);
+
+	} else {
+		if (!enterScope(false, nullptr)) {
+			setError("SerializerMsgPack; '%s' root isn't a map", m_file->getPath());
+			Scope root = {};
+			m_scopes.push_back(root);
+		}
+	}
+}
+
+bool SerializerMsgPack::beginObject(const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, "object")) {
+			return false;
+		}
+		return enterScope(false, _name);
+
+	} else {
+		if (!begin(_name, "object")) {
+			return false;
+		}
+		beginScope(kMap32, false);
+	}
+	return true;
+}
+
+void SerializerMsgPack::endObject()
+{
+	APT_ASSERT(m_scopes.size() > 1 && !m_scopes.back().m_isArray);
+	end();
+}
+
+bool SerializerMsgPack::beginArray(uint& _length_, const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, "array")) {
+			return false;
+		}
+		if (!enterScope(true, _name)) {
+			return false;
+		}
+		_length_ = m_scopes.back().m_length;
+
+	} else {
+		if (!begin(_name, "array")) {
+			return false;
+		}
+		beginScope(kArray32, true);
+	}
+	return true;
+}
+
+void SerializerMsgPack::endArray()
+{
+	APT_ASSERT(m_scopes.size() > 1 && m_scopes.back().m_isArray);
+	end();
+}
+
+template <typename tType>
+bool SerializerMsgPack::valueImpl(tType& _value_, const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, ValueTypeToStr<tType>())) {
+			return false;
+		}
+		Number n;
+		if (!readNumber(n, ValueTypeToStr<tType>(), _name)) {
+			return false;
+		}
+		_value_ = NumberTo<tType>(n);
+
+	} else {
+		if (!begin(_name, ValueTypeToStr<tType>())) {
+			return false;
+		}
+		writeScalar(_value_);
+	}
+	return true;
+}
+
+bool SerializerMsgPack::value(bool&    _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(sint8&   _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(uint8&   _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(sint16&  _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(uint16&  _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(sint32&  _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(uint32&  _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(sint64&  _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(uint64&  _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(float32& _value_, const char* _name) { return valueImpl(_value_, _name); }
+bool SerializerMsgPack::value(float64& _value_, const char* _name) { return valueImpl(_value_, _name); }
+
+bool SerializerMsgPack::value(StringBase& _value_, const char* _name)
+{
+	if (getMode() == Mode_Read) {
+		if (!find(_name, "StringBase")) {
+			return false;
+		}
+		const char* str;
+		uint32 length;
+		uint64 end;
+		if (!readString(m_pos, str, length, end)) {
+			setError("Error serializing StringBase; '%s' not a string", _name ? _name : "");
+			skipValue();
+			return false;
+		}
+		if (length == 0) {
+			_value_.clear();
+		} else {
+			_value_.set(str, length);
+		}
+		m_pos = end;
+
+	} else {
+		if (!begin(_name, "StringBase")) {
+			return false;
+		}
+		writeString((const char*)_value_, (uint)_value_.getLength());
+	}
+	return true;
+}
+
+bool SerializerMsgPack::binary(void*& _data_, uint& _sizeBytes_, const char* _name, CompressionFlags _compressionFlags)
+{
+	if (getMode() == Mode_Write) {
+		APT_ASSERT(_data_);
+		if (!begin(_name, "binary")) {
+			return false;
+		}
+		if (_compressionFlags != CompressionFlags_None) {
+			void* data = nullptr;
+			uint sizeBytes = 0;
+			Compress(_data_, _sizeBytes_, data, sizeBytes, _compressionFlags);
+			if (sizeBytes <= 0xff) {
+				write(kExt8, sizeBytes, 1);
+			} else if (sizeBytes <= 0xffff) {
+				write(kExt16, sizeBytes, 2);
+			} else {
+				write(kExt32, sizeBytes, 4);
+			}
+			sint8 extType = kExtCompressed;
+			write(&extType, 1);
+			write(data, sizeBytes);
+			free(data);
+		} else {
+			if (_sizeBytes_ <= 0xff) {
+				write(kBin8, _sizeBytes_, 1);
+			} else if (_sizeBytes_ <= 0xffff) {
+				write(kBin16, _sizeBytes_, 2);
+			} else {
+				write(kBin32, _sizeBytes_, 4);
+			}
+			write(_data_, _sizeBytes_);
+		}
+		return true;
+	}
+
+	if (!find(_name, "binary")) {
+		return false;
+	}
+	const char* data = m_file->getData();
+	const uint64 dataSize = m_file->getDataSize();
+	uint8 tag = m_pos < dataSize ? (uint8)data[m_pos] : kNil;
+	uint lengthSize = 0;
+	bool compressed = false;
+	switch (tag) {
+		case kBin8:  lengthSize = 1; break;
+		case kBin16: lengthSize = 2; break;
+		case kBin32: lengthSize = 4; break;
+		case kExt8:  lengthSize = 1; compressed = true; break;
+		case kExt16: lengthSize = 2; compressed = true; break;
+		case kExt32: lengthSize = 4; compressed = true; break;
+		default:     break;
+	};
+	const uint64 headerSize = 1 + lengthSize + (compressed ? 1 : 0);
+	if (lengthSize == 0 || m_pos + headerSize > dataSize || (compressed && (sint8)data[m_pos + 1 + lengthSize] != kExtCompressed)) {
+		setError("Error serializing binary; '%s' not binary", _name ? _name : "");
+		skipValue();
+		return false;
+	}
+	++m_pos;
+	uint64 sizeBytes = readBE(lengthSize);
+	m_pos += compressed ? 1 : 0;
+	if (m_pos + sizeBytes > dataSize) {
+		setError("Error serializing binary '%s'; unexpected end of data", _name ? _name : "");
+		return false;
+	}
+	const char* src = data + m_pos;
+	m_pos += sizeBytes;
+
+	if (compressed && _data_) {
+	 // decompress directly to _data_
+		uint retSizeBytes = DecompressTo(src, (uint)sizeBytes, _data_, _sizeBytes_);
+		if (retSizeBytes != _sizeBytes_) {
+			setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "binary", (uint64)_sizeBytes_, (uint64)(retSizeBytes ? retSizeBytes : GetDecompressedSize(src, (uint)sizeBytes)));
+			return false;
+		}
+		return true;
+	}
+
+	char* ret = nullptr;
+	uint retSizeBytes = (uint)sizeBytes;
+	if (compressed) {
+		Decompress(src, (uint)sizeBytes, (void*&)ret, retSizeBytes); // Decompress allocates the final buffer
+		if (!ret) {
+			setError("Error serializing %s, decompression failed", _name ? _name : "binary");
+			return false;
+		}
+		src = ret;
+	}
+	if (_data_) {
+		if (retSizeBytes != _sizeBytes_) {
+			setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "binary", (uint64)_sizeBytes_, (uint64)retSizeBytes);
+			free(ret);
+			return false;
+		}
+		memcpy(_data_, src, retSizeBytes);
+		free(ret);
+	} else if (ret) {
+		_data_ = ret;
+		_sizeBytes_ = retSizeBytes;
+	} else {
+		_data_ = APT_MALLOC(retSizeBytes);
+		_sizeBytes_ = retSizeBytes;
+		memcpy(_data_, src, retSizeBytes);
+	}
+	return true;
+}
+
+// PRIVATE
+
+bool SerializerMsgPack::begin(const char* _name, const char* _typeStr)
+{
+	Scope& scope = m_scopes.back();
+	if (!_name && !scope.m_isArray) {
+		setError("Error serializing %s; name must be specified if not in an array", _typeStr);
+		return false;
+	}
+	++scope.m_index;
+	StoreBE(m_file->getData() + scope.m_begin + 1, scope.m_index, sizeof(uint32)); // keep the count valid at all times
+	if (!scope.m_isArray) {
+		writeString(_name, (uint)strlen(_name));
+	}
+	return true;
+}
+
+void SerializerMsgPack::beginScope(uint8 _tag, bool _isArray)
+{
+	Scope scope = {};
+	scope.m_begin = m_file->getDataSize();
+	scope.m_isArray = _isArray;
+	m_scopes.push_back(scope);
+	write(_tag, 0, sizeof(uint32));
+}
+
+void SerializerMsgPack::end()
+{
+	const Scope& scope = m_scopes.back();
+	if (getMode() == Mode_Read) {
+		if (scope.m_end != 0) {
+			m_pos = scope.m_end;
+		} else {
+		 // skip the remaining entries
+			uint64 count = scope.m_length - scope.m_index;
+			uint64 end;
+			if (skip(m_pos, scope.m_isArray ? count : count * 2, end)) {
+				m_pos = end;
+			}
+		}
+	}
+	m_scopes.pop_back();
+}
+
+void SerializerMsgPack::write(const void* _data, uint64 _sizeBytes)
+{
+	m_file->appendData((const char*)_data, _sizeBytes);
+}
+
+void SerializerMsgPack::write(uint8 _tag, uint64 _value, uint _sizeBytes)
+{
+	char buf[1 + sizeof(uint64)];
+	buf[0] = (char)_tag;
+	StoreBE(buf + 1, _value, _sizeBytes);
+	write(buf, 1 + _sizeBytes);
+}
+
+void SerializerMsgPack::writeUint(uint64 _value)
+{
+	if (_value <= 0x7f) {
+		uint8 v = (uint8)_value;
+		write(&v, 1);
+	} else if (_value <= 0xff) {
+		write(kUint8, _value, 1);
+	} else if (_value <= 0xffff) {
+		write(kUint16, _value, 2);
+	} else if (_value <= 0xffffffff) {
+		write(kUint32, _value, 4);
+	} else {
+		write(kUint64, _value, 8);
+	}
+}
+
+void SerializerMsgPack::writeSint(sint64 _value)
+{
+	if (_value >= 0) {
+		writeUint((uint64)_value);
+	} else if (_value >= -32) {
+		uint8 v = (uint8)(sint8)_value; // negative fixint
+		write(&v, 1);
+	} else if (_value >= -0x80) {
+		write(kInt8, (uint64)_value, 1);
+	} else if (_value >= -0x8000) {
+		write(kInt16, (uint64)_value, 2);
+	} else if (_value >= -(sint64)0x80000000) {
+		write(kInt32, (uint64)_value, 4);
+	} else {
+		write(kInt64, (uint64)_value, 8);
+	}
+}
+
+template <typename tType>
+void SerializerMsgPack::writeScalar(tType _value)
+{
+	if (std::is_same<tType, bool>::value) {
+		uint8 v = _value ? kTrue : kFalse;
+		write(&v, 1);
+	} else if (std::is_same<tType, float32>::value) {
+		float32 f = (float32)_value;
+		uint32 bits;
+		memcpy(&bits, &f, sizeof(bits));
+		write(kFloat32, bits, sizeof(bits));
+	} else if (std::is_same<tType, float64>::value) {
+		float64 f = (float64)_value;
+		uint64 bits;
+		memcpy(&bits, &f, sizeof(bits));
+		write(kFloat64, bits, sizeof(bits));
+	} else if (std::is_signed<tType>::value) {
+		writeSint((sint64)_value);
+	} else {
+		writeUint((uint64)_value);
+	}
+}
+
+void SerializerMsgPack::writeString(const char* _str, uint _length)
+{
+	if (_length < 32) {
+		uint8 v = (uint8)(kFixStr | _length);
+		write(&v, 1);
+	} else if (_length <= 0xff) {
+		write(kStr8, _length, 1);
+	} else if (_length <= 0xffff) {
+		write(kStr16, _length, 2);
+	} else {
+		write(kStr32, _length, 4);
+	}
+	write(_str, _length);
+}
+
+void SerializerMsgPack::writeArrayHeader(uint _length)
+{
+	if (_length < 16) {
+		uint8 v = (uint8)(kFixArray | _length);
+		write(&v, 1);
+	} else if (_length <= 0xffff) {
+		write(kArray16, _length, 2);
+	} else {
+		write(kArray32, _length, 4);
+	}
+}
+
+bool SerializerMsgPack::find(const char* _name, const char* _typeStr)
+{
+	Scope& scope = m_scopes.back();
+	if (scope.m_isArray) {
+		if (scope.m_index >= scope.m_length) {
+			return false;
+		}
+		++scope.m_index;
+		m_valueBegin = m_pos;
+		return true;
+	}
+
+	if (!_name) {
+		setError("Error serializing %s; name must be specified if not in an array", _typeStr);
+		return false;
+	}
+
+ // search from the current entry (values are usually read in the order they were written), wrap around to the first
+ // entry, visit each entry at most once
+	const uint nameLength = (uint)strlen(_name);
+	uint64 pos = m_pos;
+	uint index = scope.m_index;
+	for (uint i = 0; i < scope.m_length; ++i) {
+		if (index == scope.m_length) {
+			scope.m_end = pos;
+			pos = scope.m_begin;
+			index = 0;
+		}
+		const char* key;
+		uint32 keyLength;
+		uint64 keyEnd;
+		if (!readString(pos, key, keyLength, keyEnd)) {
+			setError("Error serializing %s '%s'; invalid key at offset %llu", _typeStr, _name, pos);
+			return false;
+		}
+		if (keyLength == nameLength && memcmp(key, _name, nameLength) == 0) {
+			m_pos = m_valueBegin = keyEnd;
+			scope.m_index = index + 1;
+			return true;
+		}
+		if (!skip(keyEnd, 1, pos)) {
+			return false;
+		}
+		++index;
+	}
+	setError("Error serializing %s; '%s' not found", _typeStr, _name);
+	return false;
+}
+
+bool SerializerMsgPack::enterScope(bool _isArray, const char* _name)
+{
+	const char* data = m_file->getData();
+	const uint64 dataSize = m_file->getDataSize();
+	uint8 tag = m_pos < dataSize ? (uint8)data[m_pos] : kNil;
+	const uint8 fixTag = _isArray ? kFixArray : kFixMap;
+	const uint8 tag16  = _isArray ? kArray16  : kMap16;
+	uint lengthSize = tag == tag16 ? 2 : (tag == tag16 + 1 ? 4 : 0);
+	if ((tag & 0xf0) != fixTag && lengthSize == 0) {
+		setError("Error serializing %s; '%s' not %s", _isArray ? "array" : "object", _name ? _name : "", _isArray ? "an array" : "an object");
+		skipValue();
+		return false;
+	}
+	if (m_pos + 1 + lengthSize > dataSize) {
+		setError("Error serializing %s '%s'; unexpected end of data", _isArray ? "array" : "object", _name ? _name : "");
+		return false;
+	}
+	++m_pos;
+	Scope scope = {};
+	scope.m_length = lengthSize == 0 ? (tag & 0x0f) : (uint)readBE(lengthSize);
+	scope.m_begin = m_pos;
+	scope.m_isArray = _isArray;
+	m_scopes.push_back(scope);
+	return true;
+}
+
+void SerializerMsgPack::skipValue()
+{
+	uint64 end;
+	if (skip(m_valueBegin, 1, end)) {
+		m_pos = end;
+	}
+}
+
+bool SerializerMsgPack::skip(uint64 _offset, uint64 _count, uint64& end_)
+{
+	const char* data = m_file->getData();
+	const uint64 dataSize = m_file->getDataSize();
+	uint64 pos = _offset;
+	while (_count > 0) {
+		if (pos >= dataSize) {
+			break;
+		}
+		const uint8 tag = (uint8)data[pos++];
+		--_count;
+		uint lengthSize = 0;  // size of the length/count following the tag
+		uint64 size = 0;      // size of the payload following the length
+		if (tag <= 0x7f || tag >= 0xe0 || tag == kNil || tag == kFalse || tag == kTrue) {
+			continue;
+		} else if (tag < kFixArray) {
+			_count += (tag & 0x0f) * 2;
+			continue;
+		} else if (tag < kFixStr) {
+			_count += tag & 0x0f;
+			continue;
+		} else if (tag < kNil) {
+			size = tag & 0x1f;
+		} else {
+			switch (tag) {
+				case kBin8:    case kStr8:   lengthSize = 1; break;
+				case kBin16:   case kStr16:  lengthSize = 2; break;
+				case kBin32:   case kStr32:  lengthSize = 4; break;
+				case kExt8:    lengthSize = 1; size = 1; break;
+				case kExt16:   lengthSize = 2; size = 1; break;
+				case kExt32:   lengthSize = 4; size = 1; break;
+				case kUint8:   case kInt8:   size = 1; break;
+				case kUint16:  case kInt16:  size = 2; break;
+				case kFloat32: case kUint32: case kInt32: size = 4; break;
+				case kFloat64: case kUint64: case kInt64: size = 8; break;
+				case kArray16: case kMap16:  lengthSize = 2; break;
+				case kArray32: case kMap32:  lengthSize = 4; break;
+				default:
+					if (tag >= kFixExt1 && tag <= kFixExt16) {
+						size = 1 + ((uint64)1 << (tag - kFixExt1));
+						break;
+					}
+					setError("Error serializing; invalid type 0x%x at offset %llu", (uint)tag, pos - 1);
+					return false;
+			};
+		}
+		if (lengthSize > 0) {
+			if (pos + lengthSize > dataSize) {
+				break;
+			}
+			uint64 n = LoadBE(data + pos, lengthSize);
+			pos += lengthSize;
+			if (tag == kArray16 || tag == kArray32) {
+				_count += n;
+			} else if (tag == kMap16 || tag == kMap32) {
+				_count += n * 2;
+			} else {
+				size += n;
+			}
+		}
+		pos += size;
+	}
+	if (_count > 0 || pos > dataSize) {
+		setError("Error serializing; unexpected end of data at offset %llu", pos);
+		return false;
+	}
+	end_ = pos;
+	return true;
+}
+
+bool SerializerMsgPack::readString(uint64 _offset, const char*& str_, uint32& length_, uint64& end_)
+{
+	const char* data = m_file->getData();
+	const uint64 dataSize = m_file->getDataSize();
+	if (_offset >= dataSize) {
+		return false;
+	}
+	const uint8 tag = (uint8)data[_offset];
+	uint lengthSize = 0;
+	uint64 length = 0;
+	if ((tag & 0xe0) == kFixStr) {
+		length = tag & 0x1f;
+	} else if (tag >= kStr8 && tag <= kStr32) {
+		lengthSize = 1u << (tag - kStr8);
+		if (_offset + 1 + lengthSize > dataSize) {
+			return false;
+		}
+		length = LoadBE(data + _offset + 1, lengthSize);
+	} else {
+		return false;
+	}
+	const uint64 begin = _offset + 1 + lengthSize;
+	if (begin + length > dataSize) {
+		return false;
+	}
+	str_ = data + begin;
+	length_ = (uint32)length;
+	end_ = begin + length;
+	return true;
+}
+
+bool SerializerMsgPack::readNumber(Number& number_, const char* _typeStr, const char* _name)
+{
+	const uint64 dataSize = m_file->getDataSize();
+	if (m_pos >= dataSize) {
+		setError("Error serializing %s '%s'; unexpected end of data", _typeStr, _name ? _name : "");
+		return false;
+	}
+	const uint8 tag = (uint8)m_file->getData()[m_pos];
+	if (tag <= 0x7f) {
+		number_.m_kind = Number::Kind_Uint;
+		number_.m_uint = tag;
+		++m_pos;
+		return true;
+	}
+	if (tag >= 0xe0) {
+		number_.m_kind = Number::Kind_Sint;
+		number_.m_sint = (sint8)tag;
+		++m_pos;
+		return true;
+	}
+	uint size = 0;
+	switch (tag) {
+		case kFalse:
+		case kTrue:
+			number_.m_kind = Number::Kind_Bool;
+			number_.m_bool = tag == kTrue;
+			++m_pos;
+			return true;
+		case kUint8:   case kUint16:  case kUint32:  case kUint64:
+			number_.m_kind = Number::Kind_Uint;
+			size = 1u << (tag - kUint8);
+			break;
+		case kInt8:    case kInt16:   case kInt32:   case kInt64:
+			number_.m_kind = Number::Kind_Sint;
+			size = 1u << (tag - kInt8);
+			break;
+		case kFloat32: case kFloat64:
+			number_.m_kind = Number::Kind_Float;
+			size = tag == kFloat32 ? 4 : 8;
+			break;
+		default:
+			setError("Error serializing %s; '%s' not a number", _typeStr, _name ? _name : "");
+			skipValue();
+			return false;
+	};
+	if (m_pos + 1 + size > dataSize) {
+		setError("Error serializing %s '%s'; unexpected end of data", _typeStr, _name ? _name : "");
+		return false;
+	}
+	++m_pos;
+	uint64 bits = readBE(size);
+	switch (number_.m_kind) {
+		case Number::Kind_Uint:
+			number_.m_uint = bits;
+			break;
+		case Number::Kind_Sint:
+		 // sign extend
+			number_.m_sint = size == 1 ? (sint64)(sint8)bits : size == 2 ? (sint64)(sint16)bits : size == 4 ? (sint64)(sint32)bits : (sint64)bits;
+			break;
+		default:
+			if (size == 4) {
+				uint32 bits32 = (uint32)bits;
+				float32 f;
+				memcpy(&f, &bits32, sizeof(f));
+				number_.m_float = f;
+			} else {
+				memcpy(&number_.m_float, &bits, sizeof(bits));
+			}
+			break;
+	};
+	return true;
+}
+
+uint64 SerializerMsgPack::readBE(uint _sizeBytes)
+{
+	uint64 ret = LoadBE(m_file->getData() + m_pos, _sizeBytes);
+	m_pos += _sizeBytes;
+	return ret;
+}
+
+template <typename tType>
+bool SerializerMsgPack::readArray(tType* data_, uint _count, const char* _name)
+{
+	const char* typeStr = ValueTypeToStr<tType>();
+	for (uint i = 0; i < _count; ++i) {
+		Number n;
+		if (!readNumber(n, typeStr, _name)) {
+			return false;
+		}
+		data_[i] = NumberTo<tType>(n);
+	}
+	return true;
+}
+
+bool SerializerMsgPack::valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name)
+{
+	#define CASE_TYPE(_enum, _ctype, _op) \
+		case _enum: _op((_ctype*)_data_); break;
+
+	if (getMode() == Mode_Write) {
+		if (!begin(_name, "array")) {
+			return false;
+		}
+		writeArrayHeader(_count);
+		#define WRITE_ELEMENTS(_ptr) for (uint i = 0; i < _count; ++i) { writeScalar((_ptr)[i]); }
+		switch (_type) {
+			CASE_TYPE(ScalarType_Bool,    bool,    WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint8,   sint8,   WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint8,   uint8,   WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint16,  sint16,  WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint16,  uint16,  WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint32,  sint32,  WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint32,  uint32,  WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint64,  sint64,  WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint64,  uint64,  WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Float32, float32, WRITE_ELEMENTS)
+			CASE_TYPE(ScalarType_Float64, float64, WRITE_ELEMENTS)
+			default: APT_ASSERT(false); break;
+		};
+		#undef WRITE_ELEMENTS
+		return true;
+	}
+
+	if (!find(_name, "array")) {
+		return false;
+	}
+	const uint64 arrayBegin = m_valueBegin; // reading the elements moves m_valueBegin
+	if (!enterScope(true, _name)) {
+		return false;
+	}
+	const uint length = m_scopes.back().m_length;
+	bool ret = length == _count;
+	if (!ret) {
+		setError("Error serializing %s array '%s': array length was %u, expected %u", ScalarTypeToStr(_type), _name ? _name : "", length, _count);
+	} else {
+		#define READ_ELEMENTS(_ptr) ret = readArray(_ptr, _count, _name)
+		switch (_type) {
+			CASE_TYPE(ScalarType_Bool,    bool,    READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint8,   sint8,   READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint8,   uint8,   READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint16,  sint16,  READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint16,  uint16,  READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint32,  sint32,  READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint32,  uint32,  READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Sint64,  sint64,  READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Uint64,  uint64,  READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Float32, float32, READ_ELEMENTS)
+			CASE_TYPE(ScalarType_Float64, float64, READ_ELEMENTS)
+			default: APT_ASSERT(false); ret = false; break;
+		};
+		#undef READ_ELEMENTS
+	}
+	if (!ret) {
+		m_valueBegin = arrayBegin;
+		skipValue();
+	}
+	m_scopes.pop_back();
+	return ret;
+
+	#undef CASE_TYPE
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <apt/apt.h>
+#include <apt/Serializer.h>
+
+#include <EASTL/vector.h>
+
+namespace apt {
+
+class File;
+
+////////////////////////////////////////////////////////////////////////////////
+// SerializerMsgPack
+// MessagePack (https://msgpack.org) stream written to/read from a File's
+// buffer, for exchanging data with non-C++ code.
+//
+// The root is a map. Objects are maps with string keys, arrays are arrays,
+// binary() is bin (or, if compressed, ext type kExtCompressed containing the
+// output of Compress()). vec* and mat* are fixed-length arrays of float32 (see
+// valueArray()). Scalars and strings use the smallest encoding; reads accept any
+// encoding and convert between numeric types.
+//
+// Values are written sequentially. Objects and arrays are written with a
+// map32/array32 header whose count is patched as values are added, which is
+// valid MessagePack but not the smallest encoding. Reads look up values by
+// name (as SerializerJson), searching from the last value read.
+////////////////////////////////////////////////////////////////////////////////
+class SerializerMsgPack: public Serializer
+{
+public:
+	// MessagePack extension type for compressed binary data.
+	static const sint8 kExtCompressed = 1;
+
+	// _file_ must remain valid for the lifetime of the serializer. In Mode_Write any existing data in _file_ is
+	// discarded. Changing the mode via setMode() isn't supported, construct a new SerializerMsgPack to read back the data.
+	SerializerMsgPack(File& _file_, Mode _mode);
+
+	bool beginObject(const char* _name = nullptr) override;
+	void endObject() override;
+
+	bool beginArray(uint& _length_, const char* _name = nullptr) override;
+	void endArray() override;
+
+	bool value(bool&       _value_, const char* _name = nullptr) override;
+	bool value(sint8&      _value_, const char* _name = nullptr) override;
+	bool value(uint8&      _value_, const char* _name = nullptr) override;
+	bool value(sint16&     _value_, const char* _name = nullptr) override;
+	bool value(uint16&     _value_, const char* _name = nullptr) override;
+	bool value(sint32&     _value_, const char* _name = nullptr) override;
+	bool value(uint32&     _value_, const char* _name = nullptr) override;
+	bool value(sint64&     _value_, const char* _name = nullptr) override;
+	bool value(uint64&     _value_, const char* _name = nullptr) override;
+	bool value(float32&    _value_, const char* _name = nullptr) override;
+	bool value(float64&    _value_, const char* _name = nullptr) override;
+	bool value(StringBase& _value_, const char* _name = nullptr) override;
+
+	bool binary(void*& _data_, uint& _sizeBytes_, const char* _name = nullptr, CompressionFlags _compressionFlags = CompressionFlags_None) override;
+
+private:
+	struct Scope
+	{
+		uint64 m_begin;   // write: offset of the map32/array32 header, read: offset of the first entry
+		uint64 m_end;     // read: offset of the end of the map/array, 0 if not yet known
+		uint   m_length;  // read: entry count
+		uint   m_index;   // write: entries written, read: arrays: entries read, maps: index of the entry at m_pos
+		bool   m_isArray;
+	};
+
+	struct Number
+	{
+		enum Kind { Kind_Bool, Kind_Sint, Kind_Uint, Kind_Float };
+		Kind m_kind;
+		union { bool m_bool; sint64 m_sint; uint64 m_uint; float64 m_float; };
+	};
+
+	File*                m_file;
+	uint64               m_pos;        // read offset
+	uint64               m_valueBegin; // offset of the last value found by find()
+	eastl::vector<Scope> m_scopes;
+
+	// Write the key for a value (if in an object), increment the entry count.
+	bool begin(const char* _name, const char* _typeStr);
+	// Write a map32/array32 header and push a scope, the count is written by begin().
+	void beginScope(uint8 _tag, bool _isArray);
+	// Pop the current scope, when reading skip any remaining entries.
+	void end();
+	void write(const void* _data, uint64 _sizeBytes);
+	// Write _tag followed by the _sizeBytes low bytes of _value (big-endian).
+	void write(uint8 _tag, uint64 _value, uint _sizeBytes);
+	// Write integers with the smallest encoding.
+	void writeUint(uint64 _value);
+	void writeSint(sint64 _value);
+	void writeString(const char* _str, uint _length);
+	void writeArrayHeader(uint _length);
+	template <typename tType>
+	void writeScalar(tType _value);
+
+	// Locate the next value in the current array or the named value in the current map, set m_pos to the start of the
+	// value. Return false if not found or the end of the current array is reached.
+	bool find(const char* _name, const char* _typeStr);
+	// Read a map/array header at m_pos and push a scope.
+	bool enterScope(bool _isArray, const char* _name);
+	// Skip the value found by find() (e.g. after a type mismatch).
+	void skipValue();
+	// Set end_ to the offset after _count values starting at _offset. Return false if the data is invalid.
+	bool skip(uint64 _offset, uint64 _count, uint64& end_);
+	// Read a str header at _offset, set str_/length_ and end_ to the offset after the chars.
+	bool readString(uint64 _offset, const char*& str_, uint32& length_, uint64& end_);
+	bool readNumber(Number& number_, const char* _typeStr, const char* _name);
+	// Read the _sizeBytes big-endian bytes at m_pos (bounds must have been checked).
+	uint64 readBE(uint _sizeBytes);
+	// Read the elements of the array found by find().
+	template <typename tType>
+	bool readArray(tType* data_, uint _count, const char* _name);
+
+	template <typename tType>
+	bool valueImpl(tType& _value_, const char* _name);
+
+	bool valueArrayImpl(void* _data_, uint _count, ScalarType _type, const char* _name) override;
+
+}; // class SerializerMsgPack
+
+} // namespace apt
@@ -1,9 +1,10 @@
 #include <apt/String.h>
 
 #include <apt/memory.h>
+#include <apt/numeric.h>
+#include <apt/simd_string.h>
 
 #include <algorithm>
-#include <cctype>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
@@ -14,6 +15,23 @@
 
 using namespace apt;
 
+// Format into _buf, return the length of the formatted string excluding the null terminator (which may be >= _bufSize, 
+// in which case the output was truncated).
+static int FormatV(char* _buf, uint _bufSize, const char* _fmt, va_list _args)
+{
+	va_list args;
+	va_copy(args, _args);
+	int ret = vsnprintf(_buf, _bufSize, _fmt, args);
+	va_end(args);
+	if (ret < 0) {
+	 // pre-C99 vsnprintf returns -1 on overflow, need to count the chars separately
+		va_copy(args, _args);
+		ret = vsnprintf(nullptr, 0, _fmt, args);
+		va_end(args);
+	}
+	return ret;
+}
+
 // PUBLIC
 
 uint StringBase::set(const char* _src, uint _count)
@@ -34,6 +52,20 @@ uint StringBase::set(const char* _src, uint _count)
 	return srclen;
 }
 
+uint StringBase::set(const StringView& _src)
+{
+	uint srclen = _src.getLength();
+	if (m_capacity < srclen + 1) {
+		alloc(srclen + 1);
+	}
+	if (srclen > 0) {
+		memmove(m_buf, _src.begin(), srclen); // _src may reference this string
+	}
+	m_buf[srclen] = '\0';
+	m_length = srclen;
+	return srclen;
+}
+
 uint StringBase::setf(const char* _fmt, ...)
 {
 	va_list args;
@@ -45,25 +77,13 @@ uint StringBase::setf(const char* _fmt, ...)
 
 uint StringBase::setfv(const char* _fmt, va_list _args)
 {
-	va_list args;
-	va_copy(args, _args);
-
-#ifdef APT_COMPILER_MSVC
- // vsnprintf returns -1 on overflow, requires 2 passes
-	int len = vsnprintf(0, 0, _fmt, args);
-	APT_STRICT_ASSERT(len >= 0);
+ // format directly into the existing buffer, only need a 2nd pass if it overflowed
+	int len = FormatV(m_buf, m_capacity, _fmt, _args);
+	APT_ASSERT(len >= 0);
 	if (m_capacity < (uint)len + 1) {
 		alloc(len + 1);
+		APT_VERIFY(FormatV(m_buf, m_capacity, _fmt, _args) == len);
 	}
-	APT_VERIFY(vsnprintf(m_buf, m_capacity, _fmt, args) >= 0);
-#else
-	int len = vsnprintf(m_buf, m_capacity, _fmt, args);
-	APT_STRICT_ASSERT(len >= 0);
-	if (m_capacity < len + 1) {
-		alloc(len + 1);
-		APT_VERIFY(vsnprintf(m_buf, m_capacity, _fmt, args) >= 0);
-	}
-#endif
 	m_length = (uint)len;
 	return m_length;
 }
@@ -79,7 +99,7 @@ uint StringBase::append(const char* _src, uint _count)
 	}
 	uint len = getLength();
 	if (m_capacity < len + srclen + 1) {
-		realloc(len + srclen + 1);
+		grow(len + srclen + 1);
 	}
 	strncpy(m_buf + len, _src, srclen);
 	len += srclen;
@@ -88,6 +108,28 @@ uint StringBase::append(const char* _src, uint _count)
 	return len;
 }
 
+uint StringBase::append(const StringView& _src)
+{
+	uint srclen = _src.getLength();
+	uint len = getLength();
+	if (srclen == 0) {
+		return len;
+	}
+	const char* src = _src.begin();
+	if (m_capacity < len + srclen + 1) {
+	 // _src may reference this string, in which case it must be rebased after grow()
+		bool isSelf = src >= m_buf && src < m_buf + m_capacity;
+		uint offset = isSelf ? (uint)(src - m_buf) : 0;
+		grow(len + srclen + 1);
+		src = isSelf ? m_buf + offset : src;
+	}
+	memmove(m_buf + len, src, srclen);
+	len += srclen;
+	m_buf[len] = '\0';
+	m_length = len;
+	return len;
+}
+
 uint StringBase::appendf(const char* _fmt, ...)
 {
 	va_list args;
@@ -99,23 +141,39 @@ uint StringBase::appendf(const char* _fmt, ...)
 
 uint StringBase::appendfv(const char* _fmt, va_list _args)
 {
-	va_list args;
-	va_copy(args, _args);
+ // fast path for a single integer conversion, bypass the CRT
+	if (_fmt[0] == '%') {
+		char num[kMaxIntStringLength];
+		uint numlen = 0;
+		if      (strcmp(_fmt, "%d") == 0   || strcmp(_fmt, "%i") == 0)   numlen = IntToString(num, va_arg(_args, int));
+		else if (strcmp(_fmt, "%u") == 0)                                  numlen = UintToString(num, va_arg(_args, unsigned));
+		else if (strcmp(_fmt, "%lld") == 0 || strcmp(_fmt, "%lli") == 0) numlen = IntToString(num, va_arg(_args, long long));
+		else if (strcmp(_fmt, "%llu") == 0)                                numlen = UintToString(num, va_arg(_args, unsigned long long));
+		if (numlen > 0) {
+			append(num, numlen);
+			return m_length;
+		}
+	}
 
+ // format directly into the spare capacity, only need a 2nd pass if it overflowed
 	uint len = getLength();
-	int srclen = vsnprintf(0, 0, _fmt, args);
-	APT_ASSERT(srclen > 0);
+	int srclen = FormatV(m_buf ? m_buf + len : nullptr, m_capacity - len, _fmt, _args);
+	APT_ASSERT(srclen >= 0);
 	if (m_capacity < len + srclen + 1) {
-		realloc(len + srclen + 1);
+		grow(len + srclen + 1);
+		APT_VERIFY(FormatV(m_buf + len, m_capacity - len, _fmt, _args) == srclen);
 	}
-	APT_VERIFY(vsnprintf(m_buf + len, m_capacity, _fmt, args) >= 0);
 	m_length = (uint)srclen + len;
 	return m_length;
 }
 
 const char* StringBase::findFirst(const char* _list) const
 {
-	return strpbrk(m_buf, _list);
+	if (!m_buf) {
+		return nullptr;
+	}
+	const char* ret = internal::FindAny(m_buf, _list);
+	return *ret ? ret : nullptr;
 }
 const char* StringBase::findLast(const char* _list) const
 {
@@ -145,20 +203,23 @@ const char* StringBase::findLast(const char* _list) const
 
 const char* StringBase::find(const char* _str) const
 {
-	return strstr(m_buf, _str);
+	if (!m_buf) {
+		return nullptr;
+	}
+	return internal::FindSubstring(m_buf, m_length, _str, strlen(_str));
 }
 
-uint StringBase::replace(char _find, char _replace)
+const char* StringBase::find(const StringView& _str) const
 {
-	char* tmp = m_buf;
-	uint ret = 0;
-	for (; *tmp != '\0'; ++tmp) {
-		if (*tmp == _find) {
-			*tmp = _replace;
-			++ret;
-		}
+	if (!m_buf) {
+		return nullptr;
 	}
-	return ret;
+	return internal::FindSubstring(m_buf, m_length, _str.begin(), _str.getLength());
+}
+
+uint StringBase::replace(char _find, char _replace)
+{
+	return internal::ReplaceChar(m_buf, m_length, _find, _replace);
 }
 
 uint StringBase::replace(const char* _find, const char* _replace)
@@ -181,7 +242,12 @@ uint StringBase::replace(const char* _find, const char* _replace)
 	}
 	tmp.append(beg);
 	if (ret) {
-		swap(*this, tmp);
+		if (m_capacity > tmp.getLength()) {
+		 // reuse the existing buffer, never shrink
+			set((const char*)tmp, tmp.getLength());
+		} else {
+			swap(*this, tmp);
+		}
 	}
 	return ret;
 }
@@ -204,18 +270,12 @@ uint StringBase::replacefv(const char* _find, const char* _fmt, va_list _args)
 
 void StringBase::toLowerCase()
 {
-	char* tmp = m_buf;
-	for (; *tmp != '\0'; ++tmp) {
-		*tmp = (char)tolower((int)*tmp);
-	}
+	internal::ToLowerCase(m_buf, m_length);
 }
 
 void StringBase::toUpperCase()
 {
-	char* tmp = m_buf;
-	for (; *tmp != '\0'; ++tmp) {
-		*tmp = (char)toupper((int)*tmp);
-	}
+	internal::ToUpperCase(m_buf, m_length);
 }
 
 void StringBase::setLength(uint _length)
@@ -232,6 +292,12 @@ void StringBase::setCapacity(uint _capacity)
 		realloc(_capacity);
 	}
 }
+void StringBase::reserve(uint _capacity)
+{
+	if (m_capacity < _capacity) {
+		realloc(_capacity);
+	}
+}
 
 bool StringBase::operator==(const char* _rhs) const
 {
@@ -390,3 +456,10 @@ void StringBase::realloc(uint _capacity)
 		m_capacity = _capacity;
 	}
 }
+
+void StringBase::grow(uint _capacity)
+{
+	if (m_capacity < _capacity) {
+		realloc(std::max(_capacity, m_capacity + m_capacity / 2));
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <apt/apt.h>
+#include <apt/StringView.h>
 
 #include <cstdarg> // va_list
 
@@ -11,6 +12,8 @@ namespace apt {
 // Base for string class with an optional local buffer. If/when the local 
 // buffer overflows it is replaced with a heap-allocated buffer. Once the 
 // buffer is heap-allocated it never returns to using the local buffer.
+// Append operations grow the buffer geometrically; set operations allocate 
+// exactly the required capacity.
 // All const char* interfaces expect null-terminated strings.
 ////////////////////////////////////////////////////////////////////////////////
 class StringBase
@@ -22,6 +25,8 @@ public:
 	// char is appended to the end of the result. 
 	// Return the new length of the string (excluding the null terminator).
 	uint set(const char* _src, uint _count = 0);
+	// Copy the characters referenced by _src (which need not be null-terminated).
+	uint set(const StringView& _src);
 	// Set formatted content. Return the new length of the string (excluding the null terminator).
 	uint setf(const char* _fmt, ...);
 	uint setfv(const char* _fmt, va_list _args);
@@ -32,6 +37,7 @@ public:
 	// char is appended to the end of the result. 
 	// Return the new length of the string (excluding the null terminator).
 	uint append(const char* _src, uint _count = 0);
+	uint append(const StringView& _src);
 	// Append formatted content. Return the new length of the string (excluding the null terminator).
 	uint appendf(const char* _fmt, ...);
 	uint appendfv(const char* _fmt, va_list _args);
@@ -42,8 +48,10 @@ public:
 
 	// Find the first occurence of the substring _str. If not found return 0.
 	const char* find(const char* _str) const;
+	const char* find(const StringView& _str) const;
 
-	// Replace all instances of _find with _replace. Return the number of instances replaced.
+	// Replace all instances of _find with _replace. Return the number of instances replaced. The capacity is never
+	// reduced.
 	uint replace(char _find, char _replace); // single char (faster, in-place)
 	uint replace(const char* _find, const char* _replace); // substring
 	uint replacef(const char* _find, const char* _fmt, ...);
@@ -62,9 +70,13 @@ public:
 	bool isLocal() const                            { return m_buf == getLocalBuf(); }
 	uint getCapacity() const                        { return m_capacity; }
 	void setCapacity(uint _capacity);
+	// Ensure the capacity is at least _capacity (including the null terminator). Unlike setCapacity(), this is a no-op if 
+	// the capacity is already sufficient. Use to avoid reallocations when the final length of the string is known.
+	void reserve(uint _capacity);
 
 	bool  operator==(const char* _rhs) const;
 	bool  operator==(const StringBase& _rhs) const  { return this->operator==((const char*)_rhs); }
+	bool  operator==(const StringView& _rhs) const  { return StringView(m_buf, m_length) == _rhs; }
 	bool  operator<(const char* _rhs) const;
 	bool  operator<(const StringBase& _rhs) const   { return this->operator<((const char*)_rhs); }
 	bool  operator>(const char* _rhs) const;
@@ -78,6 +90,8 @@ public:
 	const char* c_str() const                       { return m_buf; }
 	const char* begin() const                       { return m_buf; }
 	const char* end() const                         { return begin() + m_length; }
+	// Implicit conversion to StringView; the view is invalidated by any operation which modifies the string.
+	operator StringView() const                     { return StringView(m_buf, m_length); }
 	
 	friend void swap(StringBase& _a_, StringBase& _b_);
 
@@ -108,6 +122,10 @@ private:
 	// Resize m_buf to _capaicty, maintain contents.
 	void realloc(uint _capacity);
 
+	// Resize m_buf to at least _capacity, maintain contents. The capacity grows geometrically such that a sequence of 
+	// append() calls requires O(log n) reallocations.
+	void grow(uint _capacity);
+
 };
 
 
@@ -122,6 +140,7 @@ public:
 	String<kCapacity>& operator=(const String<kCapacity>& _rhs)            { if (&_rhs != this) set((const char*)_rhs); return *this; }
 	String(String<kCapacity>&& _rhs):      StringBase((StringBase&&)_rhs)  {}
 	String<kCapacity>& operator=(String<kCapacity>&& _rhs)                 { StringBase::operator=((StringBase&&)_rhs); return *this; }
+	String(const StringView& _str):        StringBase(kCapacity)           { set(_str); }
 	String(const char* _fmt, ...):         StringBase(kCapacity)
 	{
 		if (_fmt) {
@@ -142,6 +161,7 @@ public:
 	String<0>& operator=(const String<0>& _rhs)                   { if (&_rhs != this) set((const char*)_rhs); return *this; }
 	String(String<0>&& _rhs):      StringBase((StringBase&&)_rhs) {}
 	String<0>& operator=(String<0>&& _rhs)                        { StringBase::operator=((StringBase&&)_rhs); return *this; }
+	String(const StringView& _str): StringBase()                  { set(_str); }
 	String(const char* _fmt, ...): StringBase()
 	{
 		if (_fmt) {
@@ -153,4 +173,18 @@ public:
 	}
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// StringBuilder
+// Heap-allocated string for incrementally building large outputs (e.g. 
+// Ini/Json serialization). The capacity is never reduced (including by
+// replace(), which reuses the buffer if the result fits and otherwise swaps in
+// a larger one), hence a StringBuilder may be clear()ed and reused without
+// allocating. Memory is only released by the dtor.
+////////////////////////////////////////////////////////////////////////////////
+class StringBuilder: public String<0>
+{
+public:
+	StringBuilder(uint _capacity = 0): String<0>()                    { reserve(_capacity); }
+};
+
 } // namespace apt
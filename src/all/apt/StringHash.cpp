@@ -17,3 +17,9 @@ StringHash::StringHash(const char* _str, uint _len)
 {
 	m_hash = Hash<HashType>(_str, _len);
 }
+
+StringHash::StringHash(const StringView& _str)
+	: m_hash(0)
+{
+	m_hash = Hash<HashType>(_str.isNull() ? "" : _str.begin(), _str.getLength());
+}
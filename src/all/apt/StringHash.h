@@ -1,6 +1,7 @@
 #pragma once
 
 #include <apt/apt.h>
+#include <apt/StringView.h>
 
 namespace apt {
 
@@ -23,6 +24,9 @@ public:
 	// Initialize from _len characters of _str.
 	StringHash(const char* _str, uint _len);
 
+	// Initialize from a StringView, equivalent to StringHash(_str.begin(), _str.getLength()).
+	StringHash(const StringView& _str);
+
 	// May be kInvalidHash in the case of an uninitialized StringHash.
 	HashType getHash() const { return m_hash; }
 
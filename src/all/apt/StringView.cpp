@@ -0,0 +1,72 @@
+#include <apt/StringView.h>
+
+#include <apt/simd_string.h>
+
+#include <algorithm>
+
+using namespace apt;
+
+// PUBLIC
+
+StringView StringView::substr(uint _offset, uint _count) const
+{
+	_offset = std::min(_offset, m_length);
+	_count  = std::min(_count, m_length - _offset);
+	return StringView(m_begin + _offset, _count);
+}
+
+const char* StringView::findFirst(char _c) const
+{
+	if (m_length == 0) {
+		return nullptr;
+	}
+	return (const char*)memchr(m_begin, _c, m_length);
+}
+
+const char* StringView::findFirst(const char* _list) const
+{
+	for (const char* c = begin(); c != end(); ++c) {
+		if (strchr(_list, *c) && *c != '\0') {
+			return c;
+		}
+	}
+	return nullptr;
+}
+
+const char* StringView::findLast(char _c) const
+{
+	for (const char* c = end(); c != begin(); --c) {
+		if (*(c - 1) == _c) {
+			return c - 1;
+		}
+	}
+	return nullptr;
+}
+
+const char* StringView::findLast(const char* _list) const
+{
+	for (const char* c = end(); c != begin(); --c) {
+		if (strchr(_list, *(c - 1)) && *(c - 1) != '\0') {
+			return c - 1;
+		}
+	}
+	return nullptr;
+}
+
+const char* StringView::find(const StringView& _str) const
+{
+	if (isNull()) {
+		return nullptr;
+	}
+	return internal::FindSubstring(m_begin, m_length, _str.m_begin, _str.m_length);
+}
+
+int StringView::compare(const StringView& _str) const
+{
+	uint n = std::min(m_length, _str.m_length);
+	int ret = n > 0 ? memcmp(m_begin, _str.m_begin, n) : 0;
+	if (ret == 0) {
+		ret = m_length < _str.m_length ? -1 : (m_length > _str.m_length ? 1 : 0);
+	}
+	return ret;
+}
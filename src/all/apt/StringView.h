@@ -0,0 +1,63 @@
+#pragma once
+
+#include <apt/apt.h>
+
+#include <cstring>
+
+namespace apt {
+
+////////////////////////////////////////////////////////////////////////////////
+// StringView
+// Non-owning reference to a range of characters (ptr + length). The range is
+// not necessarily null-terminated, hence the ptr should not be passed to
+// interfaces which expect a null-terminated string.
+// A StringView is only valid during the lifetime of the string it references.
+////////////////////////////////////////////////////////////////////////////////
+class StringView
+{
+public:
+	StringView(): m_begin(nullptr), m_length(0)                                               {}
+	StringView(const char* _str): m_begin(_str), m_length(_str ? (uint)strlen(_str) : 0)     {}
+	StringView(const char* _str, uint _length): m_begin(_str), m_length(_length)              {}
+	StringView(const char* _beg, const char* _end): m_begin(_beg), m_length((uint)(_end - _beg)) { APT_STRICT_ASSERT(_end >= _beg); }
+
+	// Return a view of _count chars beginning at _offset. The result is clamped to the end of this view.
+	StringView substr(uint _offset, uint _count = ~0u) const;
+
+	// Find the first (or last) occurence of _c or of any character in _list (null-terminated). If not found return 0.
+	const char* findFirst(char _c) const;
+	const char* findFirst(const char* _list) const;
+	const char* findLast(char _c) const;
+	const char* findLast(const char* _list) const;
+
+	// Find the first occurence of the substring _str. If not found return 0.
+	const char* find(const StringView& _str) const;
+
+	bool beginsWith(const StringView& _str) const   { return m_length >= _str.m_length && substr(0, _str.m_length) == _str; }
+	bool endsWith(const StringView& _str) const     { return m_length >= _str.m_length && substr(m_length - _str.m_length) == _str; }
+
+	// Lexicographical comparison, return < 0, 0 or > 0 (like strcmp).
+	int  compare(const StringView& _str) const;
+
+	bool operator==(const StringView& _rhs) const   { return m_length == _rhs.m_length && (m_length == 0 || memcmp(m_begin, _rhs.m_begin, m_length) == 0); }
+	bool operator!=(const StringView& _rhs) const   { return !(*this == _rhs); }
+	bool operator<(const StringView& _rhs) const    { return compare(_rhs) < 0; }
+	bool operator>(const StringView& _rhs) const    { return compare(_rhs) > 0; }
+	char operator[](uint _i) const                  { APT_STRICT_ASSERT(_i < m_length); return m_begin[_i]; }
+
+	// Length in chars (there is no null terminator).
+	uint getLength() const                          { return m_length; }
+	bool isEmpty() const                            { return m_length == 0; }
+	// Default-constructed views (and views of a nullptr string) are null, as distinct from empty views of an existing string.
+	bool isNull() const                             { return m_begin == nullptr; }
+
+	const char* begin() const                       { return m_begin; }
+	const char* end() const                         { return m_begin + m_length; }
+
+private:
+	const char* m_begin;
+	uint        m_length;
+
+};
+
+} // namespace apt
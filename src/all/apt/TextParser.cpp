@@ -1,14 +1,23 @@
 #include <apt/TextParser.h>
 
+#include <apt/numeric.h>
+#include <apt/simd_string.h>
+
+#include <algorithm>
 #include <cctype>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 
 using namespace apt;
 
-TextParser::TextParser(const char* _str)
+// PUBLIC
+
+TextParser::TextParser(const char* _str, bool _countLines)
 	: m_start(_str)
 	, m_pos(_str)
+	, m_lineCount(_countLines ? 0 : -1)
+	, m_indexEnd(_str)
 {
 }
 
@@ -35,87 +44,72 @@ bool TextParser::isLineEnd() const
 
 char TextParser::advanceToNext(char _c)
 {
-	while (!isNull() && *m_pos != _c) {
-		++m_pos;
-	}
+	setPos(internal::FindChar(m_pos, _c));
 	return *m_pos;
 }
 
 char TextParser::advanceToNext(const char* _list)
 {
-	while (!isNull()) {
-		const char* c = _list;
-		while (*c != 0) {
-			if (*m_pos == *c) {
-				return *c;
-			}
-			++c;
-		}
-		++m_pos;
-	}
+	setPos(internal::FindAny(m_pos, _list));
 	return *m_pos;
 }
 
 char TextParser::advanceToNextWhitespace()
 {
-	while (!isNull() && !isWhitespace()) {
-		++m_pos;
-	}
+	setPos(internal::FindWhitespace(m_pos));
 	return *m_pos;
 }
 
 char TextParser::advanceToNextWhitespaceOr(char _c)
 {
-	while (!isNull() && !isWhitespace() && *m_pos != _c) {
-		++m_pos;
-	}
+	const char list[] = { _c, '\0' };
+	setPos(internal::FindWhitespaceOrAny(m_pos, list));
 	return *m_pos;
 }
 
 char TextParser::advanceToNextWhitespaceOr(const char* _list)
-{	
-	while (!isNull() && !isWhitespace()) {
-		const char* c = _list;
-		while (*c != 0) {
-			if (*m_pos == *c) {
-				return *c;
-			}
-			++c;
-		}
-		++m_pos;
-	}
+{
+	setPos(internal::FindWhitespaceOrAny(m_pos, _list));
 	return *m_pos;
 }
 
 char TextParser::advanceToNextAlpha()
 {
-	while (!isNull() && !isAlpha()) {
-		++m_pos;
+	const char* pos = m_pos;
+	while (*pos != 0 && !isalpha(*pos)) {
+		++pos;
 	}
+	setPos(pos);
 	return *m_pos;
 }
 
 char TextParser::advanceToNextNum()
 {
-	while (!isNull() && !isNum()) {
-		++m_pos;
+	const char* pos = m_pos;
+	while (*pos != 0 && !isdigit(*pos)) {
+		++pos;
 	}
+	setPos(pos);
 	return *m_pos;
 }
 
 char TextParser::advanceToNextAlphaNum()
 {
-	while (!isNull() && !isAlphaNum()) {
-		++m_pos;
+	const char* pos = m_pos;
+	while (*pos != 0 && !isalnum(*pos)) {
+		++pos;
 	}
+	setPos(pos);
 	return *m_pos;
 }
 
 char TextParser::advanceToNextNonAlphaNum()
 {
-	while (!isNull() && isAlphaNum()) {
-		++m_pos;
+	const char* pos = m_pos;
+	while (*pos != 0 && isalnum(*pos)) {
+		++pos;
 	}
+	setPos(pos);
 	return *m_pos;
 }
 
@@ -127,9 +121,7 @@ char TextParser::skipLine()
 
 char TextParser::skipWhitespace()
 {
-	while (!isNull() && isWhitespace()) {
-		++m_pos;
-	}
+	setPos(internal::SkipWhitespace(m_pos));
 	return *m_pos;
 }
 
@@ -148,30 +140,58 @@ char TextParser::containsAny(const char* _beg, const char* _list)
 	return (char)0;
 }
 
-bool TextParser::matches(const char *_beg, const char* _str)
-{
-	return strncmp(_beg, _str, m_pos - _beg) == 0;
-}
-
 bool TextParser::find(const char* _str)
 {
-	const char* ret = strstr(m_pos, _str);
+	const char* ret = internal::FindSubstring(m_pos, _str);
 	if (!ret) {
 		return false;
 	}
-	m_pos = ret;
+	setPos(ret);
 	return true;
 }
 
+bool TextParser::find(const StringView& _str)
+{
+	if (_str.isEmpty()) {
+		return true;
+	}
+ // FindChar() for the first char, then compare the remainder (strncmp stops at the end of the string)
+	for (const char* pos = m_pos; *(pos = internal::FindChar(pos, _str[0])); ++pos) {
+		if (strncmp(pos + 1, _str.begin() + 1, _str.getLength() - 1) == 0) {
+			setPos(pos);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TextParser::reset(const char* _pos)
+{
+	if (_pos) {
+		setPos(_pos);
+	} else {
+		m_pos = m_start;
+		m_lineCount = m_lineCount >= 0 ? 0 : -1;
+	}
+}
+
 int TextParser::getLineCount(const char* _pos) const
 {
-	const char* c = _pos ? _pos : m_pos;
-	int ret = 0;
-	do {
-		ret += *c == '\n' ? 1 : 0;
-		--c;
-	} while (c != m_start);
-	return ret;
+	if (!_pos && m_lineCount >= 0) {
+		return (int)m_lineCount + (*m_pos == '\n' ? 1 : 0); // include m_pos
+	}
+	const char* pos = _pos ? _pos : m_pos;
+	indexLines(pos + 1); // include _pos
+	return (int)(std::upper_bound(m_lineEnds.begin(), m_lineEnds.end(), (uint)(pos - m_start)) - m_lineEnds.begin());
+}
+
+int TextParser::getColumnCount(const char* _pos) const
+{
+	const char* pos = _pos ? _pos : m_pos;
+	indexLines(pos);
+	auto it = std::lower_bound(m_lineEnds.begin(), m_lineEnds.end(), (uint)(pos - m_start)); // first '\n' at or after pos
+	uint lineBeg = it == m_lineEnds.begin() ? 0 : *(it - 1) + 1;
+	return (int)(pos - m_start) - (int)lineBeg;
 }
 
 bool TextParser::readNextBool(bool& out_)
@@ -196,7 +216,8 @@ bool TextParser::readNextDouble(double& out_)
 	if (isNum() || *m_pos == '+' || *m_pos == '-') {
 		const char* beg = m_pos;
 		advanceToNextWhitespace();
-		out_ = strtod(beg, 0);
+		out_ = 0.0;
+		ParseDouble(out_, beg);
 		return true;
 	}
 	return false;
@@ -208,13 +229,22 @@ bool TextParser::readNextInt(long int& out_)
 	if (isNum() || *m_pos == '+' || *m_pos == '-') {
 		const char* beg = m_pos;
 		advanceToNextWhitespace();
-		out_ = strtol(beg, 0, 0);
+		sint64 i = 0;
+		ParseInt(i, beg);
+		i = std::min(std::max(i, (sint64)LONG_MIN), (sint64)LONG_MAX); // long is 32 bits on Windows
+		out_ = (long int)i;
 		return true;
 	}
 	return false;
 }
 
-bool TextParser::compareNext(const char* _str)
+bool TextParser::matches(const char *_beg, const StringView& _str) const
+{
+	StringView region = getRegion(_beg);
+	return region.getLength() <= _str.getLength() && memcmp(region.begin(), _str.begin(), region.getLength()) == 0;
+}
+
+bool TextParser::compareNext(const StringView& _str)
 {
 	skipWhitespace();
 	const char* beg = m_pos;
@@ -222,6 +252,30 @@ bool TextParser::compareNext(const char* _str)
 	if (matches(beg, _str)) {
 		return true;
 	}
-	m_pos = beg;
+	setPos(beg);
 	return false;
+}
+
+// PRIVATE
+
+void TextParser::updateLineCount(const char* _pos)
+{
+	if (_pos >= m_pos) {
+		m_lineCount += (sint)internal::CountChar(m_pos, _pos, '\n');
+	} else {
+		m_lineCount -= (sint)internal::CountChar(_pos, m_pos, '\n');
+	}
+}
+
+void TextParser::indexLines(const char* _end) const
+{
+	while (m_indexEnd < _end) {
+		const char* lineEnd = internal::FindChar(m_indexEnd, '\n');
+		if (*lineEnd == '\0') {
+			m_indexEnd = lineEnd;
+			break;
+		}
+		m_lineEnds.push_back((uint)(lineEnd - m_start));
+		m_indexEnd = lineEnd + 1;
+	}
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <apt/apt.h>
+#include <apt/StringView.h>
+
+#include <EASTL/vector.h>
 
 namespace apt {
 
@@ -8,15 +11,23 @@ namespace apt {
 // TextParser
 // Common text parsing operations; advance a string ptr with character
 // classification, check if a region of the string contains characters, keep
-// a count of line endings, etc. Wraps cctype and cstring.
+// a count of line endings, etc. Scanning functions use the SIMD kernels in
+// simd_string.h.
 //
 // Only line feed '\n' are counted as line endings; carriage return '\r' are 
-// treated as whitespace only.
+// treated as whitespace only. Line endings are indexed lazily on the first
+// call to getLineCount() or getColumnCount(), subsequent lookups are 
+// O(log n). Optionally the parser maintains a running line count as the
+// current position moves (see the constructor).
+//
+// The string must not be modified during the lifetime of the parser.
 ////////////////////////////////////////////////////////////////////////////////
 class TextParser
 {
 public:
-	TextParser(const char* _str);
+	// If _countLines is true, advance*(), skip*() etc. update a running line count which getLineCount() returns
+	// for the current position (this costs a SIMD count per position change rather than an index lookup).
+	TextParser(const char* _str, bool _countLines = false);
 
 	// Classification functions test the char at the current position.
 	bool isNull() const { return *m_pos == 0; }
@@ -27,7 +38,7 @@ public:
 	bool isLineEnd() const;
 
 	// advance*() and skip*() functions return the character they stop on (0 if the function reached the end of the sequence).
-	char advance(sint _n = 1) { m_pos += _n; return *m_pos;  }
+	char advance(sint _n = 1) { setPos(m_pos + _n); return *m_pos;  }
 	char advanceToNext(char _c); // advance to next occurence of _c
 	char advanceToNext(const char* _list); // advance to next occurence of any char in _list
 	char advanceToNextWhitespace();
@@ -40,20 +51,29 @@ public:
 	char skipLine();
 	char skipWhitespace(); // include empty lines
 
-	void reset(const char* _pos = nullptr) { m_pos = _pos ? _pos : m_start; }
+	void reset(const char* _pos = nullptr);
 
 	// Return the first occurence of any characters from _list in the region between _beg and the current position, or 0 if none.
 	char containsAny(const char* _beg, const char* _list);
 
-	// Return true if the region between _beg and the current position exactly matches _str.
-	bool matches(const char *_beg, const char* _str);
+	// Return true if the region between _beg and the current position matches the start of _str (i.e. the region is a
+	// prefix of _str).
+	bool matches(const char *_beg, const char* _str)            { return matches(_beg, StringView(_str)); }
+	bool matches(const char *_beg, const StringView& _str) const;
+
+	// Return a view of the region between _beg and the current position.
+	StringView getRegion(const char* _beg) const                { APT_ASSERT(_beg <= m_pos); return StringView(_beg, m_pos); }
 
 	// Advance to the next occurrence of substring _str, return false if not found.
 	bool find(const char* _str);
+	bool find(const StringView& _str);
 
 	// Return # occurences of '\n' up to and including _pos (or the current position if _pos is 0).
 	int getLineCount(const char* _pos = nullptr) const;
 
+	// Return # of chars between the start of the line containing _pos (or the current position if _pos is 0) and _pos.
+	int getColumnCount(const char* _pos = nullptr) const;
+
 	// Return # of chars between the start of the string and the current position.
 	int getCharCount() const { return (int)(m_pos - m_start); }
 
@@ -65,13 +85,30 @@ public:
 	// first whitespace character immediately after the region. If the functions return false the current
 	// position is unchanged.
 	bool readNextBool(bool& out_);      // accepts 't', 'f', 'true', 'false', '1', '0'  
-	bool readNextDouble(double& out_);  // strtod
-	bool readNextInt(long int& out_);   // strtol
-	bool compareNext(const char* _str);
+	bool readNextDouble(double& out_);  // ParseDouble
+	bool readNextInt(long int& out_);   // ParseInt
+	bool compareNext(const char* _str)                          { return compareNext(StringView(_str)); }
+	bool compareNext(const StringView& _str);
 
 private:
-	const char* m_start;
-	const char* m_pos;
+	const char*  m_start;
+	const char*  m_pos;
+	sint         m_lineCount;  // # of '\n' in [m_start, m_pos), or -1 if not counting
+
+	mutable eastl::vector<uint> m_lineEnds;     // offsets of '\n' in [m_start, m_indexEnd)
+	mutable const char*         m_indexEnd;
+
+	void setPos(const char* _pos)
+	{
+		if (m_lineCount >= 0) {
+			updateLineCount(_pos);
+		}
+		m_pos = _pos;
+	}
+	void updateLineCount(const char* _pos);
+
+	// Extend the line index to cover [m_start, _end) (or to the end of the string).
+	void indexLines(const char* _end) const;
 
 };
 
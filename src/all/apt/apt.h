@@ -1,6 +1,6 @@
 #pragma once
 
-#define APT_VERSION "0.14"
+#define APT_VERSION "0.39"
 
 #include <apt/config.h>
 
@@ -115,6 +115,7 @@ class FileSystem;
 class Image;
 class Ini;
 class Json;
+class MemoryArena;
 class MemoryPool;
 template <typename tType> class PersistentVector;
 template <typename tType> class Pool;
@@ -124,7 +125,9 @@ class Serializer;
 	class SerializerJson;
 class StringBase;
 	template <uint kCapacity> class String;
+	class StringBuilder;
 class StringHash;
+class StringView;
 class TextParser;
 class Timestamp;
 class DateTime;
@@ -0,0 +1,313 @@
+#include <apt/base64.h>
+
+#if !APT_DISABLE_SIMD
+	#if APT_COMPILER_MSVC
+		#include <intrin.h>
+	#else
+		#include <immintrin.h>
+	#endif
+#endif
+
+using namespace apt;
+
+static const char kBase64Alphabet[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	"abcdefghijklmnopqrstuvwxyz"
+	"0123456789+/"
+	;
+
+// Map chars to 6 bit values, invalid chars map to 0xff.
+struct Base64DecodeTable
+{
+	uint8 m_values[256];
+
+	Base64DecodeTable()
+	{
+		for (int i = 0; i < 256; ++i) {
+			m_values[i] = 0xff;
+		}
+		for (int i = 0; i < 64; ++i) {
+			m_values[(uint8)kBase64Alphabet[i]] = (uint8)i;
+		}
+	}
+};
+
+// Return _sizeBytes minus any padding at the end of _in.
+static inline uint StripPadding(const char* _in, uint _sizeBytes)
+{
+	for (int i = 0; i < 2 && _sizeBytes > 0 && _in[_sizeBytes - 1] == '='; ++i) {
+		--_sizeBytes;
+	}
+	return _sizeBytes;
+}
+
+// PUBLIC
+
+uint apt::Base64EncodedSize(uint _sizeBytes)
+{
+	return (_sizeBytes + 2) / 3 * 4;
+}
+
+uint apt::Base64DecodedSize(const char* _in, uint _sizeBytes)
+{
+	uint n = StripPadding(_in, _sizeBytes);
+	uint rem = n % 4;
+	return n / 4 * 3 + (rem ? rem - 1 : 0);
+}
+
+/*******************************************************************************
+
+                                  scalar
+
+*******************************************************************************/
+
+uint internal::scalar::Base64Encode(const void* _in, uint _sizeBytes, char* out_)
+{
+	const uint8* in = (const uint8*)_in;
+	char* out = out_;
+	uint i = 0;
+	for (; i + 3 <= _sizeBytes; i += 3) {
+		uint32 v = (uint32)in[i] << 16 | (uint32)in[i + 1] << 8 | (uint32)in[i + 2];
+		out[0] = kBase64Alphabet[(v >> 18) & 0x3f];
+		out[1] = kBase64Alphabet[(v >> 12) & 0x3f];
+		out[2] = kBase64Alphabet[(v >> 6) & 0x3f];
+		out[3] = kBase64Alphabet[v & 0x3f];
+		out += 4;
+	}
+	uint rem = _sizeBytes - i;
+	if (rem) {
+		uint32 v = (uint32)in[i] << 16 | (rem == 2 ? (uint32)in[i + 1] << 8 : 0);
+		out[0] = kBase64Alphabet[(v >> 18) & 0x3f];
+		out[1] = kBase64Alphabet[(v >> 12) & 0x3f];
+		out[2] = rem == 2 ? kBase64Alphabet[(v >> 6) & 0x3f] : '=';
+		out[3] = '=';
+		out += 4;
+	}
+	return (uint)(out - out_);
+}
+
+bool internal::scalar::Base64Decode(const char* _in, uint _sizeBytes, void* out_)
+{
+	static const Base64DecodeTable s_table;
+	const uint8* in = (const uint8*)_in;
+	uint8* out = (uint8*)out_;
+	uint n = StripPadding(_in, _sizeBytes);
+	if (n % 4 == 1) {
+		return false;
+	}
+	uint i = 0;
+	for (; i + 4 <= n; i += 4) {
+		uint32 a = s_table.m_values[in[i]];
+		uint32 b = s_table.m_values[in[i + 1]];
+		uint32 c = s_table.m_values[in[i + 2]];
+		uint32 d = s_table.m_values[in[i + 3]];
+		if ((a | b | c | d) & 0x80) {
+			return false;
+		}
+		uint32 v = a << 18 | b << 12 | c << 6 | d;
+		out[0] = (uint8)(v >> 16);
+		out[1] = (uint8)(v >> 8);
+		out[2] = (uint8)v;
+		out += 3;
+	}
+	uint rem = n - i;
+	if (rem) {
+		uint32 a = s_table.m_values[in[i]];
+		uint32 b = s_table.m_values[in[i + 1]];
+		uint32 c = rem == 3 ? s_table.m_values[in[i + 2]] : 0;
+		if ((a | b | c) & 0x80) {
+			return false;
+		}
+		uint32 v = a << 18 | b << 12 | c << 6;
+		out[0] = (uint8)(v >> 16);
+		if (rem == 3) {
+			out[1] = (uint8)(v >> 8);
+		}
+	}
+	return true;
+}
+
+/*******************************************************************************
+
+                                   SIMD
+
+*******************************************************************************/
+
+// GCC requires the build to target SSSE3 for the intrinsics to be available, MSVC checks the CPU at runtime.
+#if APT_DISABLE_SIMD || (APT_COMPILER_GNU && !defined(__SSSE3__))
+
+uint apt::Base64Encode(const void* _in, uint _sizeBytes, char* out_)   { return internal::scalar::Base64Encode(_in, _sizeBytes, out_); }
+bool apt::Base64Decode(const char* _in, uint _sizeBytes, void* out_)   { return internal::scalar::Base64Decode(_in, _sizeBytes, out_); }
+
+#else
+
+// Vectorized as per http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html and
+// http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html. The kernels operate independently on each 128 bit lane
+// (3 input bytes <-> 4 chars, 12 bytes <-> 16 chars per lane), hence are written once for __m128i and __m256i.
+
+static inline __m128i Shuffle(__m128i _v, __m128i _idx)   { return _mm_shuffle_epi8(_v, _idx);   }
+static inline __m128i And(__m128i _a, __m128i _b)         { return _mm_and_si128(_a, _b);        }
+static inline __m128i Or(__m128i _a, __m128i _b)          { return _mm_or_si128(_a, _b);         }
+static inline __m128i Add(__m128i _a, __m128i _b)         { return _mm_add_epi8(_a, _b);         }
+static inline __m128i SubSatU(__m128i _a, __m128i _b)     { return _mm_subs_epu8(_a, _b);        }
+static inline __m128i CmpEq(__m128i _a, __m128i _b)       { return _mm_cmpeq_epi8(_a, _b);       }
+static inline __m128i CmpGt(__m128i _a, __m128i _b)       { return _mm_cmpgt_epi8(_a, _b);       }
+static inline __m128i MulHiU16(__m128i _a, __m128i _b)    { return _mm_mulhi_epu16(_a, _b);      }
+static inline __m128i MulLo16(__m128i _a, __m128i _b)     { return _mm_mullo_epi16(_a, _b);      }
+static inline __m128i MAddU8(__m128i _a, __m128i _b)      { return _mm_maddubs_epi16(_a, _b);    }
+static inline __m128i MAdd16(__m128i _a, __m128i _b)      { return _mm_madd_epi16(_a, _b);       }
+static inline __m128i Srl32(__m128i _v, int _n)           { return _mm_srli_epi32(_v, _n);       }
+static inline uint32  Mask(__m128i _v)                    { return (uint32)_mm_movemask_epi8(_v); }
+static inline void    Broadcast(__m128i& ret_, __m128i _v) { ret_ = _v; }
+
+#if defined(__AVX2__)
+static inline __m256i Shuffle(__m256i _v, __m256i _idx)   { return _mm256_shuffle_epi8(_v, _idx);   }
+static inline __m256i And(__m256i _a, __m256i _b)         { return _mm256_and_si256(_a, _b);        }
+static inline __m256i Or(__m256i _a, __m256i _b)          { return _mm256_or_si256(_a, _b);         }
+static inline __m256i Add(__m256i _a, __m256i _b)         { return _mm256_add_epi8(_a, _b);         }
+static inline __m256i SubSatU(__m256i _a, __m256i _b)     { return _mm256_subs_epu8(_a, _b);        }
+static inline __m256i CmpEq(__m256i _a, __m256i _b)       { return _mm256_cmpeq_epi8(_a, _b);       }
+static inline __m256i CmpGt(__m256i _a, __m256i _b)       { return _mm256_cmpgt_epi8(_a, _b);       }
+static inline __m256i MulHiU16(__m256i _a, __m256i _b)    { return _mm256_mulhi_epu16(_a, _b);      }
+static inline __m256i MulLo16(__m256i _a, __m256i _b)     { return _mm256_mullo_epi16(_a, _b);      }
+static inline __m256i MAddU8(__m256i _a, __m256i _b)      { return _mm256_maddubs_epi16(_a, _b);    }
+static inline __m256i MAdd16(__m256i _a, __m256i _b)      { return _mm256_madd_epi16(_a, _b);       }
+static inline __m256i Srl32(__m256i _v, int _n)           { return _mm256_srli_epi32(_v, _n);       }
+static inline uint32  Mask(__m256i _v)                    { return (uint32)_mm256_movemask_epi8(_v); }
+static inline void    Broadcast(__m256i& ret_, __m128i _v) { ret_ = _mm256_broadcastsi128_si256(_v); }
+#endif
+
+template <typename tVec>
+static inline tVec Lanes(__m128i _v)
+{
+	tVec ret;
+	Broadcast(ret, _v);
+	return ret;
+}
+
+// 12 bytes at the start of each lane of _in -> 16 chars.
+template <typename tVec>
+static inline tVec EncodeLanes(tVec _in)
+{
+ // split each 3 byte group into 4 6 bit indices, 1 per byte
+	tVec v = Shuffle(_in, Lanes<tVec>(_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10)));
+	tVec t0 = MulHiU16(And(v, Lanes<tVec>(_mm_set1_epi32(0x0fc0fc00))), Lanes<tVec>(_mm_set1_epi32(0x04000040)));
+	tVec t1 = MulLo16(And(v, Lanes<tVec>(_mm_set1_epi32(0x003f03f0))), Lanes<tVec>(_mm_set1_epi32(0x01000010)));
+	tVec idx = Or(t0, t1);
+
+ // map index ranges [0,25] [26,51] [52,61] 62 63 to offsets from the index to the char
+	tVec range = SubSatU(idx, Lanes<tVec>(_mm_set1_epi8(51)));
+	range = Or(range, And(CmpGt(Lanes<tVec>(_mm_set1_epi8(26)), idx), Lanes<tVec>(_mm_set1_epi8(13))));
+	const __m128i offsets = _mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+		);
+	return Add(idx, Shuffle(Lanes<tVec>(offsets), range));
+}
+
+// 16 chars per lane -> 12 bytes at the start of each lane. Return false if _in contains invalid chars.
+template <typename tVec>
+static inline bool DecodeLanes(tVec _in, tVec& out_)
+{
+	const tVec nibbleMask = Lanes<tVec>(_mm_set1_epi8(0x0f));
+	tVec hi = And(Srl32(_in, 4), nibbleMask);
+	tVec lo = And(_in, nibbleMask);
+
+ // validate: for each low nibble, a bitmask of the high nibbles which form a valid char
+	const __m128i validHi = _mm_setr_epi8(
+		(char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+		(char)0xf8, (char)0xf8, (char)0xf0, (char)0x54, (char)0x50, (char)0x50, (char)0x50, (char)0x54
+		);
+	const __m128i hiBit = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0);
+	tVec valid = And(Shuffle(Lanes<tVec>(validHi), lo), Shuffle(Lanes<tVec>(hiBit), hi));
+	if (Mask(CmpEq(valid, Lanes<tVec>(_mm_setzero_si128())))) {
+		return false;
+	}
+
+ // char -> 6 bit value, offset by high nibble except '/' which shares a high nibble with '+'
+	const __m128i offsets = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	tVec offset = Shuffle(Lanes<tVec>(offsets), hi);
+	offset = Add(offset, And(CmpEq(_in, Lanes<tVec>(_mm_set1_epi8('/'))), Lanes<tVec>(_mm_set1_epi8(-3))));
+	tVec v = Add(_in, offset);
+
+ // pack 4 6 bit values -> 3 bytes
+	v = MAddU8(v, Lanes<tVec>(_mm_set1_epi32(0x01400140)));
+	v = MAdd16(v, Lanes<tVec>(_mm_set1_epi32(0x00011000)));
+	out_ = Shuffle(v, Lanes<tVec>(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+	return true;
+}
+
+static bool CpuHasSsse3()
+{
+#if defined(__SSSE3__)
+	return true;
+#else
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#endif
+}
+
+static bool UseSimd()
+{
+	static const bool s_ret = CpuHasSsse3();
+	return s_ret;
+}
+
+uint apt::Base64Encode(const void* _in, uint _sizeBytes, char* out_)
+{
+	if (!UseSimd()) {
+		return internal::scalar::Base64Encode(_in, _sizeBytes, out_);
+	}
+	const char* in = (const char*)_in;
+	char* out = out_;
+	uint i = 0;
+ // each block reads 4 bytes beyond the 12 (or 24) which are encoded
+#if defined(__AVX2__)
+	for (; i + 28 <= _sizeBytes; i += 24) {
+		__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in + i))), _mm_loadu_si128((const __m128i*)(in + i + 12)), 1);
+		_mm256_storeu_si256((__m256i*)out, EncodeLanes(v));
+		out += 32;
+	}
+#endif
+	for (; i + 16 <= _sizeBytes; i += 12) {
+		_mm_storeu_si128((__m128i*)out, EncodeLanes(_mm_loadu_si128((const __m128i*)(in + i))));
+		out += 16;
+	}
+	out += internal::scalar::Base64Encode(in + i, _sizeBytes - i, out);
+	return (uint)(out - out_);
+}
+
+bool apt::Base64Decode(const char* _in, uint _sizeBytes, void* out_)
+{
+	if (!UseSimd()) {
+		return internal::scalar::Base64Decode(_in, _sizeBytes, out_);
+	}
+	uint n = StripPadding(_in, _sizeBytes);
+	uint outSize = n / 4 * 3;
+	char* out = (char*)out_;
+	uint i = 0;
+ // each block writes 4 bytes beyond the 12 (or 24) which are decoded, which must be within out_
+#if defined(__AVX2__)
+	for (; i + 32 <= n && (uint)(out - (char*)out_) + 28 <= outSize; i += 32) {
+		__m256i v;
+		if (!DecodeLanes(_mm256_loadu_si256((const __m256i*)(_in + i)), v)) {
+			return false;
+		}
+		_mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(v));
+		_mm_storeu_si128((__m128i*)(out + 12), _mm256_extracti128_si256(v, 1));
+		out += 24;
+	}
+#endif
+	for (; i + 16 <= n && (uint)(out - (char*)out_) + 16 <= outSize; i += 16) {
+		__m128i v;
+		if (!DecodeLanes(_mm_loadu_si128((const __m128i*)(_in + i)), v)) {
+			return false;
+		}
+		_mm_storeu_si128((__m128i*)out, v);
+		out += 12;
+	}
+	return internal::scalar::Base64Decode(_in + i, _sizeBytes - i, out);
+}
+
+#endif
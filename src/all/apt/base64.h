@@ -0,0 +1,38 @@
+#pragma once
+
+#include <apt/apt.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Base64 encode/decode (RFC 4648, standard alphabet). SSSE3 is used if the CPU
+// supports it, AVX2 if the build targets it (i.e. __AVX2__ is defined). Define
+// APT_DISABLE_SIMD to use the scalar versions.
+//
+// Encoded output is padded with '='. Decoding accepts padded or unpadded input
+// but no whitespace or line breaks.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace apt {
+
+// Return the size of the encoded output for _sizeBytes of input (excluding any null terminator).
+uint Base64EncodedSize(uint _sizeBytes);
+
+// Return the size of the decoded output for _sizeBytes of encoded input (only the padding at the end of _in is read).
+uint Base64DecodedSize(const char* _in, uint _sizeBytes);
+
+// Encode _sizeBytes from _in to out_, which must be at least Base64EncodedSize(_sizeBytes) bytes. No null terminator
+// is written. Return the number of chars written.
+uint Base64Encode(const void* _in, uint _sizeBytes, char* out_);
+
+// Decode _sizeBytes from _in to out_, which must be at least Base64DecodedSize(_in, _sizeBytes) bytes. Return false
+// if _in contains invalid characters, in which case the contents of out_ are undefined.
+bool Base64Decode(const char* _in, uint _sizeBytes, void* out_);
+
+namespace internal { namespace scalar {
+
+// Scalar reference implementations of the above.
+uint Base64Encode(const void* _in, uint _sizeBytes, char* out_);
+bool Base64Decode(const char* _in, uint _sizeBytes, void* out_);
+
+} } // namespace internal::scalar
+
+} // namespace apt
@@ -1,32 +1,1308 @@
 #include <apt/compress.h>
 
+#include <apt/hash.h>
+#include <apt/log.h>
+#include <apt/memory.h>
+#include <apt/File.h>
+#include <apt/FileSystem.h>
+
 #define MINIZ_IMPL
 #include <miniz.h>
 
+#include <EASTL/vector.h>
+
+#include <algorithm> // min, max
+#include <atomic>
+#include <cstddef> // offsetof
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <utility> // swap
+
 using namespace apt;
 
+static const uint kCompressorBufferSize = 64 * 1024;
+static const uint kFileChunkSize        = 32 * 1024;
+
+static int GetTdeflFlags(CompressionFlags _flags)
+{
+	APT_ASSERT(_flags != CompressionFlags_None); // the calling code should skip compression in this case
+
+	int level = _flags == CompressionFlags_Size ? MZ_DEFAULT_LEVEL : MZ_BEST_SPEED; // greedy parsing for levels <= 3
+	return (int)tdefl_create_comp_flags_from_zip_params(level, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+}
+
+// Per-thread codec state, allocated on first use and reused by subsequent calls on the same thread (tdefl_compressor is
+// ~300kb, hence allocating it per call dominates the cost of compressing small buffers).
+struct CodecContext
+{
+	tdefl_compressor*   m_compressor;
+	tinfl_decompressor* m_decompressor;
+	mz_uint8*           m_window;       // TINFL_LZ_DICT_SIZE ring buffer for DecompressTo() with a CompressionDictionary
+
+	CodecContext()
+		: m_compressor(nullptr)
+		, m_decompressor(nullptr)
+		, m_window(nullptr)
+	{
+	}
+
+	~CodecContext()
+	{
+		APT_FREE(m_window);
+		APT_FREE(m_decompressor);
+		APT_FREE(m_compressor);
+	}
+
+	static CodecContext& Get()
+	{
+		static APT_THREAD_LOCAL CodecContext s_context;
+		return s_context;
+	}
+
+	tdefl_compressor* getCompressor()
+	{
+		if (!m_compressor) {
+			m_compressor = (tdefl_compressor*)APT_MALLOC(sizeof(tdefl_compressor));
+			APT_ASSERT(m_compressor);
+		}
+		return m_compressor;
+	}
+
+	tinfl_decompressor* getDecompressor()
+	{
+		if (!m_decompressor) {
+			m_decompressor = (tinfl_decompressor*)APT_MALLOC(sizeof(tinfl_decompressor));
+			APT_ASSERT(m_decompressor);
+		}
+		return m_decompressor;
+	}
+
+	mz_uint8* getWindow()
+	{
+		if (!m_window) {
+			m_window = (mz_uint8*)APT_MALLOC(TINFL_LZ_DICT_SIZE);
+			APT_ASSERT(m_window);
+		}
+		return m_window;
+	}
+};
+
+// Compress _inSizeBytes from _in to out_ as a zlib stream, out_ must be at least mz_compressBound(_inSizeBytes). Return
+// the compressed size.
+static uint ZlibCompress(const void* _in, uint _inSizeBytes, void* out_, uint _outCapacity, int _tdeflFlags)
+{
+	tdefl_compressor* state = CodecContext::Get().getCompressor();
+	APT_VERIFY(tdefl_init(state, nullptr, nullptr, _tdeflFlags) == TDEFL_STATUS_OKAY);
+	size_t inSize  = _inSizeBytes;
+	size_t outSize = _outCapacity;
+	APT_VERIFY(tdefl_compress(state, _in, &inSize, out_, &outSize, TDEFL_FINISH) == TDEFL_STATUS_DONE);
+	return (uint)outSize;
+}
+
+// Decompress the zlib stream _in to out_. Return the decompressed size, or 0 if an error occurred or the output exceeds
+// _outCapacity.
+static uint ZlibDecompress(const void* _in, uint _inSizeBytes, void* out_, uint _outCapacity)
+{
+	tinfl_decompressor* state = CodecContext::Get().getDecompressor();
+	tinfl_init(state);
+	size_t inSize  = _inSizeBytes;
+	size_t outSize = _outCapacity;
+	tinfl_status status = tinfl_decompress(state,
+		(const mz_uint8*)_in, &inSize,
+		(mz_uint8*)out_, (mz_uint8*)out_, &outSize,
+		TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF
+		);
+	return status == TINFL_STATUS_DONE ? (uint)outSize : 0;
+}
+
+// Return the number of threads used to process _count items with _threadCount (0 = the number of hardware threads).
+static uint GetThreadCount(uint _count, uint _threadCount)
+{
+	if (_threadCount == 0) {
+		_threadCount = (uint)std::thread::hardware_concurrency();
+	}
+	return std::max((uint)1, std::min(_threadCount, _count));
+}
+
+// Call _func(i, threadIndex) for i in [0, _count) on up to _threadCount threads (0 = the number of hardware threads).
+// The calling thread is used as thread 0.
+template <typename tFunc>
+static void ParallelFor(uint _count, uint _threadCount, tFunc _func)
+{
+	_threadCount = GetThreadCount(_count, _threadCount);
+	if (_threadCount <= 1) {
+		for (uint i = 0; i < _count; ++i) {
+			_func(i, 0);
+		}
+		return;
+	}
+
+	std::atomic<uint> next(0);
+	auto worker = [&](uint _threadIndex) {
+		for (uint i = next++; i < _count; i = next++) {
+			_func(i, _threadIndex);
+		}
+	};
+	eastl::vector<std::thread> threads;
+	threads.reserve(_threadCount - 1);
+	for (uint i = 1; i < _threadCount; ++i) {
+		threads.emplace_back(worker, i);
+	}
+	worker(0);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+/*	Compression formats:
+
+	Header             CompressionFlags_Speed, CompressionFlags_Size
+	zlib stream
+
+	zlib stream        Compressor (no header, also the output of Compress() prior to v0.38)
+
+	Header             CompressionFlags_Fastest
+	LZ block           see LzCompress()
+
+	Header             Compress() with a CompressionDictionary (m_param is the dictionary hash)
+	deflate stream     no zlib header/checksum, see CompressionDictionary
+
+	BlockHeader        CompressBlocks()
+	uint64 offsets[m_blockCount + 1] // offset of each compressed block from the start of the data, the last is the end
+	blocks             zlib streams or LZ blocks (m_blockCodec)
+
+	Headers begin with kMagic which isn't a valid zlib header (the low 4 bits of the first byte must be 8).
+*/
+enum Codec
+{
+	Codec_Zlib       = 0,   // no header
+	Codec_ZlibSized  = 'Z',
+	Codec_Dict       = 'D',
+	Codec_Blocks     = 'B',
+	Codec_Lz         = 'L'
+};
+struct Header
+{
+	char   m_magic[3];
+	uint8  m_codec;
+	uint32 m_param;     // Codec_Blocks: block size
+	uint64 m_sizeBytes; // decompressed size
+};
+struct BlockHeader
+{
+	Header m_header;
+	uint32 m_blockCount;
+	uint32 m_blockCodec; // Codec_Zlib or Codec_Lz
+};
+static const char kMagic[3] = { 'A', 'P', 'T' };
+
+// Return the codec used for _in, read the header to header_ if there is one.
+static Codec ReadHeader(const void* _in, uint _inSizeBytes, Header& header_)
+{
+	if (_inSizeBytes < sizeof(Header) || memcmp(_in, kMagic, sizeof(kMagic)) != 0) {
+		return Codec_Zlib;
+	}
+	memcpy(&header_, _in, sizeof(header_));
+	return (Codec)header_.m_codec;
+}
+
+static void WriteHeader(void* out_, Codec _codec, uint32 _param, uint64 _sizeBytes)
+{
+	Header header;
+	memcpy(header.m_magic, kMagic, sizeof(kMagic));
+	header.m_codec     = (uint8)_codec;
+	header.m_param     = _param;
+	header.m_sizeBytes = _sizeBytes;
+	memcpy(out_, &header, sizeof(header));
+}
+
+static uint64 GetBlockOffset(const void* _in, uint _blockIndex)
+{
+	uint64 ret;
+	memcpy(&ret, (const char*)_in + sizeof(BlockHeader) + _blockIndex * sizeof(uint64), sizeof(uint64));
+	return ret;
+}
+
+// Read and validate the header and index size (but not the offsets).
+static bool ReadBlockHeader(const void* _in, uint _inSizeBytes, BlockHeader& header_)
+{
+	if (_inSizeBytes < sizeof(BlockHeader) || ReadHeader(_in, _inSizeBytes, header_.m_header) != Codec_Blocks) {
+		return false;
+	}
+	memcpy(&header_, _in, sizeof(header_));
+	uint64 blockSize = header_.m_header.m_param;
+	uint64 sizeBytes = header_.m_header.m_sizeBytes;
+	if (blockSize == 0 || sizeBytes > (uint64)~uint(0) || (header_.m_blockCodec != Codec_Zlib && header_.m_blockCodec != Codec_Lz)) {
+		return false;
+	}
+	uint64 blockCount = (sizeBytes + blockSize - 1) / blockSize;
+	uint64 indexEnd = sizeof(BlockHeader) + (blockCount + 1) * sizeof(uint64);
+	return header_.m_blockCount == blockCount && indexEnd <= _inSizeBytes;
+}
+
+/*	LZ block format (as LZ4, https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), a series of sequences:
+
+	token          high 4 bits: literal count, low 4 bits: match length - kLzMinMatch (15 = read additional bytes)
+	[uint8...]     additional literal count bytes, added to the count while == 255
+	literals
+	uint16         match offset (little-endian), 1-65535
+	[uint8...]     additional match length bytes, added to the length while == 255
+
+	The last sequence has only literals. The last match starts at least kLzMatchLimit bytes before the end of the data
+	and the last kLzLastLiterals bytes are always literals, which permits the decoder to copy 8/16 bytes at a time.
+*/
+static const uint kLzMinMatch     = 4;
+static const uint kLzLastLiterals = 5;
+static const uint kLzMatchLimit   = 12;
+static const uint kLzMaxOffset    = 65535;
+static const uint kLzHashBits     = 12;
+
+static inline uint32 LzRead32(const uint8* _p)
+{
+	uint32 ret;
+	memcpy(&ret, _p, sizeof(ret));
+	return ret;
+}
+
+static inline uint32 LzHash(uint32 _v)
+{
+	return (_v * 2654435761u) >> (32 - kLzHashBits);
+}
+
+static inline uint8* LzWriteLength(uint8* out_, uint _length)
+{
+	while (_length >= 255) {
+		*out_++ = 255;
+		_length -= 255;
+	}
+	*out_++ = (uint8)_length;
+	return out_;
+}
+
+// Return the maximum size of LzCompress() output for _sizeBytes of input.
+static uint LzCompressBound(uint _sizeBytes)
+{
+	return _sizeBytes + _sizeBytes / 255 + 16;
+}
+
+// Compress _inSizeBytes from _in to out_, which must be at least LzCompressBound(_inSizeBytes). Return the compressed
+// size. Greedy parsing with a single-entry hash table; the search step increases on incompressible data.
+static uint LzCompress(const void* _in, uint _inSizeBytes, void* out_)
+{
+	const uint8* in     = (const uint8*)_in;
+	const uint8* inEnd  = in + _inSizeBytes;
+	const uint8* ip     = in;
+	const uint8* anchor = in; // start of pending literals
+	uint8*       op     = (uint8*)out_;
+
+	if (_inSizeBytes > kLzMatchLimit) {
+		const uint8* matchLimit = inEnd - kLzMatchLimit;  // last match start
+		const uint8* copyLimit  = inEnd - kLzLastLiterals; // last match end
+		uint32 table[1 << kLzHashBits] = {}; // offsets from in; positions > 4GB alias but matches are verified
+		for (;;) {
+		 // find a match
+			const uint8* match;
+			uint searchCount = 1 << 6;
+			for (;;) {
+				if (ip > matchLimit) {
+					goto LzCompress_end;
+				}
+				uint32 h = LzHash(LzRead32(ip));
+				match = in + table[h];
+				table[h] = (uint32)(ip - in);
+				if (match < ip && (uint)(ip - match) <= kLzMaxOffset && LzRead32(match) == LzRead32(ip)) {
+					break;
+				}
+				ip += searchCount++ >> 6;
+			}
+			while (ip > anchor && match > in && ip[-1] == match[-1]) {
+				--ip;
+				--match;
+			}
+
+		 // literals
+			uint8* token = op++;
+			uint literalCount = (uint)(ip - anchor);
+			if (literalCount >= 15) {
+				*token = 15 << 4;
+				op = LzWriteLength(op, literalCount - 15);
+			} else {
+				*token = (uint8)(literalCount << 4);
+			}
+			memcpy(op, anchor, literalCount);
+			op += literalCount;
+
+		 // match
+			uint offset = (uint)(ip - match);
+			*op++ = (uint8)offset;
+			*op++ = (uint8)(offset >> 8);
+			ip += kLzMinMatch;
+			match += kLzMinMatch;
+			const uint8* matchBegin = ip;
+			while (ip + sizeof(uint64) <= copyLimit) {
+				uint64 a, b;
+				memcpy(&a, ip, sizeof(a));
+				memcpy(&b, match, sizeof(b));
+				if (a != b) {
+					break;
+				}
+				ip += sizeof(uint64);
+				match += sizeof(uint64);
+			}
+			while (ip < copyLimit && *ip == *match) {
+				++ip;
+				++match;
+			}
+			uint matchLength = (uint)(ip - matchBegin);
+			if (matchLength >= 15) {
+				*token |= 15;
+				op = LzWriteLength(op, matchLength - 15);
+			} else {
+				*token |= (uint8)matchLength;
+			}
+			anchor = ip;
+			if (ip > matchLimit) {
+				break;
+			}
+			table[LzHash(LzRead32(ip - 2))] = (uint32)(ip - 2 - in);
+		}
+	}
+
+LzCompress_end:
+	uint literalCount = (uint)(inEnd - anchor);
+	if (literalCount >= 15) {
+		*op++ = 15 << 4;
+		op = LzWriteLength(op, literalCount - 15);
+	} else {
+		*op++ = (uint8)(literalCount << 4);
+	}
+	memcpy(op, anchor, literalCount);
+	op += literalCount;
+	return (uint)(op - (uint8*)out_);
+}
+
+// Read an additional literal count/match length (see the LZ block format), return false if the end of the input is reached.
+static inline bool LzReadLength(const uint8*& _in_, const uint8* _inEnd, uint& length_)
+{
+	uint8 b;
+	do {
+		if (_in_ >= _inEnd) {
+			return false;
+		}
+		b = *_in_++;
+		length_ += b;
+	} while (b == 255);
+	return true;
+}
+
+// Decompress _in to out_, which must be exactly _outSizeBytes. Return false if _in is invalid.
+static bool LzDecompress(const void* _in, uint _inSizeBytes, void* out_, uint _outSizeBytes)
+{
+	const uint8* ip     = (const uint8*)_in;
+	const uint8* inEnd  = ip + _inSizeBytes;
+	uint8*       out    = (uint8*)out_;
+	uint8*       op     = out;
+	uint8*       outEnd = out + _outSizeBytes;
+
+	for (;;) {
+		if (ip >= inEnd) {
+			return false;
+		}
+		uint token = *ip++;
+		uint count = token >> 4;
+		uint offset;
+
+	 // short literals and match with room to copy 16 + 18 bytes: no additional length bytes or bounds checks
+		if (count < 15 && (token & 15) < 15 && inEnd - ip >= 18 && outEnd - op >= 32) {
+			memcpy(op, ip, 16);
+			ip += count;
+			op += count;
+			offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			count = (token & 15) + kLzMinMatch;
+			if (offset >= 8 && offset <= (uint)(op - out)) {
+				const uint8* match = op - offset;
+				memcpy(op,      match,      8);
+				memcpy(op + 8,  match + 8,  8);
+				memcpy(op + 16, match + 16, 2);
+				op += count;
+				continue;
+			}
+		} else {
+		 // literals
+			if (count == 15 && !LzReadLength(ip, inEnd, count)) {
+				return false;
+			}
+			if ((uint)(inEnd - ip) < count || (uint)(outEnd - op) < count) {
+				return false;
+			}
+			if (count <= 16 && inEnd - ip >= 16 && outEnd - op >= 16) {
+				memcpy(op, ip, 16);
+			} else {
+				memcpy(op, ip, count);
+			}
+			ip += count;
+			op += count;
+			if (ip == inEnd) {
+				return op == outEnd; // last sequence
+			}
+
+		 // match
+			if (inEnd - ip < 2) {
+				return false;
+			}
+			offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			count = token & 15;
+			if (count == 15 && !LzReadLength(ip, inEnd, count)) {
+				return false;
+			}
+			count += kLzMinMatch;
+		}
+
+		if (offset == 0 || offset > (uint)(op - out) || (uint)(outEnd - op) < count) {
+			return false;
+		}
+		const uint8* match = op - offset;
+		uint8* copyEnd = op + count;
+		if (offset >= 8 && (uint)(outEnd - copyEnd) >= 8) {
+			do {
+				memcpy(op, match, 8);
+				op += 8;
+				match += 8;
+			} while (op < copyEnd);
+		} else if (offset == 1) {
+			memset(op, *match, count);
+		} else {
+			while (op < copyEnd) {
+				*op++ = *match++;
+			}
+		}
+		op = copyEnd;
+	}
+}
+
+// Decompress all blocks to out_, which must be at least _info.m_sizeBytes. Return false if an error occurred.
+static bool DecompressBlocksTo(const void* _in, uint _inSizeBytes, const CompressedBlockInfo& _info, void* out_, uint _threadCount)
+{
+	std::atomic<bool> ret(true);
+	ParallelFor(_info.m_blockCount, _threadCount, [&](uint _blockIndex, uint /*_threadIndex*/) {
+			char* block = (char*)out_ + _blockIndex * _info.m_blockSizeBytes;
+			uint size = std::min(_info.m_blockSizeBytes, _info.m_sizeBytes - _blockIndex * _info.m_blockSizeBytes);
+			if (DecompressBlock(_in, _inSizeBytes, _blockIndex, block, size) != size) {
+				ret = false;
+			}
+		});
+	return ret;
+}
+
 void apt::Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags)
 {
 	APT_ASSERT(_in);
 	APT_ASSERT(_inSizeBytes);
 	APT_ASSERT(!out_);
-	APT_ASSERT(_flags != CompressionFlags_None); // the calling code should skip calling Compress in this case
 
-	int tdeflFlags = TDEFL_WRITE_ZLIB_HEADER;
-	if (_flags & CompressionFlags_Speed) {
-		tdeflFlags |= TDEFL_GREEDY_PARSING_FLAG;
+	uint capacity = _flags == CompressionFlags_Fastest ? LzCompressBound(_inSizeBytes) : (uint)mz_compressBound(_inSizeBytes);
+	char* out = (char*)malloc(sizeof(Header) + capacity);
+	APT_ASSERT(out);
+	if (_flags == CompressionFlags_Fastest) {
+		WriteHeader(out, Codec_Lz, 0, _inSizeBytes);
+		outSizeBytes_ = sizeof(Header) + LzCompress(_in, _inSizeBytes, out + sizeof(Header));
+	} else {
+		WriteHeader(out, Codec_ZlibSized, 0, _inSizeBytes);
+		outSizeBytes_ = sizeof(Header) + ZlibCompress(_in, _inSizeBytes, out + sizeof(Header), capacity, GetTdeflFlags(_flags));
 	}
-	out_ = tdefl_compress_mem_to_heap(_in, _inSizeBytes, &outSizeBytes_, tdeflFlags);
-	APT_ASSERT(out_);
+	out_ = realloc(out, outSizeBytes_);
 }
 
 void apt::Decompress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_)
+{
+	APT_ASSERT(_in);
+	APT_ASSERT(!out_);
+
+	outSizeBytes_ = 0;
+	if (_inSizeBytes == 0) {
+		return;
+	}
+	Header header;
+	switch (ReadHeader(_in, _inSizeBytes, header)) {
+		case Codec_Zlib:
+			out_ = tinfl_decompress_mem_to_heap(_in, _inSizeBytes, &outSizeBytes_, TINFL_FLAG_PARSE_ZLIB_HEADER);
+			break;
+		case Codec_Blocks:
+			DecompressBlocks(_in, _inSizeBytes, out_, outSizeBytes_);
+			break;
+		case Codec_ZlibSized:
+		case Codec_Lz:
+			if (header.m_sizeBytes <= (uint64)~uint(0)) {
+				outSizeBytes_ = (uint)header.m_sizeBytes;
+				out_ = malloc(std::max(outSizeBytes_, (uint)1));
+				APT_ASSERT(out_);
+				if (DecompressTo(_in, _inSizeBytes, out_, outSizeBytes_) != outSizeBytes_) {
+					free(out_);
+					out_ = nullptr;
+				}
+			}
+			break;
+		default:
+			break;
+	}
+	if (!out_) {
+		outSizeBytes_ = 0; // invalid input, not asserted since _in is usually external data
+	}
+}
+
+uint apt::DecompressTo(const void* _in, uint _inSizeBytes, void* out_, uint _outCapacity)
+{
+	APT_ASSERT(_in);
+	APT_ASSERT(out_);
+
+	Header header;
+	Codec codec = ReadHeader(_in, _inSizeBytes, header);
+	if (codec == Codec_Zlib) {
+		return ZlibDecompress(_in, _inSizeBytes, out_, _outCapacity);
+	}
+	if (header.m_sizeBytes > _outCapacity) {
+		return 0;
+	}
+	uint size = (uint)header.m_sizeBytes;
+	const char* in = (const char*)_in + sizeof(Header);
+	uint inSize = _inSizeBytes - sizeof(Header);
+	switch (codec) {
+		case Codec_ZlibSized:
+			return ZlibDecompress(in, inSize, out_, size) == size ? size : 0;
+		case Codec_Lz:
+			return LzDecompress(in, inSize, out_, size) ? size : 0;
+		case Codec_Blocks: {
+			CompressedBlockInfo info;
+			if (!GetCompressedBlockInfo(_in, _inSizeBytes, info)) {
+				return 0;
+			}
+			return DecompressBlocksTo(_in, _inSizeBytes, info, out_, 1) ? size : 0; // calling thread only, no threads are started
+		}
+		default:
+			return 0;
+	}
+}
+
+uint apt::GetDecompressedSize(const void* _in, uint _inSizeBytes)
+{
+	Header header;
+	if (ReadHeader(_in, _inSizeBytes, header) == Codec_Zlib || header.m_sizeBytes > (uint64)~uint(0)) {
+		return 0;
+	}
+	return (uint)header.m_sizeBytes;
+}
+
+void apt::CompressBlocks(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags, uint _blockSizeBytes, uint _threadCount)
 {
 	APT_ASSERT(_in);
 	APT_ASSERT(_inSizeBytes);
 	APT_ASSERT(!out_);
+	APT_ASSERT(_blockSizeBytes > 0 && (uint64)_blockSizeBytes <= 0xffffffffull);
+
+	uint blockCount = (_inSizeBytes + _blockSizeBytes - 1) / _blockSizeBytes;
+	Codec blockCodec = _flags == CompressionFlags_Fastest ? Codec_Lz : Codec_Zlib;
+	int tdeflFlags = blockCodec == Codec_Zlib ? GetTdeflFlags(_flags) : 0;
+
+ // compress each block to a separate buffer
+	eastl::vector<eastl::vector<char> > blocks(blockCount);
+	ParallelFor(blockCount, _threadCount, [&](uint _blockIndex, uint /*_threadIndex*/) {
+			uint offset = _blockIndex * _blockSizeBytes;
+			uint size = std::min(_blockSizeBytes, _inSizeBytes - offset);
+			eastl::vector<char>& block = blocks[_blockIndex];
+			if (blockCodec == Codec_Lz) {
+				block.resize(LzCompressBound(size));
+				block.resize(LzCompress((const char*)_in + offset, size, block.data()));
+				return;
+			}
+			block.resize((uint)mz_compressBound(size));
+			block.resize(ZlibCompress((const char*)_in + offset, size, block.data(), (uint)block.size(), tdeflFlags));
+		});
+
+ // write the header, index and blocks
+	uint64 offset = sizeof(BlockHeader) + (blockCount + 1) * sizeof(uint64);
+	uint64 totalSize = offset;
+	for (auto& block : blocks) {
+		totalSize += block.size();
+	}
+	APT_ASSERT(totalSize <= (uint64)~uint(0));
+	char* out = (char*)malloc((size_t)totalSize);
+	APT_ASSERT(out);
+	BlockHeader header;
+	WriteHeader(&header.m_header, Codec_Blocks, (uint32)_blockSizeBytes, _inSizeBytes);
+	header.m_blockCount = (uint32)blockCount;
+	header.m_blockCodec = blockCodec;
+	memcpy(out, &header, sizeof(header));
+	uint64* index = (uint64*)(out + sizeof(header));
+	for (uint i = 0; i < blockCount; ++i) {
+		index[i] = offset;
+		memcpy(out + offset, blocks[i].data(), blocks[i].size());
+		offset += blocks[i].size();
+	}
+	index[blockCount] = offset;
+
+	out_ = out;
+	outSizeBytes_ = (uint)totalSize;
+}
+
+bool apt::DecompressBlocks(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, uint _threadCount)
+{
+	APT_ASSERT(!out_);
+
+	CompressedBlockInfo info;
+	if (!GetCompressedBlockInfo(_in, _inSizeBytes, info)) {
+		return false;
+	}
+	char* out = (char*)malloc(std::max(info.m_sizeBytes, (uint)1));
+	APT_ASSERT(out);
+	if (!DecompressBlocksTo(_in, _inSizeBytes, info, out, _threadCount)) {
+		free(out);
+		return false;
+	}
+	out_ = out;
+	outSizeBytes_ = info.m_sizeBytes;
+	return true;
+}
+
+bool apt::GetCompressedBlockInfo(const void* _in, uint _inSizeBytes, CompressedBlockInfo& info_)
+{
+	BlockHeader header;
+	if (!ReadBlockHeader(_in, _inSizeBytes, header)) {
+		return false;
+	}
+	uint64 indexEnd = sizeof(BlockHeader) + ((uint64)header.m_blockCount + 1) * sizeof(uint64);
+	if (GetBlockOffset(_in, 0) != indexEnd || GetBlockOffset(_in, header.m_blockCount) > _inSizeBytes) {
+		return false;
+	}
+	for (uint i = 0; i < header.m_blockCount; ++i) {
+		if (GetBlockOffset(_in, i) > GetBlockOffset(_in, i + 1)) {
+			return false;
+		}
+	}
+	info_.m_sizeBytes      = (uint)header.m_header.m_sizeBytes;
+	info_.m_blockSizeBytes = header.m_header.m_param;
+	info_.m_blockCount     = header.m_blockCount;
+	return true;
+}
+
+uint apt::DecompressBlock(const void* _in, uint _inSizeBytes, uint _blockIndex, void* out_, uint _outCapacity)
+{
+	BlockHeader header;
+	if (!ReadBlockHeader(_in, _inSizeBytes, header) || _blockIndex >= header.m_blockCount) {
+		return 0;
+	}
+	uint64 begin = GetBlockOffset(_in, _blockIndex);
+	uint64 end   = GetBlockOffset(_in, _blockIndex + 1);
+	if (begin > end || end > _inSizeBytes) {
+		return 0;
+	}
+	uint64 blockSize = header.m_header.m_param;
+	uint64 size = std::min(blockSize, header.m_header.m_sizeBytes - (uint64)_blockIndex * blockSize);
+	if (size > _outCapacity) {
+		return 0;
+	}
+	if (header.m_blockCodec == Codec_Lz) {
+		return LzDecompress((const char*)_in + begin, (uint)(end - begin), out_, (uint)size) ? (uint)size : 0;
+	}
+	return ZlibDecompress((const char*)_in + begin, (uint)(end - begin), out_, (uint)size) == size ? (uint)size : 0;
+}
+
+/*******************************************************************************
+
+                                 Compressor
+
+*******************************************************************************/
+
+// PUBLIC
 
-	int tinflFlags = TINFL_FLAG_PARSE_ZLIB_HEADER;
-	out_ = tinfl_decompress_mem_to_heap(_in, _inSizeBytes, &outSizeBytes_, tinflFlags);
+Compressor::Compressor(CompressionFlags _flags)
+	: m_bufBegin(0)
+	, m_bufEnd(0)
+	, m_bufCapacity(kCompressorBufferSize)
+	, m_finished(false)
+	, m_done(false)
+{
+	m_state = APT_MALLOC(sizeof(tdefl_compressor)); // ~300kb, too big for the stack
+	m_buf   = (char*)APT_MALLOC(m_bufCapacity);
+	APT_VERIFY(tdefl_init((tdefl_compressor*)m_state, PutBuf, this, GetTdeflFlags(_flags)) == TDEFL_STATUS_OKAY);
+}
+
+Compressor::~Compressor()
+{
+	APT_FREE(m_buf);
+	APT_FREE(m_state);
+}
+
+uint Compressor::feed(const void* _in, uint _inSizeBytes)
+{
+	APT_ASSERT(!m_finished);
+	const char* in = (const char*)_in;
+	uint ret = 0;
+	while (ret < _inSizeBytes && (m_bufEnd - m_bufBegin) < kCompressorBufferSize) {
+		uint n = std::min(_inSizeBytes - ret, kCompressorBufferSize);
+		process(in + ret, n, TDEFL_NO_FLUSH);
+		ret += n;
+	}
+	return ret;
+}
+
+void Compressor::finish()
+{
+	m_finished = true;
+}
+
+uint Compressor::drain(void* out_, uint _capacity)
+{
+	char* out = (char*)out_;
+	uint ret = 0;
+	for (;;) {
+		uint n = std::min(_capacity - ret, m_bufEnd - m_bufBegin);
+		memcpy(out + ret, m_buf + m_bufBegin, n);
+		m_bufBegin += n;
+		ret += n;
+		if (ret == _capacity || !m_finished || m_done) {
+			break;
+		}
+		process(nullptr, 0, TDEFL_FINISH); // m_buf is empty
+	}
+	return ret;
+}
+
+bool Compressor::isDone() const
+{
+	return m_done && m_bufBegin == m_bufEnd;
+}
+
+// PRIVATE
+
+void Compressor::process(const void* _in, uint _inSizeBytes, int _flush)
+{
+	APT_ASSERT(!m_done);
+	if (m_bufBegin == m_bufEnd) {
+		m_bufBegin = m_bufEnd = 0;
+	} else if (m_bufBegin > 0) {
+		memmove(m_buf, m_buf + m_bufBegin, m_bufEnd - m_bufBegin);
+		m_bufEnd -= m_bufBegin;
+		m_bufBegin = 0;
+	}
+	tdefl_status status = tdefl_compress_buffer((tdefl_compressor*)m_state, _in, _inSizeBytes, (tdefl_flush)_flush);
+	APT_ASSERT(status >= TDEFL_STATUS_OKAY);
+	m_done = status == TDEFL_STATUS_DONE;
+}
+
+int Compressor::PutBuf(const void* _buf, int _len, void* _compressor)
+{
+ // tdefl_compress_buffer() consumes all of the input, the output is at most 1 block (~kCompressorBufferSize) per call
+	Compressor* compressor = (Compressor*)_compressor;
+	uint size = compressor->m_bufEnd + (uint)_len;
+	if (size > compressor->m_bufCapacity) {
+		compressor->m_bufCapacity = std::max(size, compressor->m_bufCapacity * 2);
+		compressor->m_buf = (char*)APT_REALLOC(compressor->m_buf, compressor->m_bufCapacity);
+		APT_ASSERT(compressor->m_buf);
+	}
+	memcpy(compressor->m_buf + compressor->m_bufEnd, _buf, _len);
+	compressor->m_bufEnd = size;
+	return MZ_TRUE;
+}
+
+/*******************************************************************************
+
+                                 Decompressor
+
+*******************************************************************************/
+
+// PUBLIC
+
+Decompressor::Decompressor()
+	: m_headerSize(0)
+	, m_dictOffset(0)
+	, m_pendingBegin(0)
+	, m_pendingSize(0)
+	, m_status(TINFL_STATUS_NEEDS_MORE_INPUT)
+{
+	m_state = APT_MALLOC(sizeof(tinfl_decompressor));
+	m_dict  = (char*)APT_MALLOC(TINFL_LZ_DICT_SIZE);
+	tinfl_init((tinfl_decompressor*)m_state);
+}
+
+Decompressor::~Decompressor()
+{
+	APT_FREE(m_dict);
+	APT_FREE(m_state);
+}
+
+uint Decompressor::feed(const void* _in, uint _inSizeBytes)
+{
+	const char* in = (const char*)_in;
+	uint ret = 0;
+
+ // skip the header written by Compress(), if any (the first byte of a zlib stream can't match kMagic)
+	while (ret < _inSizeBytes && m_headerSize < sizeof(Header) && m_status > TINFL_STATUS_DONE) {
+		if (m_headerSize == 0 && in[ret] != kMagic[0]) {
+			m_headerSize = sizeof(Header);
+			break;
+		}
+		if ((m_headerSize < sizeof(kMagic) && in[ret] != kMagic[m_headerSize]) || (m_headerSize == offsetof(Header, m_codec) && (uint8)in[ret] != Codec_ZlibSized)) {
+			m_status = TINFL_STATUS_FAILED;
+			break;
+		}
+		++m_headerSize;
+		++ret;
+	}
+
+	while (ret < _inSizeBytes && m_pendingSize == 0 && m_status > TINFL_STATUS_DONE) {
+		ret += process(in + ret, _inSizeBytes - ret);
+	}
+	return ret;
+}
+
+uint Decompressor::drain(void* out_, uint _capacity)
+{
+	char* out = (char*)out_;
+	uint ret = 0;
+	for (;;) {
+		uint n = std::min(_capacity - ret, m_pendingSize);
+		memcpy(out + ret, m_dict + m_pendingBegin, n);
+		m_pendingBegin += n;
+		m_pendingSize -= n;
+		ret += n;
+		if (ret == _capacity || m_status != TINFL_STATUS_HAS_MORE_OUTPUT) {
+			break;
+		}
+		process(nullptr, 0); // m_dict is empty
+	}
+	return ret;
+}
+
+bool Decompressor::isDone() const
+{
+	return m_status == TINFL_STATUS_DONE && m_pendingSize == 0;
+}
+
+bool Decompressor::hasError() const
+{
+	return m_status < TINFL_STATUS_DONE;
+}
+
+// PRIVATE
+
+uint Decompressor::process(const void* _in, uint _inSizeBytes)
+{
+	APT_ASSERT(m_pendingSize == 0);
+	size_t inSize  = _inSizeBytes;
+	size_t outSize = TINFL_LZ_DICT_SIZE - m_dictOffset;
+	m_status = tinfl_decompress(
+		(tinfl_decompressor*)m_state,
+		(const mz_uint8*)_in, &inSize,
+		(mz_uint8*)m_dict, (mz_uint8*)m_dict + m_dictOffset, &outSize,
+		TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT
+		);
+	m_pendingBegin = m_dictOffset;
+	m_pendingSize  = (uint)outSize;
+	m_dictOffset   = (m_dictOffset + (uint)outSize) & (TINFL_LZ_DICT_SIZE - 1);
+	return (uint)inSize;
+}
+
+/*******************************************************************************
+
+                            CompressionDictionary
+
+*******************************************************************************/
+
+/*	miniz has no equivalent of zlib's deflateSetDictionary(), hence compressing with a dictionary primes the tdefl state
+	directly, as if the dictionary had just been compressed: the dictionary is copied to the start of the window and the
+	hash chains are copied from tables built by setData(), which mirror the updates in tdefl_compress_fast() (level 1)
+	and tdefl_compress_normal(). Copying the tables replaces clearing the hash table in tdefl_init(), so priming costs
+	little more than a copy of the dictionary.
+
+	The output is a raw deflate stream; tinfl can't parse a zlib header with a preset dictionary. Decompression writes
+	the output after a copy of the dictionary so that matches can reference it.
+*/
+struct DictTables
+{
+	mz_uint16 m_fastHash[TDEFL_LEVEL1_HASH_SIZE_MASK + 1]; // tdefl_compress_fast()
+	mz_uint16 m_hash[TDEFL_LZ_HASH_SIZE];                 // tdefl_compress_normal()
+	mz_uint16 m_next[CompressionDictionary::kMaxSizeBytes];
+};
+
+// Return true if tdefl uses tdefl_compress_fast() for _tdeflFlags (see tdefl_compress()).
+static bool IsTdeflFast(int _tdeflFlags)
+{
+	return (_tdeflFlags & TDEFL_MAX_PROBES_MASK) == 1
+		&& (_tdeflFlags & TDEFL_GREEDY_PARSING_FLAG) != 0
+		&& (_tdeflFlags & (TDEFL_FILTER_MATCHES | TDEFL_FORCE_ALL_RAW_BLOCKS | TDEFL_RLE_MATCHES)) == 0;
+}
+
+/*	Training selects segments of kTrainSegmentSize with the highest total frequency of the kTrainDmerSize substrings
+	('dmers') they contain, as the COVER algorithm (https://github.com/facebook/zstd/blob/dev/lib/dictBuilder/cover.c).
+	The samples are split into epochs, one segment is selected from each epoch per pass. Each dmer contributes once per
+	segment and its frequency is cleared once it's selected, so that segments aren't redundant. Segments selected
+	first are placed at the end of the dictionary, closest to the data (shorter match distances).
+*/
+static const uint kTrainDmerSize    = 8;
+static const uint kTrainSegmentSize = 256;
+static const uint kTrainHashBits    = 20;
+static const uint32 kTrainInvalidDmer = ~uint32(0);
+
+// PUBLIC
+
+bool CompressionDictionary::Train(CompressionDictionary& dict_, const void* _samples, const uint* _sampleSizes, uint _sampleCount, uint _maxSizeBytes)
+{
+	APT_ASSERT(_maxSizeBytes > 0 && _maxSizeBytes <= kMaxSizeBytes);
+
+	const uint8* samples = (const uint8*)_samples;
+	uint totalSize = 0;
+	for (uint i = 0; i < _sampleCount; ++i) {
+		totalSize += _sampleSizes[i];
+	}
+	if (totalSize == 0) {
+		return false;
+	}
+	if (totalSize <= _maxSizeBytes) {
+		dict_.setData(samples, totalSize);
+		return true;
+	}
+
+ // hash the dmers which don't cross a sample boundary, count the frequency of each
+	eastl::vector<uint32> dmers(totalSize, kTrainInvalidDmer);
+	eastl::vector<uint32> freqs(1 << kTrainHashBits, 0);
+	for (uint i = 0, sampleBegin = 0; i < _sampleCount; sampleBegin += _sampleSizes[i++]) {
+		uint sampleEnd = sampleBegin + _sampleSizes[i];
+		for (uint j = sampleBegin; j + kTrainDmerSize <= sampleEnd; ++j) {
+			uint64 dmer;
+			memcpy(&dmer, samples + j, sizeof(dmer));
+			dmers[j] = (uint32)((dmer * 0xCF1BBCDCB7A56463ull) >> (64 - kTrainHashBits));
+			++freqs[dmers[j]];
+		}
+	}
+
+	uint segmentSize = std::min(kTrainSegmentSize, _maxSizeBytes);
+	uint epochCount  = std::max((uint)1, std::min(_maxSizeBytes / segmentSize, totalSize / segmentSize));
+	uint epochSize   = totalSize / epochCount;
+	eastl::vector<uint8> dict(_maxSizeBytes);
+	eastl::vector<uint16> active(1 << kTrainHashBits, 0); // dmer count in the current segment
+	uint tail = _maxSizeBytes;
+	uint zeroScoreCount = 0;
+	for (uint epoch = 0; tail >= kTrainDmerSize && zeroScoreCount < epochCount; epoch = (epoch + 1) % epochCount) {
+		uint size = std::min(segmentSize, tail);
+		uint dmerCount = size - kTrainDmerSize + 1; // dmers per segment
+		uint begin = epoch * epochSize;
+		uint end = std::min(begin + epochSize, totalSize) - kTrainDmerSize + 1; // end of the dmers
+
+	 // slide a segment over the epoch, score = sum of the frequencies of the distinct dmers
+		uint64 score = 0, bestScore = 0;
+		uint bestBegin = begin;
+		for (uint i = begin; i < end; ++i) {
+			uint32 dmer = dmers[i];
+			if (dmer != kTrainInvalidDmer && active[dmer]++ == 0) {
+				score += freqs[dmer];
+			}
+			if (i >= begin + dmerCount) {
+				dmer = dmers[i - dmerCount];
+				if (dmer != kTrainInvalidDmer && --active[dmer] == 0) {
+					score -= freqs[dmer];
+				}
+			}
+			if (i + 1 >= begin + dmerCount && score > bestScore) {
+				bestScore = score;
+				bestBegin = i + 1 - dmerCount;
+			}
+		}
+		for (uint i = std::max(begin, end - std::min(end, dmerCount)); i < end; ++i) {
+			if (dmers[i] != kTrainInvalidDmer) {
+				active[dmers[i]] = 0;
+			}
+		}
+		if (bestScore == 0) {
+			++zeroScoreCount;
+			continue;
+		}
+		zeroScoreCount = 0;
+
+		for (uint i = bestBegin; i < bestBegin + dmerCount; ++i) {
+			if (dmers[i] != kTrainInvalidDmer) {
+				freqs[dmers[i]] = 0;
+			}
+		}
+		tail -= size;
+		memcpy(dict.data() + tail, samples + bestBegin, size);
+	}
+	if (tail == _maxSizeBytes) {
+		return false;
+	}
+	dict_.setData(dict.data() + tail, _maxSizeBytes - tail);
+	return true;
+}
+
+CompressionDictionary::CompressionDictionary()
+	: m_data(nullptr)
+	, m_sizeBytes(0)
+	, m_hash(0)
+	, m_tables(nullptr)
+{
+}
+
+CompressionDictionary::CompressionDictionary(const void* _data, uint _sizeBytes)
+	: m_data(nullptr)
+	, m_sizeBytes(0)
+	, m_hash(0)
+	, m_tables(nullptr)
+{
+	setData(_data, _sizeBytes);
+}
+
+CompressionDictionary::~CompressionDictionary()
+{
+	APT_FREE(m_tables);
+	APT_FREE(m_data);
+}
+
+void CompressionDictionary::setData(const void* _data, uint _sizeBytes)
+{
+	APT_ASSERT(_data);
+	APT_ASSERT(_sizeBytes > 0);
+
+	if (_sizeBytes > kMaxSizeBytes) {
+	 // keep the end, which is closest to the data
+		_data = (const char*)_data + _sizeBytes - kMaxSizeBytes;
+		_sizeBytes = kMaxSizeBytes;
+	}
+	m_data = (char*)APT_REALLOC(m_data, _sizeBytes);
+	APT_ASSERT(m_data);
+	memcpy(m_data, _data, _sizeBytes);
+	m_sizeBytes = _sizeBytes;
+	m_hash = Hash<uint32>(m_data, m_sizeBytes);
+
+ // the last 2 positions are inserted by tdefl_compress_normal() as the data is added
+	if (!m_tables) {
+		m_tables = APT_MALLOC(sizeof(DictTables));
+		APT_ASSERT(m_tables);
+	}
+	DictTables& tables = *((DictTables*)m_tables);
+	memset(&tables, 0, sizeof(tables));
+	const uint8* data = (const uint8*)m_data;
+	for (uint i = 0; i + 2 < m_sizeBytes; ++i) {
+		mz_uint trigram = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+		tables.m_fastHash[(trigram ^ (trigram >> (24 - (TDEFL_LZ_HASH_BITS - 8)))) & TDEFL_LEVEL1_HASH_SIZE_MASK] = (mz_uint16)i;
+		mz_uint hash = ((data[i] << (TDEFL_LZ_HASH_SHIFT * 2)) ^ (data[i + 1] << TDEFL_LZ_HASH_SHIFT) ^ data[i + 2]) & (TDEFL_LZ_HASH_SIZE - 1);
+		tables.m_next[i] = tables.m_hash[hash];
+		tables.m_hash[hash] = (mz_uint16)i;
+	}
+}
+
+void apt::Compress(const void* _in, uint _inSizeBytes, const CompressionDictionary& _dict, void*& out_, uint& outSizeBytes_, CompressionFlags _flags)
+{
+	APT_ASSERT(_in);
+	APT_ASSERT(_inSizeBytes);
+	APT_ASSERT(!out_);
+	APT_ASSERT(_dict.getSizeBytes() > 0);
+
+	if (_flags == CompressionFlags_Fastest) {
+		_flags = CompressionFlags_Speed;
+	}
+	int tdeflFlags = GetTdeflFlags(_flags) & ~TDEFL_WRITE_ZLIB_HEADER;
+	tdefl_compressor* state = CodecContext::Get().getCompressor();
+	APT_VERIFY(tdefl_init(state, nullptr, nullptr, tdeflFlags | TDEFL_NONDETERMINISTIC_PARSING_FLAG) == TDEFL_STATUS_OKAY); // m_hash is overwritten below
+
+ // prime the window and hash chains
+	const DictTables& tables = *((const DictTables*)_dict.m_tables);
+	uint dictSize = _dict.getSizeBytes();
+	memcpy(state->m_dict, _dict.getData(), dictSize);
+	memcpy(state->m_dict + TDEFL_LZ_DICT_SIZE, _dict.getData(), std::min(dictSize, (uint)TDEFL_MAX_MATCH_LEN - 1));
+	if (IsTdeflFast(tdeflFlags)) {
+		memcpy(state->m_hash, tables.m_fastHash, sizeof(tables.m_fastHash));
+	} else {
+		memcpy(state->m_hash, tables.m_hash, sizeof(tables.m_hash));
+		memcpy(state->m_next, tables.m_next, dictSize * sizeof(mz_uint16));
+	}
+	state->m_lookahead_pos = state->m_dict_size = state->m_lz_code_buf_dict_pos = dictSize;
+
+	uint capacity = (uint)mz_compressBound(_inSizeBytes);
+	char* out = (char*)malloc(sizeof(Header) + capacity);
+	APT_ASSERT(out);
+	WriteHeader(out, Codec_Dict, _dict.getHash(), _inSizeBytes);
+	size_t inSize  = _inSizeBytes;
+	size_t outSize = capacity;
+	APT_VERIFY(tdefl_compress(state, _in, &inSize, out + sizeof(Header), &outSize, TDEFL_FINISH) == TDEFL_STATUS_DONE);
+	outSizeBytes_ = sizeof(Header) + (uint)outSize;
+	out_ = realloc(out, outSizeBytes_);
+}
+
+void apt::Decompress(const void* _in, uint _inSizeBytes, const CompressionDictionary& _dict, void*& out_, uint& outSizeBytes_)
+{
+	APT_ASSERT(_in);
+	APT_ASSERT(!out_);
+
+	Header header;
+	if (ReadHeader(_in, _inSizeBytes, header) != Codec_Dict) {
+		Decompress(_in, _inSizeBytes, out_, outSizeBytes_);
+		return;
+	}
+	outSizeBytes_ = 0;
+	if (header.m_sizeBytes <= (uint64)~uint(0)) {
+		outSizeBytes_ = (uint)header.m_sizeBytes;
+		out_ = malloc(std::max(outSizeBytes_, (uint)1));
+		APT_ASSERT(out_);
+		if (DecompressTo(_in, _inSizeBytes, _dict, out_, outSizeBytes_) != outSizeBytes_) {
+			free(out_);
+			out_ = nullptr;
+			outSizeBytes_ = 0;
+		}
+	}
+}
+
+uint apt::DecompressTo(const void* _in, uint _inSizeBytes, const CompressionDictionary& _dict, void* out_, uint _outCapacity)
+{
+	APT_ASSERT(_in);
 	APT_ASSERT(out_);
+
+	Header header;
+	if (ReadHeader(_in, _inSizeBytes, header) != Codec_Dict) {
+		return DecompressTo(_in, _inSizeBytes, out_, _outCapacity);
+	}
+	if (header.m_param != _dict.getHash() || header.m_sizeBytes > _outCapacity) {
+		return 0;
+	}
+	uint size = (uint)header.m_sizeBytes;
+	uint dictSize = _dict.getSizeBytes();
+	APT_ASSERT(dictSize <= TINFL_LZ_DICT_SIZE);
+
+ // decompress via a fixed size ring buffer (the deflate window), preloaded such that the dictionary immediately precedes
+ // the output, copying the output to out_ as the ring fills
+	CodecContext& context = CodecContext::Get();
+	mz_uint8* window = context.getWindow();
+	memcpy(window + TINFL_LZ_DICT_SIZE - dictSize, _dict.getData(), dictSize);
+
+	tinfl_decompressor* state = context.getDecompressor();
+	tinfl_init(state);
+	const mz_uint8* in = (const mz_uint8*)_in + sizeof(Header);
+	const mz_uint8* inEnd = (const mz_uint8*)_in + _inSizeBytes;
+	size_t windowPos = 0;
+	uint outSize = 0;
+	for (;;) {
+		size_t inSize = inEnd - in;
+		size_t windowSize = TINFL_LZ_DICT_SIZE - windowPos;
+		tinfl_status status = tinfl_decompress(state,
+			in, &inSize,
+			window, window + windowPos, &windowSize,
+			0 // wrapping output buffer, raw deflate
+			);
+		in += inSize;
+		if (windowSize > size - outSize) {
+			return 0;
+		}
+		memcpy((char*)out_ + outSize, window + windowPos, windowSize);
+		outSize += (uint)windowSize;
+		windowPos = (windowPos + windowSize) & (TINFL_LZ_DICT_SIZE - 1);
+		if (status == TINFL_STATUS_DONE) {
+			break;
+		}
+		if (status != TINFL_STATUS_HAS_MORE_OUTPUT) {
+			return 0;
+		}
+	}
+	return outSize == size ? size : 0;
+}
+
+bool apt::GetCompressionDictionaryHash(const void* _in, uint _inSizeBytes, uint32& hash_)
+{
+	Header header;
+	if (ReadHeader(_in, _inSizeBytes, header) != Codec_Dict) {
+		return false;
+	}
+	hash_ = header.m_param;
+	return true;
+}
+
+/*******************************************************************************
+
+                                 File
+
+*******************************************************************************/
+
+bool apt::WriteCompressed(const File& _file, const char* _path, CompressionFlags _flags)
+{
+	if (!_path) {
+		_path = _file.getPath();
+	}
+	APT_ASSERT(_path);
+
+	FILE* fp = fopen(_path, "wb");
+	if (!fp && FileSystem::CreateDir(_path)) {
+		fp = fopen(_path, "wb");
+	}
+	if (!fp) {
+		APT_LOG_ERR("Error writing '%s'", _path);
+		return false;
+	}
+
+	Compressor compressor(_flags);
+	char buf[kFileChunkSize];
+	const char* in = _file.getData();
+	uint64 inSize = _file.getDataSize();
+	if (inSize == 0) {
+		compressor.finish();
+	}
+	bool ret = true;
+	while (ret && !compressor.isDone()) {
+		if (inSize > 0) {
+			uint n = compressor.feed(in, (uint)std::min(inSize, (uint64)0x7fffffff));
+			in += n;
+			inSize -= n;
+			if (inSize == 0) {
+				compressor.finish();
+			}
+		}
+		uint n = compressor.drain(buf, sizeof(buf));
+		ret = fwrite(buf, 1, n, fp) == n;
+	}
+	ret &= fclose(fp) == 0;
+	if (!ret) {
+		APT_LOG_ERR("Error writing '%s'", _path);
+	}
+	return ret;
+}
+
+bool apt::ReadCompressed(File& file_, const char* _path)
+{
+	if (!_path) {
+		_path = file_.getPath();
+	}
+	APT_ASSERT(_path);
+
+	FILE* fp = fopen(_path, "rb");
+	if (!fp) {
+		APT_LOG_ERR("Error reading '%s'", _path);
+		return false;
+	}
+
+	File ret;
+	Decompressor decompressor;
+	char in[kFileChunkSize];
+	char out[kFileChunkSize];
+	uint inSize = 0, inOffset = 0;
+	while (!decompressor.isDone() && !decompressor.hasError()) {
+		if (inOffset == inSize) {
+			inSize = (uint)fread(in, 1, sizeof(in), fp);
+			inOffset = 0;
+			if (inSize == 0) {
+				break; // truncated or read error
+			}
+		}
+		inOffset += decompressor.feed(in + inOffset, inSize - inOffset);
+		while (uint n = decompressor.drain(out, sizeof(out))) {
+			ret.appendData(out, n);
+		}
+	}
+	bool ok = decompressor.isDone() && ferror(fp) == 0;
+	fclose(fp);
+	if (!ok) {
+		APT_LOG_ERR("Error reading '%s'%s", _path, decompressor.hasError() ? ": invalid data" : "");
+		return false;
+	}
+	ret.setPath(_path); // before swap, _path may point to file_'s path
+	swap(file_, ret);
+	return true;
 }
@@ -4,11 +4,14 @@
 
 namespace apt {
 
+class File;
+
 enum CompressionFlags
 {
 	CompressionFlags_None = 0,   // don't compress (for APIs with optional compression)
 	CompressionFlags_Speed,      // faster compression, potentially larger size
 	CompressionFlags_Size,       // slower compression, potentially smaller size
+	CompressionFlags_Fastest,    // fastest compression and decompression (LZ4-style codec, no checksum), larger size
 	CompressionFlags_Default = CompressionFlags_Speed
 };
 
@@ -17,7 +20,210 @@ enum CompressionFlags
 void Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags = CompressionFlags_Default);
 
 // Decompress _in to out_ (allocated by the function). The size of the resulting buffer is written to outSizeBytes_.
-// out_ should subsequently be release via free().
+// out_ should subsequently be release via free(). The compression format is detected from _in, which may be the output
+// of Compress() with any CompressionFlags, of CompressBlocks() or of Compressor. If _in is invalid (e.g. corrupt or
+// truncated) out_ is null and outSizeBytes_ is 0.
 void Decompress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_);
 
+// Decompress _in to out_, which is at least _outCapacity bytes (use GetDecompressedSize()). Return the decompressed
+// size, or 0 if an error occurred or out_ is too small. No memory is allocated, except for the per-thread codec state
+// on the first call (which is reused by all compression functions on the same thread). The output of CompressBlocks()
+// is decompressed on the calling thread, use DecompressBlocks() to decompress in parallel.
+uint DecompressTo(const void* _in, uint _inSizeBytes, void* out_, uint _outCapacity);
+
+// Return the decompressed size of _in, which is stored in the header written by Compress() and CompressBlocks(). Return
+// 0 if the size is unknown (the output of Compressor or of Compress() prior to v0.38).
+uint GetDecompressedSize(const void* _in, uint _inSizeBytes);
+
+////////////////////////////////////////////////////////////////////////////////
+// CompressionDictionary
+// Preset dictionary for compressing many small, similar buffers (e.g. serialized
+// records) which individually compress poorly because each starts with an empty
+// window. Train() builds a dictionary from representative samples; the data
+// (getData()) should then be stored alongside the compressed buffers and passed
+// to setData() to decompress them. Compressed data records the dictionary hash,
+// see GetCompressionDictionaryHash().
+////////////////////////////////////////////////////////////////////////////////
+class CompressionDictionary: private non_copyable<CompressionDictionary>
+{
+public:
+	static const uint kMaxSizeBytes = 32 * 1024; // deflate window size, larger dictionaries are truncated
+
+	// Build a dictionary of at most _maxSizeBytes from the most frequent substrings of _sampleCount samples, which are
+	// concatenated in _samples (the size of each is given by _sampleSizes). Return false if the samples are empty, in
+	// which case dict_ remains unchanged. Samples should total at least ~100x the dictionary size.
+	static bool Train(CompressionDictionary& dict_, const void* _samples, const uint* _sampleSizes, uint _sampleCount, uint _maxSizeBytes = 16 * 1024);
+
+	CompressionDictionary();
+	CompressionDictionary(const void* _data, uint _sizeBytes);
+	~CompressionDictionary();
+
+	// Copy _sizeBytes from _data, compute the hash and the compressor tables.
+	void setData(const void* _data, uint _sizeBytes);
+
+	const char* getData() const                                 { return m_data; }
+	uint        getSizeBytes() const                            { return m_sizeBytes; }
+	uint32      getHash() const                                 { return m_hash; }
+
+private:
+	char*  m_data;
+	uint   m_sizeBytes;
+	uint32 m_hash;
+	void*  m_tables;    // precomputed compressor hash chains, see compress.cpp
+
+	friend void Compress(const void*, uint, const CompressionDictionary&, void*&, uint&, CompressionFlags);
+};
+
+// As Compress(), using _dict as a preset dictionary. The output can only be decompressed with the same dictionary.
+// CompressionFlags_Fastest isn't supported, CompressionFlags_Speed is used instead.
+void Compress(const void* _in, uint _inSizeBytes, const CompressionDictionary& _dict, void*& out_, uint& outSizeBytes_, CompressionFlags _flags = CompressionFlags_Default);
+
+// As Decompress()/DecompressTo(), _dict must match the dictionary used to compress _in. If _in was compressed without a
+// dictionary _dict is ignored.
+void Decompress(const void* _in, uint _inSizeBytes, const CompressionDictionary& _dict, void*& out_, uint& outSizeBytes_);
+uint DecompressTo(const void* _in, uint _inSizeBytes, const CompressionDictionary& _dict, void* out_, uint _outCapacity);
+
+// If _in was compressed with a dictionary, write the hash of the dictionary to hash_ and return true.
+bool GetCompressionDictionaryHash(const void* _in, uint _inSizeBytes, uint32& hash_);
+
+// Default block size for CompressBlocks(). Smaller blocks give finer-grained random access at the cost of compression
+// ratio (each block starts with an empty dictionary).
+static const uint kCompressBlockSize = 1024 * 1024;
+
+// Split _in into blocks of _blockSizeBytes and compress them independently on up to _threadCount threads (0 = the
+// number of hardware threads). The output begins with an index of the block offsets, hence blocks can subsequently be
+// decompressed in parallel via DecompressBlocks() or individually via DecompressBlock().
+// out_ should subsequently be release via free().
+void CompressBlocks(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags = CompressionFlags_Default, uint _blockSizeBytes = kCompressBlockSize, uint _threadCount = 0);
+
+// Decompress the output of CompressBlocks() to out_ (allocated by the function) on up to _threadCount threads (0 = the
+// number of hardware threads). Return false if _in is invalid, in which case out_ is not allocated.
+// out_ should subsequently be release via free().
+bool DecompressBlocks(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, uint _threadCount = 0);
+
+struct CompressedBlockInfo
+{
+	uint m_sizeBytes;      // total decompressed size
+	uint m_blockSizeBytes; // decompressed size of each block, the last block may be smaller
+	uint m_blockCount;
+};
+
+// Read the block index from the output of CompressBlocks(). Return false if _in is invalid.
+bool GetCompressedBlockInfo(const void* _in, uint _inSizeBytes, CompressedBlockInfo& info_);
+
+// Decompress the block at _blockIndex from the output of CompressBlocks() to out_, which must be at least
+// CompressedBlockInfo::m_blockSizeBytes. Return the decompressed size of the block, or 0 if an error occurred.
+uint DecompressBlock(const void* _in, uint _inSizeBytes, uint _blockIndex, void* out_, uint _outCapacity);
+
+////////////////////////////////////////////////////////////////////////////////
+// Compressor
+// Streaming compression, output is identical to Compress() except that there
+// is no header (hence GetDecompressedSize() returns 0). Input is passed
+// via feed(), compressed output is copied out via drain(). Internal buffering
+// is bounded, hence feed() may not consume all of the input until the output
+// is drained. CompressionFlags_Fastest isn't supported by the streaming API,
+// CompressionFlags_Speed is used instead:
+//
+//   Compressor c;
+//   while (inSize > 0) {
+//      uint n = c.feed(in, inSize);
+//      in += n; inSize -= n;
+//      write(buf, c.drain(buf, sizeof(buf)));
+//   }
+//   c.finish();
+//   while (!c.isDone()) {
+//      write(buf, c.drain(buf, sizeof(buf)));
+//   }
+////////////////////////////////////////////////////////////////////////////////
+class Compressor: private non_copyable<Compressor>
+{
+public:
+	Compressor(CompressionFlags _flags = CompressionFlags_Default);
+	~Compressor();
+
+	// Consume up to _inSizeBytes from _in, return the number of bytes consumed. Fewer than _inSizeBytes are consumed
+	// if the internal output buffer is full, in which case call drain() before feeding the remainder.
+	uint feed(const void* _in, uint _inSizeBytes);
+
+	// Signal the end of the input; subsequent calls to drain() flush the remaining output. 
+	void finish();
+
+	// Copy up to _capacity bytes of compressed output to out_, return the number of bytes copied.
+	uint drain(void* out_, uint _capacity);
+
+	// Return true if finish() was called and all of the output was drained.
+	bool isDone() const;
+
+private:
+	void*  m_state;     // tdefl_compressor
+	char*  m_buf;       // output not yet drained
+	uint   m_bufBegin;
+	uint   m_bufEnd;
+	uint   m_bufCapacity;
+	bool   m_finished;
+	bool   m_done;      // compressor state flushed to m_buf
+
+	// Run the compressor on _in, append output to m_buf.
+	void process(const void* _in, uint _inSizeBytes, int _flush);
+	// tdefl output callback, append to m_buf.
+	static int PutBuf(const void* _buf, int _len, void* _compressor);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Decompressor
+// Streaming decompression of the output of Compress()/Compressor. Compressed
+// input is passed via feed(), decompressed output is copied out via drain().
+// The end of the stream is detected from the data, hence there is no finish():
+//
+//   Decompressor d;
+//   while (!d.isDone() && !d.hasError()) {
+//      uint n = d.feed(in, inSize);
+//      in += n; inSize -= n;
+//      write(buf, d.drain(buf, sizeof(buf)));
+//   }
+////////////////////////////////////////////////////////////////////////////////
+class Decompressor: private non_copyable<Decompressor>
+{
+public:
+	Decompressor();
+	~Decompressor();
+
+	// Consume up to _inSizeBytes from _in, return the number of bytes consumed. Fewer than _inSizeBytes are consumed
+	// if the internal output buffer is full (call drain() before feeding the remainder), the end of the stream is
+	// reached or an error occurred.
+	uint feed(const void* _in, uint _inSizeBytes);
+
+	// Copy up to _capacity bytes of decompressed output to out_, return the number of bytes copied.
+	uint drain(void* out_, uint _capacity);
+
+	// Return true if the end of the stream was reached and all of the output was drained.
+	bool isDone() const;
+
+	// Return true if the input was invalid.
+	bool hasError() const;
+
+private:
+	void*  m_state;     // tinfl_decompressor
+	uint   m_headerSize; // header bytes consumed
+	char*  m_dict;      // sliding window, output is written here
+	uint   m_dictOffset;
+	uint   m_pendingBegin;
+	uint   m_pendingSize;
+	int    m_status;    // tinfl_status
+
+	// Run the decompressor on _in, output to m_dict. Return the number of bytes consumed from _in.
+	uint process(const void* _in, uint _inSizeBytes);
+};
+
+// Compress _file's data and write it to _path, or _file.getPath() if _path is 0. Compressed data is written in chunks
+// as it is produced, the whole compressed buffer is never held in memory (use File::Map() to also avoid loading the
+// uncompressed data). Return false if an error occurred.
+bool WriteCompressed(const File& _file, const char* _path = nullptr, CompressionFlags _flags = CompressionFlags_Default);
+
+// Read and decompress the file at _path, or file_.getPath() if _path is 0, into file_. Compressed data is read in
+// chunks, the whole compressed buffer is never held in memory. Return false if an error occurred, in which case file_
+// remains unchanged.
+// \note Unlike File::Read() there is no implicit null appended to the data.
+bool ReadCompressed(File& file_, const char* _path = nullptr);
+
 } // namespace apt
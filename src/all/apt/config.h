@@ -5,11 +5,16 @@
 //#define APT_ENABLE_ASSERT              1   // Enable asserts. If APT_DEBUG this is enabled by default.
 //#define APT_ENABLE_STRICT_ASSERT       1   // Enable 'strict' asserts.
 //#define APT_LOG_CALLBACK_ONLY          1   // By default, log messages are written to stdout/stderr prior to the log callback dispatch. Disable this behavior.
+//#define APT_DISABLE_SIMD               1   // Use scalar versions of the string kernels (simd_string.h) and base64 codec (base64.h).
+//#define APT_ENABLE_ALLOC_COUNT         1   // Count calls to malloc/realloc (see internal::GetAllocCount()). If APT_DEBUG this is enabled by default.
 
 #if defined(APT_DEBUG)
 	#ifndef APT_ENABLE_ASSERT
 		#define APT_ENABLE_ASSERT 1
 	#endif
+	#ifndef APT_ENABLE_ALLOC_COUNT
+		#define APT_ENABLE_ALLOC_COUNT 1
+	#endif
 #endif
 
 // Compiler
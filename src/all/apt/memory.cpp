@@ -2,6 +2,14 @@
 
 #include <cstdlib>
 
+#if APT_ENABLE_ALLOC_COUNT
+	#include <atomic>
+	static std::atomic<apt::uint64> s_allocCount(0);
+	#define APT_COUNT_ALLOC() s_allocCount.fetch_add(1, std::memory_order_relaxed)
+#else
+	#define APT_COUNT_ALLOC() do {} while(0)
+#endif
+
 #if 1
 	void* operator new(size_t _size)
 	{ 
@@ -23,11 +31,13 @@
 
 void* apt::internal::malloc(size_t _size)
 {
+	APT_COUNT_ALLOC();
 	return ::malloc(_size);
 }
 
 void* apt::internal::realloc(void* _ptr, size_t _size)
 {
+	APT_COUNT_ALLOC();
 	return ::realloc(_ptr, _size);
 }
 
@@ -38,6 +48,7 @@ void apt::internal::free(void* _ptr)
 
 void* apt::internal::malloc_aligned(size_t _size, size_t _align) 
 {
+	APT_COUNT_ALLOC();
 #ifdef APT_COMPILER_MSVC
 	return _aligned_malloc(_size, _align);
 #else
@@ -47,6 +58,7 @@ void* apt::internal::malloc_aligned(size_t _size, size_t _align)
 
 void* apt::internal::realloc_aligned(void* _ptr, size_t _size, size_t _align)
 {
+	APT_COUNT_ALLOC();
 #ifdef APT_COMPILER_MSVC
 	return _aligned_realloc(_ptr, _size, _align);
 #else
@@ -58,6 +70,15 @@ void* apt::internal::realloc_aligned(void* _ptr, size_t _size, size_t _align)
 #endif
 }
 
+apt::uint64 apt::internal::GetAllocCount()
+{
+#if APT_ENABLE_ALLOC_COUNT
+	return s_allocCount.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
 void apt::internal::free_aligned(void* _ptr) 
 {
 #ifdef APT_COMPILER_MSVC
@@ -24,6 +24,10 @@ void* malloc_aligned(size_t _size, size_t _align);
 void* realloc_aligned(void* _ptr, size_t _size, size_t _align);
 void  free_aligned(void* _ptr);
 
+// Return the total number of calls to malloc/realloc (including the aligned variants), e.g. to count allocations made by
+// a block of code. Always 0 unless APT_ENABLE_ALLOC_COUNT.
+uint64 GetAllocCount();
+
 template <size_t kAlignment> struct aligned_base;
 	template<> struct alignas(1)   aligned_base<1>   {};
 	template<> struct alignas(2)   aligned_base<2>   {};
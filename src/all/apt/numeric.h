@@ -0,0 +1,37 @@
+#pragma once
+
+#include <apt/apt.h>
+
+// Locale-independent number <-> string conversion. Formatting writes a null-terminated string to out_ and returns the
+// number of chars written (excluding the null terminator). Parsing returns ptr to the first char following the number,
+// or _str if no conversion was performed (in which case out_ is unchanged).
+
+namespace apt {
+
+enum
+{
+	kMaxIntStringLength    = 21, // "-9223372036854775808" + null terminator
+	kMaxDoubleStringLength = 32  // "-2.2250738585072014e-308" + null terminator (with some slack)
+};
+
+// Write _value to out_, which must have space for at least kMaxIntStringLength chars.
+uint IntToString(char* out_, sint64 _value);
+uint UintToString(char* out_, uint64 _value);
+
+// Write a representation of _value which round-trips exactly (i.e. parses back to exactly _value) and is usually, but
+// not always, the shortest such representation to out_, which must have space for at least kMaxDoubleStringLength
+// chars. Integral values are written with a trailing ".0", very large/small values use exponent notation
+// (e.g. "1e30"). Infinity and NaN are written as "inf", "-inf", "nan".
+uint DoubleToString(char* out_, double _value);
+// As DoubleToString(), round-trips at float precision (e.g. 0.1f is written as "0.1").
+uint FloatToString(char* out_, float _value);
+
+// Parse a decimal integer with an optional sign, or a hexadecimal integer with the prefix '0x'. Leading zeros are
+// ignored (i.e. there is no octal notation). Values which overflow are clamped.
+const char* ParseInt(sint64& out_, const char* _str);
+
+// Parse a decimal floating point value with an optional sign and exponent (e.g. "-1.5e-3"), or "inf"/"infinity"/"nan"
+// (case insensitive). The result is correctly rounded.
+const char* ParseDouble(double& out_, const char* _str);
+
+} // namespace apt
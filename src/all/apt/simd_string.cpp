@@ -0,0 +1,412 @@
+#include <apt/simd_string.h>
+
+#include <cstring>
+
+#if !APT_DISABLE_SIMD
+	#if APT_COMPILER_MSVC
+		#include <intrin.h>
+	#else
+		#include <immintrin.h>
+	#endif
+#endif
+
+using namespace apt;
+using namespace apt::internal;
+
+static inline bool IsWhitespace(char _c)
+{
+	return _c == ' ' || (uint8)(_c - '\t') <= (uint8)('\r' - '\t');
+}
+
+static inline bool IsInList(char _c, const char* _list)
+{
+	for (; *_list; ++_list) {
+		if (_c == *_list) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*******************************************************************************
+
+                                  scalar
+
+*******************************************************************************/
+
+const char* scalar::FindChar(const char* _str, char _c)
+{
+	while (*_str && *_str != _c) {
+		++_str;
+	}
+	return _str;
+}
+
+const char* scalar::FindAny(const char* _str, const char* _list)
+{
+	while (*_str && !IsInList(*_str, _list)) {
+		++_str;
+	}
+	return _str;
+}
+
+const char* scalar::FindWhitespace(const char* _str)
+{
+	while (*_str && !IsWhitespace(*_str)) {
+		++_str;
+	}
+	return _str;
+}
+
+const char* scalar::FindWhitespaceOrAny(const char* _str, const char* _list)
+{
+	while (*_str && !IsWhitespace(*_str) && !IsInList(*_str, _list)) {
+		++_str;
+	}
+	return _str;
+}
+
+const char* scalar::SkipWhitespace(const char* _str)
+{
+	while (IsWhitespace(*_str)) {
+		++_str;
+	}
+	return _str;
+}
+
+const char* scalar::FindSubstring(const char* _str, const char* _sub)
+{
+	return strstr(_str, _sub);
+}
+
+const char* scalar::FindSubstring(const char* _str, uint _strLen, const char* _sub, uint _subLen)
+{
+	if (_subLen > _strLen) {
+		return nullptr;
+	}
+	for (uint i = 0, n = _strLen - _subLen; i <= n; ++i) {
+		if (memcmp(_str + i, _sub, _subLen) == 0) {
+			return _str + i;
+		}
+	}
+	return nullptr;
+}
+
+uint scalar::CountChar(const char* _beg, const char* _end, char _c)
+{
+	uint ret = 0;
+	for (; _beg < _end; ++_beg) {
+		ret += *_beg == _c ? 1 : 0;
+	}
+	return ret;
+}
+
+uint scalar::ReplaceChar(char* _str, uint _len, char _find, char _replace)
+{
+	uint ret = 0;
+	for (char* end = _str + _len; _str < end; ++_str) {
+		if (*_str == _find) {
+			*_str = _replace;
+			++ret;
+		}
+	}
+	return ret;
+}
+
+void scalar::ToUpperCase(char* _str, uint _len)
+{
+	for (char* end = _str + _len; _str < end; ++_str) {
+		if (*_str >= 'a' && *_str <= 'z') {
+			*_str -= 'a' - 'A';
+		}
+	}
+}
+
+void scalar::ToLowerCase(char* _str, uint _len)
+{
+	for (char* end = _str + _len; _str < end; ++_str) {
+		if (*_str >= 'A' && *_str <= 'Z') {
+			*_str += 'a' - 'A';
+		}
+	}
+}
+
+/*******************************************************************************
+
+                                   SIMD
+
+*******************************************************************************/
+
+#if APT_DISABLE_SIMD
+
+const char* internal::FindChar(const char* _str, char _c)                                            { return scalar::FindChar(_str, _c); }
+const char* internal::FindAny(const char* _str, const char* _list)                                   { return scalar::FindAny(_str, _list); }
+const char* internal::FindWhitespace(const char* _str)                                               { return scalar::FindWhitespace(_str); }
+const char* internal::FindWhitespaceOrAny(const char* _str, const char* _list)                       { return scalar::FindWhitespaceOrAny(_str, _list); }
+const char* internal::SkipWhitespace(const char* _str)                                               { return scalar::SkipWhitespace(_str); }
+const char* internal::FindSubstring(const char* _str, const char* _sub)                              { return scalar::FindSubstring(_str, _sub); }
+const char* internal::FindSubstring(const char* _str, uint _strLen, const char* _sub, uint _subLen)  { return scalar::FindSubstring(_str, _strLen, _sub, _subLen); }
+uint        internal::CountChar(const char* _beg, const char* _end, char _c)                         { return scalar::CountChar(_beg, _end, _c); }
+uint        internal::ReplaceChar(char* _str, uint _len, char _find, char _replace)                  { return scalar::ReplaceChar(_str, _len, _find, _replace); }
+void        internal::ToUpperCase(char* _str, uint _len)                                             { scalar::ToUpperCase(_str, _len); }
+void        internal::ToLowerCase(char* _str, uint _len)                                             { scalar::ToLowerCase(_str, _len); }
+
+#else
+
+#if defined(__AVX2__)
+	typedef __m256i Vec;
+	static const uint   kVecSize  = 32;
+	static const uint32 kFullMask = 0xffffffffu;
+	static inline Vec    Load(const char* _p)      { return _mm256_load_si256((const __m256i*)_p);  }
+	static inline Vec    LoadU(const char* _p)     { return _mm256_loadu_si256((const __m256i*)_p); }
+	static inline void   StoreU(char* _p, Vec _v)  { _mm256_storeu_si256((__m256i*)_p, _v);         }
+	static inline Vec    Splat(char _c)            { return _mm256_set1_epi8(_c);                   }
+	static inline Vec    CmpEq(Vec _a, Vec _b)     { return _mm256_cmpeq_epi8(_a, _b);              }
+	static inline Vec    Or(Vec _a, Vec _b)        { return _mm256_or_si256(_a, _b);                }
+	static inline Vec    And(Vec _a, Vec _b)       { return _mm256_and_si256(_a, _b);               }
+	static inline Vec    AndNot(Vec _a, Vec _b)    { return _mm256_andnot_si256(_a, _b);            } // ~_a & _b
+	static inline Vec    Xor(Vec _a, Vec _b)       { return _mm256_xor_si256(_a, _b);               }
+	static inline Vec    Sub(Vec _a, Vec _b)       { return _mm256_sub_epi8(_a, _b);                }
+	static inline Vec    MinU(Vec _a, Vec _b)      { return _mm256_min_epu8(_a, _b);                }
+	static inline uint32 Mask(Vec _v)              { return (uint32)_mm256_movemask_epi8(_v);       }
+#else
+	typedef __m128i Vec;
+	static const uint   kVecSize  = 16;
+	static const uint32 kFullMask = 0xffffu;
+	static inline Vec    Load(const char* _p)      { return _mm_load_si128((const __m128i*)_p);     }
+	static inline Vec    LoadU(const char* _p)     { return _mm_loadu_si128((const __m128i*)_p);    }
+	static inline void   StoreU(char* _p, Vec _v)  { _mm_storeu_si128((__m128i*)_p, _v);            }
+	static inline Vec    Splat(char _c)            { return _mm_set1_epi8(_c);                      }
+	static inline Vec    CmpEq(Vec _a, Vec _b)     { return _mm_cmpeq_epi8(_a, _b);                 }
+	static inline Vec    Or(Vec _a, Vec _b)        { return _mm_or_si128(_a, _b);                   }
+	static inline Vec    And(Vec _a, Vec _b)       { return _mm_and_si128(_a, _b);                  }
+	static inline Vec    AndNot(Vec _a, Vec _b)    { return _mm_andnot_si128(_a, _b);               } // ~_a & _b
+	static inline Vec    Xor(Vec _a, Vec _b)       { return _mm_xor_si128(_a, _b);                  }
+	static inline Vec    Sub(Vec _a, Vec _b)       { return _mm_sub_epi8(_a, _b);                   }
+	static inline Vec    MinU(Vec _a, Vec _b)      { return _mm_min_epu8(_a, _b);                   }
+	static inline uint32 Mask(Vec _v)              { return (uint32)_mm_movemask_epi8(_v);          }
+#endif
+
+static inline uint32 CountTrailingZeros(uint32 _x)
+{
+	APT_STRICT_ASSERT(_x != 0);
+#if APT_COMPILER_MSVC
+	unsigned long ret;
+	_BitScanForward(&ret, _x);
+	return (uint32)ret;
+#else
+	return (uint32)__builtin_ctz(_x);
+#endif
+}
+
+static inline uint32 PopCount(uint32 _x)
+{
+ // avoid the popcnt instruction, it isn't guaranteed on all x64 CPUs
+	_x = _x - ((_x >> 1) & 0x55555555u);
+	_x = (_x & 0x33333333u) + ((_x >> 2) & 0x33333333u);
+	return (((_x + (_x >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+}
+
+// Lanes of _v in [_lo, _hi] (unsigned comparison).
+static inline Vec InRange(Vec _v, char _lo, char _hi)
+{
+	Vec t = Sub(_v, Splat(_lo));
+	return CmpEq(MinU(t, Splat(_hi - _lo)), t);
+}
+
+static inline Vec IsWhitespace(Vec _v)
+{
+	return Or(CmpEq(_v, Splat(' ')), InRange(_v, '\t', '\r'));
+}
+
+// Splatted chars from a null-terminated list, for small lists only.
+struct CharList
+{
+	enum { kMaxSize = 16 };
+	Vec m_chars[kMaxSize];
+	int m_size;
+
+	// Return false if _list is too long.
+	bool init(const char* _list)
+	{
+		for (m_size = 0; _list[m_size]; ++m_size) {
+			if (m_size == kMaxSize) {
+				return false;
+			}
+			m_chars[m_size] = Splat(_list[m_size]);
+		}
+		return true;
+	}
+
+	Vec match(Vec _v) const
+	{
+		Vec ret = Splat(0);
+		for (int i = 0; i < m_size; ++i) {
+			ret = Or(ret, CmpEq(_v, m_chars[i]));
+		}
+		return ret;
+	}
+};
+
+// Scan null-terminated _str using aligned loads. _match returns a bitmask of matching chars in a block. Return ptr to
+// the first match or to the null terminator.
+template <typename tMatch>
+static inline const char* Scan(const char* _str, tMatch _match)
+{
+	const Vec zero = Splat(0);
+	const char* p = (const char*)((uintptr_t)_str & ~(uintptr_t)(kVecSize - 1));
+	Vec v = Load(p);
+	uint32 mask = (_match(v) | Mask(CmpEq(v, zero))) >> (uint32)(_str - p); // discard chars before _str
+	if (mask) {
+		return _str + CountTrailingZeros(mask);
+	}
+	for (;;) {
+		p += kVecSize;
+		v = Load(p);
+		mask = _match(v) | Mask(CmpEq(v, zero));
+		if (mask) {
+			return p + CountTrailingZeros(mask);
+		}
+	}
+}
+
+const char* internal::FindChar(const char* _str, char _c)
+{
+	const Vec c = Splat(_c);
+	return Scan(_str, [c](Vec _v) { return Mask(CmpEq(_v, c)); });
+}
+
+const char* internal::FindAny(const char* _str, const char* _list)
+{
+	if (_list[0] && !_list[1]) {
+		return FindChar(_str, _list[0]);
+	}
+	CharList list;
+	if (!list.init(_list)) {
+		return scalar::FindAny(_str, _list);
+	}
+	return Scan(_str, [&list](Vec _v) { return Mask(list.match(_v)); });
+}
+
+const char* internal::FindWhitespace(const char* _str)
+{
+	return Scan(_str, [](Vec _v) { return Mask(IsWhitespace(_v)); });
+}
+
+const char* internal::FindWhitespaceOrAny(const char* _str, const char* _list)
+{
+	CharList list;
+	if (!list.init(_list)) {
+		return scalar::FindWhitespaceOrAny(_str, _list);
+	}
+	return Scan(_str, [&list](Vec _v) { return Mask(Or(IsWhitespace(_v), list.match(_v))); });
+}
+
+const char* internal::SkipWhitespace(const char* _str)
+{
+ // typically there are only a few whitespace chars to skip, check the first one before starting a block scan
+	if (!IsWhitespace(*_str)) {
+		return _str;
+	}
+ // the null terminator isn't whitespace, hence Scan() will stop there
+	return Scan(_str, [](Vec _v) { return ~Mask(IsWhitespace(_v)) & kFullMask; });
+}
+
+const char* internal::FindSubstring(const char* _str, const char* _sub)
+{
+	if (!*_sub) {
+		return _str;
+	}
+	uint subLen = strlen(_sub);
+	for (;;) {
+		_str = FindChar(_str, *_sub);
+		if (!*_str) {
+			return nullptr;
+		}
+		if (strncmp(_str + 1, _sub + 1, subLen - 1) == 0) { // strncmp stops at the end of _str
+			return _str;
+		}
+		++_str;
+	}
+}
+
+const char* internal::FindSubstring(const char* _str, uint _strLen, const char* _sub, uint _subLen)
+{
+	if (_subLen == 0) {
+		return _str;
+	}
+	if (_subLen > _strLen) {
+		return nullptr;
+	}
+ // compare the first and last chars of _sub at each position, only call memcmp for candidates
+	const Vec first = Splat(_sub[0]);
+	const Vec last  = Splat(_sub[_subLen - 1]);
+	uint i = 0;
+	for (; i + _subLen - 1 + kVecSize <= _strLen; i += kVecSize) {
+		uint32 mask = Mask(And(CmpEq(LoadU(_str + i), first), CmpEq(LoadU(_str + i + _subLen - 1), last)));
+		while (mask) {
+			const char* candidate = _str + i + CountTrailingZeros(mask);
+			if (memcmp(candidate, _sub, _subLen) == 0) {
+				return candidate;
+			}
+			mask &= mask - 1;
+		}
+	}
+	return scalar::FindSubstring(_str + i, _strLen - i, _sub, _subLen);
+}
+
+uint internal::CountChar(const char* _beg, const char* _end, char _c)
+{
+	const Vec c = Splat(_c);
+	uint ret = 0;
+	for (; _beg + kVecSize <= _end; _beg += kVecSize) {
+		ret += PopCount(Mask(CmpEq(LoadU(_beg), c)));
+	}
+	return ret + scalar::CountChar(_beg, _end, _c);
+}
+
+uint internal::ReplaceChar(char* _str, uint _len, char _find, char _replace)
+{
+	const Vec find = Splat(_find);
+	const Vec repl = Splat(_replace);
+	uint ret = 0;
+	uint i = 0;
+	for (; i + kVecSize <= _len; i += kVecSize) {
+		Vec v = LoadU(_str + i);
+		Vec m = CmpEq(v, find);
+		uint32 mask = Mask(m);
+		if (mask) {
+			StoreU(_str + i, Or(AndNot(m, v), And(m, repl)));
+			ret += PopCount(mask);
+		}
+	}
+	return ret + scalar::ReplaceChar(_str + i, _len - i, _find, _replace);
+}
+
+// Flip the case bit (0x20) of chars in [_lo, _hi].
+static inline void FlipCase(char* _str, uint _len, char _lo, char _hi)
+{
+	const Vec caseBit = Splat(0x20);
+	uint i = 0;
+	for (; i + kVecSize <= _len; i += kVecSize) {
+		Vec v = LoadU(_str + i);
+		StoreU(_str + i, Xor(v, And(InRange(v, _lo, _hi), caseBit)));
+	}
+	for (; i < _len; ++i) {
+		if (_str[i] >= _lo && _str[i] <= _hi) {
+			_str[i] ^= 0x20;
+		}
+	}
+}
+
+void internal::ToUpperCase(char* _str, uint _len)
+{
+	FlipCase(_str, _len, 'a', 'z');
+}
+
+void internal::ToLowerCase(char* _str, uint _len)
+{
+	FlipCase(_str, _len, 'A', 'Z');
+}
+
+#endif // APT_DISABLE_SIMD
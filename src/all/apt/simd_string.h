@@ -0,0 +1,67 @@
+#pragma once
+
+#include <apt/apt.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// SIMD string kernels used by StringBase and TextParser. SSE2 is used by
+// default, AVX2 if the build targets it (i.e. __AVX2__ is defined). Define
+// APT_DISABLE_SIMD to use the scalar versions.
+//
+// Functions which take a null-terminated string may read beyond the null
+// terminator up to the end of the containing aligned block (which never
+// crosses a page boundary).
+//
+// Whitespace is classified as per isspace() in the "C" locale: ' ', '\t',
+// '\n', '\v', '\f', '\r'. Case conversion is ASCII only.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace apt { namespace internal {
+
+// Return ptr to the first occurrence of _c in _str, or to the null terminator if not found.
+const char* FindChar(const char* _str, char _c);
+
+// Return ptr to the first occurrence of any char in _list (null-terminated), or to the null terminator if not found.
+const char* FindAny(const char* _str, const char* _list);
+
+// Return ptr to the first whitespace char in _str, or to the null terminator if not found.
+const char* FindWhitespace(const char* _str);
+
+// Return ptr to the first whitespace char or any char in _list, or to the null terminator if not found.
+const char* FindWhitespaceOrAny(const char* _str, const char* _list);
+
+// Return ptr to the first non-whitespace char in _str (which may be the null terminator).
+const char* SkipWhitespace(const char* _str);
+
+// Return ptr to the first occurrence of _sub in _str, or nullptr if not found.
+const char* FindSubstring(const char* _str, const char* _sub);
+// As FindSubstring(), _str and _sub have a known length and may contain null characters.
+const char* FindSubstring(const char* _str, uint _strLen, const char* _sub, uint _subLen);
+
+// Return # occurrences of _c in [_beg, _end).
+uint        CountChar(const char* _beg, const char* _end, char _c);
+
+// Replace all instances of _find with _replace in the first _len chars of _str. Return the number of instances replaced.
+uint        ReplaceChar(char* _str, uint _len, char _find, char _replace);
+
+// Convert the first _len chars of _str to upper/lower case.
+void        ToUpperCase(char* _str, uint _len);
+void        ToLowerCase(char* _str, uint _len);
+
+// Scalar reference implementations of the above.
+namespace scalar {
+
+const char* FindChar(const char* _str, char _c);
+const char* FindAny(const char* _str, const char* _list);
+const char* FindWhitespace(const char* _str);
+const char* FindWhitespaceOrAny(const char* _str, const char* _list);
+const char* SkipWhitespace(const char* _str);
+const char* FindSubstring(const char* _str, const char* _sub);
+const char* FindSubstring(const char* _str, uint _strLen, const char* _sub, uint _subLen);
+uint        CountChar(const char* _beg, const char* _end, char _c);
+uint        ReplaceChar(char* _str, uint _len, char _find, char _replace);
+void        ToUpperCase(char* _str, uint _len);
+void        ToLowerCase(char* _str, uint _len);
+
+} // namespace scalar
+
+} } // namespace apt::internal
@@ -85,6 +85,7 @@ bool File::Read(File& file_, const char* _path)
 	ret = true;
 	
   // close existing handle/free existing data
+	file_.unmap();
 	if ((HANDLE)file_.m_impl != INVALID_HANDLE_VALUE) {
 		APT_PLATFORM_VERIFY(CloseHandle((HANDLE)file_.m_impl));
 	}
@@ -92,8 +93,9 @@ bool File::Read(File& file_, const char* _path)
 		APT_FREE(file_.m_data);
 	}
 	
-	file_.m_data     = data;
-	file_.m_dataSize = dataSize;
+	file_.m_data         = data;
+	file_.m_dataSize     = dataSize;
+	file_.m_dataCapacity = dataSize + 2;
 	file_.setPath(_path);
 
 File_Read_end:
@@ -110,6 +112,77 @@ File_Read_end:
 	return ret;
 }
 
+bool File::Map(File& file_, const char* _path)
+{
+	if (!_path) {
+		_path = file_.getPath();
+	}
+	APT_ASSERT(_path);
+
+	bool   ret     = false;
+	char*  data    = nullptr;
+	HANDLE mapping = NULL;
+	DWORD  err     = 0;
+	LARGE_INTEGER li;
+
+ 	HANDLE h = CreateFile(
+		_path,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL
+		);
+	if (h == INVALID_HANDLE_VALUE) {
+		err = GetLastError();
+		goto File_Map_end;
+	}
+	if (!GetFileSizeEx(h, &li)) {
+		err = GetLastError();
+		goto File_Map_end;
+	}
+	if (li.QuadPart > 0) { // can't map an empty file
+		mapping = CreateFileMapping(h, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			err = GetLastError();
+			goto File_Map_end;
+		}
+		data = (char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) {
+			err = GetLastError();
+			goto File_Map_end;
+		}
+	}
+
+	ret = true;
+
+  // release existing data
+	file_.setData(0, 0);
+	if ((HANDLE)file_.m_impl != INVALID_HANDLE_VALUE) {
+		APT_PLATFORM_VERIFY(CloseHandle((HANDLE)file_.m_impl));
+	}
+
+	file_.m_data     = data;
+	file_.m_dataSize = (uint64)li.QuadPart;
+	file_.m_impl     = mapping ? mapping : INVALID_HANDLE_VALUE; // the view keeps the file open, only need the mapping handle
+	file_.m_isMapped = mapping != NULL;
+	file_.setPath(_path);
+
+File_Map_end:
+	if (!ret) {
+		if (mapping != NULL) {
+			APT_PLATFORM_VERIFY(CloseHandle(mapping));
+		}
+		APT_LOG_ERR("Error mapping '%s':\n\t%s", _path, GetPlatformErrorString((uint64)err));
+		APT_ASSERT(false);
+	}
+	if (h != INVALID_HANDLE_VALUE) {
+		APT_PLATFORM_VERIFY(CloseHandle(h));
+	}
+	return ret;
+}
+
 bool File::Write(const File& _file, const char* _path)
 {
 	if (!_path) {
@@ -160,4 +233,20 @@ File_Write_end:
 		APT_PLATFORM_VERIFY(CloseHandle(h));
 	}
 	return ret;
+}
+
+// PRIVATE
+
+void File::unmap()
+{
+	if (!m_isMapped) {
+		return;
+	}
+	APT_PLATFORM_VERIFY(UnmapViewOfFile(m_data));
+	APT_PLATFORM_VERIFY(CloseHandle((HANDLE)m_impl));
+	m_impl         = INVALID_HANDLE_VALUE;
+	m_data         = nullptr;
+	m_dataSize     = 0;
+	m_dataCapacity = 0;
+	m_isMapped     = false;
 }
\ No newline at end of file
@@ -23,6 +23,11 @@ using namespace apt;
 // Windows expects a list of string pairs to pass to GetOpenFileName() (display name, filter).
 static void BuildFilterString(std::initializer_list<const char*> _filterList, StringBase& ret_)
 {
+	uint len = ret_.getLength();
+	for (auto& filter : _filterList) {
+		len += strlen(filter) * 2 + 2;
+	}
+	ret_.reserve(len + 1);
 	for (auto& filter : _filterList) {
 		ret_.appendf("%s?%s?", filter, filter);
 	}
@@ -120,6 +125,15 @@ bool FileSystem::Delete(const char* _path)
 	return true;
 }
 
+bool FileSystem::Rename(const char* _from, const char* _to)
+{
+	if (MoveFileEx(_from, _to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == 0) {
+		APT_LOG_ERR("MoveFileEx(%s, %s): %s", _from, _to, GetPlatformErrorString(GetLastError()));
+		return false;
+	}
+	return true;
+}
+
 DateTime FileSystem::GetTimeCreated(const char* _path, RootType _rootHint)
 {
 	PathStr fullPath;
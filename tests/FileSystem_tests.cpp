@@ -1,6 +1,12 @@
 #include <catch.hpp>
 
 #include <apt/Filesystem.h>
+#include <apt/log.h>
+#include <apt/memory.h>
+#include <apt/StringHash.h>
+#include <apt/Time.h>
+
+#include <EASTL/vector.h>
 
 using namespace apt;
 
@@ -29,3 +35,71 @@ TEST_CASE("Matches", "[FileSystem]")
 	REQUIRE(FileSystem::Matches("*Law*",   "La")       == false);
 	REQUIRE(FileSystem::Matches("*Law*",   "aw")       == false);
 }
+
+TEST_CASE("Path manipulation", "[FileSystem]")
+{
+	const char* kPath = "dir.0/dir1\\file.tar.gz";
+	REQUIRE(FileSystem::StripPath(kPath)    == "file.tar.gz");
+	REQUIRE(FileSystem::GetPath(kPath)      == "dir.0/dir1\\");
+	REQUIRE(FileSystem::GetFileName(kPath)  == "file");
+	REQUIRE(FileSystem::GetExtension(kPath) == "gz");
+	REQUIRE(FileSystem::StripPath(kPath).begin() == kPath + 11); // no copy
+
+	REQUIRE(FileSystem::StripPath("file")     == "file");
+	REQUIRE(FileSystem::GetPath("file")       == "");
+	REQUIRE(FileSystem::GetExtension("dir.0/file").isEmpty());
+	REQUIRE(FileSystem::GetFileName("dir/")   == "");
+
+	PathStr path(kPath);
+	PathStr name = FileSystem::GetFileName(path);
+	REQUIRE(name == "file");
+}
+
+TEST_CASE("Path manipulation performance", "[FileSystem][.]")
+{
+	const int kPathCount = 100000;
+	eastl::vector<PathStr> paths(kPathCount);
+	for (int i = 0; i < kPathCount; ++i) {
+		if (i % 4 == 0) {
+			paths[i].setf("assets/characters/non_player/variants/%d/textures/high_resolution/compressed/bc7/mip_chain/%d/albedo_roughness_metallic/baked_lighting/%d.dds", i, i, i);
+		} else {
+			paths[i].setf("assets/models/%d/mesh_%d.obj", i % 100, i);
+		}
+	}
+
+	APT_LOG("\nFileSystem path manipulation (%d paths) *********", kPathCount);
+
+ // previous API, a PathStr copy per call
+	uint64 allocCount = internal::GetAllocCount();
+	uint   extCount = 0;
+	Timestamp t = Time::GetTimestamp();
+	for (auto& path : paths) {
+		PathStr name(FileSystem::StripPath(path));
+		PathStr ext(FileSystem::GetExtension(path));
+		PathStr dir(FileSystem::GetPath(path));
+		extCount += ext == "dds" ? 1 : 0;
+		extCount += StringHash((const char*)name) == StringHash("mesh_1.obj") ? 1 : 0;
+		extCount += dir.isEmpty() ? 1 : 0;
+	}
+	t = Time::GetTimestamp() - t;
+	allocCount = internal::GetAllocCount() - allocCount;
+	APT_LOG("\tPathStr:    %8llu allocs, %s", allocCount, t.asString());
+
+ // views
+	allocCount = internal::GetAllocCount();
+	uint viewExtCount = 0;
+	t = Time::GetTimestamp();
+	for (auto& path : paths) {
+		StringView name = FileSystem::StripPath(path);
+		StringView ext  = FileSystem::GetExtension(path);
+		StringView dir  = FileSystem::GetPath(path);
+		viewExtCount += ext == "dds" ? 1 : 0;
+		viewExtCount += StringHash(name) == StringHash("mesh_1.obj") ? 1 : 0;
+		viewExtCount += dir.isEmpty() ? 1 : 0;
+	}
+	t = Time::GetTimestamp() - t;
+	allocCount = internal::GetAllocCount() - allocCount;
+	APT_LOG("\tStringView: %8llu allocs, %s", allocCount, t.asString());
+
+	REQUIRE(extCount == viewExtCount);
+}
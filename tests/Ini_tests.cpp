@@ -0,0 +1,307 @@
+#include <catch.hpp>
+
+#include <apt/log.h>
+#include <apt/File.h>
+#include <apt/FileSystem.h>
+#include <apt/Ini.h>
+#include <apt/memory.h>
+#include <apt/String.h>
+#include <apt/Time.h>
+
+using namespace apt;
+
+static bool ReadIni(Ini& ini_, const char* _str)
+{
+	File f;
+	f.setData(_str, strlen(_str) + 1); // parser expects a null terminator, as per File::Read()
+	return Ini::Read(ini_, f);
+}
+
+TEST_CASE("getProperty", "[Ini]")
+{
+	Ini ini;
+	REQUIRE(ReadIni(ini,
+		"global = 1\n"
+		"[a]\n"
+		"x = 2\n"
+		"y = 0.5, 1.5\n"
+		"[b]\n"
+		"x = 3\n"
+		"z = \"str\"\n"
+		));
+
+	REQUIRE(ini.getProperty("global").asInt() == 1);
+	REQUIRE(ini.getProperty("global", "").asInt() == 1);
+	REQUIRE(ini.getProperty("x").asInt() == 2);          // first occurrence
+	REQUIRE(ini.getProperty("x", "a").asInt() == 2);
+	REQUIRE(ini.getProperty("x", "b").asInt() == 3);
+	REQUIRE(ini.getProperty("y", "a").getCount() == 2);
+	REQUIRE(ini.getProperty("y", "a").asDouble(1) == 1.5);
+	REQUIRE(ini.getProperty("y", "b").isNull());
+	REQUIRE(strcmp(ini.getProperty("z").asString(), "str") == 0);
+	REQUIRE(ini.getProperty("w").isNull());
+
+	String<8> name("x");
+	REQUIRE(ini.getProperty(StringView(name), StringView("b")).asInt() == 3);
+	REQUIRE(ini.getProperty(StringHash("x"), StringHash("b")).asInt() == 3);
+	REQUIRE(ini.getProperty(StringHash("x")).asInt() == 2);
+	REQUIRE(ini.getProperty(StringHash("w")).isNull());
+
+ // pushed properties are indexed
+	ini.pushSection("c");
+	ini.pushValue<int>("x", 4);
+	ini.pushValue("s", "pushed");
+	REQUIRE(ini.getProperty("x", "c").asInt() == 4);
+	REQUIRE(ini.getProperty("x").asInt() == 2);
+	REQUIRE(strcmp(ini.getProperty("s", "c").asString(), "pushed") == 0);
+	REQUIRE(strcmp(ini.getProperty("s").asString(), "pushed") == 0);
+}
+
+TEST_CASE("Format_Binary", "[Ini]")
+{
+	Ini src;
+	REQUIRE(ReadIni(src,
+		"global = 1\n"
+		"[a]\n"
+		"x = 2\n"
+		"y = 0.5, 1.5\n"
+		"[b]\n"
+		"x = 3\n"
+		"t = true\n"
+		"z = \"str\", \"array\"\n"
+		));
+	File f;
+	REQUIRE(Ini::Write(src, f, Ini::Format_Binary));
+
+	Ini ini;
+	REQUIRE(Ini::Read(ini, f));
+	REQUIRE(ini.getProperty("global").asInt() == 1);
+	REQUIRE(ini.getProperty("x").asInt() == 2);
+	REQUIRE(ini.getProperty("x", "b").asInt() == 3);
+	REQUIRE(ini.getProperty("y", "a").getCount() == 2);
+	REQUIRE(ini.getProperty("y", "a").asDouble(1) == 1.5);
+	REQUIRE(ini.getProperty("y", "b").isNull());
+	REQUIRE(ini.getProperty("z").getCount() == 2);
+	REQUIRE(strcmp(ini.getProperty("z", "b").asString(0), "str") == 0);
+	REQUIRE(strcmp(ini.getProperty("z", "b").asString(1), "array") == 0);
+	REQUIRE(ini.getProperty(StringHash("t"), StringHash("b")).asBool() == true);
+	REQUIRE(ini.getProperty("w").isNull());
+
+ // images are read only, can be rewritten as binary only
+	File f2;
+	REQUIRE(!Ini::Write(ini, f2));
+	REQUIRE(Ini::Write(ini, f2, Ini::Format_Binary));
+	REQUIRE(f2.getDataSize() == f.getDataSize());
+	REQUIRE(memcmp(f2.getData(), f.getData(), (size_t)f.getDataSize()) == 0);
+	REQUIRE(!ReadIni(ini, "w = 1\n"));
+
+ // corrupt image
+	f.getData()[sizeof(uint32)] = 0x7f;
+	Ini bad;
+	REQUIRE(!Ini::Read(bad, f));
+
+ // offsets/counts out of range, index without an empty slot
+	REQUIRE(Ini::Write(src, f, Ini::Format_Binary));
+	uint32 header[12];
+	memcpy(header, f.getData(), sizeof(header));
+	for (int i : { 3, 4, 5, 6, 7, 8, 9, 10, 11 }) { // m_sectionCount .. m_strings
+		File corrupt;
+		corrupt.setData(f.getData(), f.getDataSize());
+		uint32 value = header[i] + (i == 6 ? 1 : 0xffff0);
+		memcpy(corrupt.getData() + i * sizeof(uint32), &value, sizeof(value));
+		REQUIRE(!Ini::Read(bad, corrupt));
+	}
+	{	File corrupt;
+		corrupt.setData(f.getData(), f.getDataSize());
+		char* index = corrupt.getData() + header[10];
+		for (uint32 i = 0; i < header[6]; ++i) {
+			int entry = 0;
+			memcpy(index + i * 16 + 8, &entry, sizeof(entry)); // IndexEntry::m_index
+		}
+		REQUIRE(!Ini::Read(bad, corrupt));
+	}
+}
+
+TEST_CASE("ReadCached", "[Ini]")
+{
+	const char* kPath = "Ini_tests_ReadCached.ini";
+	const char* kCachePath = "Ini_tests_ReadCached.ini.bin";
+	FileSystem::Delete(kCachePath);
+
+	File f;
+	const char* kSrc = "[a]\nx = 2\ns = \"str\"\n";
+	f.setData(kSrc, strlen(kSrc));
+	REQUIRE(File::Write(f, kPath));
+
+	{	Ini ini;
+		REQUIRE(Ini::ReadCached(ini, kPath)); // parse, write the cache
+		REQUIRE(ini.getProperty("x", "a").asInt() == 2);
+		REQUIRE(File::Exists(kCachePath));
+	}
+	{	Ini ini;
+		REQUIRE(Ini::ReadCached(ini, kPath)); // read the cache (mapped)
+		REQUIRE(ini.getProperty("x", "a").asInt() == 2);
+		REQUIRE(strcmp(ini.getProperty("s").asString(), "str") == 0);
+		REQUIRE(!Ini::Write(ini, f)); // proves the cache was used
+	}
+	{	File corrupt;
+		corrupt.setData("\0INI garbage", 12);
+		REQUIRE(File::Write(corrupt, kCachePath));
+		Ini ini;
+		REQUIRE(Ini::ReadCached(ini, kPath)); // corrupt cache, parse and rewrite
+		REQUIRE(ini.getProperty("x", "a").asInt() == 2);
+		REQUIRE(!File::Exists("Ini_tests_ReadCached.ini.bin.tmp"));
+	}
+	{	Ini ini;
+		REQUIRE(Ini::ReadCached(ini, kPath)); // rewritten cache is valid
+		REQUIRE(ini.getProperty("x", "a").asInt() == 2);
+		REQUIRE(!Ini::Write(ini, f));
+	}
+
+	FileSystem::Delete(kPath);
+	FileSystem::Delete(kCachePath);
+}
+
+TEST_CASE("getProperty performance", "[Ini][.]")
+{
+	const int kSectionCount = 500;
+	const int kKeysPerSection = 100; // 50k keys
+
+	StringBuilder src;
+	for (int i = 0; i < kSectionCount; ++i) {
+		src.appendf("[section%d]\n", i);
+		for (int j = 0; j < kKeysPerSection; ++j) {
+			src.appendf("key%dx%d = %d\n", i, j, j);
+		}
+	}
+
+	APT_LOG("\nIni getProperty performance (%d keys) *********", kSectionCount * kKeysPerSection);
+	Ini ini;
+	Timestamp t = Time::GetTimestamp();
+	REQUIRE(ReadIni(ini, (const char*)src));
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tRead                  %10.2fms", t.asMilliseconds());
+
+ // query every key, as at startup
+	String<64> key, section;
+	volatile sint64 sink = 0;
+	t = Time::GetTimestamp();
+	for (int i = 0; i < kSectionCount; ++i) {
+		section.setf("section%d", i);
+		for (int j = 0; j < kKeysPerSection; ++j) {
+			key.setf("key%dx%d", i, j);
+			sink = sink + ini.getProperty((const char*)key, (const char*)section).asInt();
+		}
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tgetProperty(section)  %10.2fms", t.asMilliseconds());
+
+	t = Time::GetTimestamp();
+	for (int i = 0; i < kSectionCount; ++i) {
+		for (int j = 0; j < kKeysPerSection; ++j) {
+			key.setf("key%dx%d", i, j);
+			sink = sink + ini.getProperty((const char*)key).asInt();
+		}
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tgetProperty()         %10.2fms", t.asMilliseconds());
+
+	StringHash* hashes = new StringHash[kSectionCount * kKeysPerSection];
+	for (int i = 0; i < kSectionCount; ++i) {
+		for (int j = 0; j < kKeysPerSection; ++j) {
+			key.setf("key%dx%d", i, j);
+			hashes[i * kKeysPerSection + j] = StringHash((const char*)key);
+		}
+	}
+	t = Time::GetTimestamp();
+	for (int i = 0; i < kSectionCount * kKeysPerSection; ++i) {
+		sink = sink + ini.getProperty(hashes[i]).asInt();
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tgetProperty(hash)     %10.2fms", t.asMilliseconds());
+	delete[] hashes;
+}
+
+TEST_CASE("Read performance", "[Ini][.]")
+{
+	const int kKeyCount = 200000;
+
+	StringBuilder src;
+	for (int i = 0; i < kKeyCount; ++i) {
+		if (i % 100 == 0) {
+			src.appendf("[section%d]\n", i / 100);
+		}
+		switch (i % 4) {
+			case 0:  src.appendf("key%d = \"value %d\"\n", i, i); break;
+			case 1:  src.appendf("key%d = \"a\", \"b\", \"c\"\n", i); break;
+			case 2:  src.appendf("key%d = %d, %d\n", i, i, -i); break;
+			default: src.appendf("key%d = %d.5\n", i, i); break;
+		};
+	}
+
+	APT_LOG("\nIni Read performance (%d keys, %u bytes) *********", kKeyCount, src.getLength());
+	File f;
+	f.setData((const char*)src, src.getLength() + 1);
+	for (int i = 0; i < 2; ++i) { // 2nd iteration re-reads into a new Ini
+		Ini* ini = new Ini;
+		uint64 allocs = internal::GetAllocCount();
+		Timestamp t = Time::GetTimestamp();
+		REQUIRE(Ini::Read(*ini, f));
+		t = Time::GetTimestamp() - t;
+		allocs = internal::GetAllocCount() - allocs;
+		APT_LOG("\tRead     %10.2fms, %llu allocations", t.asMilliseconds(), allocs);
+		t = Time::GetTimestamp();
+		delete ini;
+		t = Time::GetTimestamp() - t;
+		APT_LOG("\t~Ini     %10.2fms", t.asMilliseconds());
+	}
+}
+
+TEST_CASE("Format_Binary performance", "[Ini][.]")
+{
+	const int kKeyCount = 200000;
+	const char* kTextPath = "Ini_tests_perf.ini";
+	const char* kBinaryPath = "Ini_tests_perf.ini.bin";
+
+	StringBuilder src;
+	for (int i = 0; i < kKeyCount; ++i) {
+		if (i % 100 == 0) {
+			src.appendf("[section%d]\n", i / 100);
+		}
+		switch (i % 4) {
+			case 0:  src.appendf("key%d = \"value %d\"\n", i, i); break;
+			case 1:  src.appendf("key%d = \"a\", \"b\", \"c\"\n", i); break;
+			case 2:  src.appendf("key%d = %d, %d\n", i, i, -i); break;
+			default: src.appendf("key%d = %d.5\n", i, i); break;
+		};
+	}
+	File f;
+	f.setData((const char*)src, src.getLength());
+	REQUIRE(File::Write(f, kTextPath));
+	{	Ini ini;
+		REQUIRE(Ini::Read(ini, kTextPath));
+		REQUIRE(Ini::Write(ini, kBinaryPath, Ini::Format_Binary));
+	}
+
+	APT_LOG("\nIni Format_Binary performance (%d keys) *********", kKeyCount);
+	String<64> key;
+	volatile sint64 sink = 0;
+	const char* paths[] = { kTextPath, kBinaryPath };
+	const char* names[] = { "text  ", "binary" };
+	for (int i = 0; i < 2; ++i) {
+		Timestamp t = Time::GetTimestamp();
+		Ini* ini = new Ini;
+		REQUIRE(Ini::Read(*ini, paths[i]));
+		Timestamp tload = Time::GetTimestamp() - t;
+		for (int j = 0; j < kKeyCount; j += 100) { // query a subset, as at startup
+			key.setf("key%d", j);
+			sink = sink + ini->getProperty((const char*)key).getCount();
+		}
+		delete ini;
+		t = Time::GetTimestamp() - t;
+		APT_LOG("\t%s Read %10.2fms, total %10.2fms", names[i], tload.asMilliseconds(), t.asMilliseconds());
+	}
+
+	FileSystem::Delete(kTextPath);
+	FileSystem::Delete(kBinaryPath);
+}
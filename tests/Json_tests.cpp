@@ -1,7 +1,15 @@
 #include <catch.hpp>
 
+#include <apt/log.h>
 #include <apt/memory.h>
+#include <apt/File.h>
+#include <apt/FileSystem.h>
 #include <apt/Json.h>
+#include <apt/String.h>
+#include <apt/Time.h>
+
+#include <cstdarg>
+#include <cstdio>
 
 using namespace apt;
 
@@ -128,6 +136,54 @@ TEST_CASE("Binary", "[SerializerJson]")
 	
 	REQUIRE(dataSize == kSrcDataSize);
 	REQUIRE(memcmp(data, kSrcData, dataSize) == 0);
+	free(data);
+
+ // decode to a caller buffer
+	char buf[512];
+	data = buf;
+	REQUIRE(js.binary(data, dataSize, "BinaryTest"));
+	REQUIRE(memcmp(buf, kSrcData, kSrcDataSize) == 0);
+
+ // compressed
+	js.setMode(SerializerJson::Mode_Write);
+	data = (void*)kSrcData;
+	dataSize = kSrcDataSize;
+	js.binary(data, dataSize, "BinaryTestCompressed", CompressionFlags_Speed);
+	js.setMode(SerializerJson::Mode_Read);
+	data = nullptr;
+	REQUIRE(js.binary(data, dataSize, "BinaryTestCompressed"));
+	REQUIRE(dataSize == kSrcDataSize);
+	REQUIRE(memcmp(data, kSrcData, dataSize) == 0);
+	free(data);
+
+ // compressed, fast codec (detected by Decompress)
+	js.setMode(SerializerJson::Mode_Write);
+	data = (void*)kSrcData;
+	dataSize = kSrcDataSize;
+	js.binary(data, dataSize, "BinaryTestCompressedFastest", CompressionFlags_Fastest);
+	js.setMode(SerializerJson::Mode_Read);
+	data = buf;
+	REQUIRE(js.binary(data, dataSize, "BinaryTestCompressedFastest"));
+	REQUIRE(dataSize == kSrcDataSize);
+	REQUIRE(memcmp(buf, kSrcData, kSrcDataSize) == 0);
+
+ // missing/empty
+	js.setMode(SerializerJson::Mode_Write);
+	String<8> empty;
+	js.value((StringBase&)empty, "BinaryTestEmpty");
+	js.setMode(SerializerJson::Mode_Read);
+	data = nullptr;
+	REQUIRE(!js.binary(data, dataSize, "BinaryTestMissing"));
+	REQUIRE(!js.binary(data, dataSize, "BinaryTestEmpty"));
+	REQUIRE(data == nullptr);
+
+ // corrupt compressed data
+	js.setMode(SerializerJson::Mode_Write);
+	String<8> corrupt("1AAAA");
+	js.value((StringBase&)corrupt, "BinaryTestCorrupt");
+	js.setMode(SerializerJson::Mode_Read);
+	REQUIRE(!js.binary(data, dataSize, "BinaryTestCorrupt"));
+	REQUIRE(data == nullptr);
 }
 
 TEST_CASE("Enum", "[SerializerJson]")
@@ -170,4 +226,637 @@ TEST_CASE("Enum", "[SerializerJson]")
 	REQUIRE(apples == Fruit_Apples);
 	REQUIRE(pears  == Fruit_Pears);
 	REQUIRE(count  == Fruit_Count);
+}
+
+TEST_CASE("ReadInsitu", "[Json]")
+{
+	const char* kSrc = "{ \"str\": \"value\", \"esc\": \"a\\tb\", \"num\": 2 }";
+	File f;
+	f.setData(kSrc, strlen(kSrc) + 1);
+	const char* beg = f.getData();
+	const char* end = beg + f.getDataSize();
+
+	Json json;
+	REQUIRE(Json::ReadInsitu(json, f));
+	REQUIRE(f.getData() == nullptr); // buffer was moved into json
+	const char* str = json.getValue<const char*>("str");
+	REQUIRE(strcmp(str, "value") == 0);
+	REQUIRE((str >= beg && str < end)); // points into the buffer
+	REQUIRE(strcmp(json.getValue<const char*>("esc"), "a\tb") == 0);
+	REQUIRE(json.getValue<int>("num") == 2);
+
+	f.setData("{ invalid", 10);
+	REQUIRE(!Json::ReadInsitu(json, f));
+	REQUIRE(strcmp(json.getValue<const char*>("str"), "value") == 0); // unchanged on error
+	REQUIRE(f.getData() != nullptr); // caller keeps the buffer on error
+	REQUIRE(f.getDataSize() == 10);
+}
+
+TEST_CASE("ReadInsitu performance", "[Json][.]")
+{
+	const int kObjectCount = 1000000;
+
+	StringBuilder src;
+	src.append("[\n");
+	for (int i = 0; i < kObjectCount; ++i) {
+		src.appendf("\t{ \"name\": \"object %d\", \"tag\": \"some string value %d\", \"id\": %d, \"values\": [%d.5, %d, \"%d\"] }%s\n", i, i, i, i, -i, i, i == kObjectCount - 1 ? "" : ",");
+	}
+	src.append("]");
+
+	APT_LOG("\nJson ReadInsitu performance (%u bytes) *********", src.getLength());
+	File f;
+	f.setData((const char*)src, src.getLength() + 1);
+	Timestamp t = Time::GetTimestamp();
+	{	Json json;
+		REQUIRE(Json::Read(json, f));
+		t = Time::GetTimestamp() - t;
+	}
+	APT_LOG("\tRead        %10.2fms", t.asMilliseconds());
+	t = Time::GetTimestamp();
+	{	Json json;
+		REQUIRE(Json::ReadInsitu(json, f));
+		t = Time::GetTimestamp() - t;
+	}
+	APT_LOG("\tReadInsitu  %10.2fms", t.asMilliseconds());
+}
+
+// Record events as a string.
+struct JsonReaderRecorder: public JsonReader::Handler
+{
+	StringBuilder m_events;
+	int           m_stopAfter = -1;
+
+	bool event(const char* _fmt, ...)
+	{
+		va_list args;
+		va_start(args, _fmt);
+		m_events.appendfv(_fmt, args);
+		va_end(args);
+		return --m_stopAfter != 0;
+	}
+	bool beginObject()                                 { return event("{"); }
+	bool endObject(uint _memberCount)                  { return event("}%u", _memberCount); }
+	bool beginArray()                                  { return event("["); }
+	bool endArray(uint _length)                        { return event("]%u", _length); }
+	bool key(const char* _name, uint _length)          { return event("%s:", _name); }
+	bool nullValue()                                   { return event("null "); }
+	bool boolValue(bool _value)                        { return event("%s ", _value ? "true" : "false"); }
+	bool intValue(sint64 _value)                       { return event("%lld ", _value); }
+	bool uintValue(uint64 _value)                      { return event("%lluu ", _value); }
+	bool doubleValue(double _value)                    { return event("%g ", _value); }
+	bool stringValue(const char* _value, uint _length) { return event("'%s'%u ", _value, _length); }
+};
+
+struct JsonReaderSource
+{
+	const char* m_str;
+	uint        m_size;
+	uint        m_pos;
+};
+static uint JsonReaderRead(char* buf_, uint _bufSize, void* _userData)
+{
+	JsonReaderSource* src = (JsonReaderSource*)_userData;
+	uint n = APT_MIN(_bufSize, src->m_size - src->m_pos);
+	memcpy(buf_, src->m_str + src->m_pos, n);
+	src->m_pos += n;
+	return n;
+}
+
+TEST_CASE("JsonReader", "[Json]")
+{
+	const char* kSrc = "{ \"a\": [1, -2, 0.5, 18446744073709551615], \"b\": { \"c\": null, \"d\": true }, \"e\": \"str\" }";
+	const char* kEvents = "{a:[1 -2 0.5 18446744073709551615u ]4b:{c:null d:true }2e:'str'3 }3";
+	File f;
+	f.setData(kSrc, strlen(kSrc)); // no null terminator, as per File::Map()
+
+	{	JsonReader reader(f);
+		JsonReaderRecorder handler;
+		REQUIRE(reader.read(handler));
+		REQUIRE(strcmp((const char*)handler.m_events, kEvents) == 0);
+	}
+	for (uint bufferSize : { 1u, 3u, 64u }) { // exercise refills
+		JsonReaderSource src = { kSrc, (uint)strlen(kSrc), 0 };
+		JsonReader reader(JsonReaderRead, &src, bufferSize);
+		JsonReaderRecorder handler;
+		REQUIRE(reader.read(handler));
+		REQUIRE(strcmp((const char*)handler.m_events, kEvents) == 0);
+	}
+	{	JsonReader reader(f);
+		JsonReaderRecorder handler;
+		handler.m_stopAfter = 3;
+		REQUIRE(!reader.read(handler));
+		REQUIRE(strcmp((const char*)handler.m_events, "{a:[") == 0);
+	}
+	{	File bad;
+		bad.setData("{ \"a\": ", 7);
+		JsonReader reader(bad);
+		JsonReaderRecorder handler;
+		REQUIRE(!reader.read(handler));
+	}
+}
+
+TEST_CASE("JsonReader::readArray", "[Json]")
+{
+	const char* kSrc = "[ { \"id\": 0, \"name\": \"zero\", \"v\": [1, 2] }, 1, \"two\", [3, [4]], { \"id\": 4, \"o\": { \"x\": 5 } } ]";
+	File f;
+	f.setData(kSrc, strlen(kSrc));
+
+	{	JsonReader reader(f);
+		Json json;
+		int i = 0;
+		REQUIRE(reader.readArray(json, [&i](Json& _json) {
+			switch (i) {
+				case 0:
+					REQUIRE(_json.getValue<int>("id") == 0);
+					REQUIRE(strcmp(_json.getValue<const char*>("name"), "zero") == 0);
+					REQUIRE(_json.find("v"));
+					REQUIRE(_json.enterArray());
+					REQUIRE(_json.getArrayLength() == 2);
+					REQUIRE(_json.getValue<int>(1) == 2);
+					_json.leaveArray();
+					break;
+				case 4:
+					REQUIRE(_json.getValue<int>("id") == 4);
+					REQUIRE(_json.find("o"));
+					REQUIRE(_json.enterObject());
+					REQUIRE(_json.getValue<int>("x") == 5);
+					_json.leaveObject();
+					break;
+				default:
+					REQUIRE(!_json.find("id")); // scalars/arrays at the root
+					break;
+			};
+			++i;
+			return true;
+		}));
+		REQUIRE(i == 5);
+	}
+	{	JsonReader reader(f);
+		Json json;
+		int i = 0;
+		REQUIRE(reader.readArray(json, [&i](Json&) { return ++i < 2; })); // stopping isn't an error
+		REQUIRE(i == 2);
+	}
+	{	File obj;
+		obj.setData("{ \"a\": 1 }", 10);
+		JsonReader reader(obj);
+		Json json;
+		REQUIRE(!reader.readArray(json, [](Json&) { return true; }));
+	}
+}
+
+TEST_CASE("JsonReader performance", "[Json][.]")
+{
+	const int kObjectCount = 1000000;
+	const char* kPath = "Json_tests_JsonReader.json";
+
+	StringBuilder src;
+	src.append("[\n");
+	for (int i = 0; i < kObjectCount; ++i) {
+		src.appendf("\t{ \"name\": \"object %d\", \"tag\": \"some string value %d\", \"id\": %d, \"values\": [%d.5, %d, \"%d\"] }%s\n", i, i, i, i, -i, i, i == kObjectCount - 1 ? "" : ",");
+	}
+	src.append("]");
+	File f;
+	f.setData((const char*)src, src.getLength());
+	REQUIRE(File::Write(f, kPath));
+	f.setData(0, 0);
+	src.clear();
+
+	struct CountIds: public JsonReader::Handler
+	{
+		sint64 m_sum = 0;
+		bool intValue(sint64 _value) { m_sum += _value; return true; }
+	};
+
+	APT_LOG("\nJsonReader performance (%d objects) *********", kObjectCount);
+	Timestamp t = Time::GetTimestamp();
+	{	Json json;
+		REQUIRE(Json::Read(json, kPath));
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tJson::Read (DOM)       %10.2fms", t.asMilliseconds());
+
+	t = Time::GetTimestamp();
+	{	REQUIRE(File::Map(f, kPath));
+		JsonReader reader(f);
+		CountIds handler;
+		REQUIRE(reader.read(handler));
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tread (File::Map)       %10.2fms", t.asMilliseconds());
+
+	t = Time::GetTimestamp();
+	{	FILE* fp = fopen(kPath, "rb");
+		REQUIRE(fp);
+		JsonReader reader([](char* buf_, uint _bufSize, void* _fp) { return (uint)fread(buf_, 1, _bufSize, (FILE*)_fp); }, fp);
+		CountIds handler;
+		REQUIRE(reader.read(handler));
+		fclose(fp);
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tread (chunked)         %10.2fms", t.asMilliseconds());
+
+	t = Time::GetTimestamp();
+	{	JsonReader reader(f);
+		Json json;
+		sint64 sum = 0;
+		REQUIRE(reader.readArray(json, [&sum](Json& _json) { sum += _json.getValue<sint64>("id"); return true; }));
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\treadArray (File::Map)  %10.2fms", t.asMilliseconds());
+
+	f.setData(0, 0);
+	FileSystem::Delete(kPath);
+}
+
+TEST_CASE("find", "[Json]")
+{
+	const int kMemberCount = 100; // > Json::Impl::kMinIndexedMembers
+
+	Json json;
+	String<32> name;
+	char names[kMemberCount][8]; // names passed to setValue() must outlive json
+	for (int i = 0; i < kMemberCount; ++i) {
+		snprintf(names[i], sizeof(names[i]), "m%d", i);
+	}
+	json.beginObject("small");
+		json.setValue("a", 1);
+		json.setValue("b", 2);
+	json.endObject();
+	json.beginObject("large");
+		for (int i = 0; i < kMemberCount; ++i) {
+			json.setValue(names[i], i); // find() before each add, index is updated incrementally
+		}
+	json.endObject();
+
+	REQUIRE(json.find("small"));
+	REQUIRE(json.enterObject());
+		REQUIRE(json.find(StringHash("b")));
+		REQUIRE(json.getValue<int>() == 2);
+		REQUIRE(!json.find(StringHash("c")));
+	json.leaveObject();
+
+	REQUIRE(json.find("large"));
+	REQUIRE(json.enterObject());
+		for (int i = 0; i < kMemberCount; ++i) {
+			name.setf("m%d", i);
+			REQUIRE(json.find((const char*)name));
+			REQUIRE(json.getValue<int>() == i);
+			REQUIRE(json.find(StringHash((const char*)name)));
+			REQUIRE(json.getValue<int>() == i);
+		}
+		REQUIRE(!json.find("missing"));
+		REQUIRE(!json.find(StringHash("missing")));
+		json.setValue("added", -1); // mutation after the index was built
+		REQUIRE(json.getValue<int>("added") == -1);
+		REQUIRE(json.getValue<int>("m0") == 0);
+	json.leaveObject();
+
+ // grow 2 indexed objects alternately, each member array is reallocated (moved) as it grows
+	for (int i = 0; i < kMemberCount; ++i) {
+		for (const char* obj : { "x", "y" }) {
+			json.beginObject(obj);
+				json.setValue(names[i], i);
+				REQUIRE(json.getValue<int>(names[i / 2]) == i / 2);
+			json.endObject();
+		}
+	}
+	for (const char* obj : { "x", "y" }) {
+		REQUIRE(json.find(obj));
+		REQUIRE(json.enterObject());
+			for (int i = 0; i < kMemberCount; ++i) {
+				REQUIRE(json.getValue<int>(names[i]) == i);
+			}
+		json.leaveObject();
+	}
+
+ // duplicate names, first occurrence is found
+	File f;
+	StringBuilder src;
+	src.append("{ \"dup\": 0");
+	for (int i = 1; i < kMemberCount; ++i) {
+		src.appendf(", \"%s\": %d", i % 2 ? "dup" : "other", i);
+	}
+	src.append(" }");
+	f.setData((const char*)src, src.getLength() + 1);
+	REQUIRE(Json::Read(json, f));
+	REQUIRE(json.getValue<int>("dup") == 0);
+	REQUIRE(json.find(StringHash("other")));
+	REQUIRE(json.getValue<int>() == 2);
+}
+
+TEST_CASE("find performance", "[Json][.]")
+{
+	const int kMemberCount = 20000;
+
+	String<32> name;
+	char (*names)[16] = new char[kMemberCount][16]; // names passed to setValue() must outlive json
+	Json json;
+	{	SerializerJson js(json, SerializerJson::Mode_Write);
+		js.beginObject("config");
+		for (int i = 0; i < kMemberCount; ++i) {
+			snprintf(names[i], sizeof(names[i]), "member%d", i);
+			js.value(i, names[i]);
+		}
+		js.endObject();
+	}
+
+	APT_LOG("\nJson find performance (%d members) *********", kMemberCount);
+	Timestamp t = Time::GetTimestamp();
+	{	SerializerJson js(json, SerializerJson::Mode_Read);
+		js.beginObject("config");
+		for (int i = 0; i < kMemberCount; ++i) {
+			name.setf("member%d", i);
+			int v;
+			REQUIRE(js.value(v, (const char*)name));
+			REQUIRE(v == i);
+		}
+		js.endObject();
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tSerializerJson read   %10.2fms", t.asMilliseconds());
+
+	StringHash* hashes = new StringHash[kMemberCount];
+	for (int i = 0; i < kMemberCount; ++i) {
+		name.setf("member%d", i);
+		hashes[i] = StringHash((const char*)name);
+	}
+	json.find("config");
+	json.enterObject();
+	t = Time::GetTimestamp();
+	for (int i = 0; i < kMemberCount; ++i) {
+		json.find(hashes[i]);
+	}
+	t = Time::GetTimestamp() - t;
+	json.leaveObject();
+	APT_LOG("\tfind(StringHash)      %10.2fms", t.asMilliseconds());
+	delete[] hashes;
+	delete[] names;
+}
+
+TEST_CASE("reset", "[Json]")
+{
+	Json json;
+	json.setValue("a", 1);
+	json.beginObject("o");
+		json.setValue("b", 2);
+	json.endObject();
+	json.reset();
+	REQUIRE(!json.find("a"));
+	REQUIRE(!json.find("o"));
+
+	File f;
+	const char* kSrc = "{ \"a\": 3, \"s\": \"str\" }";
+	for (int i = 0; i < 3; ++i) {
+		f.setData(kSrc, strlen(kSrc) + 1);
+		json.reset();
+		REQUIRE(Json::Read(json, f));
+		REQUIRE(json.getValue<int>("a") == 3);
+		REQUIRE(strcmp(json.getValue<const char*>("s"), "str") == 0);
+	}
+	json.reset();
+	json.setValue("b", 4);
+	REQUIRE(json.getValue<int>("b") == 4);
+	REQUIRE(!json.find("a"));
+}
+
+TEST_CASE("message performance", "[Json][.]")
+{
+	const int kMessageCount = 100000;
+	const char* kMessage = 
+		"{ \"type\": \"update\", \"id\": 1234, \"time\": 16.5, \"tags\": [\"a\", \"bb\", \"ccc\"],"
+		" \"position\": [1.0, 2.0, 3.0], \"payload\": { \"name\": \"a message with a longer string value\", \"flags\": 7 } }";
+
+	File f;
+	f.setData(kMessage, strlen(kMessage) + 1);
+	volatile sint64 sink = 0;
+
+	APT_LOG("\nJson message performance (%d messages) *********", kMessageCount);
+	uint64 allocs = internal::GetAllocCount();
+	Timestamp t = Time::GetTimestamp();
+	for (int i = 0; i < kMessageCount; ++i) {
+		Json json;
+		Json::Read(json, f);
+		sink = sink + json.getValue<sint64>("id");
+	}
+	t = Time::GetTimestamp() - t;
+	allocs = internal::GetAllocCount() - allocs;
+	APT_LOG("\tnew Json    %10.0f msg/s, %llu allocations", kMessageCount / t.asSeconds(), allocs);
+
+	allocs = internal::GetAllocCount();
+	t = Time::GetTimestamp();
+	{	Json json;
+		for (int i = 0; i < kMessageCount; ++i) {
+			json.reset();
+			Json::Read(json, f);
+			sink = sink + json.getValue<sint64>("id");
+		}
+	}
+	t = Time::GetTimestamp() - t;
+	allocs = internal::GetAllocCount() - allocs;
+	APT_LOG("\treset()     %10.0f msg/s, %llu allocations", kMessageCount / t.asSeconds(), allocs);
+}
+
+TEST_CASE("Write", "[Json]")
+{
+	const char* kSrc = "{ \"str\": \"value\", \"num\": 1.23456789, \"arr\": [1, 2, 3], \"obj\": { \"x\": -4 } }";
+	Json json;
+	{	File f;
+		f.setData(kSrc, strlen(kSrc) + 1);
+		REQUIRE(Json::Read(json, f));
+	}
+
+	File compact;
+	REQUIRE(Json::Write(json, compact, Json::WriteOptions(false)));
+	REQUIRE(compact.getDataSize() == strlen("{\"str\":\"value\",\"num\":1.23456789,\"arr\":[1,2,3],\"obj\":{\"x\":-4}}"));
+	REQUIRE(memcmp(compact.getData(), "{\"str\":\"value\",\"num\":1.23456789,\"arr\":[1,2,3],\"obj\":{\"x\":-4}}", (size_t)compact.getDataSize()) == 0);
+
+	File pretty;
+	REQUIRE(Json::Write(json, pretty));
+	REQUIRE(pretty.getDataSize() > compact.getDataSize());
+	REQUIRE(memchr(pretty.getData(), '\t', (size_t)pretty.getDataSize()) != nullptr);
+
+ // round trip
+	pretty.appendData("", 1); // null terminator for Read()
+	Json json2;
+	REQUIRE(Json::Read(json2, pretty));
+	REQUIRE(strcmp(json2.getValue<const char*>("str"), "value") == 0);
+	REQUIRE(json2.getValue<double>("num") == 1.23456789);
+
+ // precision, reuse the buffer
+	REQUIRE(Json::Write(json, compact, Json::WriteOptions(false, 2)));
+	REQUIRE(memcmp(compact.getData(), "{\"str\":\"value\",\"num\":1.23,", strlen("{\"str\":\"value\",\"num\":1.23,")) == 0);
+
+ // larger than the initial buffer
+	Json big;
+	big.beginArray("arr");
+	for (int i = 0; i < 10000; ++i) {
+		big.pushValue(i);
+	}
+	big.endArray();
+	REQUIRE(Json::Write(big, compact, Json::WriteOptions(false)));
+	REQUIRE(compact.getDataSize() > 10000 * 2);
+	REQUIRE(compact.getData()[compact.getDataSize() - 1] == '}');
+
+ // chunked write to disk
+	const char* kPath = "Json_tests_Write.json";
+	REQUIRE(Json::Write(big, kPath, FileSystem::RootType_Default, Json::WriteOptions(false)));
+	File f;
+	REQUIRE(File::Read(f, kPath));
+	REQUIRE(f.getDataSize() == compact.getDataSize());
+	REQUIRE(memcmp(f.getData(), compact.getData(), (size_t)f.getDataSize()) == 0);
+	FileSystem::Delete(kPath);
+}
+
+TEST_CASE("Write performance", "[Json][.]")
+{
+	const int kObjectCount = 1000000;
+
+	StringBuilder src;
+	src.append("[\n");
+	for (int i = 0; i < kObjectCount; ++i) {
+		src.appendf("\t{ \"name\": \"object %d\", \"tag\": \"some string value %d\", \"id\": %d, \"values\": [%d.123456789, %d, \"%d\"] }%s\n", i, i, i, i, -i, i, i == kObjectCount - 1 ? "" : ",");
+	}
+	src.append("]");
+	Json json;
+	{	File f;
+		f.setData((const char*)src, src.getLength() + 1);
+		REQUIRE(Json::Read(json, f));
+		src.clear();
+	}
+
+	APT_LOG("\nJson Write performance (%d objects) *********", kObjectCount);
+	const char* kPath = "Json_tests_Write.json";
+	const char* names[] = { "pretty       ", "compact      ", "compact, %.3f" };
+	Json::WriteOptions options[] = { Json::WriteOptions(true), Json::WriteOptions(false), Json::WriteOptions(false, 3) };
+	for (int i = 0; i < 3; ++i) {
+		File f;
+		Timestamp t = Time::GetTimestamp();
+		REQUIRE(Json::Write(json, f, options[i]));
+		t = Time::GetTimestamp() - t;
+		APT_LOG("\t%s File %10.2fms, %8.2fMB/s (%llu bytes)", names[i], t.asMilliseconds(), (double)f.getDataSize() / (1024.0 * 1024.0) / t.asSeconds(), f.getDataSize());
+
+		t = Time::GetTimestamp();
+		REQUIRE(Json::Write(json, kPath, FileSystem::RootType_Default, options[i]));
+		t = Time::GetTimestamp() - t;
+		APT_LOG("\t%s disk %10.2fms, %8.2fMB/s", names[i], t.asMilliseconds(), (double)f.getDataSize() / (1024.0 * 1024.0) / t.asSeconds());
+	}
+	FileSystem::Delete(kPath);
+}
+
+TEST_CASE("JsonPath", "[Json]")
+{
+	const char* kSrc =
+		"{ \"render\": { \"shadows\": { \"cascades\": [ 10, 20, { \"x\": 30 } ], \"enabled\": true } },"
+		"  \"a/b\": 1, \"c~d\": 2, \"2\": \"two\", \"\": { \"\": 3 } }";
+	Json json;
+	{	File f;
+		f.setData(kSrc, strlen(kSrc) + 1);
+		REQUIRE(Json::Read(json, f));
+	}
+
+	JsonPath cascade("/render/shadows/cascades/1");
+	REQUIRE(cascade.isValid());
+	REQUIRE(cascade.getSegmentCount() == 4);
+	REQUIRE(json.getValue<int>(cascade) == 20);
+	REQUIRE(json.getValue<int>(cascade) == 20); // cached
+	REQUIRE(json.getValue<int>(JsonPath("/render/shadows/cascades/2/x")) == 30);
+	REQUIRE(json.getValue<bool>(JsonPath("/render/shadows/enabled")) == true);
+	REQUIRE(json.getValue<int>(JsonPath("/a~1b")) == 2 - 1);
+	REQUIRE(json.getValue<int>(JsonPath("/c~0d")) == 2);
+	REQUIRE(strcmp(json.getValue<const char*>(JsonPath("/2")), "two") == 0); // numeric member name
+	REQUIRE(json.getValue<int>(JsonPath("//")) == 3);
+	REQUIRE(json.find(JsonPath("")));
+	REQUIRE(json.getType() == Json::ValueType_Object);
+
+	REQUIRE(!json.find(JsonPath("/render/missing")));
+	REQUIRE(!json.find(JsonPath("/render/shadows/cascades/3")));
+	REQUIRE(!json.find(JsonPath("/render/shadows/cascades/01")));
+	REQUIRE(!json.find(JsonPath("/render/shadows/enabled/x")));
+	JsonPath invalid("render");
+	REQUIRE(!invalid.isValid());
+	REQUIRE(!json.find(invalid));
+
+ // the current object is unchanged
+	REQUIRE(json.find("render"));
+	REQUIRE(json.enterObject());
+		REQUIRE(json.getValue<int>(cascade) == 20);
+		REQUIRE(json.find("shadows"));
+	json.leaveObject();
+
+ // modifying the document invalidates the cache
+	JsonPath added("/render/added");
+	REQUIRE(!json.find(added));
+	REQUIRE(json.find("render"));
+	REQUIRE(json.enterObject());
+		for (int i = 0; i < 32; ++i) {
+			json.setValue("added", i); // reallocates the member array
+		}
+	json.leaveObject();
+	REQUIRE(json.getValue<int>(added) == 31);
+	REQUIRE(json.getValue<int>(cascade) == 20);
+
+ // the cache is per document
+	Json json2;
+	json2.beginObject("render");
+		json2.setValue("added", -1);
+	json2.endObject();
+	REQUIRE(json2.getValue<int>(added) == -1);
+	REQUIRE(json.getValue<int>(added) == 31);
+	REQUIRE(!json2.find(cascade));
+}
+
+TEST_CASE("JsonPath performance", "[Json][.]")
+{
+	const int kLookupCount = 1000000;
+	const int kMembersPerLevel = 8;
+
+ // 5 levels of objects, the value is the last member at each level
+	StringBuilder src;
+	for (int level = 0; level < 5; ++level) {
+		src.append("{ ");
+		for (int i = 0; i < kMembersPerLevel - 1; ++i) {
+			src.appendf("\"member%d\": %d, ", i, i);
+		}
+		src.appendf("\"level%d\": ", level);
+	}
+	src.append("42");
+	for (int level = 0; level < 5; ++level) {
+		src.append(" }");
+	}
+	Json json;
+	{	File f;
+		f.setData((const char*)src, src.getLength() + 1);
+		REQUIRE(Json::Read(json, f));
+	}
+	const char* kPath = "/level0/level1/level2/level3/level4";
+
+	APT_LOG("\nJsonPath performance (%d lookups, depth 5) *********", kLookupCount);
+	volatile sint64 sink = 0;
+	Timestamp t = Time::GetTimestamp();
+	for (int i = 0; i < kLookupCount; ++i) {
+		json.find("level0"); json.enterObject();
+		json.find("level1"); json.enterObject();
+		json.find("level2"); json.enterObject();
+		json.find("level3"); json.enterObject();
+		sink = sink + json.getValue<int>("level4");
+		json.leaveObject(); json.leaveObject(); json.leaveObject(); json.leaveObject();
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tfind/enterObject      %10.2fms, %6.1fns/lookup", t.asMilliseconds(), t.asMilliseconds() * 1e6 / kLookupCount);
+
+	t = Time::GetTimestamp();
+	for (int i = 0; i < kLookupCount; ++i) { // compile and resolve each time
+		sink = sink + json.getValue<int>(JsonPath(kPath));
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tJsonPath (per lookup) %10.2fms, %6.1fns/lookup", t.asMilliseconds(), t.asMilliseconds() * 1e6 / kLookupCount);
+
+	JsonPath path(kPath);
+	t = Time::GetTimestamp();
+	for (int i = 0; i < kLookupCount; ++i) {
+		sink = sink + json.getValue<int>(path);
+	}
+	t = Time::GetTimestamp() - t;
+	APT_LOG("\tJsonPath (cached)     %10.2fms, %6.1fns/lookup", t.asMilliseconds(), t.asMilliseconds() * 1e6 / kLookupCount);
 }
\ No newline at end of file
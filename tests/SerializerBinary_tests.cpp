@@ -0,0 +1,903 @@
+#include <catch.hpp>
+
+#include <apt/log.h>
+#include <apt/File.h>
+#include <apt/FileSystem.h>
+#include <apt/Json.h>
+#include <apt/rand.h>
+#include <apt/SerializerBinary.h>
+#include <apt/String.h>
+#include <apt/Time.h>
+
+#include <EASTL/vector.h>
+
+#include <cstring>
+
+using namespace apt;
+
+namespace {
+
+struct Entity
+{
+	String<32>  m_name;
+	uint32      m_id;
+	sint16      m_layer;
+	bool        m_active;
+	float32     m_health;
+	float64     m_time;
+	vec3        m_position;
+	mat4        m_world;
+	String<16>  m_tags[3];
+
+	bool operator==(const Entity& _rhs) const
+	{
+		bool ret = m_name == _rhs.m_name && m_id == _rhs.m_id && m_layer == _rhs.m_layer && m_active == _rhs.m_active
+			&& m_health == _rhs.m_health && m_time == _rhs.m_time && m_position == _rhs.m_position && m_world == _rhs.m_world;
+		for (int i = 0; i < 3; ++i) {
+			ret &= m_tags[i] == _rhs.m_tags[i];
+		}
+		return ret;
+	}
+};
+
+bool SerializeEntity(Serializer& _serializer_, Entity& _entity_)
+{
+	bool ret = true;
+	ret &= _serializer_.value(_entity_.m_name,     "Name");
+	ret &= _serializer_.value(_entity_.m_id,       "Id");
+	ret &= _serializer_.value(_entity_.m_layer,    "Layer");
+	ret &= _serializer_.value(_entity_.m_active,   "Active");
+	ret &= _serializer_.value(_entity_.m_health,   "Health");
+	ret &= _serializer_.value(_entity_.m_time,     "Time");
+	ret &= _serializer_.value(_entity_.m_position, "Position");
+	ret &= _serializer_.value(_entity_.m_world,    "World");
+	uint tagCount = 3;
+	if (_serializer_.beginArray(tagCount, "Tags")) {
+		for (uint i = 0; i < tagCount && i < 3; ++i) {
+			ret &= _serializer_.value((StringBase&)_entity_.m_tags[i]);
+		}
+		_serializer_.endArray();
+	}
+	return ret;
+}
+
+bool SerializeEntities(Serializer& _serializer_, eastl::vector<Entity>& _entities_)
+{
+	bool ret = true;
+	uint count = (uint)_entities_.size();
+	if (_serializer_.beginArray(count, "Entities")) {
+		_entities_.resize(count);
+		for (uint i = 0; i < count; ++i) {
+			if (!_serializer_.beginObject()) {
+				return false;
+			}
+			ret &= SerializeEntity(_serializer_, _entities_[i]);
+			_serializer_.endObject();
+		}
+		_serializer_.endArray();
+	}
+	return ret;
+}
+
+void GenerateEntities(eastl::vector<Entity>& entities_, uint _count)
+{
+	Rand<> rnd;
+	entities_.resize(_count);
+	for (uint i = 0; i < _count; ++i) {
+		Entity& e = entities_[i];
+		e.m_name.setf("Entity%u", i);
+		e.m_id = rnd.raw();
+		e.m_layer = (sint16)rnd.get<int>(-100, 100);
+		e.m_active = rnd.get<bool>();
+		e.m_health = rnd.get<float>(0.0f, 100.0f);
+		e.m_time = (float64)rnd.get<float>(0.0f, 1000.0f) + 1.0 / 3.0;
+		e.m_position = vec3(rnd.get<float>(), rnd.get<float>(), rnd.get<float>());
+		e.m_world = mat4(1.0f);
+		e.m_world[3] = vec4(e.m_position, 1.0f);
+		e.m_tags[0] = "Static";
+		e.m_tags[1] = e.m_active ? "Active" : "Inactive";
+		e.m_tags[2].setf("Group%d", i % 8);
+	}
+}
+
+} // namespace
+
+TEST_CASE("SerializerBinary", "[SerializerBinary]")
+{
+	eastl::vector<Entity> src;
+	GenerateEntities(src, 16);
+
+	const char* kBinary = "Binary data which is long enough to be compressed, binary data which is long enough to be compressed.";
+	const uint  kBinarySize = (uint)strlen(kBinary);
+
+	const SerializerBinary::Flags kFlags[] = {
+		SerializerBinary::Flags_Tagged,
+		SerializerBinary::Flags_Tagged | SerializerBinary::Flags_Aligned,
+		0,
+		SerializerBinary::Flags_Aligned
+	};
+	for (SerializerBinary::Flags flags : kFlags) {
+		const bool tagged = (flags & SerializerBinary::Flags_Tagged) != 0;
+		File f;
+		{	SerializerBinary sb(f, Serializer::Mode_Write, flags);
+			REQUIRE(sb.isTagged() == tagged);
+			sint8   s8  = -8;           REQUIRE(sb.value(s8,  "s8"));
+			uint8   u8  = 8;            REQUIRE(sb.value(u8,  "u8"));
+			uint16  u16 = 16;           REQUIRE(sb.value(u16, "u16"));
+			sint32  s32 = -32;          REQUIRE(sb.value(s32, "s32"));
+			sint64  s64 = -(1ll << 40); REQUIRE(sb.value(s64, "s64"));
+			uint64  u64 = ~0ull;        REQUIRE(sb.value(u64, "u64"));
+			String<8> empty;            REQUIRE(sb.value(empty, "empty"));
+			REQUIRE(SerializeEntities(sb, src));
+
+			void* data = (void*)kBinary;
+			uint dataSize = kBinarySize;
+			REQUIRE(sb.binary(data, dataSize, "Binary"));
+			REQUIRE(sb.binary(data, dataSize, "BinaryCompressed", CompressionFlags_Speed));
+
+		 // name is required outside of an array
+			float f32 = 0.0f;
+			REQUIRE(!sb.value(f32));
+			REQUIRE(sb.getError() != nullptr);
+		}
+		{	SerializerBinary sb(f, Serializer::Mode_Read);
+			REQUIRE(sb.getError() == nullptr);
+			REQUIRE(sb.isTagged() == tagged);
+			REQUIRE(sb.isAligned() == ((flags & SerializerBinary::Flags_Aligned) != 0));
+			sint8   s8;  REQUIRE(sb.value(s8,  "s8"));  REQUIRE(s8  == -8);
+			uint8   u8;  REQUIRE(sb.value(u8,  "u8"));  REQUIRE(u8  == 8);
+			uint16  u16; REQUIRE(sb.value(u16, "u16")); REQUIRE(u16 == 16);
+			sint32  s32; REQUIRE(sb.value(s32, "s32")); REQUIRE(s32 == -32);
+			sint64  s64; REQUIRE(sb.value(s64, "s64")); REQUIRE(s64 == -(1ll << 40));
+			uint64  u64; REQUIRE(sb.value(u64, "u64")); REQUIRE(u64 == ~0ull);
+			String<8> empty("xxx"); REQUIRE(sb.value(empty, "empty")); REQUIRE(empty.isEmpty());
+
+			eastl::vector<Entity> dst;
+			REQUIRE(SerializeEntities(sb, dst));
+			REQUIRE(dst.size() == src.size());
+			for (uint i = 0; i < src.size(); ++i) {
+				REQUIRE(dst[i] == src[i]);
+			}
+
+			void* data = nullptr;
+			uint dataSize = 0;
+			REQUIRE(sb.binary(data, dataSize, "Binary"));
+			REQUIRE(dataSize == kBinarySize);
+			REQUIRE(memcmp(data, kBinary, kBinarySize) == 0);
+			free(data);
+
+			char buf[256];
+			data = buf;
+			dataSize = kBinarySize;
+			REQUIRE(sb.binary(data, dataSize, "BinaryCompressed"));
+			REQUIRE(memcmp(buf, kBinary, kBinarySize) == 0);
+		}
+	}
+
+ // invalid header
+	File f;
+	f.setData("APTJ0000", 8);
+	SerializerBinary sb(f, Serializer::Mode_Read);
+	REQUIRE(sb.getError() != nullptr);
+}
+
+TEST_CASE("SerializerBinary tagged", "[SerializerBinary]")
+{
+	File f;
+	{	SerializerBinary sb(f, Serializer::Mode_Write);
+		uint8 a = 1;  sb.value(a, "a");
+		sb.beginObject("obj");
+			sint32 b = -2; sb.value(b, "b");
+			String<8> c("c"); sb.value(c, "c");
+			uint len = 3;
+			sb.beginArray(len, "arr");
+				for (uint i = 0; i < len; ++i) {
+					sb.value(i);
+				}
+			sb.endArray();
+		sb.endObject();
+		float32 d = 4.5f; sb.value(d, "d");
+	}
+	SerializerBinary sb(f, Serializer::Mode_Read);
+
+ // out of order, skipping unread values
+	float32 d = 0.0f;
+	REQUIRE(sb.value(d, "d"));
+	REQUIRE(d == 4.5f);
+	REQUIRE(sb.beginObject("obj"));
+		String<8> c;
+		REQUIRE(sb.value(c, "c"));
+		REQUIRE(c == "c");
+		uint len;
+		REQUIRE(sb.beginArray(len, "arr"));
+		REQUIRE(len == 3);
+		uint v;
+		REQUIRE(sb.value(v));
+		REQUIRE(v == 0);
+		sb.endArray(); // skip the remaining elements
+		sint32 b = 0;
+		REQUIRE(sb.value(b, "b"));
+		REQUIRE(b == -2);
+
+	 // missing
+		sint32 missing = 7;
+		REQUIRE(!sb.value(missing, "missing"));
+		REQUIRE(missing == 7);
+		REQUIRE(sb.getError() != nullptr);
+	sb.endObject();
+
+ // type conversion
+	float64 a = 0.0;
+	REQUIRE(sb.value(a, "a"));
+	REQUIRE(a == 1.0);
+	sint64 di = 0;
+	REQUIRE(sb.value(di, "d"));
+	REQUIRE(di == 4);
+
+ // type mismatch
+	REQUIRE(!sb.value(c, "a"));
+	REQUIRE(!sb.beginObject("a"));
+	REQUIRE(!sb.beginArray(len, "obj"));
+}
+
+TEST_CASE("SerializerBinary performance", "[SerializerBinary][.]")
+{
+	const uint kCount = 100000;
+	eastl::vector<Entity> src;
+	GenerateEntities(src, kCount);
+
+	APT_LOG("\nSerializerBinary performance *********");
+	APT_LOG("%u entities:", kCount);
+
+	{	Json json;
+		File f;
+		Timestamp t = Time::GetTimestamp();
+		{	SerializerJson sj(json, Serializer::Mode_Write);
+			SerializeEntities(sj, src);
+		}
+		Json::Write(json, f, Json::WriteOptions(false));
+		double save = (Time::GetTimestamp() - t).asMilliseconds();
+
+		eastl::vector<Entity> dst;
+		t = Time::GetTimestamp();
+		Json jsonRead;
+		Json::Read(jsonRead, f);
+		{	SerializerJson sj(jsonRead, Serializer::Mode_Read);
+			REQUIRE(SerializeEntities(sj, dst));
+		}
+		double load = (Time::GetTimestamp() - t).asMilliseconds();
+		REQUIRE(dst[kCount - 1] == src[kCount - 1]);
+		APT_LOG("\tSerializerJson            %8.2fMB, save %8.2fms, load %8.2fms", (double)f.getDataSize() / (1024.0 * 1024.0), save, load);
+	}
+
+	for (bool tagged : { true, false }) {
+		File f;
+		Timestamp t = Time::GetTimestamp();
+		{	SerializerBinary sb(f, Serializer::Mode_Write, tagged ? SerializerBinary::Flags_Tagged : 0);
+			SerializeEntities(sb, src);
+		}
+		double save = (Time::GetTimestamp() - t).asMilliseconds();
+
+		eastl::vector<Entity> dst;
+		t = Time::GetTimestamp();
+		{	SerializerBinary sb(f, Serializer::Mode_Read);
+			REQUIRE(SerializeEntities(sb, dst));
+		}
+		double load = (Time::GetTimestamp() - t).asMilliseconds();
+		REQUIRE(dst[kCount - 1] == src[kCount - 1]);
+		APT_LOG("\tSerializerBinary %-8s %8.2fMB, save %8.2fms, load %8.2fms", tagged ? "tagged" : "untagged", (double)f.getDataSize() / (1024.0 * 1024.0), save, load);
+	}
+}
+
+TEST_CASE("valueArray", "[Serializer]")
+{
+	const uint kCount = 100;
+	eastl::vector<vec3>   positions(kCount);
+	eastl::vector<uint16> indices(kCount);
+	for (uint i = 0; i < kCount; ++i) {
+		positions[i] = vec3((float)i, (float)i * 0.5f, -(float)i);
+		indices[i] = (uint16)(kCount - i);
+	}
+
+	auto Write = [&](Serializer& _serializer_) {
+		REQUIRE(_serializer_.valueArray(positions.data(), kCount, "Positions"));
+		REQUIRE(_serializer_.valueArray(indices.data(), kCount, "Indices"));
+	 // element-wise
+		uint len = kCount;
+		REQUIRE(_serializer_.beginArray(len, "Elements"));
+		for (uint i = 0; i < kCount; ++i) {
+			REQUIRE(_serializer_.value(indices[i]));
+		}
+		_serializer_.endArray();
+	 // nested in an array
+		len = 2;
+		REQUIRE(_serializer_.beginArray(len, "Nested"));
+		REQUIRE(_serializer_.valueArray(positions.data(), 2));
+		REQUIRE(_serializer_.valueArray(positions.data() + 2, 2));
+		_serializer_.endArray();
+	};
+	auto Read = [&](Serializer& _serializer_) {
+		eastl::vector<vec3> p(kCount, vec3(0.0f));
+		REQUIRE(_serializer_.valueArray(p.data(), kCount, "Positions"));
+		REQUIRE(memcmp(p.data(), positions.data(), sizeof(vec3) * kCount) == 0);
+	 // element type conversion
+		eastl::vector<float64> i64(kCount, 0.0);
+		REQUIRE(_serializer_.valueArray(i64.data(), kCount, "Indices"));
+		REQUIRE(i64[1] == (float64)indices[1]);
+	 // read element-wise array
+		eastl::vector<uint16> e(kCount, 0);
+		REQUIRE(_serializer_.valueArray(e.data(), kCount, "Elements"));
+		REQUIRE(e == indices);
+	 // read packed array element-wise
+		uint len = 0;
+		REQUIRE(_serializer_.beginArray(len, "Indices"));
+		REQUIRE(len == kCount);
+		for (uint i = 0; i < kCount; ++i) {
+			uint16 v = 0;
+			REQUIRE(_serializer_.value(v));
+			REQUIRE(v == indices[i]);
+		}
+		_serializer_.endArray();
+	 // nested
+		REQUIRE(_serializer_.beginArray(len, "Nested"));
+		vec3 v[2];
+		REQUIRE(_serializer_.valueArray(v, 2));
+		REQUIRE(_serializer_.valueArray(v, 2));
+		REQUIRE(v[1] == positions[3]);
+		REQUIRE(!_serializer_.valueArray(v, 2)); // end of array
+		_serializer_.endArray();
+	 // length mismatch
+		REQUIRE(!_serializer_.valueArray(p.data(), kCount - 1, "Positions"));
+		REQUIRE(_serializer_.getError() != nullptr);
+	};
+
+	{	Json json;
+		SerializerJson sj(json, Serializer::Mode_Write);
+		Write(sj);
+		sj.setMode(Serializer::Mode_Read);
+		Read(sj);
+	}
+	{	File f;
+		{	SerializerBinary sb(f, Serializer::Mode_Write);
+			Write(sb);
+		}
+		SerializerBinary sb(f, Serializer::Mode_Read);
+		Read(sb);
+	}
+ // untagged streams must be read in order and without type conversion
+	{	File f;
+		{	SerializerBinary sb(f, Serializer::Mode_Write, 0);
+			Write(sb);
+		}
+		SerializerBinary sb(f, Serializer::Mode_Read);
+		eastl::vector<vec3> p(kCount);
+		REQUIRE(sb.valueArray(p.data(), kCount, "Positions"));
+		REQUIRE(memcmp(p.data(), positions.data(), sizeof(vec3) * kCount) == 0);
+		eastl::vector<uint16> e(kCount, 0);
+		REQUIRE(sb.valueArray(e.data(), kCount, "Indices"));
+		REQUIRE(e == indices);
+		REQUIRE(sb.valueArray(e.data(), kCount, "Elements"));
+		REQUIRE(e == indices);
+	}
+}
+
+TEST_CASE("valueArray performance", "[Serializer][.]")
+{
+	const uint kVec3Count = 1000000;
+	const uint kMat4Count = 100000;
+	eastl::vector<vec3> positions(kVec3Count);
+	eastl::vector<mat4> transforms(kMat4Count);
+	Rand<> rnd;
+	for (auto& p : positions) {
+		p = vec3(rnd.get<float>(), rnd.get<float>(), rnd.get<float>());
+	}
+	for (auto& t : transforms) {
+		t = mat4(1.0f);
+		t[3] = vec4(rnd.get<float>(), rnd.get<float>(), rnd.get<float>(), 1.0f);
+	}
+
+	APT_LOG("\nvalueArray performance *********");
+	APT_LOG("%u vec3, %u mat4:", kVec3Count, kMat4Count);
+
+	// Serialize a flat array of floats via one value() call per component (as value(vec3&) did previously).
+	auto PerElement = [](Serializer& _serializer_, float* _data_, uint _count, const char* _name) {
+		uint len = _count;
+		if (_serializer_.beginArray(len, _name)) {
+			for (uint i = 0; i < len; ++i) {
+				_serializer_.value(_data_[i]);
+			}
+			_serializer_.endArray();
+		}
+	};
+
+	auto Serialize = [&](Serializer& _serializer_, vec3* _positions_, mat4* _transforms_, bool _bulk) {
+		if (_bulk) {
+			_serializer_.valueArray(_positions_, kVec3Count, "Positions");
+			_serializer_.valueArray(_transforms_, kMat4Count, "Transforms");
+		} else {
+			PerElement(_serializer_, (float*)_positions_, kVec3Count * 3, "Positions");
+			PerElement(_serializer_, (float*)_transforms_, kMat4Count * 16, "Transforms");
+		}
+	};
+
+	const char* kBackendName[] = { "SerializerJson", "SerializerBinary tagged", "SerializerBinary untagged" };
+	for (int backend = 0; backend < 3; ++backend) {
+		double save[2], load[2];
+		for (int bulk = 0; bulk < 2; ++bulk) {
+			Json json;
+			File f;
+			Timestamp t = Time::GetTimestamp();
+			if (backend == 0) {
+				SerializerJson sj(json, Serializer::Mode_Write);
+				Serialize(sj, positions.data(), transforms.data(), bulk != 0);
+			} else {
+				SerializerBinary sb(f, Serializer::Mode_Write, backend == 1 ? SerializerBinary::Flags_Tagged : 0);
+				Serialize(sb, positions.data(), transforms.data(), bulk != 0);
+			}
+			save[bulk] = (Time::GetTimestamp() - t).asMilliseconds();
+
+			eastl::vector<vec3> p(kVec3Count);
+			eastl::vector<mat4> m(kMat4Count);
+			t = Time::GetTimestamp();
+			if (backend == 0) {
+				SerializerJson sj(json, Serializer::Mode_Read);
+				Serialize(sj, p.data(), m.data(), bulk != 0);
+			} else {
+				SerializerBinary sb(f, Serializer::Mode_Read);
+				Serialize(sb, p.data(), m.data(), bulk != 0);
+			}
+			load[bulk] = (Time::GetTimestamp() - t).asMilliseconds();
+			REQUIRE(memcmp(p.data(), positions.data(), sizeof(vec3) * kVec3Count) == 0);
+			REQUIRE(memcmp(m.data(), transforms.data(), sizeof(mat4) * kMat4Count) == 0);
+		}
+		APT_LOG("\t%-26s save %8.2fms -> %8.2fms (x%.1f), load %8.2fms -> %8.2fms (x%.1f)", kBackendName[backend], save[0], save[1], save[0] / save[1], load[0], load[1], load[0] / load[1]);
+	}
+}
+
+TEST_CASE("SerializerBinary views", "[SerializerBinary]")
+{
+	const char* kPath = "SerializerBinary_tests_views.bin";
+	const uint kCount = 100;
+	eastl::vector<vec3>   positions(kCount);
+	eastl::vector<uint16> indices(kCount);
+	for (uint i = 0; i < kCount; ++i) {
+		positions[i] = vec3((float)i, (float)i * 0.5f, -(float)i);
+		indices[i] = (uint16)(kCount - i);
+	}
+	const char* kBinary = "Binary data which is long enough to be compressed, binary data which is long enough to be compressed.";
+	const uint  kBinarySize = (uint)strlen(kBinary);
+
+	const SerializerBinary::Flags kFlags[] = {
+		SerializerBinary::Flags_Tagged | SerializerBinary::Flags_Aligned,
+		SerializerBinary::Flags_Aligned
+	};
+	for (SerializerBinary::Flags flags : kFlags) {
+		{	File f;
+			{	SerializerBinary sb(f, Serializer::Mode_Write, flags);
+				uint8 pad = 1;
+				sb.value(pad, "Pad"); // misalign the following value
+				sb.valueArray(positions.data(), kCount, "Positions");
+				sb.value(pad, "Pad");
+				void* data = (void*)kBinary;
+				uint dataSize = kBinarySize;
+				sb.binary(data, dataSize, "Binary");
+				sb.valueArray(indices.data(), kCount, "Indices");
+				sb.binary(data, dataSize, "BinaryCompressed", CompressionFlags_Speed);
+			}
+			REQUIRE(File::Write(f, kPath));
+		}
+
+		File f;
+		REQUIRE(File::Map(f, kPath));
+		SerializerBinary sb(f, Serializer::Mode_Read);
+		REQUIRE(sb.isAligned());
+		const char* beg = f.getData();
+		const char* end = beg + f.getDataSize();
+		uint8 pad;
+		REQUIRE(sb.value(pad, "Pad"));
+
+		const vec3* p = nullptr;
+		uint count = 0;
+		REQUIRE(sb.valueArrayView(p, count, "Positions"));
+		REQUIRE(count == kCount);
+		REQUIRE((const char*)p > beg);
+		REQUIRE((const char*)(p + count) <= end);
+		REQUIRE(((uintptr_t)p % SerializerBinary::kAlignment) == 0);
+		REQUIRE(memcmp(p, positions.data(), sizeof(vec3) * kCount) == 0);
+
+		REQUIRE(sb.value(pad, "Pad"));
+		const void* data = nullptr;
+		uint dataSize = 0;
+		REQUIRE(sb.binaryView(data, dataSize, "Binary"));
+		REQUIRE(dataSize == kBinarySize);
+		REQUIRE(((uintptr_t)data % SerializerBinary::kAlignment) == 0);
+		REQUIRE(memcmp(data, kBinary, kBinarySize) == 0);
+
+		if (sb.isTagged()) {
+		 // stored type mismatch
+			const float32* f32 = nullptr;
+			REQUIRE(!sb.valueArrayView(f32, count, "Indices"));
+		 // the copying path still works
+			uint16 i16[kCount];
+			REQUIRE(sb.valueArray(i16, kCount, "Indices"));
+			REQUIRE(memcmp(i16, indices.data(), sizeof(i16)) == 0);
+		}
+		const uint16* i16 = nullptr;
+		REQUIRE(sb.valueArrayView(i16, count, "Indices"));
+		REQUIRE(count == kCount);
+		REQUIRE(memcmp(i16, indices.data(), sizeof(uint16) * kCount) == 0);
+
+	 // compressed data can't be viewed
+		REQUIRE(!sb.binaryView(data, dataSize, "BinaryCompressed"));
+	}
+	FileSystem::Delete(kPath);
+}
+
+TEST_CASE("SerializerBinary views performance", "[SerializerBinary][.]")
+{
+ // kChunkCount arrays of kChunkSize bytes, the source/destination chunk is reused to limit memory usage
+	const char* kPath       = "SerializerBinary_tests_asset.bin";
+	const uint  kChunkCount = 8;
+	const uint  kChunkSize  = 256 * 1024 * 1024;
+	const uint  kChunkLen   = kChunkSize / sizeof(vec4);
+	const char* kChunkNames[kChunkCount] = { "Chunk0", "Chunk1", "Chunk2", "Chunk3", "Chunk4", "Chunk5", "Chunk6", "Chunk7" };
+
+	eastl::vector<vec4> chunk(kChunkLen);
+	for (uint i = 0; i < kChunkLen; ++i) {
+		chunk[i] = vec4((float)i);
+	}
+	{	File f;
+		{	SerializerBinary sb(f, Serializer::Mode_Write, SerializerBinary::Flags_Default | SerializerBinary::Flags_Aligned);
+			for (uint i = 0; i < kChunkCount; ++i) {
+				sb.valueArray(chunk.data(), kChunkLen, kChunkNames[i]);
+			}
+		}
+		REQUIRE(File::Write(f, kPath));
+	}
+
+ // the data is used in both cases, read 1 float per cache line
+	auto Touch = [](const vec4* _data, uint _count) {
+		float ret = 0.0f;
+		for (uint i = 0; i < _count; i += 4) {
+			ret += _data[i].x;
+		}
+		return ret;
+	};
+
+	APT_LOG("\nSerializerBinary views performance *********");
+	APT_LOG("%u x %uMB arrays (first load follows the write, flush the OS file cache before this point for cold numbers):", kChunkCount, kChunkSize / (1024 * 1024));
+	for (int pass = 0; pass < 2; ++pass) {
+		float sum[2] = {};
+
+		Timestamp t = Time::GetTimestamp();
+		{	File f;
+			REQUIRE(File::Read(f, kPath));
+			SerializerBinary sb(f, Serializer::Mode_Read);
+			for (uint i = 0; i < kChunkCount; ++i) {
+				REQUIRE(sb.valueArray(chunk.data(), kChunkLen, kChunkNames[i]));
+				sum[0] += Touch(chunk.data(), kChunkLen);
+			}
+		}
+		double copy = (Time::GetTimestamp() - t).asMilliseconds();
+
+		t = Time::GetTimestamp();
+		{	File f;
+			REQUIRE(File::Map(f, kPath));
+			SerializerBinary sb(f, Serializer::Mode_Read);
+			for (uint i = 0; i < kChunkCount; ++i) {
+				const vec4* data = nullptr;
+				uint count = 0;
+				REQUIRE(sb.valueArrayView(data, count, kChunkNames[i]));
+				sum[1] += Touch(data, count);
+			}
+		}
+		double view = (Time::GetTimestamp() - t).asMilliseconds();
+		REQUIRE(sum[0] == sum[1]);
+
+		APT_LOG("\t%-6s Read+valueArray %8.2fms, Map+valueArrayView %8.2fms (x%.1f)", pass == 0 ? "first" : "second", copy, view, copy / view);
+	}
+	FileSystem::Delete(kPath);
+}
+
+namespace {
+
+struct Transform
+{
+	vec3 m_position;
+	vec4 m_orientation;
+	vec3 m_scale;
+};
+APT_REFLECT_BEGIN(Transform)
+	APT_REFLECT_FIELD(m_position,    "Position")
+	APT_REFLECT_FIELD(m_orientation, "Orientation")
+	APT_REFLECT_FIELD(m_scale,       "Scale")
+APT_REFLECT_END()
+
+struct Particle
+{
+	String<32> m_name;
+	uint32     m_id;
+	uint32     m_flags;
+	sint32     m_group;
+	sint32     m_parent;
+	float32    m_age;
+	float32    m_lifetime;
+	float32    m_mass;
+	float32    m_drag;
+	float32    m_size;
+	float32    m_sizeVelocity;
+	float32    m_rotation;
+	float32    m_angularVelocity;
+	uint8      m_r, m_g, m_b, m_a;
+	uint16     m_emitter;
+	sint16     m_layer;
+	bool       m_active;
+	bool       m_visible;
+	float64    m_spawnTime; // preceded by padding
+	vec3       m_position;
+	vec3       m_velocity;
+	float32    m_weights[4];
+	Transform  m_transform;
+};
+APT_REFLECT_BEGIN(Particle)
+	APT_REFLECT_FIELD(m_name,            "Name")
+	APT_REFLECT_FIELD(m_id,              "Id")
+	APT_REFLECT_FIELD(m_flags,           "Flags")
+	APT_REFLECT_FIELD(m_group,           "Group")
+	APT_REFLECT_FIELD(m_parent,          "Parent")
+	APT_REFLECT_FIELD(m_age,             "Age")
+	APT_REFLECT_FIELD(m_lifetime,        "Lifetime")
+	APT_REFLECT_FIELD(m_mass,            "Mass")
+	APT_REFLECT_FIELD(m_drag,            "Drag")
+	APT_REFLECT_FIELD(m_size,            "Size")
+	APT_REFLECT_FIELD(m_sizeVelocity,    "SizeVelocity")
+	APT_REFLECT_FIELD(m_rotation,        "Rotation")
+	APT_REFLECT_FIELD(m_angularVelocity, "AngularVelocity")
+	APT_REFLECT_FIELD(m_r,               "R")
+	APT_REFLECT_FIELD(m_g,               "G")
+	APT_REFLECT_FIELD(m_b,               "B")
+	APT_REFLECT_FIELD(m_a,               "A")
+	APT_REFLECT_FIELD(m_emitter,         "Emitter")
+	APT_REFLECT_FIELD(m_layer,           "Layer")
+	APT_REFLECT_FIELD(m_active,          "Active")
+	APT_REFLECT_FIELD(m_visible,         "Visible")
+	APT_REFLECT_FIELD(m_spawnTime,       "SpawnTime")
+	APT_REFLECT_FIELD(m_position,        "Position")
+	APT_REFLECT_FIELD(m_velocity,        "Velocity")
+	APT_REFLECT_FIELD(m_weights,         "Weights")
+	APT_REFLECT_FIELD(m_transform,       "Transform")
+APT_REFLECT_END()
+
+// Equivalent of Serialize(_serializer_, _particle_, _name) written by hand.
+bool SerializeParticle(Serializer& _serializer_, Particle& _particle_, const char* _name = nullptr)
+{
+	if (!_serializer_.beginObject(_name)) {
+		return false;
+	}
+	bool ret = true;
+	ret &= Serialize(_serializer_, _particle_.m_name,            "Name");
+	ret &= Serialize(_serializer_, _particle_.m_id,              "Id");
+	ret &= Serialize(_serializer_, _particle_.m_flags,           "Flags");
+	ret &= Serialize(_serializer_, _particle_.m_group,           "Group");
+	ret &= Serialize(_serializer_, _particle_.m_parent,          "Parent");
+	ret &= Serialize(_serializer_, _particle_.m_age,             "Age");
+	ret &= Serialize(_serializer_, _particle_.m_lifetime,        "Lifetime");
+	ret &= Serialize(_serializer_, _particle_.m_mass,            "Mass");
+	ret &= Serialize(_serializer_, _particle_.m_drag,            "Drag");
+	ret &= Serialize(_serializer_, _particle_.m_size,            "Size");
+	ret &= Serialize(_serializer_, _particle_.m_sizeVelocity,    "SizeVelocity");
+	ret &= Serialize(_serializer_, _particle_.m_rotation,        "Rotation");
+	ret &= Serialize(_serializer_, _particle_.m_angularVelocity, "AngularVelocity");
+	ret &= Serialize(_serializer_, _particle_.m_r,               "R");
+	ret &= Serialize(_serializer_, _particle_.m_g,               "G");
+	ret &= Serialize(_serializer_, _particle_.m_b,               "B");
+	ret &= Serialize(_serializer_, _particle_.m_a,               "A");
+	ret &= Serialize(_serializer_, _particle_.m_emitter,         "Emitter");
+	ret &= Serialize(_serializer_, _particle_.m_layer,           "Layer");
+	ret &= Serialize(_serializer_, _particle_.m_active,          "Active");
+	ret &= Serialize(_serializer_, _particle_.m_visible,         "Visible");
+	ret &= Serialize(_serializer_, _particle_.m_spawnTime,       "SpawnTime");
+	ret &= Serialize(_serializer_, _particle_.m_position,        "Position");
+	ret &= Serialize(_serializer_, _particle_.m_velocity,        "Velocity");
+	ret &= _serializer_.valueArray(_particle_.m_weights, 4,      "Weights");
+	if (_serializer_.beginObject("Transform")) {
+		ret &= Serialize(_serializer_, _particle_.m_transform.m_position,    "Position");
+		ret &= Serialize(_serializer_, _particle_.m_transform.m_orientation, "Orientation");
+		ret &= Serialize(_serializer_, _particle_.m_transform.m_scale,       "Scale");
+		_serializer_.endObject();
+	} else {
+		ret = false;
+	}
+	_serializer_.endObject();
+	return ret;
+}
+
+void GenerateParticles(eastl::vector<Particle>& particles_, uint _count)
+{
+	Rand<> rnd;
+	particles_.resize(_count);
+	for (uint i = 0; i < _count; ++i) {
+		Particle& p = particles_[i];
+		p.m_name.setf("Particle%u", i);
+		p.m_id              = i;
+		p.m_flags           = rnd.raw();
+		p.m_group           = rnd.get<int>(-10, 10);
+		p.m_parent          = (sint32)i - 1;
+		p.m_age             = rnd.get<float>(0.0f, 10.0f);
+		p.m_lifetime        = rnd.get<float>(0.0f, 10.0f);
+		p.m_mass            = rnd.get<float>(0.1f, 2.0f);
+		p.m_drag            = rnd.get<float>();
+		p.m_size            = rnd.get<float>(0.1f, 4.0f);
+		p.m_sizeVelocity    = rnd.get<float>(-1.0f, 1.0f);
+		p.m_rotation        = rnd.get<float>(0.0f, 6.28f);
+		p.m_angularVelocity = rnd.get<float>(-1.0f, 1.0f);
+		p.m_r               = (uint8)rnd.get<int>(0, 255);
+		p.m_g               = (uint8)rnd.get<int>(0, 255);
+		p.m_b               = (uint8)rnd.get<int>(0, 255);
+		p.m_a               = (uint8)rnd.get<int>(0, 255);
+		p.m_emitter         = (uint16)rnd.get<int>(0, 1000);
+		p.m_layer           = (sint16)rnd.get<int>(-100, 100);
+		p.m_active          = rnd.get<bool>();
+		p.m_visible         = rnd.get<bool>();
+		p.m_spawnTime       = (float64)rnd.get<float>(0.0f, 1000.0f) + 1.0 / 3.0;
+		p.m_position        = vec3(rnd.get<float>(), rnd.get<float>(), rnd.get<float>());
+		p.m_velocity        = vec3(rnd.get<float>(), rnd.get<float>(), rnd.get<float>());
+		for (float32& w : p.m_weights) {
+			w = rnd.get<float>();
+		}
+		p.m_transform.m_position    = p.m_position;
+		p.m_transform.m_orientation = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		p.m_transform.m_scale       = vec3(p.m_size);
+	}
+}
+
+// Particles are compared via their untagged serialization (padding bytes are undefined, hence memcmp isn't possible).
+void ParticleData(Particle& _particle_, File& data_)
+{
+	SerializerBinary sb(data_, Serializer::Mode_Write, 0);
+	SerializeParticle(sb, _particle_, "Particle");
+}
+bool ParticlesEqual(Particle& _a, Particle& _b)
+{
+	File a, b;
+	ParticleData(_a, a);
+	ParticleData(_b, b);
+	return a.getDataSize() == b.getDataSize() && memcmp(a.getData(), b.getData(), a.getDataSize()) == 0;
+}
+
+} // namespace
+
+TEST_CASE("Reflect", "[Serializer]")
+{
+	eastl::vector<Particle> src;
+	GenerateParticles(src, 2);
+
+	const ReflectTable& table = GetReflectTable((const Particle*)nullptr);
+	REQUIRE(table.m_fieldCount == 26);
+	REQUIRE(table.m_fields[1].m_nameHash == StringHash("Id"));
+	REQUIRE(table.m_fields[1].m_type == Serializer::ScalarType_Uint32);
+	REQUIRE(table.m_fields[0].m_serialize != nullptr);
+	REQUIRE(table.m_fields[23].m_count == 3);
+	REQUIRE(table.m_fields[24].m_count == 4);
+	REQUIRE(table.m_fields[25].m_type == Serializer::ScalarType_Count);
+
+	{	Json json;
+		{	SerializerJson sj(json, Serializer::Mode_Write);
+			REQUIRE(Serialize(sj, src[0], "Particle0"));
+			REQUIRE(SerializeParticle(sj, src[1], "Particle1"));
+		}
+		SerializerJson sj(json, Serializer::Mode_Read);
+		Particle dst[2];
+		REQUIRE(SerializeParticle(sj, dst[0], "Particle0"));
+		REQUIRE(Serialize(sj, dst[1], "Particle1"));
+		REQUIRE(ParticlesEqual(dst[0], src[0]));
+		REQUIRE(ParticlesEqual(dst[1], src[1]));
+	}
+
+	const SerializerBinary::Flags kFlags[] = {
+		SerializerBinary::Flags_Tagged,
+		SerializerBinary::Flags_Tagged | SerializerBinary::Flags_Aligned,
+		0,
+		SerializerBinary::Flags_Aligned
+	};
+	for (SerializerBinary::Flags flags : kFlags) {
+	 // the data is identical to the hand-written version
+		File reflected, manual;
+		{	SerializerBinary sb(reflected, Serializer::Mode_Write, flags);
+			REQUIRE(Serialize(sb, src[0], "Particle0"));
+			REQUIRE(Serialize(sb, src[1], "Particle1"));
+		}
+		{	SerializerBinary sb(manual, Serializer::Mode_Write, flags);
+			REQUIRE(SerializeParticle(sb, src[0], "Particle0"));
+			REQUIRE(SerializeParticle(sb, src[1], "Particle1"));
+		}
+		REQUIRE(reflected.getDataSize() == manual.getDataSize());
+		REQUIRE(memcmp(reflected.getData(), manual.getData(), manual.getDataSize()) == 0);
+
+		SerializerBinary sb(reflected, Serializer::Mode_Read);
+		Particle dst[2];
+		if (sb.isTagged()) {
+		 // out of order
+			REQUIRE(Serialize(sb, dst[1], "Particle1"));
+			REQUIRE(Serialize(sb, dst[0], "Particle0"));
+		} else {
+			REQUIRE(Serialize(sb, dst[0], "Particle0"));
+			REQUIRE(Serialize(sb, dst[1], "Particle1"));
+		}
+		REQUIRE(ParticlesEqual(dst[0], src[0]));
+		REQUIRE(ParticlesEqual(dst[1], src[1]));
+	}
+
+ // tagged streams tolerate missing fields and type changes
+	{	File f;
+		{	SerializerBinary sb(f, Serializer::Mode_Write);
+			sb.beginObject("Particle");
+			float64 id = 7.0;
+			sb.value(id, "Id");
+			vec3 position(1.0f, 2.0f, 3.0f);
+			Serialize(sb, position, "Position");
+			sb.endObject();
+		}
+		SerializerBinary sb(f, Serializer::Mode_Read);
+		Particle dst = src[0];
+		REQUIRE(!Serialize(sb, dst, "Particle"));
+		REQUIRE(sb.getError() != nullptr);
+		REQUIRE(dst.m_id == 7);
+		REQUIRE(dst.m_position == vec3(1.0f, 2.0f, 3.0f));
+		REQUIRE(dst.m_mass == src[0].m_mass);
+	}
+}
+
+TEST_CASE("Reflect performance", "[Serializer][.]")
+{
+	const uint kCount = 100000;
+	eastl::vector<Particle> src;
+	GenerateParticles(src, kCount);
+
+	APT_LOG("\nReflect performance *********");
+	APT_LOG("%u particles (%u fields), hand-written -> reflected:", kCount, (uint)GetReflectTable((const Particle*)nullptr).m_fieldCount);
+
+	auto SerializeParticles = [](Serializer& _serializer_, eastl::vector<Particle>& _particles_, bool _reflected) {
+		bool ret = true;
+		uint count = (uint)_particles_.size();
+		if (_serializer_.beginArray(count, "Particles")) {
+			_particles_.resize(count);
+			for (uint i = 0; i < count; ++i) {
+				ret &= _reflected ? Serialize(_serializer_, _particles_[i]) : SerializeParticle(_serializer_, _particles_[i]);
+			}
+			_serializer_.endArray();
+		}
+		return ret;
+	};
+
+	const char* kBackendName[] = { "SerializerJson", "SerializerBinary tagged", "SerializerBinary untagged" };
+	for (int backend = 0; backend < 3; ++backend) {
+		double save[2], load[2];
+		for (int reflected = 0; reflected < 2; ++reflected) {
+			Json json;
+			File f;
+			Timestamp t = Time::GetTimestamp();
+			if (backend == 0) {
+				SerializerJson sj(json, Serializer::Mode_Write);
+				SerializeParticles(sj, src, reflected != 0);
+			} else {
+				SerializerBinary sb(f, Serializer::Mode_Write, backend == 1 ? SerializerBinary::Flags_Tagged : 0);
+				SerializeParticles(sb, src, reflected != 0);
+			}
+			save[reflected] = (Time::GetTimestamp() - t).asMilliseconds();
+
+			eastl::vector<Particle> dst;
+			t = Time::GetTimestamp();
+			if (backend == 0) {
+				SerializerJson sj(json, Serializer::Mode_Read);
+				REQUIRE(SerializeParticles(sj, dst, reflected != 0));
+			} else {
+				SerializerBinary sb(f, Serializer::Mode_Read);
+				REQUIRE(SerializeParticles(sb, dst, reflected != 0));
+			}
+			load[reflected] = (Time::GetTimestamp() - t).asMilliseconds();
+			REQUIRE(ParticlesEqual(dst[kCount - 1], src[kCount - 1]));
+		}
+		APT_LOG("\t%-26s save %8.2fms -> %8.2fms (x%.1f), load %8.2fms -> %8.2fms (x%.1f)", kBackendName[backend], save[0], save[1], save[0] / save[1], load[0], load[1], load[0] / load[1]);
+	}
+}
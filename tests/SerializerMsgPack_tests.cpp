@@ -0,0 +1,296 @@
+#include <catch.hpp>
+
+#include <apt/log.h>
+#include <apt/File.h>
+#include <apt/Json.h>
+#include <apt/rand.h>
+#include <apt/SerializerMsgPack.h>
+#include <apt/String.h>
+#include <apt/Time.h>
+
+#include <EASTL/vector.h>
+
+#include <cstring>
+
+using namespace apt;
+
+namespace {
+
+struct Monster
+{
+	String<32> m_name;
+	uint32     m_id;
+	sint16     m_level;
+	bool       m_hostile;
+	float32    m_health;
+	float64    m_spawnTime;
+	vec3       m_position;
+	mat4       m_world;
+	uint8      m_loot[8];
+};
+APT_REFLECT_BEGIN(Monster)
+	APT_REFLECT_FIELD(m_name,      "Name")
+	APT_REFLECT_FIELD(m_id,        "Id")
+	APT_REFLECT_FIELD(m_level,     "Level")
+	APT_REFLECT_FIELD(m_hostile,   "Hostile")
+	APT_REFLECT_FIELD(m_health,    "Health")
+	APT_REFLECT_FIELD(m_spawnTime, "SpawnTime")
+	APT_REFLECT_FIELD(m_position,  "Position")
+	APT_REFLECT_FIELD(m_world,     "World")
+	APT_REFLECT_FIELD(m_loot,      "Loot")
+APT_REFLECT_END()
+
+bool operator==(const Monster& _a, const Monster& _b)
+{
+	return _a.m_name == _b.m_name && _a.m_id == _b.m_id && _a.m_level == _b.m_level && _a.m_hostile == _b.m_hostile
+		&& _a.m_health == _b.m_health && _a.m_spawnTime == _b.m_spawnTime && _a.m_position == _b.m_position
+		&& _a.m_world == _b.m_world && memcmp(_a.m_loot, _b.m_loot, sizeof(_a.m_loot)) == 0;
+}
+
+void GenerateMonsters(eastl::vector<Monster>& monsters_, uint _count)
+{
+	Rand<> rnd;
+	monsters_.resize(_count);
+	for (uint i = 0; i < _count; ++i) {
+		Monster& m = monsters_[i];
+		m.m_name.setf("Monster%u", i);
+		m.m_id = rnd.raw();
+		m.m_level = (sint16)rnd.get<int>(-100, 100);
+		m.m_hostile = rnd.get<bool>();
+		m.m_health = rnd.get<float>(0.0f, 100.0f);
+		m.m_spawnTime = (float64)rnd.get<float>(0.0f, 1000.0f) + 1.0 / 3.0;
+		m.m_position = vec3(rnd.get<float>(), rnd.get<float>(), rnd.get<float>());
+		m.m_world = mat4(1.0f);
+		m.m_world[3] = vec4(m.m_position, 1.0f);
+		for (uint8& l : m.m_loot) {
+			l = (uint8)rnd.get<int>(0, 255);
+		}
+	}
+}
+
+bool SerializeMonsters(Serializer& _serializer_, eastl::vector<Monster>& _monsters_)
+{
+	bool ret = true;
+	uint count = (uint)_monsters_.size();
+	if (_serializer_.beginArray(count, "Monsters")) {
+		_monsters_.resize(count);
+		for (uint i = 0; i < count; ++i) {
+			ret &= Serialize(_serializer_, _monsters_[i]);
+		}
+		_serializer_.endArray();
+	}
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE("SerializerMsgPack", "[SerializerMsgPack]")
+{
+	eastl::vector<Monster> monsters;
+	GenerateMonsters(monsters, 20);
+	String<512> longString; // > str8
+	for (int i = 0; i < 40; ++i) {
+		longString.appendf("%d ", i);
+	}
+	eastl::vector<uint8> bin(100000);
+	for (uint i = 0; i < (uint)bin.size(); ++i) {
+		bin[i] = (uint8)(i % 7);
+	}
+	const sint64 kInts[] = { 0, 1, 127, 128, 255, 256, 65535, 65536, 0xffffffffll, 0x100000000ll, -1, -32, -33, -128, -129, -32768, -32769, -2147483648ll, -2147483649ll };
+
+	File f;
+	{	SerializerMsgPack mp(f, Serializer::Mode_Write);
+		REQUIRE(SerializeMonsters(mp, monsters));
+		uint len = APT_ARRAY_COUNT(kInts);
+		REQUIRE(mp.beginArray(len, "Ints"));
+		for (sint64 i : kInts) {
+			REQUIRE(mp.value(i));
+		}
+		mp.endArray();
+		uint64 u64 = 0xffffffffffffffffull;
+		REQUIRE(mp.value(u64, "Uint64"));
+		REQUIRE(mp.value(longString, "LongString"));
+		REQUIRE(mp.beginObject("Unknown")); // skipped when reading
+		REQUIRE(mp.value(longString, "LongString"));
+		len = 1;
+		REQUIRE(mp.beginArray(len, "Nested"));
+		REQUIRE(mp.beginObject());
+		mp.endObject();
+		mp.endArray();
+		mp.endObject();
+		void* data = bin.data();
+		uint dataSize = (uint)bin.size();
+		REQUIRE(mp.binary(data, dataSize, "Binary"));
+		REQUIRE(mp.binary(data, dataSize, "BinaryCompressed", CompressionFlags_Speed));
+		len = 3;
+		REQUIRE(mp.beginArray(len, "Mixed"));
+		sint32 i32 = 1;
+		REQUIRE(mp.value(i32));
+		REQUIRE(mp.value(longString));
+		REQUIRE(mp.value(i32));
+		mp.endArray();
+		REQUIRE(mp.value(u64, "AfterMixed"));
+		REQUIRE(!mp.value(u64)); // name required
+	}
+
+	SerializerMsgPack mp(f, Serializer::Mode_Read);
+	REQUIRE(mp.getError() == nullptr);
+
+ // out of order
+	uint64 u64 = 0;
+	REQUIRE(mp.value(u64, "Uint64"));
+	REQUIRE(u64 == 0xffffffffffffffffull);
+	float64 f64 = 0.0;
+	REQUIRE(mp.value(f64, "Uint64")); // conversion
+	String<512> str;
+	REQUIRE(mp.value(str, "LongString"));
+	REQUIRE(str == longString);
+
+	void* data = nullptr;
+	uint dataSize = 0;
+	REQUIRE(mp.binary(data, dataSize, "BinaryCompressed"));
+	REQUIRE(dataSize == (uint)bin.size());
+	REQUIRE(memcmp(data, bin.data(), dataSize) == 0);
+	free(data);
+	data = nullptr;
+	REQUIRE(mp.binary(data, dataSize, "Binary"));
+	REQUIRE(memcmp(data, bin.data(), dataSize) == 0);
+	free(data);
+
+	eastl::vector<Monster> dst;
+	REQUIRE(SerializeMonsters(mp, dst));
+	REQUIRE(dst.size() == monsters.size());
+	for (uint i = 0; i < (uint)dst.size(); ++i) {
+		REQUIRE(dst[i] == monsters[i]);
+	}
+
+	uint len = 0;
+	REQUIRE(mp.beginArray(len, "Ints"));
+	REQUIRE(len == APT_ARRAY_COUNT(kInts));
+	for (sint64 i : kInts) {
+		sint64 v = 0;
+		REQUIRE(mp.value(v));
+		REQUIRE(v == i);
+	}
+	sint64 v;
+	REQUIRE(!mp.value(v)); // end of array
+	mp.endArray();
+
+ // errors
+	REQUIRE(!mp.value(v, "Missing"));
+	REQUIRE(mp.getError() != nullptr);
+	REQUIRE(!mp.value(v, "LongString")); // not a number
+	REQUIRE(!mp.beginObject("Ints")); // not an object
+	REQUIRE(mp.value(str, "LongString"));
+	REQUIRE(str == longString);
+
+ // invalid element, the whole array is skipped
+	sint32 mixed[3];
+	REQUIRE(!mp.valueArray(mixed, 3, "Mixed"));
+	REQUIRE(mp.value(u64, "AfterMixed"));
+	REQUIRE(u64 == 0xffffffffffffffffull);
+}
+
+TEST_CASE("SerializerMsgPack format", "[SerializerMsgPack]")
+{
+ // output matches the spec
+	File f;
+	{	SerializerMsgPack mp(f, Serializer::Mode_Write);
+		sint32 a = 1, b = -1;
+		String<8> c = "hi";
+		mp.value(a, "a");
+		mp.value(b, "b");
+		mp.value(c, "c");
+		uint len = 2;
+		mp.beginArray(len, "d");
+		bool t = true;
+		float32 h = 1.5f;
+		mp.value(t);
+		mp.value(h);
+		mp.endArray();
+	}
+	const uint8 kExpected[] = {
+		0xdf, 0x00, 0x00, 0x00, 0x04,                    // map32, 4 entries
+		0xa1, 'a', 0x01,                                 // "a": 1
+		0xa1, 'b', 0xff,                                 // "b": -1
+		0xa1, 'c', 0xa2, 'h', 'i',                       // "c": "hi"
+		0xa1, 'd', 0xdd, 0x00, 0x00, 0x00, 0x02,         // "d": array32, 2 elements
+		0xc3,                                            // true
+		0xca, 0x3f, 0xc0, 0x00, 0x00                     // 1.5f
+	};
+	REQUIRE(f.getDataSize() == sizeof(kExpected));
+	REQUIRE(memcmp(f.getData(), kExpected, sizeof(kExpected)) == 0);
+
+ // read the smallest encoding as written by other implementations
+	const uint8 kInput[] = {
+		0x83,                                            // fixmap, 3 entries
+		0xa3, 'p', 'o', 's', 0x93, 0x01, 0xcb, 0x40, 0x00, 0, 0, 0, 0, 0, 0, 0xd0, 0xfd, // "pos": [1, 2.0, -3]
+		0xa4, 'n', 'a', 'm', 'e', 0xd9, 0x03, 'f', 'o', 'o', // "name": str8 "foo"
+		0xa3, 'e', 'x', 't', 0xd6, 0x05, 1, 2, 3, 4      // "ext": fixext4, skipped
+	};
+	f.setData((const char*)kInput, sizeof(kInput));
+	SerializerMsgPack mp(f, Serializer::Mode_Read);
+	String<8> name;
+	REQUIRE(mp.value(name, "name"));
+	REQUIRE(name == "foo");
+	vec3 pos;
+	REQUIRE(Serialize(mp, pos, "pos"));
+	REQUIRE(pos == vec3(1.0f, 2.0f, -3.0f));
+	REQUIRE(!mp.value(name, "ext"));
+
+ // invalid root
+	f.setData("\x91\x01", 2);
+	SerializerMsgPack invalid(f, Serializer::Mode_Read);
+	REQUIRE(invalid.getError() != nullptr);
+	REQUIRE(!invalid.value(name, "name"));
+}
+
+TEST_CASE("SerializerMsgPack performance", "[SerializerMsgPack][.]")
+{
+	const uint kCount = 100000;
+	eastl::vector<Monster> src;
+	GenerateMonsters(src, kCount);
+
+	APT_LOG("\nSerializerMsgPack performance *********");
+	APT_LOG("%u monsters:", kCount);
+
+	double jsonSave, jsonLoad;
+	uint64 jsonSize;
+	{	Json json;
+		File f;
+		Timestamp t = Time::GetTimestamp();
+		{	SerializerJson sj(json, Serializer::Mode_Write);
+			SerializeMonsters(sj, src);
+		}
+		Json::Write(json, f, Json::WriteOptions(false));
+		jsonSave = (Time::GetTimestamp() - t).asMilliseconds();
+		jsonSize = f.getDataSize();
+
+		eastl::vector<Monster> dst;
+		t = Time::GetTimestamp();
+		Json jsonRead;
+		Json::Read(jsonRead, f);
+		{	SerializerJson sj(jsonRead, Serializer::Mode_Read);
+			REQUIRE(SerializeMonsters(sj, dst));
+		}
+		jsonLoad = (Time::GetTimestamp() - t).asMilliseconds();
+		REQUIRE(dst[kCount - 1] == src[kCount - 1]);
+		APT_LOG("\tSerializerJson    %8.2fMB, save %8.2fms, load %8.2fms", (double)jsonSize / (1024.0 * 1024.0), jsonSave, jsonLoad);
+	}
+	{	File f;
+		Timestamp t = Time::GetTimestamp();
+		{	SerializerMsgPack mp(f, Serializer::Mode_Write);
+			SerializeMonsters(mp, src);
+		}
+		double save = (Time::GetTimestamp() - t).asMilliseconds();
+
+		eastl::vector<Monster> dst;
+		t = Time::GetTimestamp();
+		{	SerializerMsgPack mp(f, Serializer::Mode_Read);
+			REQUIRE(SerializeMonsters(mp, dst));
+		}
+		double load = (Time::GetTimestamp() - t).asMilliseconds();
+		REQUIRE(dst[kCount - 1] == src[kCount - 1]);
+		APT_LOG("\tSerializerMsgPack %8.2fMB, save %8.2fms, load %8.2fms (size x%.2f, save x%.1f, load x%.1f)", (double)f.getDataSize() / (1024.0 * 1024.0), save, load, (double)f.getDataSize() / (double)jsonSize, jsonSave / save, jsonLoad / load);
+	}
+}
@@ -4,6 +4,9 @@
 #include <apt/math.h>
 #include <apt/rand.h>
 #include <apt/String.h>
+#include <apt/StringHash.h>
+#include <apt/StringView.h>
+#include <apt/Time.h>
 
 #include <EASTL/vector.h>
 #include <EASTL/vector_map.h>
@@ -156,3 +159,137 @@ TEST_CASE("Move_copy", "[String]")
 		REQUIRE(move_dyn_to_dyn == dyn);
 	}
 }
+
+TEST_CASE("setf, appendf", "[String]")
+{
+	String<8> str;
+	str.setf("%d", 1234); // fits in the local buffer
+	REQUIRE(str == "1234");
+	REQUIRE(str.isLocal());
+	str.appendf("%s", "56789abcdef"); // overflow
+	REQUIRE(str == "123456789abcdef");
+	REQUIRE(str.getLength() == 15);
+	str.setf("%s-%s", "abc", "def");
+	REQUIRE(str == "abc-def");
+	REQUIRE(str.getLength() == 7);
+
+	String<0> heap;
+	heap.appendf("%d", 1);
+	REQUIRE(heap == "1");
+	heap.appendf("%s", "");
+	REQUIRE(heap == "1");
+
+ // single integer conversions bypass the CRT
+	heap.appendf("%i", -23);
+	heap.appendf("%u", 4000000000u);
+	heap.appendf("%lld", -9223372036854775807ll - 1);
+	heap.appendf("%llu", 18446744073709551615ull);
+	REQUIRE(heap == "1-234000000000-922337203685477580818446744073709551615");
+}
+
+TEST_CASE("reserve, StringBuilder", "[String]")
+{
+	StringBuilder sb(1024);
+	REQUIRE(sb.getCapacity() == 1024);
+	for (int i = 0; i < 100; ++i) {
+		sb.appendf("%d,", i % 10);
+	}
+	REQUIRE(sb.getLength() == 200);
+	REQUIRE(sb.getCapacity() == 1024);
+	REQUIRE(sb.replace(",", "") == 100);
+	REQUIRE(sb.getLength() == 100);
+	REQUIRE(sb.getCapacity() == 1024);
+	sb.clear();
+	REQUIRE(sb.getCapacity() == 1024);
+	sb.reserve(16); // no-op
+	REQUIRE(sb.getCapacity() == 1024);
+}
+
+TEST_CASE("StringView", "[String]")
+{
+	const char* kStr = "path/to/file.ext";
+	StringView sv(kStr);
+	REQUIRE(sv.getLength() == 16);
+	REQUIRE(sv == "path/to/file.ext");
+	REQUIRE(sv != "path/to/file");
+	REQUIRE(sv.substr(5, 2) == "to");
+	REQUIRE(sv.substr(12) == ".ext");
+	REQUIRE(sv.substr(100).isEmpty());
+	REQUIRE(sv.findFirst('/') == kStr + 4);
+	REQUIRE(sv.findLast('/') == kStr + 7);
+	REQUIRE(sv.findLast("./") == kStr + 12);
+	REQUIRE(sv.findFirst('x') == kStr + 14);
+	REQUIRE(sv.substr(0, 12).findFirst('x') == nullptr);
+	REQUIRE(sv.find("file") == kStr + 8);
+	REQUIRE(sv.substr(0, 10).find("file") == nullptr);
+	REQUIRE(sv.beginsWith("path/"));
+	REQUIRE(sv.endsWith(".ext"));
+	REQUIRE(!sv.endsWith("path/to/file.ext+"));
+	REQUIRE(StringView("abc") < StringView("abd"));
+	REQUIRE(StringView("ab")  < StringView("abc"));
+	REQUIRE(StringView("abc") > StringView("ab"));
+	REQUIRE(StringView().isNull());
+	REQUIRE(StringView().isEmpty());
+	REQUIRE(StringView("") == StringView());
+
+ // hash of a view == hash of the equivalent null-terminated string
+	REQUIRE(StringHash(sv.substr(8, 4)) == StringHash("file"));
+
+ // StringBase interop
+	String<8> str(sv.substr(8, 4));
+	REQUIRE(str == "file");
+	REQUIRE(str == sv.substr(8, 4));
+	str.append(sv.substr(12));
+	REQUIRE(str == "file.ext");
+	str.set(sv.substr(0, 4));
+	REQUIRE(str == "path");
+	REQUIRE(str.find(sv.substr(1, 2)) == (const char*)str + 1);
+	str.append(str); // self-append across a realloc
+	REQUIRE(str == "pathpath");
+	str.append(StringView(str).substr(2));
+	REQUIRE(str == "pathpaththpath");
+	StringView view = str;
+	REQUIRE(view.getLength() == str.getLength());
+	REQUIRE(view.begin() == (const char*)str);
+}
+
+TEST_CASE("append performance", "[String][.]")
+{
+	const int   kFragmentCount = 1000000;
+	const char* kFragment      = "fragment";
+	const uint  kFragmentLen   = strlen(kFragment);
+
+	APT_LOG("\nString append performance (%d fragments) *********", kFragmentCount);
+
+	enum Growth { Growth_Exact, Growth_Geometric, Growth_Reserve, Growth_Appendf };
+	const char* kGrowthStr[] = { "exact", "geometric", "reserve", "appendf" };
+	for (int growth = Growth_Exact; growth <= Growth_Appendf; ++growth) {
+		StringBuilder str;
+		if (growth == Growth_Reserve) {
+			str.reserve(kFragmentCount * kFragmentLen + 1);
+		}
+		uint   reallocCount = 0;
+		uint64 copiedBytes  = 0; // upper bound, assumes every realloc moves the buffer
+		uint   capacity     = str.getCapacity();
+		Timestamp t = Time::GetTimestamp();
+		for (int i = 0; i < kFragmentCount; ++i) {
+			if (growth == Growth_Exact) {
+			 // emulate the previous behavior, reallocate to exactly the required size
+				str.setCapacity(APT_MAX(str.getLength() + kFragmentLen + 1, str.getCapacity()));
+			}
+			if (growth == Growth_Appendf) {
+				str.appendf("%s", kFragment);
+			} else {
+				str.append(kFragment, kFragmentLen);
+			}
+			if (str.getCapacity() != capacity) {
+				++reallocCount;
+				copiedBytes += str.getLength() - kFragmentLen;
+				capacity = str.getCapacity();
+			}
+		}
+		t = Time::GetTimestamp() - t;
+		REQUIRE(str.getLength() == kFragmentCount * kFragmentLen);
+		APT_LOG("\t%-10s %8u reallocs, %12llu bytes copied, %s", kGrowthStr[growth], reallocCount, copiedBytes, t.asString());
+	}
+}
@@ -0,0 +1,118 @@
+#include <catch.hpp>
+
+#include <apt/log.h>
+#include <apt/memory.h>
+#include <apt/rand.h>
+#include <apt/simd_string.h>
+#include <apt/TextParser.h>
+#include <apt/Time.h>
+
+using namespace apt;
+
+// Reference implementation, count line endings and chars since the last line ending.
+static void RefLineColumn(const char* _str, const char* _pos, int& line_, int& column_)
+{
+	line_ = 0;
+	column_ = 0;
+	for (const char* c = _str; c != _pos; ++c) {
+		++column_;
+		if (*c == '\n') {
+			++line_;
+			column_ = 0;
+		}
+	}
+}
+
+TEST_CASE("getLineCount, getColumnCount", "[TextParser]")
+{
+	const char* kStr = "[section]\nkey = 1\n\n  value = \"abc\"\r\nlast";
+	const int kLen = (int)strlen(kStr);
+
+	TextParser tp(kStr);
+	REQUIRE(tp.getLineCount() == 0);
+	REQUIRE(tp.getColumnCount() == 0);
+	for (int i = 0; i <= kLen; ++i) {
+		int line, column;
+		RefLineColumn(kStr, kStr + i, line, column);
+		line += kStr[i] == '\n' ? 1 : 0; // getLineCount() includes _pos
+		REQUIRE(tp.getLineCount(kStr + i) == line);
+		REQUIRE(tp.getColumnCount(kStr + i) == column);
+	}
+ // lookups behind the indexed region
+	REQUIRE(tp.getLineCount(kStr + 10) == 1);
+	REQUIRE(tp.getColumnCount(kStr + 12) == 2);
+
+ // running line count
+	TextParser tpc(kStr, true);
+	TextParser tpi(kStr);
+	while (!tpc.isNull()) {
+		tpc.skipWhitespace();
+		tpi.skipWhitespace();
+		REQUIRE(tpc.getLineCount() == tpi.getLineCount());
+		tpc.advanceToNextWhitespace();
+		tpi.advanceToNextWhitespace();
+		REQUIRE(tpc.getLineCount() == tpi.getLineCount());
+	}
+	tpc.reset(kStr + 12);
+	REQUIRE(tpc.getLineCount() == 1);
+	tpc.skipLine();
+	REQUIRE(tpc.getLineCount() == 3); // includes the empty line at the current position
+	tpc.reset();
+	REQUIRE(tpc.getLineCount() == 0);
+}
+
+TEST_CASE("line count performance", "[TextParser][.]")
+{
+	const uint kSize = 50 * 1024 * 1024;
+	const int  kDiagnostics = 10000;
+
+ // lines of 'key = value' with random lengths
+	char* str = (char*)APT_MALLOC(kSize + 1);
+	Rand<> rnd;
+	for (uint i = 0; i < kSize; ++i) {
+		str[i] = rnd.get<int>(0, 40) == 0 ? '\n' : (char)rnd.get<int>('a', 'z');
+	}
+	str[kSize] = '\0';
+	const char** positions = new const char*[kDiagnostics];
+	for (int i = 0; i < kDiagnostics; ++i) {
+		positions[i] = str + rnd.get<int>(0, (int)kSize - 1);
+	}
+
+	APT_LOG("\nline count performance (%u bytes, %d diagnostics) *********", kSize, kDiagnostics);
+	volatile sint64 sink = 0;
+
+	Timestamp t0 = Time::GetTimestamp();
+	for (int i = 0; i < kDiagnostics; ++i) {
+		sink = sink + (sint64)internal::CountChar(str, positions[i] + 1, '\n');
+	}
+	t0 = Time::GetTimestamp() - t0;
+	Timestamp t1 = Time::GetTimestamp();
+	{	TextParser tp(str);
+		for (int i = 0; i < kDiagnostics; ++i) {
+			sink = sink + tp.getLineCount(positions[i]) + tp.getColumnCount(positions[i]);
+		}
+	}
+	t1 = Time::GetTimestamp() - t1;
+	APT_LOG("\tgetLineCount    rescan %10.2fms, index %10.2fms (x%.2f)", t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds());
+
+ // cost of maintaining the running line count during a full tokenization
+	t0 = Time::GetTimestamp();
+	{	TextParser tp(str);
+		while (tp.skipWhitespace() != 0) {
+			tp.advanceToNextWhitespaceOr('=');
+		}
+	}
+	t0 = Time::GetTimestamp() - t0;
+	t1 = Time::GetTimestamp();
+	{	TextParser tp(str, true);
+		while (tp.skipWhitespace() != 0) {
+			tp.advanceToNextWhitespaceOr('=');
+		}
+		sink = sink + tp.getLineCount();
+	}
+	t1 = Time::GetTimestamp() - t1;
+	APT_LOG("\ttokenize        plain  %10.2fms, count %10.2fms (x%.2f)", t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds());
+
+	delete[] positions;
+	APT_FREE(str);
+}
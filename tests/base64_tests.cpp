@@ -0,0 +1,133 @@
+#include <catch.hpp>
+
+#include <apt/base64.h>
+#include <apt/log.h>
+#include <apt/math.h>
+#include <apt/memory.h>
+#include <apt/rand.h>
+#include <apt/Time.h>
+
+#include <cstring>
+
+using namespace apt;
+
+TEST_CASE("vectors", "[base64]")
+{
+ // RFC 4648 test vectors
+	const char* kVectors[][2] = {
+		{ "",       ""         },
+		{ "f",      "Zg=="     },
+		{ "fo",     "Zm8="     },
+		{ "foo",    "Zm9v"     },
+		{ "foob",   "Zm9vYg==" },
+		{ "fooba",  "Zm9vYmE=" },
+		{ "foobar", "Zm9vYmFy" },
+	};
+	for (auto& v : kVectors) {
+		uint len = (uint)strlen(v[0]);
+		char enc[16] = {};
+		REQUIRE(Base64EncodedSize(len) == strlen(v[1]));
+		REQUIRE(Base64Encode(v[0], len, enc) == strlen(v[1]));
+		REQUIRE(strcmp(enc, v[1]) == 0);
+
+		char dec[16] = {};
+		REQUIRE(Base64DecodedSize(v[1], (uint)strlen(v[1])) == len);
+		REQUIRE(Base64Decode(v[1], (uint)strlen(v[1]), dec));
+		REQUIRE(strcmp(dec, v[0]) == 0);
+	}
+
+ // unpadded input
+	char dec[16] = {};
+	REQUIRE(Base64DecodedSize("Zm9vYmE", 7) == 5);
+	REQUIRE(Base64Decode("Zm9vYmE", 7, dec));
+	REQUIRE(strcmp(dec, "fooba") == 0);
+
+ // invalid input
+	REQUIRE(!Base64Decode("Zm9vY", 5, dec)); // 1 char remaining
+	REQUIRE(!Base64Decode("Zm9v Y==", 8, dec));
+	REQUIRE(!Base64Decode("Zm=vYmFy", 8, dec));
+}
+
+TEST_CASE("round trip", "[base64]")
+{
+	Rand<> rnd;
+	const uint kMaxSize = 300;
+	uint8 src[kMaxSize];
+	for (uint i = 0; i < kMaxSize; ++i) {
+		src[i] = (uint8)rnd.get<int>(0, 255);
+	}
+	char enc[kMaxSize * 2], encScalar[kMaxSize * 2];
+	uint8 dec[kMaxSize + 4], decScalar[kMaxSize + 4];
+	for (uint size = 0; size < kMaxSize; ++size) {
+		uint encSize = Base64Encode(src, size, enc);
+		REQUIRE(encSize == Base64EncodedSize(size));
+		REQUIRE(internal::scalar::Base64Encode(src, size, encScalar) == encSize);
+		REQUIRE(memcmp(enc, encScalar, encSize) == 0);
+
+	 // canary, decode must not write beyond the decoded size
+		uint decSize = Base64DecodedSize(enc, encSize);
+		REQUIRE(decSize == size);
+		memset(dec, 0xcd, sizeof(dec));
+		REQUIRE(Base64Decode(enc, encSize, dec));
+		REQUIRE(memcmp(dec, src, size) == 0);
+		REQUIRE(dec[size] == 0xcd);
+		REQUIRE(internal::scalar::Base64Decode(enc, encSize, decScalar));
+		REQUIRE(memcmp(decScalar, src, size) == 0);
+
+	 // an invalid char anywhere (including within a SIMD block) is detected
+		if (encSize > 0) {
+			const char kInvalid[] = { ' ', '\n', '-', '_', '\x80', '\0', ':', '@', '[', '`', '{' };
+			uint unpadded = encSize;
+			while (enc[unpadded - 1] == '=') {
+				--unpadded;
+			}
+			uint pos = (uint)rnd.get<int>(0, (int)unpadded - 1);
+			char c = enc[pos];
+			enc[pos] = kInvalid[size % sizeof(kInvalid)];
+			REQUIRE(!Base64Decode(enc, encSize, dec));
+			REQUIRE(!internal::scalar::Base64Decode(enc, encSize, dec));
+			enc[pos] = c;
+		}
+	}
+}
+
+TEST_CASE("Base64 performance", "[base64][.]")
+{
+	const uint kSizes[] = { 1024, 64 * 1024, 64 * 1024 * 1024 };
+
+	APT_LOG("\nbase64 performance *********");
+	for (uint size : kSizes) {
+		uint8* src = (uint8*)APT_MALLOC(size);
+		Rand<> rnd;
+		for (uint i = 0; i < size; ++i) {
+			src[i] = (uint8)rnd.get<int>(0, 255);
+		}
+		char* enc = (char*)APT_MALLOC(Base64EncodedSize(size));
+		uint8* dec = (uint8*)APT_MALLOC(size);
+		const uint kRepeat = APT_MAX((uint)1, (256 * 1024 * 1024) / size);
+		const double gb = (double)size * kRepeat / (1024.0 * 1024.0 * 1024.0);
+
+		#define BENCH(_name, _simd, _scalar) \
+			{ \
+				Timestamp t0 = Time::GetTimestamp(); \
+				for (uint r = 0; r < kRepeat; ++r) { _scalar; } \
+				t0 = Time::GetTimestamp() - t0; \
+				Timestamp t1 = Time::GetTimestamp(); \
+				for (uint r = 0; r < kRepeat; ++r) { _simd; } \
+				t1 = Time::GetTimestamp() - t1; \
+				APT_LOG("\t%-8s scalar %6.2fGB/s, simd %6.2fGB/s (x%.2f)", _name, gb / t0.asSeconds(), gb / t1.asSeconds(), t0.asSeconds() / t1.asSeconds()); \
+			}
+
+		APT_LOG("%u bytes (x%u):", size, kRepeat);
+		uint encSize = Base64Encode(src, size, enc);
+		BENCH("Encode", Base64Encode(src, size, enc),     internal::scalar::Base64Encode(src, size, enc));
+		BENCH("Decode", Base64Decode(enc, encSize, dec),  internal::scalar::Base64Decode(enc, encSize, dec));
+		REQUIRE(memcmp(src, dec, size) == 0);
+
+		#undef BENCH
+
+		APT_FREE(dec);
+		APT_FREE(enc);
+		APT_FREE(src);
+	}
+}
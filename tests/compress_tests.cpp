@@ -5,8 +5,17 @@
 #include <apt/log.h>
 #include <apt/memory.h>
 #include <apt/File.h>
+#include <apt/FileSystem.h>
+#include <apt/rand.h>
 #include <apt/Time.h>
 
+#include <EASTL/vector.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
 using namespace apt;
 
 static void CompressionTest(const char* _filePath, CompressionFlags _flags)
@@ -49,4 +58,694 @@ TEST_CASE("performance", "[Compression]")
 {
 	CompressionTest("bob_lamp_update.md5anim");
 }
-#endif
\ No newline at end of file
+#endif
+
+// Text-like data (words from a small dictionary) with some random bytes.
+static void GenerateData(char* data_, uint64 _sizeBytes)
+{
+	static const char* kWords[] = { "apple ", "banana ", "cherry ", "date ", "elderberry ", "fig ", "grape ", "\n" };
+	Rand<> rnd;
+	uint64 i = 0;
+	while (i < _sizeBytes) {
+		uint32 r = rnd.raw();
+		if ((r & 0xff) == 0) {
+			data_[i++] = (char)(r >> 8);
+			continue;
+		}
+		const char* word = kWords[(r >> 8) % APT_ARRAY_COUNT(kWords)];
+		while (*word && i < _sizeBytes) {
+			data_[i++] = *word++;
+		}
+	}
+}
+
+// Serialized records (Json objects with similar keys and values), concatenated; the size of each is appended to sizes_.
+static void GenerateRecords(eastl::vector<char>& records_, eastl::vector<uint>& sizes_, uint _count, uint32 _seed)
+{
+	static const char* kItems[] = { "sword", "shield", "potion", "bow", "arrow", "helmet", "ring", "scroll" };
+	Rand<> rnd(_seed);
+	for (uint i = 0; i < _count; ++i) {
+		char buf[512];
+		int n = snprintf(buf, sizeof(buf),
+			"{\"Name\":\"Monster%u\",\"Id\":%u,\"Level\":%d,\"Hostile\":%s,\"Health\":%.2f,\"Position\":[%.3f,%.3f,%.3f],\"Inventory\":[\"%s\",\"%s\"],\"Faction\":\"%s\"}",
+			rnd.get<int>(0, 1000), rnd.raw(), rnd.get<int>(1, 60), rnd.get<bool>() ? "true" : "false", rnd.get<float>(0.0f, 100.0f),
+			rnd.get<float>(-100.0f, 100.0f), rnd.get<float>(-100.0f, 100.0f), rnd.get<float>(-100.0f, 100.0f),
+			kItems[rnd.get<int>(0, 7)], kItems[rnd.get<int>(0, 7)], rnd.get<bool>() ? "Horde" : "Alliance"
+			);
+		records_.insert(records_.end(), buf, buf + n);
+		sizes_.push_back((uint)n);
+	}
+}
+
+static void StreamCompress(const void* _in, uint _inSizeBytes, eastl::vector<char>& out_, uint _feedSize, uint _drainSize)
+{
+	Compressor compressor(CompressionFlags_Speed);
+	eastl::vector<char> buf(_drainSize);
+	const char* in = (const char*)_in;
+	if (_inSizeBytes == 0) {
+		compressor.finish();
+	}
+	while (!compressor.isDone()) {
+		if (_inSizeBytes > 0) {
+			uint n = compressor.feed(in, std::min(_inSizeBytes, _feedSize));
+			in += n;
+			_inSizeBytes -= n;
+			if (_inSizeBytes == 0) {
+				compressor.finish();
+			}
+		}
+		uint n = compressor.drain(buf.data(), _drainSize);
+		out_.insert(out_.end(), buf.data(), buf.data() + n);
+	}
+}
+
+static bool StreamDecompress(const void* _in, uint _inSizeBytes, eastl::vector<char>& out_, uint _feedSize, uint _drainSize)
+{
+	Decompressor decompressor;
+	eastl::vector<char> buf(_drainSize);
+	const char* in = (const char*)_in;
+	while (!decompressor.isDone() && !decompressor.hasError()) {
+		uint n = decompressor.feed(in, std::min(_inSizeBytes, _feedSize));
+		in += n;
+		_inSizeBytes -= n;
+		uint drained = 0;
+		while ((n = decompressor.drain(buf.data(), _drainSize)) > 0) {
+			out_.insert(out_.end(), buf.data(), buf.data() + n);
+			drained += n;
+		}
+		if (_inSizeBytes == 0 && drained == 0) {
+			break;
+		}
+	}
+	return decompressor.isDone();
+}
+
+TEST_CASE("Compress", "[Compression]")
+{
+	const uint kSize = 256 * 1024 + 3;
+	eastl::vector<char> text(kSize);
+	GenerateData(text.data(), kSize);
+	eastl::vector<char> noise(kSize);
+	Rand<> rnd;
+	for (char& c : noise) {
+		c = (char)rnd.raw();
+	}
+	eastl::vector<char> zeros(kSize, 0);
+	const eastl::vector<char>* kData[] = { &text, &noise, &zeros };
+	const uint kSizes[] = { 1, 4, 12, 13, 17, 31, 64, 4096, kSize };
+	const CompressionFlags kFlags[] = { CompressionFlags_Speed, CompressionFlags_Size, CompressionFlags_Fastest };
+
+	for (CompressionFlags flags : kFlags) {
+		for (const eastl::vector<char>* data : kData) {
+			for (uint size : kSizes) {
+				void* c = nullptr;
+				uint csz;
+				Compress(data->data(), size, c, csz, flags);
+				void* d = nullptr;
+				uint dsz;
+				Decompress(c, csz, d, dsz);
+				REQUIRE(dsz == size);
+				REQUIRE(memcmp(d, data->data(), size) == 0);
+				REQUIRE(GetDecompressedSize(c, csz) == size);
+				memset(d, 0, size);
+				REQUIRE(DecompressTo(c, csz, d, size) == size);
+				REQUIRE(memcmp(d, data->data(), size) == 0);
+				free(c);
+				free(d);
+			}
+		}
+	}
+
+ // Fastest block compression
+	void* c = nullptr;
+	uint csz;
+	CompressBlocks(text.data(), kSize, c, csz, CompressionFlags_Fastest, 64 * 1024);
+	void* d = nullptr;
+	uint dsz;
+	Decompress(c, csz, d, dsz);
+	REQUIRE(dsz == kSize);
+	REQUIRE(memcmp(d, text.data(), kSize) == 0);
+	free(d);
+	eastl::vector<char> block(64 * 1024);
+	REQUIRE(DecompressBlock(c, csz, 4, block.data(), (uint)block.size()) == 3);
+	REQUIRE(DecompressBlock(c, csz - 1, 4, block.data(), (uint)block.size()) == 0); // truncated
+	d = nullptr;
+	Decompress(c, csz - 1, d, dsz);
+	REQUIRE(d == nullptr);
+	REQUIRE(dsz == 0);
+	free(c);
+
+ // truncated input, Decompress() returns null
+	for (CompressionFlags flags : kFlags) {
+		c = nullptr;
+		Compress(text.data(), kSize, c, csz, flags);
+		d = nullptr;
+		Decompress(c, csz / 2, d, dsz);
+		REQUIRE(d == nullptr);
+		REQUIRE(dsz == 0);
+		free(c);
+	}
+}
+
+TEST_CASE("Compressor", "[Compression]")
+{
+	const uint kSize = 1024 * 1024 + 17;
+	eastl::vector<char> data(kSize);
+	GenerateData(data.data(), kSize);
+
+	void* ref = nullptr;
+	uint refSize;
+	Compress(data.data(), kSize, ref, refSize, CompressionFlags_Speed);
+
+	const uint kChunkSizes[][2] = { // feed, drain
+		{ kSize, 64 * 1024 },
+		{ 7,     13 },
+		{ 4096,  1 },
+		{ 1,     100000 },
+	};
+	for (auto& chunkSize : kChunkSizes) {
+	 // output is identical to Compress() without the header
+		eastl::vector<char> compressed;
+		StreamCompress(data.data(), kSize, compressed, chunkSize[0], chunkSize[1]);
+		REQUIRE(compressed.size() < refSize);
+		uint headerSize = refSize - (uint)compressed.size();
+		REQUIRE(memcmp(compressed.data(), (char*)ref + headerSize, compressed.size()) == 0);
+		REQUIRE(GetDecompressedSize(compressed.data(), (uint)compressed.size()) == 0);
+
+		eastl::vector<char> decompressed;
+		REQUIRE(StreamDecompress(ref, refSize, decompressed, chunkSize[0], chunkSize[1]));
+		REQUIRE(decompressed.size() == kSize);
+		REQUIRE(memcmp(decompressed.data(), data.data(), kSize) == 0);
+		decompressed.clear();
+		REQUIRE(StreamDecompress(compressed.data(), (uint)compressed.size(), decompressed, chunkSize[0], chunkSize[1]));
+		REQUIRE(decompressed.size() == kSize);
+	}
+
+ // truncated/invalid input
+	eastl::vector<char> decompressed;
+	REQUIRE(!StreamDecompress(ref, refSize - 1, decompressed, 4096, 4096));
+	eastl::vector<char> invalid(refSize);
+	memcpy(invalid.data(), ref, refSize);
+	invalid[0] ^= 0xff; // header
+	decompressed.clear();
+	REQUIRE(!StreamDecompress(invalid.data(), refSize, decompressed, 4096, 4096));
+	void* fastest = nullptr;
+	uint fastestSize;
+	Compress(data.data(), kSize, fastest, fastestSize, CompressionFlags_Fastest);
+	decompressed.clear();
+	REQUIRE(!StreamDecompress(fastest, fastestSize, decompressed, 1, 4096)); // not a zlib stream
+	free(fastest);
+
+ // empty input
+	eastl::vector<char> compressed;
+	StreamCompress(nullptr, 0, compressed, 1, 1);
+	decompressed.clear();
+	REQUIRE(StreamDecompress(compressed.data(), (uint)compressed.size(), decompressed, 1, 1));
+	REQUIRE(decompressed.empty());
+
+	free(ref);
+}
+
+TEST_CASE("WriteCompressed/ReadCompressed", "[Compression]")
+{
+	const char* kPath = "compress_tests_WriteCompressed.bin";
+	File f;
+	f.setData(nullptr, 3 * 1024 * 1024);
+	GenerateData(f.getData(), f.getDataSize());
+	REQUIRE(WriteCompressed(f, kPath));
+
+	File compressed;
+	REQUIRE(File::Read(compressed, kPath));
+	REQUIRE(compressed.getDataSize() < f.getDataSize());
+	void* d = nullptr;
+	uint dsz;
+	Decompress(compressed.getData(), (uint)compressed.getDataSize(), d, dsz);
+	REQUIRE(dsz == f.getDataSize());
+	REQUIRE(memcmp(d, f.getData(), dsz) == 0);
+	free(d);
+
+	File g;
+	g.setPath(kPath);
+	REQUIRE(ReadCompressed(g));
+	REQUIRE(g.getDataSize() == f.getDataSize());
+	REQUIRE(memcmp(g.getData(), f.getData(), f.getDataSize()) == 0);
+	REQUIRE(strcmp(g.getPath(), kPath) == 0);
+
+ // invalid data, g remains unchanged
+	compressed.setDataSize(compressed.getDataSize() / 2);
+	REQUIRE(File::Write(compressed, kPath));
+	REQUIRE(!ReadCompressed(g, kPath));
+	REQUIRE(g.getDataSize() == f.getDataSize());
+
+	FileSystem::Delete(kPath);
+}
+
+TEST_CASE("DecompressTo", "[Compression]")
+{
+	const uint kSize = 100000;
+	eastl::vector<char> data(kSize);
+	GenerateData(data.data(), kSize);
+	eastl::vector<char> out(kSize + 1);
+
+	const CompressionFlags kFlags[] = { CompressionFlags_Speed, CompressionFlags_Fastest };
+	for (CompressionFlags flags : kFlags) {
+		void* c = nullptr;
+		uint csz;
+		Compress(data.data(), kSize, c, csz, flags);
+		REQUIRE(GetDecompressedSize(c, csz) == kSize);
+		REQUIRE(DecompressTo(c, csz, out.data(), kSize + 1) == kSize);
+		REQUIRE(memcmp(out.data(), data.data(), kSize) == 0);
+		REQUIRE(DecompressTo(c, csz, out.data(), kSize - 1) == 0); // too small
+		REQUIRE(DecompressTo(c, csz - 1, out.data(), kSize) == 0); // truncated
+		REQUIRE(GetDecompressedSize(c, 8) == 0);
+		free(c);
+	}
+
+ // block format
+	void* c = nullptr;
+	uint csz;
+	CompressBlocks(data.data(), kSize, c, csz, CompressionFlags_Speed, 16 * 1024);
+	REQUIRE(GetDecompressedSize(c, csz) == kSize);
+	memset(out.data(), 0, kSize);
+	REQUIRE(DecompressTo(c, csz, out.data(), kSize) == kSize);
+	REQUIRE(memcmp(out.data(), data.data(), kSize) == 0);
+	REQUIRE(DecompressTo(c, csz, out.data(), kSize - 1) == 0);
+	free(c);
+
+ // headerless zlib stream (Compressor), the size is unknown
+	eastl::vector<char> stream;
+	StreamCompress(data.data(), kSize, stream, kSize, kSize);
+	memset(out.data(), 0, kSize);
+	REQUIRE(DecompressTo(stream.data(), (uint)stream.size(), out.data(), kSize + 1) == kSize);
+	REQUIRE(memcmp(out.data(), data.data(), kSize) == 0);
+	REQUIRE(DecompressTo(stream.data(), (uint)stream.size(), out.data(), kSize - 1) == 0);
+
+ // per-thread codec state
+	bool ret = false;
+	std::thread thread([&]() {
+			void* tc = nullptr;
+			uint tcsz;
+			Compress(data.data(), kSize, tc, tcsz, CompressionFlags_Size);
+			eastl::vector<char> tout(kSize);
+			ret = DecompressTo(tc, tcsz, tout.data(), kSize) == kSize && memcmp(tout.data(), data.data(), kSize) == 0;
+			free(tc);
+		});
+	thread.join();
+	REQUIRE(ret);
+}
+
+TEST_CASE("CompressionDictionary", "[Compression]")
+{
+	eastl::vector<char> samples;
+	eastl::vector<uint> sampleSizes;
+	GenerateRecords(samples, sampleSizes, 2000, 1);
+	CompressionDictionary dict;
+	REQUIRE(CompressionDictionary::Train(dict, samples.data(), sampleSizes.data(), (uint)sampleSizes.size(), 8 * 1024));
+	REQUIRE(dict.getSizeBytes() == 8 * 1024);
+	REQUIRE(!CompressionDictionary::Train(dict, samples.data(), sampleSizes.data(), 0));
+
+	eastl::vector<char> records;
+	eastl::vector<uint> recordSizes;
+	GenerateRecords(records, recordSizes, 500, 2);
+	eastl::vector<char> out(1024);
+	const CompressionFlags kFlags[] = { CompressionFlags_Speed, CompressionFlags_Size };
+	for (CompressionFlags flags : kFlags) {
+		uint plainSize = 0, dictSize = 0;
+		const char* record = records.data();
+		for (uint size : recordSizes) {
+			void* c = nullptr;
+			uint csz;
+			Compress(record, size, c, csz, flags);
+			plainSize += csz;
+			REQUIRE(DecompressTo(c, csz, dict, out.data(), (uint)out.size()) == size); // dict is ignored
+			free(c);
+			c = nullptr;
+
+			Compress(record, size, dict, c, csz, flags);
+			dictSize += csz;
+			uint32 hash;
+			REQUIRE(GetCompressionDictionaryHash(c, csz, hash));
+			REQUIRE(hash == dict.getHash());
+			REQUIRE(GetDecompressedSize(c, csz) == size);
+			memset(out.data(), 0, size);
+			REQUIRE(DecompressTo(c, csz, dict, out.data(), (uint)out.size()) == size);
+			REQUIRE(memcmp(out.data(), record, size) == 0);
+			REQUIRE(DecompressTo(c, csz, out.data(), (uint)out.size()) == 0); // no dictionary
+			free(c);
+			record += size;
+		}
+		REQUIRE(dictSize * 2 < plainSize);
+	}
+
+ // large input, the window wraps
+	const uint kSize = 100000;
+	eastl::vector<char> data(kSize);
+	GenerateData(data.data(), kSize);
+	for (CompressionFlags flags : kFlags) {
+		void* c = nullptr;
+		uint csz;
+		Compress(data.data(), kSize, dict, c, csz, flags);
+		void* d = nullptr;
+		uint dsz;
+		Decompress(c, csz, dict, d, dsz);
+		REQUIRE(dsz == kSize);
+		REQUIRE(memcmp(d, data.data(), kSize) == 0);
+		free(d);
+
+	 // the dictionary is identified by its data
+		CompressionDictionary copy(dict.getData(), dict.getSizeBytes());
+		REQUIRE(copy.getHash() == dict.getHash());
+		eastl::vector<char> dout(kSize);
+		REQUIRE(DecompressTo(c, csz, copy, dout.data(), kSize) == kSize);
+		copy.setData(samples.data(), 1024);
+		REQUIRE(DecompressTo(c, csz, copy, dout.data(), kSize) == 0);
+		REQUIRE(DecompressTo(c, csz - 1, dict, dout.data(), kSize) == 0); // truncated
+		free(c);
+	}
+}
+
+TEST_CASE("CompressBlocks", "[Compression]")
+{
+	const uint kSize = 3 * 1024 * 1024 + 5;
+	const uint kBlockSize = 256 * 1024;
+	eastl::vector<char> data(kSize);
+	GenerateData(data.data(), kSize);
+
+	void* c1 = nullptr;
+	uint csz1;
+	CompressBlocks(data.data(), kSize, c1, csz1, CompressionFlags_Speed, kBlockSize, 1);
+	void* c4 = nullptr;
+	uint csz4;
+	CompressBlocks(data.data(), kSize, c4, csz4, CompressionFlags_Speed, kBlockSize, 4);
+	REQUIRE(csz1 == csz4); // output is independent of the thread count
+	REQUIRE(memcmp(c1, c4, csz1) == 0);
+	free(c4);
+
+	CompressedBlockInfo info;
+	REQUIRE(GetCompressedBlockInfo(c1, csz1, info));
+	REQUIRE(info.m_sizeBytes == kSize);
+	REQUIRE(info.m_blockSizeBytes == kBlockSize);
+	REQUIRE(info.m_blockCount == 13);
+
+	void* d = nullptr;
+	uint dsz;
+	REQUIRE(DecompressBlocks(c1, csz1, d, dsz, 3));
+	REQUIRE(dsz == kSize);
+	REQUIRE(memcmp(d, data.data(), kSize) == 0);
+	free(d);
+	d = nullptr;
+	Decompress(c1, csz1, d, dsz); // detects the block format
+	REQUIRE(dsz == kSize);
+	REQUIRE(memcmp(d, data.data(), kSize) == 0);
+	free(d);
+	d = nullptr;
+
+ // random access
+	eastl::vector<char> block(kBlockSize);
+	for (uint i = info.m_blockCount; i > 0; --i) {
+		uint blockIndex = i - 1;
+		uint size = DecompressBlock(c1, csz1, blockIndex, block.data(), kBlockSize);
+		REQUIRE(size == (blockIndex == info.m_blockCount - 1 ? 5 : kBlockSize));
+		REQUIRE(memcmp(block.data(), data.data() + blockIndex * kBlockSize, size) == 0);
+	}
+	REQUIRE(DecompressBlock(c1, csz1, info.m_blockCount, block.data(), kBlockSize) == 0);
+	REQUIRE(DecompressBlock(c1, csz1, 0, block.data(), kBlockSize - 1) == 0); // too small
+
+ // invalid data
+	REQUIRE(!GetCompressedBlockInfo(c1, 16, info));
+	REQUIRE(!DecompressBlocks(c1, csz1 - 1, d, dsz));
+	REQUIRE(d == nullptr);
+	((char*)c1)[csz1 / 2] ^= 0xff;
+	REQUIRE(!DecompressBlocks(c1, csz1, d, dsz));
+	REQUIRE(d == nullptr);
+	free(c1);
+}
+
+TEST_CASE("Compressor performance", "[Compression][.]")
+{
+	const uint64 kSize = 1024ull * 1024 * 1024;
+	const char* kPath = "compress_tests_performance.bin";
+	APT_LOG("\nCompressor performance *********");
+	APT_LOG("\t%.2fMB", (double)kSize / (1024.0 * 1024.0));
+
+	File f;
+	f.setData(nullptr, kSize);
+	GenerateData(f.getData(), kSize);
+
+ // Compress() + File::Write(): the whole compressed buffer is held in memory
+	Timestamp t = Time::GetTimestamp();
+	{	File compressed;
+		void* c = nullptr;
+		uint csz;
+		Compress(f.getData(), (uint)kSize, c, csz, CompressionFlags_Speed);
+		compressed.setData((const char*)c, csz); // copy
+		free(c);
+		File::Write(compressed, kPath);
+		APT_LOG("\tCompress() + File::Write()        %8.2fms, temporary buffers %8.2fMB", (Time::GetTimestamp() - t).asMilliseconds(), (double)csz * 2.0 / (1024.0 * 1024.0));
+	}
+	t = Time::GetTimestamp();
+	REQUIRE(WriteCompressed(f, kPath, CompressionFlags_Speed));
+	APT_LOG("\tWriteCompressed()                 %8.2fms, temporary buffers    < 0.50MB", (Time::GetTimestamp() - t).asMilliseconds());
+
+ // File::Read() + Decompress(): the compressed data and a copy of the decompressed data are held in memory
+	t = Time::GetTimestamp();
+	{	File compressed;
+		File::Read(compressed, kPath);
+		void* d = nullptr;
+		uint dsz;
+		Decompress(compressed.getData(), (uint)compressed.getDataSize(), d, dsz);
+		File decompressed;
+		decompressed.setData((const char*)d, dsz); // copy
+		free(d);
+		APT_LOG("\tFile::Read() + Decompress()       %8.2fms, temporary buffers %8.2fMB", (Time::GetTimestamp() - t).asMilliseconds(), (double)(compressed.getDataSize() + dsz) / (1024.0 * 1024.0));
+	}
+	t = Time::GetTimestamp();
+	{	File decompressed;
+		REQUIRE(ReadCompressed(decompressed, kPath));
+		APT_LOG("\tReadCompressed()                  %8.2fms, temporary buffers    < 0.50MB", (Time::GetTimestamp() - t).asMilliseconds());
+		REQUIRE(decompressed.getDataSize() == kSize);
+		REQUIRE(memcmp(decompressed.getData(), f.getData(), kSize) == 0);
+	}
+
+	FileSystem::Delete(kPath);
+}
+
+TEST_CASE("CompressBlocks performance", "[Compression][.]")
+{
+	const uint kSize = 1024 * 1024 * 1024;
+	APT_LOG("\nCompressBlocks performance *********");
+	APT_LOG("\t%.2fMB, %u hardware threads", (double)kSize / (1024.0 * 1024.0), std::thread::hardware_concurrency());
+
+	eastl::vector<char> data(kSize);
+	GenerateData(data.data(), kSize);
+
+	Timestamp t = Time::GetTimestamp();
+	{	void* c = nullptr;
+		uint csz;
+		Compress(data.data(), kSize, c, csz, CompressionFlags_Speed);
+		double compressMs = (Time::GetTimestamp() - t).asMilliseconds();
+		void* d = nullptr;
+		uint dsz;
+		t = Time::GetTimestamp();
+		Decompress(c, csz, d, dsz);
+		APT_LOG("\tCompress()/Decompress()            compress %8.2fms, decompress %8.2fms, %.2fMB", compressMs, (Time::GetTimestamp() - t).asMilliseconds(), (double)csz / (1024.0 * 1024.0));
+		free(c);
+		free(d);
+	}
+
+	const uint kThreadCounts[] = { 1, 2, 4, 8 };
+	for (uint threadCount : kThreadCounts) {
+		void* c = nullptr;
+		uint csz;
+		t = Time::GetTimestamp();
+		CompressBlocks(data.data(), kSize, c, csz, CompressionFlags_Speed, kCompressBlockSize, threadCount);
+		double compressMs = (Time::GetTimestamp() - t).asMilliseconds();
+		void* d = nullptr;
+		uint dsz;
+		t = Time::GetTimestamp();
+		REQUIRE(DecompressBlocks(c, csz, d, dsz, threadCount));
+		double decompressMs = (Time::GetTimestamp() - t).asMilliseconds();
+		REQUIRE(memcmp(d, data.data(), kSize) == 0);
+		APT_LOG("\tCompressBlocks()/DecompressBlocks() compress %8.2fms, decompress %8.2fms, %.2fMB (%u threads)", compressMs, decompressMs, (double)csz / (1024.0 * 1024.0), threadCount);
+		if (threadCount == 1) {
+			eastl::vector<char> block(kCompressBlockSize);
+			t = Time::GetTimestamp();
+			REQUIRE(DecompressBlock(c, csz, 512, block.data(), kCompressBlockSize) == kCompressBlockSize);
+			APT_LOG("\tDecompressBlock()                  %8.2fms", (Time::GetTimestamp() - t).asMilliseconds());
+		}
+		free(c);
+		free(d);
+	}
+}
+
+TEST_CASE("Compression codecs", "[Compression][.]")
+{
+	const uint kSize = 16 * 1024 * 1024;
+	APT_LOG("\nCompression codecs *********");
+
+ // corpus
+	eastl::vector<char> text(kSize);
+	GenerateData(text.data(), kSize);
+	eastl::vector<char> json;
+	json.reserve(kSize);
+	Rand<> rnd;
+	for (uint i = 0; json.size() < kSize; ++i) {
+		char buf[256];
+		int n = snprintf(buf, sizeof(buf), "{\"Name\":\"Monster%u\",\"Level\":%d,\"Position\":[%.4f,%.4f,%.4f],\"Hostile\":%s},\n", i, rnd.get<int>(0, 100), rnd.get<float>(), rnd.get<float>(), rnd.get<float>(), rnd.get<bool>() ? "true" : "false");
+		json.insert(json.end(), buf, buf + n);
+	}
+	json.resize(kSize);
+	eastl::vector<char> mesh(kSize); // position, normal, uv on a grid
+	float32* vertex = (float32*)mesh.data();
+	for (uint i = 0; i < kSize / (8 * sizeof(float32)); ++i, vertex += 8) {
+		float32 x = (float32)(i % 1024), z = (float32)(i / 1024);
+		vertex[0] = x;
+		vertex[1] = sinf(x * 0.1f) * cosf(z * 0.1f);
+		vertex[2] = z;
+		vertex[3] = 0.0f;
+		vertex[4] = 1.0f;
+		vertex[5] = 0.0f;
+		vertex[6] = x / 1024.0f;
+		vertex[7] = z / 1024.0f;
+	}
+	eastl::vector<char> noise(kSize);
+	for (char& c : noise) {
+		c = (char)rnd.raw();
+	}
+	struct Sample { const char* m_name; const eastl::vector<char>* m_data; };
+	const Sample kCorpus[] = { { "text", &text }, { "json", &json }, { "mesh", &mesh }, { "noise", &noise } };
+
+	struct Codec { const char* m_name; CompressionFlags m_flags; };
+	const Codec kCodecs[] = { { "Speed  ", CompressionFlags_Speed }, { "Size   ", CompressionFlags_Size }, { "Fastest", CompressionFlags_Fastest } };
+
+	for (auto& sample : kCorpus) {
+		APT_LOG("\t%s (%.2fMB):", sample.m_name, (double)kSize / (1024.0 * 1024.0));
+		for (auto& codec : kCodecs) {
+			void* c = nullptr;
+			uint csz;
+			Timestamp t = Time::GetTimestamp();
+			Compress(sample.m_data->data(), kSize, c, csz, codec.m_flags);
+			double compressS = (Time::GetTimestamp() - t).asSeconds();
+			void* d = nullptr;
+			uint dsz;
+			t = Time::GetTimestamp();
+			Decompress(c, csz, d, dsz);
+			double decompressS = (Time::GetTimestamp() - t).asSeconds();
+			REQUIRE(memcmp(d, sample.m_data->data(), kSize) == 0);
+			double mb = (double)kSize / (1024.0 * 1024.0);
+			APT_LOG("\t\t%s  ratio %6.2f%%, compress %8.2fMB/s, decompress %8.2fMB/s", codec.m_name, (double)csz / (double)kSize * 100.0, mb / compressS, mb / decompressS);
+			free(c);
+			free(d);
+		}
+	}
+}
+
+TEST_CASE("Compress small buffers", "[Compression][.]")
+{
+	const uint kTotalSize = 16 * 1024 * 1024;
+	APT_LOG("\nCompress small buffers *********");
+
+	eastl::vector<char> data(kTotalSize);
+	GenerateData(data.data(), kTotalSize);
+	eastl::vector<char> out(64 * 1024);
+
+	const uint kSizes[] = { 1024, 4 * 1024, 16 * 1024, 64 * 1024 };
+	const CompressionFlags kFlags[] = { CompressionFlags_Speed, CompressionFlags_Fastest };
+	for (CompressionFlags flags : kFlags) {
+		APT_LOG("\t%s:", flags == CompressionFlags_Speed ? "Speed" : "Fastest");
+		for (uint size : kSizes) {
+			uint count = kTotalSize / size;
+			eastl::vector<void*> c(count, nullptr);
+			eastl::vector<uint> csz(count);
+			Timestamp t = Time::GetTimestamp();
+			for (uint i = 0; i < count; ++i) {
+				Compress(data.data() + i * size, size, c[i], csz[i], flags);
+			}
+			double compressUs = (Time::GetTimestamp() - t).asMicroseconds() / (double)count;
+
+			t = Time::GetTimestamp();
+			for (uint i = 0; i < count; ++i) {
+				void* d = nullptr;
+				uint dsz;
+				Decompress(c[i], csz[i], d, dsz);
+				free(d);
+			}
+			double decompressUs = (Time::GetTimestamp() - t).asMicroseconds() / (double)count;
+
+			uint total = 0;
+			t = Time::GetTimestamp();
+			for (uint i = 0; i < count; ++i) {
+				total += DecompressTo(c[i], csz[i], out.data(), size);
+			}
+			double decompressToUs = (Time::GetTimestamp() - t).asMicroseconds() / (double)count;
+			REQUIRE(total == count * size);
+			REQUIRE(memcmp(out.data(), data.data() + (count - 1) * size, size) == 0);
+
+			APT_LOG("\t\t%5ukb x %6u  Compress %8.2fus, Decompress %8.2fus, DecompressTo %8.2fus", size / 1024, count, compressUs, decompressUs, decompressToUs);
+			for (void* p : c) {
+				free(p);
+			}
+		}
+	}
+}
+
+TEST_CASE("CompressionDictionary performance", "[Compression][.]")
+{
+	const uint kCount = 200000;
+	APT_LOG("\nCompressionDictionary performance *********");
+
+	eastl::vector<char> samples;
+	eastl::vector<uint> sampleSizes;
+	GenerateRecords(samples, sampleSizes, 20000, 1);
+	eastl::vector<char> records;
+	eastl::vector<uint> recordSizes;
+	GenerateRecords(records, recordSizes, kCount, 2);
+	double mb = (double)records.size() / (1024.0 * 1024.0);
+	APT_LOG("\t%u records, %.2fMB (%u bytes per record):", kCount, mb, (uint)records.size() / kCount);
+
+	eastl::vector<void*> c(kCount, nullptr);
+	eastl::vector<uint> csz(kCount);
+	eastl::vector<char> out(1024);
+	auto run = [&](const char* _name, const CompressionDictionary* _dict, CompressionFlags _flags) {
+			const char* record = records.data();
+			Timestamp t = Time::GetTimestamp();
+			for (uint i = 0; i < kCount; ++i) {
+				if (_dict) {
+					Compress(record, recordSizes[i], *_dict, c[i], csz[i], _flags);
+				} else {
+					Compress(record, recordSizes[i], c[i], csz[i], _flags);
+				}
+				record += recordSizes[i];
+			}
+			double compressS = (Time::GetTimestamp() - t).asSeconds();
+
+			uint total = 0;
+			uint64 compressedSize = 0;
+			t = Time::GetTimestamp();
+			for (uint i = 0; i < kCount; ++i) {
+				total += _dict ? DecompressTo(c[i], csz[i], *_dict, out.data(), (uint)out.size()) : DecompressTo(c[i], csz[i], out.data(), (uint)out.size());
+				compressedSize += csz[i];
+			}
+			double decompressS = (Time::GetTimestamp() - t).asSeconds();
+			REQUIRE(total == (uint)records.size());
+
+			APT_LOG("\t\t%-22s ratio %6.2f%%, compress %8.2fMB/s, decompress %8.2fMB/s", _name, (double)compressedSize / (double)records.size() * 100.0, mb / compressS, mb / decompressS);
+			for (void*& p : c) {
+				free(p);
+				p = nullptr;
+			}
+		};
+
+	run("Speed", nullptr, CompressionFlags_Speed);
+	run("Size", nullptr, CompressionFlags_Size);
+	run("Fastest", nullptr, CompressionFlags_Fastest);
+	const uint kDictSizes[] = { 4 * 1024, 16 * 1024, 32 * 1024 };
+	for (uint dictSize : kDictSizes) {
+		CompressionDictionary dict;
+		Timestamp t = Time::GetTimestamp();
+		CompressionDictionary::Train(dict, samples.data(), sampleSizes.data(), (uint)sampleSizes.size(), dictSize);
+		APT_LOG("\t\t%ukb dictionary, trained from %u samples in %.2fms", dictSize / 1024, (uint)sampleSizes.size(), (Time::GetTimestamp() - t).asMilliseconds());
+		run("Speed + dictionary", &dict, CompressionFlags_Speed);
+		run("Size + dictionary", &dict, CompressionFlags_Size);
+	}
+}
@@ -0,0 +1,246 @@
+#include <catch.hpp>
+
+#include <apt/log.h>
+#include <apt/numeric.h>
+#include <apt/rand.h>
+#include <apt/Time.h>
+
+#include <cfloat>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace apt;
+
+static double RandDouble(Rand<>& _rnd)
+{
+ // random bit patterns cover the whole range, including subnormals
+	for (;;) {
+		uint64 bits = ((uint64)_rnd.raw() << 32) | _rnd.raw();
+		double ret;
+		memcpy(&ret, &bits, sizeof(ret));
+		if (std::isfinite(ret)) {
+			return ret;
+		}
+	}
+}
+
+static float RandFloat(Rand<>& _rnd)
+{
+	for (;;) {
+		uint32 bits = _rnd.raw();
+		float ret;
+		memcpy(&ret, &bits, sizeof(ret));
+		if (std::isfinite(ret)) {
+			return ret;
+		}
+	}
+}
+
+TEST_CASE("IntToString, ParseInt", "[numeric]")
+{
+	const sint64 kValues[] = { 0, 1, -1, 9, 10, 99, 100, 12345, -12345, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN };
+	char buf[kMaxIntStringLength];
+	char ref[kMaxIntStringLength];
+	for (sint64 value : kValues) {
+		uint len = IntToString(buf, value);
+		snprintf(ref, sizeof(ref), "%" PRId64, value);
+		REQUIRE(strcmp(buf, ref) == 0);
+		REQUIRE(len == strlen(ref));
+		sint64 parsed;
+		REQUIRE(ParseInt(parsed, buf) == buf + len);
+		REQUIRE(parsed == value);
+	}
+	REQUIRE(UintToString(buf, UINT64_MAX) == 20);
+	REQUIRE(strcmp(buf, "18446744073709551615") == 0);
+
+	sint64 i = 7;
+	REQUIRE(*ParseInt(i, "+42,") == ',');
+	REQUIRE(i == 42);
+	REQUIRE(*ParseInt(i, "0x1F ") == ' ');
+	REQUIRE(i == 31);
+	REQUIRE(*ParseInt(i, "-0xff") == '\0');
+	REQUIRE(i == -255);
+	REQUIRE(*ParseInt(i, "0012") == '\0');
+	REQUIRE(i == 12);
+	REQUIRE(*ParseInt(i, "0x") == 'x'); // parses "0"
+	REQUIRE(i == 0);
+	ParseInt(i, "99999999999999999999");
+	REQUIRE(i == INT64_MAX);
+	ParseInt(i, "-99999999999999999999");
+	REQUIRE(i == INT64_MIN);
+
+	const char* str = "abc";
+	i = 7;
+	REQUIRE(ParseInt(i, str) == str);
+	REQUIRE(ParseInt(i, "-") != nullptr);
+	REQUIRE(i == 7);
+}
+
+TEST_CASE("DoubleToString, FloatToString", "[numeric]")
+{
+	char buf[kMaxDoubleStringLength];
+
+	DoubleToString(buf, 0.1);          REQUIRE(strcmp(buf, "0.1") == 0);
+	DoubleToString(buf, 1.0);          REQUIRE(strcmp(buf, "1.0") == 0);
+	DoubleToString(buf, -2.5);         REQUIRE(strcmp(buf, "-2.5") == 0);
+	DoubleToString(buf, 1e30);         REQUIRE(strcmp(buf, "1e30") == 0);
+	DoubleToString(buf, -0.0);         REQUIRE(strcmp(buf, "-0.0") == 0);
+	DoubleToString(buf, INFINITY);     REQUIRE(strcmp(buf, "inf") == 0);
+	DoubleToString(buf, -INFINITY);    REQUIRE(strcmp(buf, "-inf") == 0);
+	DoubleToString(buf, NAN);          REQUIRE(strcmp(buf, "nan") == 0);
+	FloatToString(buf, 0.1f);          REQUIRE(strcmp(buf, "0.1") == 0);
+	FloatToString(buf, 3.14159f);      REQUIRE(strcmp(buf, "3.14159") == 0);
+	FloatToString(buf, FLT_MAX);       REQUIRE(strcmp(buf, "3.4028235e38") == 0);
+
+ // round trip
+	Rand<> rnd;
+	for (int i = 0; i < 100000; ++i) {
+		double d = RandDouble(rnd);
+		uint len = DoubleToString(buf, d);
+		REQUIRE(len < kMaxDoubleStringLength);
+		REQUIRE(strtod(buf, nullptr) == d);
+		double parsed;
+		REQUIRE(ParseDouble(parsed, buf) == buf + len);
+		REQUIRE(parsed == d);
+
+		float f = RandFloat(rnd);
+		len = FloatToString(buf, f);
+		REQUIRE(len < kMaxDoubleStringLength);
+		REQUIRE(strtof(buf, nullptr) == f);
+	}
+}
+
+TEST_CASE("ParseDouble", "[numeric]")
+{
+	const char* kValues[] =
+	{
+		"0", "-0", "1", "1.5", "-1.5", ".5", "5.", "1e10", "1E-10", "+1.25e+2", "123456789012345678901234567890",
+		"0.000000000000000000000000000000123456789", "3.14159265358979323846264338327950288",
+		"1.7976931348623157e308", "1.7976931348623159e308", "2.2250738585072014e-308", "4.9406564584124654e-324",
+		"2.4703282292062327e-324", "2.4703282292062328e-324", "1e-400", "1e400",
+		"9007199254740993", "9007199254740992.5", "18446744073709551615", "18446744073709551616.5",
+		"2.22507385850720113605740979670913197593481954635164564e-308",     // subnormal boundary
+		"7.3177701707893310e+15",                                            // half-way case
+		"1.00000000000000011102230246251565404236316680908203125",          // exactly half-way, rounds to even
+		"1.00000000000000011102230246251565404236316680908203126",          // just above half-way
+	};
+	for (const char* str : kValues) {
+		double ref = strtod(str, nullptr);
+		double parsed;
+		REQUIRE(*ParseDouble(parsed, str) == '\0');
+		REQUIRE(memcmp(&parsed, &ref, sizeof(double)) == 0);
+	}
+
+	double d = 7.0;
+	REQUIRE(*ParseDouble(d, "1.5,2") == ',');
+	REQUIRE(d == 1.5);
+	REQUIRE(*ParseDouble(d, "2e") == 'e');
+	REQUIRE(d == 2.0);
+	REQUIRE(*ParseDouble(d, "-Infinity") == '\0');
+	REQUIRE(d == -INFINITY);
+	REQUIRE(*ParseDouble(d, "NaN") == '\0');
+	REQUIRE(d != d);
+	d = 7.0;
+	const char* str = "e5";
+	REQUIRE(ParseDouble(d, str) == str);
+	REQUIRE(ParseDouble(d, ".") != nullptr);
+	REQUIRE(d == 7.0);
+
+ // random decimal strings with up to 25 digits
+	Rand<> rnd;
+	char buf[64];
+	for (int i = 0; i < 100000; ++i) {
+		int n = 0;
+		int digits = rnd.get<int>(1, 25);
+		int point = rnd.get<int>(0, digits);
+		for (int j = 0; j < digits; ++j) {
+			if (j == point) {
+				buf[n++] = '.';
+			}
+			buf[n++] = (char)('0' + rnd.get<int>(0, 9));
+		}
+		n += sprintf(buf + n, "e%d", rnd.get<int>(-330, 310));
+		double ref = strtod(buf, nullptr);
+		double parsed;
+		REQUIRE(ParseDouble(parsed, buf) == buf + n);
+		REQUIRE(memcmp(&parsed, &ref, sizeof(double)) == 0);
+	}
+}
+
+TEST_CASE("numeric performance", "[numeric][.]")
+{
+	const int kCount = 1000000;
+	Rand<> rnd;
+	double* doubles = new double[kCount];
+	sint64* ints = new sint64[kCount];
+	for (int i = 0; i < kCount; ++i) {
+	 // typical data (e.g. vertex positions, config values) rather than random bit patterns
+		doubles[i] = (double)rnd.get<float>(-1000.0f, 1000.0f);
+		ints[i] = (sint64)rnd.get<int>(-1000000, 1000000);
+	}
+	char* strs = new char[kCount * kMaxDoubleStringLength];
+
+	APT_LOG("\nnumeric performance (%d values) *********", kCount);
+	volatile double dsink = 0.0;
+	volatile sint64 isink = 0;
+	Timestamp t0, t1;
+
+	t0 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		snprintf(strs + i * kMaxDoubleStringLength, kMaxDoubleStringLength, "%.17g", doubles[i]);
+	}
+	t0 = Time::GetTimestamp() - t0;
+	t1 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		DoubleToString(strs + i * kMaxDoubleStringLength, doubles[i]);
+	}
+	t1 = Time::GetTimestamp() - t1;
+	APT_LOG("\tformat double   snprintf %8.2fms, DoubleToString %8.2fms (x%.2f)", t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds());
+
+	t0 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		dsink = dsink + strtod(strs + i * kMaxDoubleStringLength, nullptr);
+	}
+	t0 = Time::GetTimestamp() - t0;
+	t1 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		double d;
+		ParseDouble(d, strs + i * kMaxDoubleStringLength);
+		dsink = dsink + d;
+	}
+	t1 = Time::GetTimestamp() - t1;
+	APT_LOG("\tparse double    strtod   %8.2fms, ParseDouble    %8.2fms (x%.2f)", t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds());
+
+	t0 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		snprintf(strs + i * kMaxDoubleStringLength, kMaxDoubleStringLength, "%" PRId64, ints[i]);
+	}
+	t0 = Time::GetTimestamp() - t0;
+	t1 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		IntToString(strs + i * kMaxDoubleStringLength, ints[i]);
+	}
+	t1 = Time::GetTimestamp() - t1;
+	APT_LOG("\tformat int      snprintf %8.2fms, IntToString    %8.2fms (x%.2f)", t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds());
+
+	t0 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		isink = isink + strtoll(strs + i * kMaxDoubleStringLength, nullptr, 0);
+	}
+	t0 = Time::GetTimestamp() - t0;
+	t1 = Time::GetTimestamp();
+	for (int i = 0; i < kCount; ++i) {
+		sint64 n;
+		ParseInt(n, strs + i * kMaxDoubleStringLength);
+		isink = isink + n;
+	}
+	t1 = Time::GetTimestamp() - t1;
+	APT_LOG("\tparse int       strtoll  %8.2fms, ParseInt       %8.2fms (x%.2f)", t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds());
+
+	delete[] strs;
+	delete[] ints;
+	delete[] doubles;
+}
@@ -0,0 +1,153 @@
+#include <catch.hpp>
+
+#include <apt/log.h>
+#include <apt/math.h>
+#include <apt/memory.h>
+#include <apt/rand.h>
+#include <apt/simd_string.h>
+#include <apt/Time.h>
+
+#include <cstring>
+
+using namespace apt;
+using namespace apt::internal;
+
+// Fill _str with _len random chars from a small alphabet (such that matches are frequent), null terminate.
+static void RandString(Rand<>& _rnd, char* _str, uint _len)
+{
+	static const char kAlphabet[] = "abcXYZ019 \t\n\r\v\f_=;[]#\x80\xff";
+	for (uint i = 0; i < _len; ++i) {
+		_str[i] = kAlphabet[_rnd.get<int>(0, (int)sizeof(kAlphabet) - 2)];
+	}
+	_str[_len] = '\0';
+}
+
+// Call _test(str, len) for strings at every alignment within a 64 byte block and a range of lengths.
+template <typename tTest>
+static void ForEachString(tTest _test)
+{
+	Rand<> rnd;
+	char* buf = (char*)APT_MALLOC_ALIGNED(1024, 64);
+	for (uint offset = 0; offset < 64; ++offset) {
+		for (uint len = 0; len < 200; len += rnd.get<int>(1, 7)) {
+			char* str = buf + offset;
+			RandString(rnd, str, len);
+			_test(str, len);
+		}
+	}
+	APT_FREE_ALIGNED(buf);
+}
+
+TEST_CASE("search", "[simd_string]")
+{
+	ForEachString([](const char* _str, uint _len) {
+		for (const char* c = "aZ9 \n#\x80"; *c; ++c) {
+			REQUIRE(FindChar(_str, *c) == scalar::FindChar(_str, *c));
+		}
+		REQUIRE(FindChar(_str, '\0') == _str + _len);
+		const char* lists[] = { "", "a", "=;", "[]#", "\t\n\r\v\f", "0123456789abcdefg" }; // last list exceeds the SIMD limit
+		for (auto list : lists) {
+			REQUIRE(FindAny(_str, list) == scalar::FindAny(_str, list));
+			REQUIRE(FindWhitespaceOrAny(_str, list) == scalar::FindWhitespaceOrAny(_str, list));
+		}
+		REQUIRE(FindWhitespace(_str) == scalar::FindWhitespace(_str));
+		REQUIRE(SkipWhitespace(_str) == scalar::SkipWhitespace(_str));
+	});
+
+	char ws[] = " \t\n\r\v\f \t\n\r\v\f \t\n\r\v\f \t\n\r\v\f \t\n\r\v\fx";
+	REQUIRE(*SkipWhitespace(ws) == 'x');
+	ws[sizeof(ws) - 2] = '\0';
+	REQUIRE(SkipWhitespace(ws) == ws + sizeof(ws) - 2);
+}
+
+TEST_CASE("substring", "[simd_string]")
+{
+	ForEachString([](const char* _str, uint _len) {
+		const char* subs[] = { "", "a", "ab", "X\n", "9 \t", "abcabc", "_=;[]#" };
+		for (auto sub : subs) {
+			REQUIRE(FindSubstring(_str, sub) == scalar::FindSubstring(_str, sub));
+			REQUIRE(FindSubstring(_str, _len, sub, strlen(sub)) == scalar::FindSubstring(_str, _len, sub, strlen(sub)));
+		}
+	 // substrings taken from the string itself are always found
+		if (_len > 4) {
+			const char* sub = _str + _len - 5;
+			REQUIRE(FindSubstring(_str, _len, sub, 5) == strstr(_str, sub));
+			REQUIRE(FindSubstring(_str, sub) == strstr(_str, sub));
+		}
+	});
+
+	const char str[] = "abc\0abc\0xyz";
+	REQUIRE(FindSubstring(str, sizeof(str) - 1, "\0x", 2) == str + 7);
+	REQUIRE(FindSubstring(str, sizeof(str) - 1, "abcd", 4) == nullptr);
+	REQUIRE(FindSubstring("abc", 3, "abcd", 4) == nullptr);
+}
+
+TEST_CASE("count, replace, case", "[simd_string]")
+{
+	ForEachString([](const char* _str, uint _len) {
+		for (const char* c = "a\n\x80"; *c; ++c) {
+			REQUIRE(CountChar(_str, _str + _len, *c) == scalar::CountChar(_str, _str + _len, *c));
+		}
+
+		char a[256], b[256];
+		memcpy(a, _str, _len + 1);
+		memcpy(b, _str, _len + 1);
+		REQUIRE(ReplaceChar(a, _len, 'a', '\x80') == scalar::ReplaceChar(b, _len, 'a', '\x80'));
+		REQUIRE(memcmp(a, b, _len + 1) == 0);
+
+		ToUpperCase(a, _len);
+		scalar::ToUpperCase(b, _len);
+		REQUIRE(memcmp(a, b, _len + 1) == 0);
+		ToLowerCase(a, _len);
+		scalar::ToLowerCase(b, _len);
+		REQUIRE(memcmp(a, b, _len + 1) == 0);
+	});
+
+	char str[] = "Hello, World! [@`{]";
+	ToUpperCase(str, sizeof(str) - 1);
+	REQUIRE(strcmp(str, "HELLO, WORLD! [@`{]") == 0);
+	ToLowerCase(str, sizeof(str) - 1);
+	REQUIRE(strcmp(str, "hello, world! [@`{]") == 0);
+}
+
+TEST_CASE("performance", "[simd_string][.]")
+{
+	const uint kSizes[] = { 1024, 64 * 1024, 1024 * 1024, 100 * 1024 * 1024 };
+
+	APT_LOG("\nsimd_string performance *********");
+	for (uint size : kSizes) {
+	 // mostly identifiers separated by whitespace, so that the whitespace scans stop frequently
+		char* str = (char*)APT_MALLOC(size + 1);
+		Rand<> rnd;
+		for (uint i = 0; i < size; ++i) {
+			str[i] = rnd.get<int>(0, 15) == 0 ? (rnd.get<int>(0, 3) == 0 ? '\n' : ' ') : (char)rnd.get<int>('a', 'z');
+		}
+		str[size] = '\0';
+		const uint kRepeat = APT_MAX((uint)1, (64 * 1024 * 1024) / size);
+
+		#define BENCH(_name, _simd, _scalar) \
+			{ \
+				volatile uint64 sink = 0; \
+				Timestamp t0 = Time::GetTimestamp(); \
+				for (uint r = 0; r < kRepeat; ++r) { sink += (uint64)(_scalar); } \
+				t0 = Time::GetTimestamp() - t0; \
+				Timestamp t1 = Time::GetTimestamp(); \
+				for (uint r = 0; r < kRepeat; ++r) { sink += (uint64)(_simd); } \
+				t1 = Time::GetTimestamp() - t1; \
+				APT_LOG("\t%-16s scalar %10.3fms, simd %10.3fms (x%.2f)", _name, t0.asMilliseconds(), t1.asMilliseconds(), t0.asSeconds() / t1.asSeconds()); \
+			}
+
+		APT_LOG("%u bytes (x%u):", size, kRepeat);
+		BENCH("FindChar",       FindChar(str, '#'),                          scalar::FindChar(str, '#'));
+		BENCH("FindAny",        FindAny(str, "#[]"),                         scalar::FindAny(str, "#[]"));
+		BENCH("Tokenize",       ([str]{ const char* s = str; while (*s) { s = FindWhitespace(SkipWhitespace(s)); } return s; })(),
+		                        ([str]{ const char* s = str; while (*s) { s = scalar::FindWhitespace(scalar::SkipWhitespace(s)); } return s; })());
+		BENCH("FindSubstring",  FindSubstring(str, size, "zzzzzz", 6),       scalar::FindSubstring(str, size, "zzzzzz", 6));
+		BENCH("CountChar",      CountChar(str, str + size, '\n'),            scalar::CountChar(str, str + size, '\n'));
+		BENCH("ToUpperCase",    (ToUpperCase(str, size), 0),                 (scalar::ToUpperCase(str, size), 0));
+
+		#undef BENCH
+
+		APT_FREE(str);
+	}
+}